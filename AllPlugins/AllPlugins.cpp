@@ -0,0 +1,30 @@
+/**
+ *  @file AllPlugins.cpp
+ *  @author Goto Kenta
+ *  @brief すべてのエフェクトを1つのライブラリとして公開するエントリポイント
+ *  @note FMOD_PLUGINS_COMBINED=1 で各プラグインの.cppと一緒にビルドする。
+ *        ワーカープールやIRキャッシュはモジュールに1つなので、全エフェクトで共有される
+ */
+
+# include "../Common/FmodPluginBase.h"
+
+static_assert(FMOD_PLUGINS_COMBINED, "AllPlugins.cpp must be built with FMOD_PLUGINS_COMBINED=1");
+
+/* 各プラグインの.cppで FMOD_PLUGIN_EXPORT が定義する関数 */
+FMOD_DSP_DESCRIPTION* F_CALL GeneticReverb_GetDSPDescription();
+FMOD_DSP_DESCRIPTION* F_CALL BitCrasher_GetDSPDescription();
+FMOD_DSP_DESCRIPTION* F_CALL Template_GetDSPDescription();
+
+/**
+ * @brief FMODがライブラリ内のすべてのプラグインを取得するためのエクスポート関数
+ * @return FMOD_PLUGINTYPE_MAX で終わるプラグインの一覧
+ */
+extern "C" FMOD_EXPORT FMOD_PLUGINLIST* F_CALL FMODGetPluginDescriptionList() {
+    static FMOD_PLUGINLIST s_List[] = {
+        { FMOD_PLUGINTYPE_DSP, GeneticReverb_GetDSPDescription() },
+        { FMOD_PLUGINTYPE_DSP, BitCrasher_GetDSPDescription() },
+        { FMOD_PLUGINTYPE_DSP, Template_GetDSPDescription() },
+        { FMOD_PLUGINTYPE_MAX, nullptr },
+    };
+    return s_List;
+}
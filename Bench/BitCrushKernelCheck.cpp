@@ -0,0 +1,106 @@
+/**
+ *  @file BitCrushKernelCheck.cpp
+ *  @author Goto Kenta
+ *  @brief BitCrasherのSIMDカーネル（Classic）が、Faustが生成した mydsp::compute とビット単位で同じ出力になるかを確かめる
+ *  @note 使い方: BitCrushKernelCheck [ブロック数（チャンネル数ごと、既定 400）]
+ *        チャンネル数 1〜8 で、ブロックごとに長さ・Bits・Downsampling を乱数で変えながら両方で処理し、
+ *        出力を memcmp で比べる。一致しなければ最初に食い違った位置を表示して1を返す
+ */
+
+# include "../BitCrasher/BitCrushKernel.h"
+# include "../BitCrasher/FaustBitCrasher.h"
+
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <random>
+# include <vector>
+
+namespace {
+    constexpr unsigned int kMaxBlockSize = 1024;
+
+    /**
+     * @brief チャンネル数 channels で blocks ブロックを処理して比べる
+     * @return 一致すれば true
+     */
+    bool Check(int channels, int blocks, std::mt19937& rng) {
+        std::uniform_int_distribution<unsigned int> distFrames(1, kMaxBlockSize);
+        std::uniform_int_distribution<int> distBits(1, 16);
+        std::uniform_int_distribution<int> distDownsampling(1, 32);
+        std::uniform_real_distribution<float> distSample(-1.0f, 1.0f);
+
+        // Faust版はチャンネルごとに1インスタンス（BitCrasher の BITCRASHER_USE_FAUST_KERNEL と同じ）
+        std::vector<mydsp> faustDsps(static_cast<size_t>(channels));
+        for (mydsp& faustDsp : faustDsps) {
+            faustDsp.init(48000);
+        }
+
+        std::vector<float> kernelMemory(kBitCrushStateFloatsPerChannel * static_cast<size_t>(channels));
+        BitCrushKernelState kernel { };
+        BitCrushKernel_Bind(kernel, kernelMemory.data(), channels);
+        BitCrushKernel_Clear(kernel);
+
+        const size_t samples = static_cast<size_t>(kMaxBlockSize) * static_cast<size_t>(channels);
+        std::vector<float> in(samples), kernelOut(samples), faustOut(samples);
+        std::vector<float> scratchIn(kMaxBlockSize), scratchOut(kMaxBlockSize);
+
+        for (int block = 0 ; block < blocks ; ++block) {
+            const unsigned int frames = distFrames(rng);
+            const int bits = distBits(rng);
+            const int downsampling = distDownsampling(rng);
+            for (size_t i = 0 ; i < static_cast<size_t>(frames) * channels ; ++i) {
+                in[i] = distSample(rng);
+            }
+
+            BitCrushKernel_Process(kernel, in.data(), kernelOut.data(), frames, channels, bits, downsampling);
+
+            for (int ch = 0 ; ch < channels ; ++ch) {
+                mydsp& faustDsp = faustDsps[static_cast<size_t>(ch)];
+                faustDsp.fHslider1 = static_cast<FAUSTFLOAT>(bits);
+                faustDsp.fHslider0 = static_cast<FAUSTFLOAT>(downsampling);
+
+                for (unsigned int i = 0 ; i < frames ; ++i) {
+                    scratchIn[i] = in[i * channels + ch];
+                }
+                FAUSTFLOAT* fin[1] = { scratchIn.data() };
+                FAUSTFLOAT* fout[1] = { scratchOut.data() };
+                faustDsp.mydsp::compute(static_cast<int>(frames), fin, fout);
+                for (unsigned int i = 0 ; i < frames ; ++i) {
+                    faustOut[i * channels + ch] = scratchOut[i];
+                }
+            }
+
+            const size_t count = static_cast<size_t>(frames) * channels;
+            if (std::memcmp(kernelOut.data(), faustOut.data(), count * sizeof(float)) != 0) {
+                size_t first = 0;
+                while (std::memcmp(&kernelOut[first], &faustOut[first], sizeof(float)) == 0) {
+                    ++first;
+                }
+                std::printf("channels %d block %d (frames %u, bits %d, downsampling %d): frame %zu ch %zu kernel %.9g faust %.9g\n",
+                            channels, block, frames, bits, downsampling, first / channels, first % channels,
+                            kernelOut[first], faustOut[first]);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int blocks = (argc > 1) ? std::atoi(argv[1]) : 400;
+    if (blocks <= 0) {
+        std::fprintf(stderr, "usage: %s [blocks per channel count]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    bool passed = true;
+    for (int channels = 1 ; channels <= 8 ; ++channels) {
+        const bool matched = Check(channels, blocks, rng);
+        std::printf("%d ch: %s\n", channels, matched ? "bit-exact" : "MISMATCH");
+        passed = passed && matched;
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/**
+ *  @file BitCrushQualityCheck.cpp
+ *  @author Goto Kenta
+ *  @brief BitCrasherの品質モード（Dither / Noise Shaped / Anti-alias）のカーネルが、サンプルごとに順に計算した結果とビット単位で同じになるかを確かめる
+ *  @note 使い方: BitCrushQualityCheck [ブロック数（モード・チャンネル数ごと、既定 200）]
+ *        チャンネル数 1〜8 で、ブロックごとに長さ・Bits・Downsampling を乱数で変えながら処理し、次の2つを確かめる。
+ *        - BitCrushKernel_ProcessQuality（1・2チャンネルはフレーム方向、4チャンネル以上はチャンネル方向にSIMDでまとめる）と、
+ *          チャンネルごと・サンプルごとに計算した参照の出力を memcmp で比べる
+ *        - 出力とホールド値の差が、ディザ（±1.5ステップ）・ノイズシェーピング（±3ステップ）で決まる範囲に収まる
+ *        満たさなければ最初の位置を表示して1を返す
+ */
+
+# include "../BitCrasher/BitCrushKernel.h"
+
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <random>
+# include <vector>
+
+namespace {
+    constexpr unsigned int kMaxBlockSize = 1024;
+
+    /**
+     * @brief 1チャンネル分の参照の状態
+     */
+    struct ReferenceChannel {
+        float held = 0.0f;
+        float shapingError = 0.0f;
+        float filterZ1 = 0.0f;
+        float filterZ2 = 0.0f;
+        uint32_t noise1 = 0;
+        uint32_t noise2 = 0;
+    };
+
+    /**
+     * @brief 品質モードをチャンネルごと・サンプルごとに計算する（SIMDを使わない参照）
+     */
+    class Reference {
+    public:
+        explicit Reference(int channels) : m_channels(static_cast<size_t>(channels)) {
+            // BitCrushKernel_Clear と同じ種
+            for (int ch = 0 ; ch < channels ; ++ch) {
+                m_channels[static_cast<size_t>(ch)].noise1 = 0x9E3779B9u * static_cast<uint32_t>(ch + 1);
+                m_channels[static_cast<size_t>(ch)].noise2 = 0x9E3779B9u * static_cast<uint32_t>(channels + ch + 1);
+            }
+        }
+
+        void process(const float* in, float* out, float* held, unsigned int frames, int bits, int downsampling, int quality) {
+            const auto scale = static_cast<float>((1 << bits) - 1);
+            const float invScale = 1.0f / scale;
+            const bool shaped = (quality == BITCRUSH_QUALITY_NOISE_SHAPED);
+            const bool filtered = (quality == BITCRUSH_QUALITY_ANTI_ALIAS) && downsampling > 1;
+            const BitCrushFilterCoeffs c = filtered ? BitCrushKernel_AntiAliasCoeffs(downsampling) : BitCrushFilterCoeffs { };
+            const auto channels = static_cast<int>(m_channels.size());
+
+            for (int ch = 0 ; ch < channels ; ++ch) {
+                ReferenceChannel& s = m_channels[static_cast<size_t>(ch)];
+                for (unsigned int i = 0 ; i < frames ; ++i) {
+                    const size_t index = static_cast<size_t>(i) * channels + ch;
+                    float x = in[index];
+                    if (filtered) {
+                        const float y = c.b0 * x + s.filterZ1;
+                        s.filterZ1 = c.b1 * x - c.a1 * y + s.filterZ2;
+                        s.filterZ2 = c.b2 * x - c.a2 * y;
+                        x = y;
+                    }
+
+                    // サンプル番号が downsampling の倍数になる直前のサンプルで取り込む
+                    if ((m_sampleCount + i + 1) % static_cast<uint64_t>(downsampling) == 0) {
+                        s.held = x;
+                    }
+
+                    const float dither = BitCrushKernel_NoiseToFloat(BitCrushKernel_NextNoise(s.noise1))
+                                       + BitCrushKernel_NoiseToFloat(BitCrushKernel_NextNoise(s.noise2));
+                    float v = s.held * scale;
+                    if (shaped) {
+                        v -= s.shapingError;
+                    }
+                    const auto q = static_cast<float>(std::lrint(v + dither));
+                    if (shaped) {
+                        s.shapingError = q - v;
+                    }
+                    out[index] = q * invScale;
+                    held[index] = s.held;
+                }
+            }
+            m_sampleCount += frames;
+        }
+
+    private:
+        std::vector<ReferenceChannel> m_channels;
+        uint64_t m_sampleCount = 0;
+    };
+
+    /**
+     * @brief 品質モード quality、チャンネル数 channels で blocks ブロックを処理して比べる
+     * @return 一致し、誤差が範囲内なら true
+     */
+    bool Check(int quality, int channels, int blocks, std::mt19937& rng) {
+        std::uniform_int_distribution<unsigned int> distFrames(1, kMaxBlockSize);
+        std::uniform_int_distribution<int> distBits(1, 16);
+        std::uniform_int_distribution<int> distDownsampling(1, 32);
+        std::uniform_real_distribution<float> distSample(-1.0f, 1.0f);
+
+        std::vector<float> kernelMemory(kBitCrushStateFloatsPerChannel * static_cast<size_t>(channels));
+        BitCrushKernelState kernel { };
+        BitCrushKernel_Bind(kernel, kernelMemory.data(), channels);
+        BitCrushKernel_Clear(kernel);
+        Reference reference(channels);
+
+        // ノイズシェーピングは今回と前回の誤差（それぞれ ±1.5ステップ以内）の差が加わる
+        const float maxSteps = (quality == BITCRUSH_QUALITY_NOISE_SHAPED) ? 3.0f : 1.5f;
+
+        const size_t samples = static_cast<size_t>(kMaxBlockSize) * static_cast<size_t>(channels);
+        std::vector<float> in(samples), kernelOut(samples), referenceOut(samples), held(samples);
+
+        for (int block = 0 ; block < blocks ; ++block) {
+            const unsigned int frames = distFrames(rng);
+            const int bits = distBits(rng);
+            const int downsampling = distDownsampling(rng);
+            for (size_t i = 0 ; i < static_cast<size_t>(frames) * channels ; ++i) {
+                in[i] = distSample(rng);
+            }
+
+            BitCrushKernel_ProcessQuality(kernel, in.data(), kernelOut.data(), frames, channels, bits, downsampling, quality);
+            reference.process(in.data(), referenceOut.data(), held.data(), frames, bits, downsampling, quality);
+
+            const size_t count = static_cast<size_t>(frames) * channels;
+            if (std::memcmp(kernelOut.data(), referenceOut.data(), count * sizeof(float)) != 0) {
+                size_t first = 0;
+                while (std::memcmp(&kernelOut[first], &referenceOut[first], sizeof(float)) == 0) {
+                    ++first;
+                }
+                std::printf("quality %d channels %d block %d (frames %u, bits %d, downsampling %d): frame %zu ch %zu kernel %.9g reference %.9g\n",
+                            quality, channels, block, frames, bits, downsampling, first / channels, first % channels,
+                            kernelOut[first], referenceOut[first]);
+                return false;
+            }
+
+            const float scale = static_cast<float>((1 << bits) - 1);
+            for (size_t i = 0 ; i < count ; ++i) {
+                const float steps = std::fabs(kernelOut[i] - held[i]) * scale;
+                if (steps > maxSteps * 1.0001f) {
+                    std::printf("quality %d channels %d block %d (bits %d): frame %zu ch %zu is %.3g steps from the held value (limit %.3g)\n",
+                                quality, channels, block, bits, i / channels, i % channels, steps, maxSteps);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int blocks = (argc > 1) ? std::atoi(argv[1]) : 200;
+    if (blocks <= 0) {
+        std::fprintf(stderr, "usage: %s [blocks per quality and channel count]\n", argv[0]);
+        return 1;
+    }
+
+    static const struct {
+        int quality;
+        const char* name;
+    } kQualities[] = {
+        { BITCRUSH_QUALITY_DITHER, "dither" },
+        { BITCRUSH_QUALITY_NOISE_SHAPED, "noise shaped" },
+        { BITCRUSH_QUALITY_ANTI_ALIAS, "anti-alias" },
+    };
+
+    std::mt19937 rng(1234);
+    bool passed = true;
+    for (const auto& q : kQualities) {
+        for (int channels = 1 ; channels <= 8 ; ++channels) {
+            const bool matched = Check(q.quality, channels, blocks, rng);
+            std::printf("%s %d ch: %s\n", q.name, channels, matched ? "bit-exact" : "MISMATCH");
+            passed = passed && matched;
+        }
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/**
+ *  @file EnergyAnalysisCheck.cpp
+ *  @author Goto Kenta
+ *  @brief BatchedEnergyAnalysis の指標が、AnalysisHelpers のdoubleの積分と許容誤差内で一致するかを確かめる
+ *  @note 使い方: EnergyAnalysisCheck [試行回数（既定 16）]
+ *        CMakeでは BatchedEnergyAnalysis.cpp をfloatのカハン加算（FMOD_PLUGINS_FLOAT_ENERGY=1）でビルドした EnergyAnalysisCheck と、
+ *        doubleの積分でビルドした EnergyAnalysisCheckDouble の2つを作る。
+ *        減衰する雑音のIRを8本ずつ作り、次の2つを比べる。超えたら内容を表示して1を返す
+ *        - EDC: reverseEnergySum8Float と reverseEnergySum8 の相対誤差（全エネルギーの -80dB までのサンプル）
+ *        - 指標: BatchedEnergyAnalysis と calculateSchroederDecay → calculateT60 / calculateEDT、calculateC80（doubleの積分）の差
+ */
+
+# include "../GeneticReverb/AnalysisHelpers.h"
+# include "../GeneticReverb/BatchedEnergyAnalysis.h"
+# include "../Common/SimdDispatch.h"
+
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <random>
+# include <vector>
+
+# ifndef FMOD_PLUGINS_FLOAT_ENERGY
+    # define FMOD_PLUGINS_FLOAT_ENERGY 0
+# endif
+
+namespace {
+    constexpr float kSampleRate = 48000.0f;
+    constexpr size_t kLanes = BatchedEnergyAnalysis::kLanes;
+
+    constexpr double kMaxEdcRelativeError = 1e-6;       // カハン加算なら 1e-7 程度
+    constexpr double kMaxTimeError = 4.0 / kSampleRate; // T60・EDT（境界とほぼ等しいサンプルで数サンプルずれるのは許す）
+    constexpr double kMaxC80Error = 1e-4;               // dB
+
+    /**
+     * @brief T60 が t60 秒で減衰する雑音のIRを作る
+     */
+    std::vector<float> DecayingNoise(size_t length, double t60, std::mt19937& rng) {
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+        const double decay = std::pow(10.0, -3.0 / (t60 * kSampleRate));
+        std::vector<float> ir(length);
+        double amplitude = 1.0;
+        for (float& x : ir) {
+            x = static_cast<float>(amplitude) * dist(rng);
+            amplitude *= decay;
+        }
+        return ir;
+    }
+
+    struct Errors {
+        double edc = 0.0;
+        double t60 = 0.0;
+        double edt = 0.0;
+        double c80 = 0.0;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    const int trials = (argc > 1) ? std::atoi(argv[1]) : 16;
+    if (trials <= 0) {
+        std::fprintf(stderr, "usage: %s [trials]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> distT60(0.1, 3.0);
+    std::uniform_int_distribution<size_t> distLength(4800, 96000);
+
+    const SimdKernelTable& simd = SimdKernels();
+    BatchedEnergyAnalysis analysis;
+    Errors worst;
+    bool passed = true;
+
+    for (int trial = 0 ; trial < trials ; ++trial) {
+        // 長さの違うIRを混ぜる（短いレーンは BatchedEnergyAnalysis の中で0で埋められる）
+        std::vector<std::vector<float>> irs(kLanes);
+        const float* pointers[kLanes];
+        size_t lengths[kLanes];
+        size_t frames = 0;
+        for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+            irs[lane] = DecayingNoise(distLength(rng), distT60(rng), rng);
+            pointers[lane] = irs[lane].data();
+            lengths[lane] = irs[lane].size();
+            frames = std::max(frames, lengths[lane]);
+        }
+
+        // EDCそのもの
+        std::vector<std::vector<float>> padded(kLanes);
+        const float* sources[kLanes];
+        for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+            padded[lane] = irs[lane];
+            padded[lane].resize(frames, 0.0f);
+            sources[lane] = padded[lane].data();
+        }
+        std::vector<float> interleaved(frames * kLanes);
+        std::vector<double> edc(frames * kLanes);
+        std::vector<float> edcFloat(frames * kLanes);
+        simd.interleave8(sources, interleaved.data(), frames);
+        simd.reverseEnergySum8(interleaved.data(), edc.data(), frames);
+        simd.reverseEnergySum8Float(interleaved.data(), edcFloat.data(), frames);
+
+        for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+            const double floor = edc[lane] * 1e-8;
+            for (size_t i = 0 ; i < lengths[lane] ; ++i) {
+                const double reference = edc[i * kLanes + lane];
+                if (reference < floor) {
+                    break;
+                }
+                const double error = std::abs(static_cast<double>(edcFloat[i * kLanes + lane]) - reference) / reference;
+                worst.edc = std::max(worst.edc, error);
+            }
+        }
+
+        // 指標
+        EnergyMetrics metrics[kLanes];
+        analysis.analyze(pointers, lengths, kLanes, kSampleRate, metrics);
+        for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+            const std::vector<float> decay = calculateSchroederDecay(irs[lane]);
+            const double t60 = std::abs(metrics[lane].t60 - calculateT60(decay, kSampleRate));
+            const double edt = std::abs(metrics[lane].edt - calculateEDT(decay, kSampleRate));
+            const double c80 = std::abs(metrics[lane].c80 - calculateC80(irs[lane], kSampleRate));
+            worst.t60 = std::max(worst.t60, t60);
+            worst.edt = std::max(worst.edt, edt);
+            worst.c80 = std::max(worst.c80, c80);
+
+            if (t60 > kMaxTimeError || edt > kMaxTimeError || c80 > kMaxC80Error) {
+                std::printf("trial %d lane %zu (length %zu): |dT60| %.3g s, |dEDT| %.3g s, |dC80| %.3g dB\n",
+                            trial, lane, lengths[lane], t60, edt, c80);
+                passed = false;
+            }
+        }
+    }
+
+    if (worst.edc > kMaxEdcRelativeError) {
+        passed = false;
+    }
+
+    std::printf("EDC relative error %.3g (limit %.3g)\n", worst.edc, kMaxEdcRelativeError);
+    std::printf("|dT60| %.3g s, |dEDT| %.3g s (limit %.3g), |dC80| %.3g dB (limit %.3g)\n",
+                worst.t60, worst.edt, kMaxTimeError, worst.c80, kMaxC80Error);
+    std::printf("%s energy %s\n", FMOD_PLUGINS_FLOAT_ENERGY ? "float" : "double", passed ? "within tolerance" : "MISMATCH");
+    return passed ? 0 : 1;
+}
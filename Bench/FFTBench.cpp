@@ -0,0 +1,124 @@
+/**
+ *  @file FFTBench.cpp
+ *  @author Goto Kenta
+ *  @brief ビルドされているFFTの実装を、コンボリューターで使う分割長ごとに比べる
+ *  @note 使い方: FFTBench [秒数（サイズごと、既定 0.2）]
+ *        分割長 64〜4096（変換の長さはその2倍）で順変換と逆変換の1往復にかかる時間と、
+ *        往復の誤差・組み込みの実装とのスペクトルの差を表示する
+ */
+
+# include "../Common/FFT.h"
+
+# include <algorithm>
+# include <chrono>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <random>
+# include <vector>
+
+namespace {
+    struct Result {
+        double nsPerRoundTrip = 0.0;
+        double roundTripError = 0.0; // 往復したときの最大誤差
+        double spectrumError = 0.0;  // 組み込みの実装との最大差（スペクトルの最大値で割る）
+    };
+
+    Result Measure(const FFTPlan& plan, const FFTPlan& reference, const std::vector<float>& signal, double seconds) {
+        const size_t n = plan.size();
+        const size_t count = plan.complexSize();
+
+        FFTWorkspace work;
+        work.prepare(plan);
+        FFTWorkspace referenceWork;
+        referenceWork.prepare(reference);
+
+        std::vector<float> re(count), im(count), out(n);
+        std::vector<float> referenceRe(count), referenceIm(count);
+
+        Result result;
+
+        // 精度
+        plan.forward(signal.data(), re.data(), im.data(), work.data());
+        reference.forward(signal.data(), referenceRe.data(), referenceIm.data(), referenceWork.data());
+        double peak = 0.0;
+        for (size_t k = 0 ; k < count ; ++k) {
+            peak = std::max(peak, static_cast<double>(std::hypot(referenceRe[k], referenceIm[k])));
+            const double diff = std::hypot(static_cast<double>(re[k]) - referenceRe[k], static_cast<double>(im[k]) - referenceIm[k]);
+            result.spectrumError = std::max(result.spectrumError, diff);
+        }
+        if (peak > 0.0) {
+            result.spectrumError /= peak;
+        }
+
+        plan.inverse(re.data(), im.data(), out.data(), work.data());
+        for (size_t i = 0 ; i < n ; ++i) {
+            result.roundTripError = std::max(result.roundTripError, std::fabs(static_cast<double>(out[i]) - signal[i]));
+        }
+
+        // 速度（時間を読む回数を減らすため、まとめて回してから時間を見る）
+        const size_t batch = std::max<size_t>(1, (1u << 16) / n);
+        size_t iterations = 0;
+        const auto start = std::chrono::steady_clock::now();
+        double elapsed = 0.0;
+        do {
+            for (size_t b = 0 ; b < batch ; ++b) {
+                plan.forward(signal.data(), re.data(), im.data(), work.data());
+                plan.inverse(re.data(), im.data(), out.data(), work.data());
+            }
+            iterations += batch;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < seconds);
+
+        result.nsPerRoundTrip = elapsed * 1e9 / static_cast<double>(iterations);
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const double seconds = (argc > 1) ? std::atof(argv[1]) : 0.2;
+    if (seconds <= 0.0) {
+        std::fprintf(stderr, "usage: %s [seconds per size]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("default backend: %s\n", FFTPlan::BackendName(FFTPlan::DefaultBackend()));
+    std::printf("%-8s %-10s %14s %14s %14s %12s\n", "block", "backend", "ns/roundtrip", "roundtrip err", "vs builtin", "speedup");
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    for (size_t block = 64 ; block <= 4096 ; block *= 2) {
+        const size_t n = 2 * block;
+
+        // コンボリューターと同じく後半は0にする
+        std::vector<float> signal(n, 0.0f);
+        for (size_t i = 0 ; i < block ; ++i) {
+            signal[i] = dist(rng);
+        }
+
+        const auto reference = FFTPlan::Create(n, FFTBackend::Builtin);
+        double builtinNs = 0.0;
+
+        for (FFTBackend backend : { FFTBackend::Builtin, FFTBackend::PFFFT, FFTBackend::FFTW }) {
+            if (!FFTPlan::IsAvailable(backend)) {
+                continue;
+            }
+
+            const auto plan = FFTPlan::Create(n, backend);
+            if (plan->backend() != backend) {
+                std::printf("%-8zu %-10s %14s\n", block, FFTPlan::BackendName(backend), "(unsupported)");
+                continue;
+            }
+
+            const Result result = Measure(*plan, *reference, signal, seconds);
+            if (backend == FFTBackend::Builtin) {
+                builtinNs = result.nsPerRoundTrip;
+            }
+            std::printf("%-8zu %-10s %14.1f %14.2e %14.2e %11.2fx\n", block, FFTPlan::BackendName(backend),
+                        result.nsPerRoundTrip, result.roundTripError, result.spectrumError, builtinNs / result.nsPerRoundTrip);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ *  @file FFTCheck.cpp
+ *  @author Goto Kenta
+ *  @brief FFTの実装と PartitionedConvolver が、doubleで計算した素朴なDFT・直接の畳み込みと許容誤差内で一致するかを確かめる
+ *  @note 使い方: FFTCheck [畳み込みの試行回数（ブロックサイズごと、既定 4）]
+ *        - FFT: ビルドされている実装ごとに、長さ 2〜4096 の乱数を順変換してDFTと比べ、逆変換で元に戻るかを見る
+ *        - 畳み込み: ブロックサイズ 1 / 64 / 512 で、長さを乱数で決めたIRと入力を、乱数の長さに区切って process に渡し、
+ *          直接の畳み込みと比べる（使われるFFTは既定の実装。環境変数 FMOD_PLUGINS_FFT で選べる）
+ *        超えたら内容を表示して1を返す
+ */
+
+# include "../Common/FFT.h"
+# include "../Common/PartitionedConvolver.h"
+
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <random>
+# include <vector>
+
+namespace {
+    constexpr double kPi = 3.14159265358979323846;
+
+    constexpr double kMaxSpectrumError = 1e-5;    // DFTとの差の二乗和の平方根（DFTの二乗和の平方根で割る）
+    constexpr double kMaxRoundTripError = 1e-5;   // 往復したときの最大誤差（入力は -1〜1）
+    constexpr double kMaxConvolutionError = 1e-5; // 直接の畳み込みとの最大差（その最大値で割る）
+
+    /**
+     * @brief 実数列 in のDFTの前半（size / 2 + 1 個）をdoubleで求める
+     */
+    void ReferenceDFT(const std::vector<float>& in, std::vector<double>& re, std::vector<double>& im) {
+        const size_t n = in.size();
+        std::vector<double> cosTable(n), sinTable(n);
+        for (size_t i = 0 ; i < n ; ++i) {
+            cosTable[i] = std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(n));
+            sinTable[i] = std::sin(2.0 * kPi * static_cast<double>(i) / static_cast<double>(n));
+        }
+
+        re.assign(n / 2 + 1, 0.0);
+        im.assign(n / 2 + 1, 0.0);
+        for (size_t k = 0 ; k <= n / 2 ; ++k) {
+            double sumRe = 0.0, sumIm = 0.0;
+            for (size_t i = 0 ; i < n ; ++i) {
+                const size_t index = (k * i) % n;
+                sumRe += in[i] * cosTable[index];
+                sumIm -= in[i] * sinTable[index];
+            }
+            re[k] = sumRe;
+            im[k] = sumIm;
+        }
+    }
+
+    /**
+     * @brief 実装 backend を長さ 2〜4096 で確かめる
+     * @return 許容誤差内なら true
+     */
+    bool CheckFFT(FFTBackend backend, std::mt19937& rng) {
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        double worstSpectrum = 0.0, worstRoundTrip = 0.0;
+        bool passed = true;
+
+        for (size_t n = 2 ; n <= 4096 ; n *= 2) {
+            const auto plan = FFTPlan::Create(n, backend);
+            if (plan->backend() != backend) {
+                continue; // そのサイズに対応しない実装は組み込みの実装になる（組み込みの実装で確かめる）
+            }
+
+            std::vector<float> in(n);
+            for (float& x : in) {
+                x = dist(rng);
+            }
+
+            FFTWorkspace work;
+            work.prepare(*plan);
+            std::vector<float> re(plan->complexSize()), im(plan->complexSize()), out(n);
+            plan->forward(in.data(), re.data(), im.data(), work.data());
+
+            std::vector<double> referenceRe, referenceIm;
+            ReferenceDFT(in, referenceRe, referenceIm);
+            double errorSum = 0.0, referenceSum = 0.0;
+            for (size_t k = 0 ; k < plan->complexSize() ; ++k) {
+                const double dr = re[k] - referenceRe[k];
+                const double di = im[k] - referenceIm[k];
+                errorSum += dr * dr + di * di;
+                referenceSum += referenceRe[k] * referenceRe[k] + referenceIm[k] * referenceIm[k];
+            }
+            const double spectrumError = std::sqrt(errorSum / referenceSum);
+
+            plan->inverse(re.data(), im.data(), out.data(), work.data());
+            double roundTripError = 0.0;
+            for (size_t i = 0 ; i < n ; ++i) {
+                roundTripError = std::max(roundTripError, std::fabs(static_cast<double>(out[i]) - in[i]));
+            }
+
+            worstSpectrum = std::max(worstSpectrum, spectrumError);
+            worstRoundTrip = std::max(worstRoundTrip, roundTripError);
+            if (spectrumError > kMaxSpectrumError || roundTripError > kMaxRoundTripError) {
+                std::printf("%s size %zu: spectrum error %.3g, round trip error %.3g\n",
+                            FFTPlan::BackendName(backend), n, spectrumError, roundTripError);
+                passed = false;
+            }
+        }
+
+        std::printf("fft %-8s spectrum error %.3g (limit %.3g), round trip error %.3g (limit %.3g)\n",
+                    FFTPlan::BackendName(backend), worstSpectrum, kMaxSpectrumError, worstRoundTrip, kMaxRoundTripError);
+        return passed;
+    }
+
+    /**
+     * @brief ブロックサイズ blockSize の PartitionedConvolver を直接の畳み込みと比べる
+     * @return 許容誤差内なら true
+     */
+    bool CheckConvolver(size_t blockSize, int trials, std::mt19937& rng) {
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::uniform_int_distribution<size_t> distIrLength(1, 2000);
+        std::uniform_int_distribution<size_t> distInputLength(1, 4096);
+        std::uniform_int_distribution<size_t> distChunk(0, 3 * blockSize + 7); // ブロックの途中・ちょうど・複数ブロックを混ぜる
+        double worst = 0.0;
+        bool passed = true;
+
+        for (int trial = 0 ; trial < trials ; ++trial) {
+            std::vector<float> ir(distIrLength(rng)), input(distInputLength(rng));
+            for (float& x : ir) {
+                x = dist(rng);
+            }
+            for (float& x : input) {
+                x = dist(rng);
+            }
+
+            PartitionedConvolver convolver;
+            if (!convolver.init(blockSize, ir.data(), ir.size())) {
+                std::printf("convolver block %zu: init failed\n", blockSize);
+                return false;
+            }
+
+            std::vector<float> output(input.size());
+            for (size_t pos = 0 ; pos < input.size() ; ) {
+                const size_t chunk = std::min(distChunk(rng), input.size() - pos);
+                convolver.process(input.data() + pos, output.data() + pos, chunk);
+                pos += chunk;
+            }
+
+            double error = 0.0, peak = 0.0;
+            for (size_t i = 0 ; i < input.size() ; ++i) {
+                double reference = 0.0;
+                for (size_t j = 0 ; j < ir.size() && j <= i ; ++j) {
+                    reference += static_cast<double>(ir[j]) * input[i - j];
+                }
+                error = std::max(error, std::fabs(output[i] - reference));
+                peak = std::max(peak, std::fabs(reference));
+            }
+            error /= peak;
+
+            worst = std::max(worst, error);
+            if (error > kMaxConvolutionError) {
+                std::printf("convolver block %zu trial %d (ir %zu, input %zu): error %.3g\n",
+                            blockSize, trial, ir.size(), input.size(), error);
+                passed = false;
+            }
+        }
+
+        std::printf("convolver block %-4zu error %.3g (limit %.3g)\n", blockSize, worst, kMaxConvolutionError);
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int trials = (argc > 1) ? std::atoi(argv[1]) : 4;
+    if (trials <= 0) {
+        std::fprintf(stderr, "usage: %s [convolution trials per block size]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    bool passed = true;
+
+    for (FFTBackend backend : { FFTBackend::Builtin, FFTBackend::PFFFT, FFTBackend::FFTW }) {
+        if (FFTPlan::IsAvailable(backend)) {
+            passed = CheckFFT(backend, rng) && passed;
+        }
+    }
+
+    std::printf("convolver backend: %s\n", FFTPlan::BackendName(FFTPlan::DefaultBackend()));
+    for (size_t blockSize : { 1, 64, 512 }) {
+        passed = CheckConvolver(blockSize, trials, rng) && passed;
+    }
+
+    std::printf("%s\n", passed ? "within tolerance" : "MISMATCH");
+    return passed ? 0 : 1;
+}
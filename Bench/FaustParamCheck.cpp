@@ -0,0 +1,227 @@
+/**
+ *  @file FaustParamCheck.cpp
+ *  @author Goto Kenta
+ *  @brief FaustFmodPlugin が小さなFaustのUI定義から作るパラメータ表と、FAUST_FMOD_PLUGIN のエクスポートを確かめる
+ *  @note 使い方: FaustParamCheck
+ *        CMakeでは単体のライブラリと同じ FaustParamCheck と、FMOD_PLUGINS_COMBINED=1 でビルドした FaustParamCheckCombined の2つを作る。
+ *        - パラメータ表: スライダー・数値入力・ボタン・チェックボックス・バーグラフと [unit] メタデータが、
+ *          期待どおりの種類・名前・単位・範囲・既定値になるか
+ *        - 値の受け渡し: 設定した値が読み出せるか、バーグラフへの書き込みが拒否されるか、処理後にバーグラフの値が公開されるか
+ *        食い違ったら内容を表示して1を返す
+ */
+
+# include "../Common/FaustFmodPlugin.h"
+
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <vector>
+
+namespace {
+    /**
+     * @brief Faustが生成するクラスと同じ形の小さなDSP（入力にゲインをかけ、ピークをバーグラフに出す）
+     */
+    class SmallDSP {
+    public:
+        int getNumInputs() { return 1; }
+        int getNumOutputs() { return 1; }
+
+        void buildUserInterface(UI* ui) {
+            ui->openVerticalBox("Small");
+            ui->declare(&m_gain, "unit", "dB");
+            ui->addHorizontalSlider("Gain", &m_gain, FAUSTFLOAT(0.0f), FAUSTFLOAT(-60.0f), FAUSTFLOAT(12.0f), FAUSTFLOAT(0.1f));
+            ui->addNumEntry("Steps", &m_steps, FAUSTFLOAT(4.0f), FAUSTFLOAT(1.0f), FAUSTFLOAT(16.0f), FAUSTFLOAT(1.0f));
+            ui->addButton("Trigger", &m_trigger);
+            ui->addCheckButton("Bypass", &m_bypass);
+            ui->addHorizontalBargraph("Level", &m_level, FAUSTFLOAT(0.0f), FAUSTFLOAT(1.0f));
+            ui->closeBox();
+        }
+
+        void init(int) { instanceClear(); }
+        void instanceClear() { m_level = 0.0f; }
+
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {
+            const float gain = (m_bypass != 0.0f) ? 1.0f : std::pow(10.0f, m_gain / 20.0f);
+            float peak = 0.0f;
+            for (int i = 0 ; i < count ; ++i) {
+                outputs[0][i] = inputs[0][i] * gain;
+                peak = std::max(peak, std::fabs(outputs[0][i]));
+            }
+            m_level = peak;
+        }
+
+    private:
+        FAUSTFLOAT m_gain = 0.0f;
+        FAUSTFLOAT m_steps = 4.0f;
+        FAUSTFLOAT m_trigger = 0.0f;
+        FAUSTFLOAT m_bypass = 0.0f;
+        FAUSTFLOAT m_level = 0.0f;
+    };
+
+    /**
+     * @brief 期待するパラメータ定義
+     */
+    struct Expected {
+        const char* name;
+        const char* label;
+        FMOD_DSP_PARAMETER_TYPE type;
+        float min;
+        float max;
+        float defaultValue;
+    };
+
+    constexpr Expected kExpected[] = {
+        { "Gain",    "dB", FMOD_DSP_PARAMETER_TYPE_FLOAT, -60.0f, 12.0f, 0.0f },
+        { "Steps",   "",   FMOD_DSP_PARAMETER_TYPE_FLOAT, 1.0f,   16.0f, 4.0f },
+        { "Trigger", "",   FMOD_DSP_PARAMETER_TYPE_BOOL,  0.0f,   1.0f,  0.0f },
+        { "Bypass",  "",   FMOD_DSP_PARAMETER_TYPE_BOOL,  0.0f,   1.0f,  0.0f },
+        { "Level",   "",   FMOD_DSP_PARAMETER_TYPE_FLOAT, 0.0f,   1.0f,  0.0f },
+    };
+    constexpr int kGain = 0;
+    constexpr int kBypass = 3;
+    constexpr int kLevel = 4;
+
+    constexpr int kSampleRate = 48000;
+    constexpr unsigned int kBlockSize = 256;
+
+    void* F_CALL HostAlloc(unsigned int size, FMOD_MEMORY_TYPE, const char*) { return std::malloc(size); }
+    void* F_CALL HostRealloc(void* ptr, unsigned int size, FMOD_MEMORY_TYPE, const char*) { return std::realloc(ptr, size); }
+    void F_CALL HostFree(void* ptr, FMOD_MEMORY_TYPE, const char*) { std::free(ptr); }
+
+    FMOD_RESULT F_CALL HostGetSampleRate(FMOD_DSP_STATE*, int* rate) {
+        *rate = kSampleRate;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL HostGetBlockSize(FMOD_DSP_STATE*, unsigned int* blocksize) {
+        *blocksize = kBlockSize;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL HostGetSpeakerMode(FMOD_DSP_STATE*, FMOD_SPEAKERMODE* mixer, FMOD_SPEAKERMODE* output) {
+        if (mixer) *mixer = FMOD_SPEAKERMODE_STEREO;
+        if (output) *output = FMOD_SPEAKERMODE_STEREO;
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief パラメータ表を期待する定義と比べる
+     */
+    bool CheckTable(const FMOD_DSP_DESCRIPTION* desc) {
+        constexpr int expectedCount = static_cast<int>(sizeof(kExpected) / sizeof(kExpected[0]));
+        if (desc->numparameters != expectedCount || !desc->paramdesc) {
+            std::printf("expected %d parameters, got %d\n", expectedCount, desc->numparameters);
+            return false;
+        }
+
+        bool passed = true;
+        for (int p = 0 ; p < expectedCount ; ++p) {
+            const Expected& e = kExpected[p];
+            const FMOD_DSP_PARAMETER_DESC& d = *desc->paramdesc[p];
+
+            bool match = d.type == e.type && std::strcmp(d.name, e.name) == 0 && std::strcmp(d.label, e.label) == 0;
+            if (match && e.type == FMOD_DSP_PARAMETER_TYPE_FLOAT) {
+                match = d.floatdesc.min == e.min && d.floatdesc.max == e.max && d.floatdesc.defaultval == e.defaultValue;
+            }
+            else if (match) {
+                match = (d.booldesc.defaultval != 0) == (e.defaultValue != 0.0f);
+            }
+
+            if (!match) {
+                std::printf("parameter %d: got %s [%s] type %d, expected %s [%s] type %d (range %g..%g, default %g)\n",
+                            p, d.name, d.label, static_cast<int>(d.type), e.name, e.label, static_cast<int>(e.type), e.min, e.max, e.defaultValue);
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+    /**
+     * @brief プラグインを作って値を受け渡し、1ブロック処理する
+     */
+    bool CheckValues(FMOD_DSP_DESCRIPTION* desc) {
+        FMOD_DSP_STATE_FUNCTIONS functions { };
+        functions.alloc = HostAlloc;
+        functions.realloc = HostRealloc;
+        functions.free = HostFree;
+        functions.getsamplerate = HostGetSampleRate;
+        functions.getblocksize = HostGetBlockSize;
+        functions.getspeakermode = HostGetSpeakerMode;
+
+        FMOD_DSP_STATE state { };
+        state.functions = &functions;
+        if (desc->create(&state) != FMOD_OK || desc->reset(&state) != FMOD_OK) {
+            std::printf("create / reset failed\n");
+            return false;
+        }
+
+        bool passed = true;
+        float gain = 0.0f;
+        FMOD_BOOL bypass = 0;
+        if (desc->setparameterfloat(&state, kGain, -6.0f) != FMOD_OK ||
+            desc->getparameterfloat(&state, kGain, &gain, nullptr) != FMOD_OK || gain != -6.0f) {
+            std::printf("Gain: set -6, read back %g\n", gain);
+            passed = false;
+        }
+        if (desc->setparameterbool(&state, kBypass, 1) != FMOD_OK ||
+            desc->getparameterbool(&state, kBypass, &bypass, nullptr) != FMOD_OK || !bypass) {
+            std::printf("Bypass: set true, read back %d\n", static_cast<int>(bypass));
+            passed = false;
+        }
+        if (desc->setparameterfloat(&state, kLevel, 0.5f) == FMOD_OK) {
+            std::printf("Level: writing a bargraph was accepted\n");
+            passed = false;
+        }
+        if (desc->setparameterbool(&state, kGain, 1) == FMOD_OK) {
+            std::printf("Gain: writing a float parameter as bool was accepted\n");
+            passed = false;
+        }
+
+        // Bypass を戻し、-6dBで 0.5 のDCを処理するとバーグラフは 0.5 * 10^(-6/20)
+        desc->setparameterbool(&state, kBypass, 0);
+        std::vector<float> in(static_cast<size_t>(kBlockSize) * 2, 0.5f), out(in.size());
+        int inChannels = 2, outChannels = 2;
+        FMOD_CHANNELMASK inMask = 0, outMask = 0;
+        float* inBuffer = in.data();
+        float* outBuffer = out.data();
+        FMOD_DSP_BUFFER_ARRAY inArray { 1, &inChannels, &inMask, &inBuffer, FMOD_SPEAKERMODE_STEREO };
+        FMOD_DSP_BUFFER_ARRAY outArray { 1, &outChannels, &outMask, &outBuffer, FMOD_SPEAKERMODE_STEREO };
+        desc->process(&state, kBlockSize, &inArray, &outArray, false, FMOD_DSP_PROCESS_QUERY);
+        desc->process(&state, kBlockSize, &inArray, &outArray, false, FMOD_DSP_PROCESS_PERFORM);
+
+        const float expected = 0.5f * std::pow(10.0f, -6.0f / 20.0f);
+        float level = 0.0f;
+        desc->getparameterfloat(&state, kLevel, &level, nullptr);
+        if (std::fabs(level - expected) > 1e-6f || std::fabs(out.back() - expected) > 1e-6f) {
+            std::printf("after one block: Level %g, output %g, expected %g\n", level, out.back(), expected);
+            passed = false;
+        }
+
+        desc->release(&state);
+        return passed;
+    }
+}
+
+FAUST_FMOD_PLUGIN(SmallFaust, SmallDSP, "Small Faust", 0x00010002)
+
+# if FMOD_PLUGINS_COMBINED
+    // まとめたライブラリでは AllPlugins.cpp と同じくこの名前で参照する
+    # define SMALL_FAUST_DESCRIPTION SmallFaust_GetDSPDescription
+# else
+    # define SMALL_FAUST_DESCRIPTION FMODGetDSPDescription
+# endif
+
+int main() {
+    FMOD_DSP_DESCRIPTION* desc = SMALL_FAUST_DESCRIPTION();
+    bool passed = desc && std::strcmp(desc->name, "Small Faust") == 0 && desc->version == 0x00010002;
+    if (!passed) {
+        std::printf("exported description has the wrong name or version\n");
+    }
+    else {
+        passed = CheckTable(desc) && CheckValues(desc);
+    }
+
+    std::printf("%s export: %s\n", FMOD_PLUGINS_COMBINED ? "combined" : "single", passed ? "parameter table ok" : "MISMATCH");
+    return passed ? 0 : 1;
+}
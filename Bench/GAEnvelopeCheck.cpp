@@ -0,0 +1,180 @@
+/**
+ *  @file GAEnvelopeCheck.cpp
+ *  @author Goto Kenta
+ *  @brief GeneticAlgorithm の交叉・突然変異で少しずつ更新したエネルギー包絡が、IR全体から計算し直した包絡と一致するかを確かめる
+ *  @note 使い方: GAEnvelopeCheck [試行回数（交叉と突然変異の組み合わせごと、既定 300）]
+ *        CrossoverMethod と MutationMethod の全ての組み合わせで、長さの違う（32の倍数でないものを含む）親から子を作り、
+ *        交叉の後と突然変異の後の Individual::envelope を blockSumSquares で全体を計算し直した値と比べる。
+ *        子は半分の確率で次の試行の親にするので、更新した包絡を親として写す場合も確かめる。超えたら内容を表示して1を返す
+ */
+
+# include "../GeneticReverb/GeneticAlgorithm.h"
+# include "../Common/SimdDispatch.h"
+
+# include <algorithm>
+# include <cmath>
+# include <cstdint>
+# include <cstdio>
+# include <cstdlib>
+# include <random>
+# include <vector>
+
+/**
+ * @brief GeneticAlgorithm の交叉・突然変異を直接呼ぶ
+ */
+struct GeneticAlgorithmCheckAccess {
+    static Individual Crossover(GeneticAlgorithm& ga, const Individual& parent1, const Individual& parent2) { return ga.crossover(parent1, parent2); }
+    static void Mutate(GeneticAlgorithm& ga, Individual& ind) { ga.mutate(ind); }
+    static void UpdateEnvelope(Individual& ind) { GeneticAlgorithm::updateEnvelope(ind, 0, ind.ir.size()); }
+};
+
+namespace {
+    constexpr float kSampleRate = 48000.0f;
+    constexpr size_t kBlockSize = GeneticAlgorithm::kEnvelopeBlockSize;
+    constexpr size_t kMaxLength = 100 * kBlockSize;
+
+    constexpr double kMaxRelativeError = 1e-12; // 同じカーネルでブロックの頭から足すので、本来は一致する
+    constexpr double kMinEnergy = 1e-30;
+
+    const char* CrossoverName(CrossoverMethod method) {
+        switch (method) {
+            case CrossoverMethod::Uniform: return "Uniform";
+            case CrossoverMethod::Segment: return "Segment";
+            case CrossoverMethod::Blend: return "Blend";
+            case CrossoverMethod::EnvelopePreserving: return "EnvelopePreserving";
+        }
+        return "?";
+    }
+
+    const char* MutationName(MutationMethod method) {
+        return (method == MutationMethod::Fixed) ? "Fixed" : "SelfAdaptive";
+    }
+
+    /**
+     * @brief 長さを乱数で決める（32の倍数・32未満・ブロックの途中で終わるものを混ぜる）
+     */
+    size_t RandomLength(std::mt19937& rng) {
+        std::uniform_int_distribution<int> distKind(0, 3);
+        std::uniform_int_distribution<size_t> distBlocks(1, kMaxLength / kBlockSize);
+        std::uniform_int_distribution<size_t> distShort(1, kBlockSize - 1);
+        std::uniform_int_distribution<size_t> distAny(1, kMaxLength);
+        switch (distKind(rng)) {
+            case 0: return distBlocks(rng) * kBlockSize;
+            case 1: return distShort(rng);
+            default: return distAny(rng);
+        }
+    }
+
+    /**
+     * @brief 減衰する雑音の個体を作る（ときどき無音のブロックを入れる）
+     */
+    Individual RandomIndividual(size_t length, std::mt19937& rng) {
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+        std::uniform_real_distribution<double> distT60(0.05, 0.5);
+        const double decay = std::pow(10.0, -3.0 / (distT60(rng) * kSampleRate));
+
+        Individual ind;
+        ind.ir.resize(length);
+        double amplitude = 1.0;
+        for (float& x : ind.ir) {
+            x = static_cast<float>(amplitude) * dist(rng);
+            amplitude *= decay;
+        }
+        if (std::uniform_int_distribution<int>(0, 3)(rng) == 0) {
+            const size_t block = std::uniform_int_distribution<size_t>(0, (length - 1) / kBlockSize)(rng);
+            std::fill(ind.ir.begin() + static_cast<std::ptrdiff_t>(block * kBlockSize),
+                      ind.ir.begin() + static_cast<std::ptrdiff_t>(std::min((block + 1) * kBlockSize, length)), 0.0f);
+        }
+
+        ind.mutationRate = 0.01f;
+        ind.mutationStep = 0.2f;
+        GeneticAlgorithmCheckAccess::UpdateEnvelope(ind);
+        return ind;
+    }
+
+    /**
+     * @brief 包絡を計算し直した値と比べる
+     * @return 最大の相対誤差（包絡の長さが違えば無限大）
+     */
+    double EnvelopeError(const Individual& ind) {
+        const size_t blocks = (ind.ir.size() + kBlockSize - 1) / kBlockSize;
+        if (ind.envelope.size() != blocks) {
+            return INFINITY;
+        }
+
+        std::vector<double> reference(blocks);
+        SimdKernels().blockSumSquares(ind.ir.data(), ind.ir.size(), kBlockSize, reference.data());
+        double error = 0.0;
+        for (size_t b = 0 ; b < blocks ; ++b) {
+            error = std::max(error, std::fabs(ind.envelope[b] - reference[b]) / std::max(reference[b], kMinEnergy));
+        }
+        return error;
+    }
+
+    /**
+     * @brief 交叉と突然変異の組み合わせ1つを確かめる
+     * @return 許容誤差内なら true
+     */
+    bool Check(CrossoverMethod crossover, MutationMethod mutation, int trials, std::mt19937& rng) {
+        GeneticAlgorithm ga(2, 0.01f, kSampleRate);
+        ga.setSeed(static_cast<uint32_t>(rng()));
+        ga.setCrossover(crossover, 3);
+        ga.setMutation(mutation);
+
+        Individual parent1 = RandomIndividual(RandomLength(rng), rng);
+        Individual parent2 = RandomIndividual(RandomLength(rng), rng);
+        double worstCrossover = 0.0, worstMutation = 0.0;
+        bool passed = true;
+
+        for (int trial = 0 ; trial < trials ; ++trial) {
+            Individual child = GeneticAlgorithmCheckAccess::Crossover(ga, parent1, parent2);
+            const double crossoverError = EnvelopeError(child);
+            GeneticAlgorithmCheckAccess::Mutate(ga, child);
+            const double mutationError = EnvelopeError(child);
+
+            worstCrossover = std::max(worstCrossover, crossoverError);
+            worstMutation = std::max(worstMutation, mutationError);
+            if (crossoverError > kMaxRelativeError || mutationError > kMaxRelativeError) {
+                std::printf("%s / %s trial %d (parents %zu, %zu): crossover error %.3g, mutation error %.3g\n",
+                            CrossoverName(crossover), MutationName(mutation), trial, parent1.ir.size(), parent2.ir.size(),
+                            crossoverError, mutationError);
+                passed = false;
+            }
+
+            // 子を次の親にするか、新しい親と入れ替える
+            if (std::uniform_int_distribution<int>(0, 1)(rng) == 0) {
+                parent1 = std::move(child);
+            } else {
+                parent1 = RandomIndividual(RandomLength(rng), rng);
+            }
+            if (std::uniform_int_distribution<int>(0, 3)(rng) == 0) {
+                parent2 = RandomIndividual(parent1.ir.size(), rng); // 同じ長さの親
+            } else if (std::uniform_int_distribution<int>(0, 1)(rng) == 0) {
+                parent2 = RandomIndividual(RandomLength(rng), rng);
+            }
+        }
+
+        std::printf("%-18s / %-12s crossover error %.3g, mutation error %.3g (limit %.3g)\n",
+                    CrossoverName(crossover), MutationName(mutation), worstCrossover, worstMutation, kMaxRelativeError);
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int trials = (argc > 1) ? std::atoi(argv[1]) : 300;
+    if (trials <= 0) {
+        std::fprintf(stderr, "usage: %s [trials per method]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    bool passed = true;
+    for (CrossoverMethod crossover : { CrossoverMethod::Uniform, CrossoverMethod::Segment, CrossoverMethod::Blend, CrossoverMethod::EnvelopePreserving }) {
+        for (MutationMethod mutation : { MutationMethod::Fixed, MutationMethod::SelfAdaptive }) {
+            passed = Check(crossover, mutation, trials, rng) && passed;
+        }
+    }
+
+    std::printf("%s\n", passed ? "within tolerance" : "MISMATCH");
+    return passed ? 0 : 1;
+}
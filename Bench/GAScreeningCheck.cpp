@@ -0,0 +1,94 @@
+/**
+ *  @file GAScreeningCheck.cpp
+ *  @author Goto Kenta
+ *  @brief GeneticAlgorithm の粗い評価でのふるい分け（setScreening）で、詳しい評価の回数が減り、最終的な適応度が悪くならないかを確かめる
+ *  @note 使い方: GAScreeningCheck [世代数（既定 40）] [種の数（目標ごと、既定 2）]
+ *        目標ごと・種ごとに、同じ種でふるい分けの有無だけを変えて compute し、詳しく評価したIRの数と最良の適応度を表示する。
+ *        落とした子がエリートに入るはずのものでなければ、乱数の引き方は変わらないので最良の適応度は同じになる。
+ *        全体の評価の回数がふるい分けなしの kMaxEvaluationRatio 倍を超えるか、
+ *        最良の適応度の平均がふるい分けなしの平均より kFitnessMargin 以上悪ければ1を返す
+ */
+
+# include "../GeneticReverb/GeneticAlgorithm.h"
+
+# include <cstdint>
+# include <cstdio>
+# include <cstdlib>
+
+namespace {
+    constexpr float kSampleRate = 48000.0f;
+    constexpr int kPopulationSize = 50;    // IROptimizer::Create と同じ
+    constexpr float kMutationRate = 0.001f;
+
+    constexpr double kMaxEvaluationRatio = 0.95; // 集団が収束すると子の適応度の差が粗い評価の誤差と同じくらいになるので、減るのは1〜2割
+    constexpr double kFitnessMargin = 0.05;      // 最良の適応度の平均の悪化の許容量（T60 の 0.5ms 相当）
+
+    struct Result {
+        size_t evaluations = 0;
+        double fitness = 0.0;
+    };
+
+    /**
+     * @brief 種 seed で1回 compute する
+     */
+    Result Run(const ReverbTargetParams& target, uint32_t seed, bool screening, int generations) {
+        GeneticAlgorithm ga(kPopulationSize, kMutationRate, kSampleRate);
+        ga.setSeed(seed);
+        ga.setScreening(screening);
+
+        Result result;
+        ga.setProgressCallback([&result](int, int, double bestFitness) { result.fitness = bestFitness; });
+        ga.compute(target, generations);
+        result.evaluations = ga.evaluationCount();
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int generations = (argc > 1) ? std::atoi(argv[1]) : 40;
+    const int seeds = (argc > 2) ? std::atoi(argv[2]) : 2;
+    if (generations <= 0 || seeds <= 0) {
+        std::fprintf(stderr, "usage: %s [generations] [seeds per target]\n", argv[0]);
+        return 1;
+    }
+
+    ReverbTargetParams targets[3];
+    targets[0].t60 = 0.3f;
+    targets[0].c80 = 8.0f;
+    targets[1].t60 = 0.6f;
+    targets[1].c80 = 3.0f;
+    targets[2].t60 = 1.0f;
+    targets[2].c80 = 0.0f;
+
+    Result totalOn, totalOff;
+    int runs = 0, unchanged = 0;
+    for (const ReverbTargetParams& target : targets) {
+        for (int s = 0 ; s < seeds ; ++s) {
+            const auto seed = static_cast<uint32_t>(1234 + s);
+            const Result on = Run(target, seed, true, generations);
+            const Result off = Run(target, seed, false, generations);
+            std::printf("T60 %.2f C80 %5.1f seed %u: evaluations %6zu / %6zu, fitness %.4f / %.4f (screening on / off)\n",
+                        target.t60, target.c80, seed, on.evaluations, off.evaluations, on.fitness, off.fitness);
+
+            totalOn.evaluations += on.evaluations;
+            totalOn.fitness += on.fitness;
+            totalOff.evaluations += off.evaluations;
+            totalOff.fitness += off.fitness;
+            ++runs;
+            if (on.fitness == off.fitness) {
+                ++unchanged;
+            }
+        }
+    }
+
+    const double evaluationRatio = static_cast<double>(totalOn.evaluations) / static_cast<double>(totalOff.evaluations);
+    const double meanOn = totalOn.fitness / runs;
+    const double meanOff = totalOff.fitness / runs;
+    const bool passed = (evaluationRatio <= kMaxEvaluationRatio) && (meanOn <= meanOff + kFitnessMargin);
+
+    std::printf("evaluations %zu / %zu (ratio %.3f, limit %.3f)\n",
+                totalOn.evaluations, totalOff.evaluations, evaluationRatio, kMaxEvaluationRatio);
+    std::printf("mean fitness %.4f / %.4f (margin %.3f), same best fitness in %d of %d runs\n", meanOn, meanOff, kFitnessMargin, unchanged, runs);
+    std::printf("%s\n", passed ? "screening keeps quality" : "SCREENING REGRESSION");
+    return passed ? 0 : 1;
+}
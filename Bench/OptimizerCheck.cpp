@@ -0,0 +1,140 @@
+/**
+ *  @file OptimizerCheck.cpp
+ *  @author Goto Kenta
+ *  @brief CMA-ES・差分進化が届く目標に収束するか、全ての最適化が cancel で止まるかを確かめる
+ *  @note 使い方: OptimizerCheck [世代数の上限（既定 60）]
+ *        - 収束: CmaEsOptimizer / DifferentialEvolutionOptimizer を固定の種で compute し、返ったIRを BatchedEnergyAnalysis で測って、
+ *          T60 が kMaxT60Error、C80 が kMaxC80Error 以内か、適応度が kFitnessGoal を下回った世代とともに確かめる
+ *          （目標は ParametricIRModel の範囲内: 後部のT60は目標の 1/8〜4倍、初期部分のゲインは ±30dB）
+ *        - キャンセル: GA を含む全ての方法を別のスレッドで世代数 10000 で動かし、数世代進んだところで cancel を呼んで、
+ *          cancel が返った後に終わった世代が1つ以下で compute が戻り、空でないIRを返すかを確かめる
+ *        超えたら内容を表示して1を返す
+ */
+
+# include "../GeneticReverb/BatchedEnergyAnalysis.h"
+# include "../GeneticReverb/IROptimizer.h"
+
+# include <atomic>
+# include <chrono>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <thread>
+# include <vector>
+
+namespace {
+    constexpr float kSampleRate = 48000.0f;
+    constexpr uint32_t kSeed = 1234;
+
+    constexpr double kFitnessGoal = 0.5;    // 100 * |dT60| + |dC80|
+    constexpr double kMaxT60Error = 0.005;  // 秒
+    constexpr double kMaxC80Error = 0.5;    // dB
+
+    constexpr int kCancelGenerations = 10000;
+    constexpr int kCancelAfter = 3;         // この世代まで進んだら cancel する
+
+    /**
+     * @brief backend で target を探し、返ったIRを測って確かめる
+     * @return 許容誤差内なら true
+     */
+    bool CheckConvergence(OptimizerBackend backend, const ReverbTargetParams& target, int generations) {
+        const auto optimizer = IROptimizer::Create(backend, kSampleRate);
+        optimizer->setSeed(kSeed);
+
+        int reached = -1;
+        optimizer->setProgressCallback([&reached, generations](int curGen, int, double bestFitness) {
+            if (reached < 0 && curGen > 0 && curGen < generations && bestFitness < kFitnessGoal) {
+                reached = curGen;
+            }
+        });
+        const std::vector<float> ir = optimizer->compute(target, generations);
+        if (ir.empty()) {
+            std::printf("%-5s T60 %.2f C80 %5.1f: empty IR\n", IROptimizer::BackendName(backend), target.t60, target.c80);
+            return false;
+        }
+
+        BatchedEnergyAnalysis analysis;
+        const float* irs[1] = { ir.data() };
+        const size_t lengths[1] = { ir.size() };
+        EnergyMetrics metrics;
+        analysis.analyze(irs, lengths, 1, kSampleRate, &metrics);
+
+        const double t60Error = std::fabs(metrics.t60 - target.t60);
+        const double c80Error = std::fabs(metrics.c80 - target.c80);
+        const bool passed = t60Error <= kMaxT60Error && c80Error <= kMaxC80Error;
+        std::printf("%-5s T60 %.2f C80 %5.1f: |dT60| %.4f s, |dC80| %.3f dB, fitness < %.1f at generation %d, %zu evaluations%s\n",
+                    IROptimizer::BackendName(backend), target.t60, target.c80, t60Error, c80Error, kFitnessGoal, reached,
+                    optimizer->evaluationCount(), passed ? "" : "  FAILED");
+        return passed;
+    }
+
+    /**
+     * @brief backend の compute を別のスレッドで動かし、途中で cancel して止まるかを確かめる
+     * @return 止まれば true
+     */
+    bool CheckCancel(OptimizerBackend backend) {
+        const auto optimizer = IROptimizer::Create(backend, kSampleRate);
+        optimizer->setSeed(kSeed);
+
+        std::atomic<int> generation { 0 };
+        optimizer->setProgressCallback([&generation](int curGen, int totalGen, double) {
+            if (curGen < totalGen) {
+                generation.store(curGen);
+            }
+        });
+
+        ReverbTargetParams target;
+        target.t60 = 1.0f;
+        target.c80 = -30.0f; // 届かない目標（適応度で止まらないようにする）
+
+        std::vector<float> ir;
+        std::atomic<bool> finished { false };
+        std::thread worker([&] {
+            ir = optimizer->compute(target, kCancelGenerations);
+            finished.store(true);
+        });
+
+        while (generation.load() < kCancelAfter && !finished.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        optimizer->cancel();
+        const int cancelledAt = generation.load();
+        worker.join();
+
+        const int stoppedAt = generation.load();
+        const bool passed = !ir.empty() && stoppedAt <= cancelledAt + 1 && stoppedAt < kCancelGenerations;
+        std::printf("%-5s cancel at generation %d, stopped at %d%s\n",
+                    IROptimizer::BackendName(backend), cancelledAt, stoppedAt, passed ? "" : (ir.empty() ? "  EMPTY IR" : "  DID NOT STOP"));
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int generations = (argc > 1) ? std::atoi(argv[1]) : 60;
+    if (generations <= 0) {
+        std::fprintf(stderr, "usage: %s [max generations]\n", argv[0]);
+        return 1;
+    }
+
+    ReverbTargetParams targets[3];
+    targets[0].t60 = 0.4f;
+    targets[0].c80 = 8.0f;
+    targets[1].t60 = 1.0f;
+    targets[1].c80 = 4.0f;
+    targets[2].t60 = 2.0f;
+    targets[2].c80 = -1.0f;
+
+    bool passed = true;
+    for (OptimizerBackend backend : { OptimizerBackend::CMAES, OptimizerBackend::DifferentialEvolution }) {
+        for (const ReverbTargetParams& target : targets) {
+            passed = CheckConvergence(backend, target, generations) && passed;
+        }
+    }
+
+    for (OptimizerBackend backend : { OptimizerBackend::GeneticAlgorithm, OptimizerBackend::CMAES, OptimizerBackend::DifferentialEvolution }) {
+        passed = CheckCancel(backend) && passed;
+    }
+
+    std::printf("%s\n", passed ? "within tolerance" : "FAILED");
+    return passed ? 0 : 1;
+}
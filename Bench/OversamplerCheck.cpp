@@ -0,0 +1,228 @@
+/**
+ *  @file OversamplerCheck.cpp
+ *  @author Goto Kenta
+ *  @brief Oversampler の倍率・位相特性ごとに、レイテンシ・通過域のゲイン・イメージとエイリアスの除去量を確かめる
+ *  @note 使い方: OversamplerCheck
+ *        倍率 2 / 4 / 8 と線形位相・最小位相の組み合わせごとに、5チャンネル（4チャンネルはSIMD、1チャンネルはスカラー）で次を調べる。
+ *        - インパルス: 往復（何もしない処理）の応答の和が1で、直流の群遅延 Σ n h[n] / Σ h[n] が Latency() と一致し、全チャンネルが同じになるか
+ *        - 正弦波: 通過域（〜0.4 fs）のゲイン、アップサンプルで出るイメージ、ナイキストを超える成分を間引いたときのエイリアス
+ *        正弦波の周波数はDFTのビンにそろえ、過渡応答が消えてから測る。許容値を超えたら内容を表示して1を返す
+ */
+
+# include "../Common/Oversampler.h"
+
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <cstring>
+# include <vector>
+
+namespace {
+    constexpr double kPi = 3.14159265358979323846;
+
+    constexpr int kChannels = 5;           // 4チャンネルをSIMD、残りをスカラーで処理させる
+    constexpr unsigned int kMaxFrames = 256;
+    constexpr size_t kImpulseLength = 4096; // IIRの裾が消えるまで
+    constexpr size_t kDftLength = 4096;    // 元のレートでの測定長
+    constexpr size_t kSettle = 2048;       // 過渡応答を捨てるフレーム数
+
+    constexpr double kMaxDcGainError = 1e-4;
+    constexpr double kMaxLatencyError = 0.01;   // 元のレートのサンプル数
+    constexpr double kPassbandEdge = 0.4;       // 元のサンプリング周波数に対する比
+    constexpr double kMaxPassbandRipple = 0.05; // dB
+
+    // イメージ・エイリアスの除去量（dB、0.4 fs までの正弦波）。
+    // 線形位相は 0.4 fs のイメージ（0.6 fs）が1段目のハーフバンドの遷移帯域に入るので約83dB、最小位相は遷移帯域が狭いので100dB以上
+    constexpr double kMinRejectionLinear = 80.0;
+    constexpr double kMinRejectionMinimum = 100.0;
+
+    const char* PhaseName(OversamplerPhase phase) {
+        return (phase == OVERSAMPLER_LINEAR_PHASE) ? "linear" : "minimum";
+    }
+
+    /**
+     * @brief 倍率と位相特性を決めた Oversampler と、その領域
+     */
+    struct Instance {
+        Oversampler oversampler;
+        std::vector<float> memory;
+
+        Instance(int factor, OversamplerPhase phase) {
+            memory.resize(Oversampler::MemorySize(factor, kChannels, kMaxFrames) / sizeof(float) + 1);
+            oversampler.Init(factor, phase, kChannels, kMaxFrames, memory.data());
+        }
+    };
+
+    /**
+     * @brief signal のビン bin の振幅（長さ n の矩形窓DFT）
+     */
+    double BinAmplitude(const std::vector<double>& signal, size_t bin) {
+        const size_t n = signal.size();
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0 ; i < n ; ++i) {
+            const double phase = 2.0 * kPi * static_cast<double>((bin * i) % n) / static_cast<double>(n);
+            re += signal[i] * std::cos(phase);
+            im -= signal[i] * std::sin(phase);
+        }
+        return 2.0 * std::sqrt(re * re + im * im) / static_cast<double>(n);
+    }
+
+    /**
+     * @brief 全チャンネルに同じ値を並べたインタリーブバッファを作る
+     */
+    std::vector<float> Interleave(const std::vector<double>& mono) {
+        std::vector<float> out(mono.size() * kChannels);
+        for (size_t i = 0 ; i < mono.size() ; ++i) {
+            std::fill(out.begin() + static_cast<std::ptrdiff_t>(i * kChannels), out.begin() + static_cast<std::ptrdiff_t>((i + 1) * kChannels), static_cast<float>(mono[i]));
+        }
+        return out;
+    }
+
+    /**
+     * @brief 何もしない処理で往復させ、チャンネル ch を取り出す
+     */
+    std::vector<double> RoundTrip(Oversampler& oversampler, const std::vector<double>& mono, int ch) {
+        const std::vector<float> in = Interleave(mono);
+        std::vector<float> out(in.size());
+        oversampler.Process(in.data(), out.data(), static_cast<unsigned int>(mono.size()), [](float*, unsigned int) { });
+
+        std::vector<double> result(mono.size());
+        for (size_t i = 0 ; i < mono.size() ; ++i) {
+            result[i] = out[i * kChannels + static_cast<size_t>(ch)];
+        }
+        return result;
+    }
+
+    std::vector<double> Sine(size_t length, size_t bin, size_t period) {
+        std::vector<double> x(length);
+        for (size_t i = 0 ; i < length ; ++i) {
+            x[i] = 0.5 * std::sin(2.0 * kPi * static_cast<double>((bin * i) % period) / static_cast<double>(period));
+        }
+        return x;
+    }
+
+    /**
+     * @brief 1つの倍率・位相特性を調べる
+     * @return 許容値内なら true
+     */
+    bool Check(int factor, OversamplerPhase phase) {
+        bool passed = true;
+
+        // インパルス応答
+        double dcGain = 0.0, delay = 0.0;
+        bool channelsMatch = true;
+        {
+            Instance instance(factor, phase);
+            std::vector<double> impulse(kImpulseLength, 0.0);
+            impulse[0] = 1.0;
+            const std::vector<float> in = Interleave(impulse);
+            std::vector<float> out(in.size());
+            instance.oversampler.Process(in.data(), out.data(), static_cast<unsigned int>(kImpulseLength), [](float*, unsigned int) { });
+
+            double moment = 0.0;
+            for (size_t i = 0 ; i < kImpulseLength ; ++i) {
+                const float* frame = out.data() + i * kChannels;
+                dcGain += frame[0];
+                moment += static_cast<double>(i) * frame[0];
+                for (int ch = 1 ; ch < kChannels ; ++ch) {
+                    channelsMatch = channelsMatch && std::memcmp(&frame[ch], &frame[0], sizeof(float)) == 0;
+                }
+            }
+            delay = moment / dcGain;
+        }
+        const double latency = Instance(factor, phase).oversampler.Latency();
+        if (std::fabs(dcGain - 1.0) > kMaxDcGainError || std::fabs(delay - latency) > kMaxLatencyError || !channelsMatch) {
+            std::printf("%dx %s: DC gain %.6f, group delay %.4f vs Latency() %.4f, channels %s\n",
+                        factor, PhaseName(phase), dcGain, delay, latency, channelsMatch ? "match" : "DIFFER");
+            passed = false;
+        }
+
+        // 通過域のゲイン（往復）
+        double ripple = 0.0;
+        for (double ratio : { 0.01, 0.1, 0.2, 0.3, kPassbandEdge }) {
+            const auto bin = static_cast<size_t>(ratio * kDftLength);
+            Instance instance(factor, phase);
+            const std::vector<double> y = RoundTrip(instance.oversampler, Sine(kSettle + kDftLength, bin, kDftLength), kChannels - 1);
+            const double gain = 20.0 * std::log10(BinAmplitude(std::vector<double>(y.begin() + kSettle, y.end()), bin) / 0.5);
+            ripple = std::max(ripple, std::fabs(gain));
+        }
+        if (ripple > kMaxPassbandRipple) {
+            std::printf("%dx %s: passband gain deviates %.4f dB up to %.2f fs\n", factor, PhaseName(phase), ripple, kPassbandEdge);
+            passed = false;
+        }
+
+        // イメージ（アップサンプルだけ。高いレートでは m N ± k のビンに出る）
+        const size_t highLength = kDftLength * static_cast<size_t>(factor);
+        double image = -400.0;
+        for (double ratio : { 0.1, 0.3, kPassbandEdge }) {
+            const auto bin = static_cast<size_t>(ratio * kDftLength);
+            Instance instance(factor, phase);
+            const std::vector<float> in = Interleave(Sine(kSettle + kDftLength, bin, kDftLength));
+            std::vector<double> up(highLength);
+            for (size_t offset = 0 ; offset < kSettle + kDftLength ; offset += kMaxFrames) {
+                const float* buffer = instance.oversampler.Upsample(in.data() + offset * kChannels, kMaxFrames);
+                for (size_t i = 0 ; i < kMaxFrames * static_cast<size_t>(factor) ; ++i) {
+                    const size_t index = offset * static_cast<size_t>(factor) + i;
+                    if (index >= kSettle * static_cast<size_t>(factor)) {
+                        up[index - kSettle * static_cast<size_t>(factor)] = buffer[i * kChannels];
+                    }
+                }
+            }
+
+            const double fundamental = BinAmplitude(up, bin);
+            for (size_t m = 1 ; m < static_cast<size_t>(factor) ; ++m) {
+                for (size_t imageBin : { m * kDftLength - bin, m * kDftLength + bin }) {
+                    if (imageBin <= highLength / 2) {
+                        image = std::max(image, 20.0 * std::log10(BinAmplitude(up, imageBin) / fundamental + 1e-20));
+                    }
+                }
+            }
+        }
+        const double minRejection = (phase == OVERSAMPLER_LINEAR_PHASE) ? kMinRejectionLinear : kMinRejectionMinimum;
+        if (-image < minRejection) {
+            std::printf("%dx %s: image rejection %.1f dB\n", factor, PhaseName(phase), -image);
+            passed = false;
+        }
+
+        // エイリアス（高いレートで fs - f0 の正弦波を作り、間引いたあと f0 に折り返す量）
+        double alias = -400.0;
+        for (double ratio : { 0.1, 0.3, kPassbandEdge }) {
+            const auto bin = static_cast<size_t>(ratio * kDftLength);
+            const size_t aliasBin = kDftLength - bin;
+            Instance instance(factor, phase);
+            const std::vector<double> highSine = Sine((kSettle + kDftLength) * static_cast<size_t>(factor), aliasBin, highLength);
+            std::vector<float> out((kSettle + kDftLength) * kChannels);
+            size_t written = 0;
+            instance.oversampler.Process(out.data(), out.data(), static_cast<unsigned int>(kSettle + kDftLength), [&](float* buffer, unsigned int frames) {
+                for (unsigned int i = 0 ; i < frames ; ++i, ++written) {
+                    std::fill(buffer + static_cast<size_t>(i) * kChannels, buffer + static_cast<size_t>(i + 1) * kChannels, static_cast<float>(highSine[written]));
+                }
+            });
+
+            std::vector<double> y(kDftLength);
+            for (size_t i = 0 ; i < kDftLength ; ++i) {
+                y[i] = out[(kSettle + i) * kChannels];
+            }
+            alias = std::max(alias, 20.0 * std::log10(BinAmplitude(y, bin) / 0.5 + 1e-20));
+        }
+        if (-alias < minRejection) {
+            std::printf("%dx %s: alias rejection %.1f dB\n", factor, PhaseName(phase), -alias);
+            passed = false;
+        }
+
+        std::printf("%dx %-7s latency %7.3f (measured %7.3f), DC gain %.6f, passband %.4f dB, images %.1f dB, aliases %.1f dB: %s\n",
+                    factor, PhaseName(phase), latency, delay, dcGain, ripple, image, alias, passed ? "ok" : "FAILED");
+        return passed;
+    }
+}
+
+int main() {
+    bool passed = true;
+    for (int factor : { 2, 4, 8 }) {
+        for (OversamplerPhase phase : { OVERSAMPLER_LINEAR_PHASE, OVERSAMPLER_MINIMUM_PHASE }) {
+            passed = Check(factor, phase) && passed;
+        }
+    }
+    std::printf("%s\n", passed ? "within tolerance" : "MISMATCH");
+    return passed ? 0 : 1;
+}
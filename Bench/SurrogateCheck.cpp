@@ -0,0 +1,189 @@
+/**
+ *  @file SurrogateCheck.cpp
+ *  @author Goto Kenta
+ *  @brief ParametricIRModel::predict の見積もりが描いたIRの実測と合うか、代理モデルで詳しい評価がどれだけ減るかを確かめる
+ *  @note 使い方: SurrogateCheck [パラメータの数（目標ごと、既定 64）] [世代数（既定 60）]
+ *        - 見積もり: 目標ごとに一様乱数のパラメータで render したIRを BatchedEnergyAnalysis で測り、predict と比べる。
+ *          FitnessSurrogate で補正した適応度の予測と、実際の適応度の差も表示する
+ *        - 評価の数: CmaEsOptimizer / DifferentialEvolutionOptimizer を同じ種で代理モデルの有無だけ変えて compute し、
+ *          詳しく評価したIRの数と最良の適応度を表示する
+ *        見積もりの誤差が許容量を超えるか、代理モデルで評価が kMaxEvaluationRatio 倍より減らないか、
+ *        最良の適応度の平均が代理モデルなしより kFitnessMargin 以上悪ければ1を返す
+ */
+
+# include "../GeneticReverb/BatchedEnergyAnalysis.h"
+# include "../GeneticReverb/CmaEsOptimizer.h"
+# include "../GeneticReverb/DifferentialEvolutionOptimizer.h"
+# include "../GeneticReverb/FitnessSurrogate.h"
+# include "../GeneticReverb/ParametricIR.h"
+
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <random>
+# include <vector>
+
+namespace {
+    constexpr float kSampleRate = 48000.0f;
+    constexpr size_t kLanes = BatchedEnergyAnalysis::kLanes;
+    constexpr size_t kDimension = ParametricIRModel::kParameterCount;
+
+    constexpr double kMaxT60RelativeError = 0.05; // 見積もりと実測の差（実測で割る、95パーセンタイル）
+    constexpr double kMaxEdtRelativeError = 0.10;
+    constexpr double kMaxC80Error = 0.5;          // dB（95パーセンタイル）
+
+    constexpr double kMaxEvaluationRatio = 0.6;   // 代理モデルで詳しい評価が4割以上減ること
+    constexpr double kFitnessMargin = 0.5;        // 最良の適応度の平均の悪化の許容量
+
+    /**
+     * @brief 誤差の並びの p パーセンタイル
+     */
+    double Percentile(std::vector<double> values, double p) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size())))];
+    }
+
+    /**
+     * @brief 目標 target の範囲で predict を実測と比べる
+     * @return 許容誤差内なら true
+     */
+    bool CheckPrediction(const ReverbTargetParams& target, int samples, std::mt19937& rng) {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        ParametricIRModel model;
+        model.prepare(kSampleRate, target, static_cast<uint32_t>(rng()));
+
+        BatchedEnergyAnalysis analysis;
+        FitnessSurrogate surrogate;
+        surrogate.reset();
+        std::vector<double> t60Errors, edtErrors, c80Errors, rawFitnessErrors, fitnessErrors;
+
+        std::vector<std::vector<float>> irs(kLanes);
+        for (int first = 0 ; first < samples ; first += static_cast<int>(kLanes)) {
+            double parameters[kLanes][kDimension];
+            EnergyMetrics predicted[kLanes], measured[kLanes];
+            const float* pointers[kLanes];
+            size_t lengths[kLanes];
+            for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+                for (double& x : parameters[lane]) {
+                    x = dist(rng);
+                }
+                predicted[lane] = model.predict(parameters[lane]);
+                model.render(parameters[lane], irs[lane]);
+                pointers[lane] = irs[lane].data();
+                lengths[lane] = irs[lane].size();
+            }
+            analysis.analyze(pointers, lengths, kLanes, kSampleRate, measured);
+
+            for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+                t60Errors.push_back(std::fabs(predicted[lane].t60 - measured[lane].t60) / std::max(measured[lane].t60, 1e-3f));
+                edtErrors.push_back(std::fabs(predicted[lane].edt - measured[lane].edt) / std::max(measured[lane].edt, 1e-3f));
+                c80Errors.push_back(std::fabs(predicted[lane].c80 - measured[lane].c80));
+
+                // 補正した適応度の予測（前の組までで補正したもの）
+                const double actual = FitnessEvaluator::Score(measured[lane].t60, measured[lane].c80, target);
+                rawFitnessErrors.push_back(std::fabs(FitnessEvaluator::Score(predicted[lane].t60, predicted[lane].c80, target) - actual));
+                fitnessErrors.push_back(std::fabs(surrogate.predictFitness(predicted[lane], target) - actual));
+            }
+            for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+                surrogate.addSample(predicted[lane], measured[lane]);
+            }
+            surrogate.recalibrate();
+        }
+
+        const double t60 = Percentile(t60Errors, 0.95);
+        const double edt = Percentile(edtErrors, 0.95);
+        const double c80 = Percentile(c80Errors, 0.95);
+        const bool passed = t60 <= kMaxT60RelativeError && edt <= kMaxEdtRelativeError && c80 <= kMaxC80Error;
+        std::printf("predict T60 %.2f C80 %5.1f: 95th percentile T60 %.2f%% EDT %.2f%% C80 %.3f dB (max %.2f%% %.2f%% %.3f dB), "
+                    "fitness error median %.3f -> %.3f calibrated%s\n",
+                    target.t60, target.c80, 100.0 * t60, 100.0 * edt, c80,
+                    100.0 * Percentile(t60Errors, 1.0), 100.0 * Percentile(edtErrors, 1.0), Percentile(c80Errors, 1.0),
+                    Percentile(rawFitnessErrors, 0.5), Percentile(fitnessErrors, 0.5), passed ? "" : "  FAILED");
+        return passed;
+    }
+
+    struct Result {
+        size_t evaluations = 0;
+        double fitness = 0.0;
+    };
+
+    /**
+     * @brief 代理モデルの有無を指定して1回 compute する
+     */
+    template <class Optimizer>
+    Result Run(const ReverbTargetParams& target, uint32_t seed, bool surrogate, int generations) {
+        Optimizer optimizer(kSampleRate);
+        optimizer.setSeed(seed);
+        optimizer.setSurrogate(surrogate);
+
+        Result result;
+        optimizer.setProgressCallback([&result](int, int, double bestFitness) { result.fitness = bestFitness; });
+        optimizer.compute(target, generations);
+        result.evaluations = optimizer.evaluationCount();
+        return result;
+    }
+
+    /**
+     * @brief 代理モデルの有無で詳しい評価の数と最良の適応度を比べる
+     * @return 評価が減り、適応度が悪くならなければ true
+     */
+    template <class Optimizer>
+    bool CheckEvaluations(const char* name, const ReverbTargetParams* targets, size_t targetCount, int generations) {
+        Result totalOn, totalOff;
+        for (size_t t = 0 ; t < targetCount ; ++t) {
+            for (uint32_t seed = 1234 ; seed < 1236 ; ++seed) {
+                const Result on = Run<Optimizer>(targets[t], seed, true, generations);
+                const Result off = Run<Optimizer>(targets[t], seed, false, generations);
+                std::printf("%-5s T60 %.2f C80 %5.1f seed %u: evaluations %5zu / %5zu, fitness %.4f / %.4f (surrogate on / off)\n",
+                            name, targets[t].t60, targets[t].c80, seed, on.evaluations, off.evaluations, on.fitness, off.fitness);
+                totalOn.evaluations += on.evaluations;
+                totalOn.fitness += on.fitness;
+                totalOff.evaluations += off.evaluations;
+                totalOff.fitness += off.fitness;
+            }
+        }
+
+        const auto runs = static_cast<double>(2 * targetCount);
+        const double ratio = static_cast<double>(totalOn.evaluations) / static_cast<double>(totalOff.evaluations);
+        const double meanOn = totalOn.fitness / runs;
+        const double meanOff = totalOff.fitness / runs;
+        const bool passed = ratio <= kMaxEvaluationRatio && meanOn <= meanOff + kFitnessMargin;
+        std::printf("%-5s evaluations %zu / %zu (ratio %.3f, limit %.3f), mean fitness %.4f / %.4f (margin %.2f)%s\n",
+                    name, totalOn.evaluations, totalOff.evaluations, ratio, kMaxEvaluationRatio, meanOn, meanOff, kFitnessMargin,
+                    passed ? "" : "  FAILED");
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int samples = (argc > 1) ? std::atoi(argv[1]) : 64;
+    const int generations = (argc > 2) ? std::atoi(argv[2]) : 60;
+    if (samples <= 0 || generations <= 0) {
+        std::fprintf(stderr, "usage: %s [parameter sets per target] [generations]\n", argv[0]);
+        return 1;
+    }
+
+    ReverbTargetParams targets[3];
+    targets[0].t60 = 0.4f;
+    targets[0].c80 = 8.0f;
+    targets[1].t60 = 1.0f;
+    targets[1].c80 = 4.0f;
+    targets[2].t60 = 2.0f;
+    targets[2].c80 = -1.0f;
+
+    std::mt19937 rng(1234);
+    bool passed = true;
+    for (const ReverbTargetParams& target : targets) {
+        passed = CheckPrediction(target, samples, rng) && passed;
+    }
+
+    passed = CheckEvaluations<CmaEsOptimizer>("cmaes", targets, 3, generations) && passed;
+    passed = CheckEvaluations<DifferentialEvolutionOptimizer>("de", targets, 3, generations) && passed;
+
+    std::printf("%s\n", passed ? "within tolerance" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -5,26 +5,21 @@
  */
 
 # include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <cstdio>
 # include <new>
 
+# include "BitCrushKernel.h"
 # include "FaustBitCrasher.h"
-# include "../ThirdParty/inc/fmod_common.h"
-# include "../ThirdParty/inc/fmod_dsp.h"
+# include "../Common/FaustParamBridge.h"
+# include "../Common/FmodPluginBase.h"
+# include "../Common/Oversampler.h"
 
-/* コールバック関数 */
-FMOD_RESULT F_CALL GeneticReverb_Create(FMOD_DSP_STATE* dsp_state);
-FMOD_RESULT F_CALL BitCrasher_Release(FMOD_DSP_STATE* dsp_state);
-FMOD_RESULT F_CALL BitCrasher_Process(FMOD_DSP_STATE* dsp_state, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inBuffers, FMOD_DSP_BUFFER_ARRAY* outBuffers, FMOD_BOOL inputsIdle, FMOD_DSP_PROCESS_OPERATION op);
-FMOD_RESULT F_CALL BitCrasher_SetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float value);
-FMOD_RESULT F_CALL BitCrasher_GetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float* value, char* valuestr);
-
-/**
- * @brief BitCrasher DSPプラグインの内部データ
- */
-struct BitCrasherState {
-    mydsp* faustDspL;
-    mydsp* faustDspR;
-};
+// 1にするとFaustが生成したmydsp::computeで処理する（SIMDカーネルとの比較用）
+# ifndef BITCRASHER_USE_FAUST_KERNEL
+    # define BITCRASHER_USE_FAUST_KERNEL 0
+# endif
 
 /**
  * @brief BitCrasher DSPプラグインのパラメータインデックス
@@ -32,319 +27,479 @@ struct BitCrasherState {
 enum {
     BITCRASHER_PARAM_BITS = 0,
     BITCRASHER_PARAM_DOWNSAMPLING,
+    BITCRASHER_PARAM_QUALITY,
+    BITCRASHER_PARAM_OVERSAMPLING,
     NUM_PARAMETERS,
 };
 
+// Faustのスライダーに対応するFMODパラメータ（BitCrasher.dsp のラベル）
+static const char* s_FaustLabels[NUM_PARAMETERS] = { "bits", "downsampling", nullptr, nullptr };
+
+// オーバーサンプリングの段数（0でなし、1で2x、2で4x、3で8x）
+constexpr int kMaxOversamplingStages = 3;
+
+// チャンネルごとの状態は作成時にFMODの最大チャンネル幅の分だけ確保し、ミキサースレッドでは確保しない
+constexpr int kMaxChannels = FMOD_MAX_CHANNEL_WIDTH;
+
 // パラメータ説明の定義
 static FMOD_DSP_PARAMETER_DESC s_Bits;
 static FMOD_DSP_PARAMETER_DESC s_Downsampling;
+static FMOD_DSP_PARAMETER_DESC s_Quality;
+static FMOD_DSP_PARAMETER_DESC s_Oversampling;
 static FMOD_DSP_PARAMETER_DESC* s_Params[NUM_PARAMETERS];
 
+// 品質モードの表示名
+static const char* s_QualityNames[BITCRUSH_QUALITY_COUNT] = { "Classic", "Dither", "Shaped", "AntiAlias" };
+
+// オーバーサンプリングの表示名
+static const char* s_OversamplingNames[kMaxOversamplingStages + 1] = { "Off", "2x", "4x", "8x" };
+
 /**
  * @brief BitCrasher DSPプラグインのパラメータ説明の初期化
  */
 static void InitParameterDescs() {
     FMOD_DSP_INIT_PARAMDESC_FLOAT(s_Bits, "Bits", "", "BitDepth", 1.0f, 16.0f, 8.0f); // ビット深度の範囲を0から16に設定
     FMOD_DSP_INIT_PARAMDESC_FLOAT(s_Downsampling, "Downsampling", "x", "Downsampling Factor", 1.0f, 32.0f, 4.0f); // ダウンサンプリングの範囲を1から16に設定
+    FMOD_DSP_INIT_PARAMDESC_INT(s_Quality, "Quality", "", "Classic / TPDF Dither / Noise Shaped / Anti-Aliased", 0, BITCRUSH_QUALITY_COUNT - 1, BITCRUSH_QUALITY_CLASSIC, false, s_QualityNames);
     s_Params[BITCRASHER_PARAM_BITS] = &s_Bits;
     s_Params[BITCRASHER_PARAM_DOWNSAMPLING] = &s_Downsampling;
+    FMOD_DSP_INIT_PARAMDESC_INT(s_Oversampling, "Oversampling", "", "Run the crusher at 2x / 4x / 8x with minimum-phase half-band filters", 0, kMaxOversamplingStages, 0, false, s_OversamplingNames);
+    s_Params[BITCRASHER_PARAM_QUALITY] = &s_Quality;
+    s_Params[BITCRASHER_PARAM_OVERSAMPLING] = &s_Oversampling;
 }
 
-/**
- * @brief BitCrasher DSPプラグインの説明構造体
- */
-FMOD_DSP_DESCRIPTION templateDesc = {
-    FMOD_PLUGIN_SDK_VERSION,      // プラグインSDKのバージョン
-    "BitCrasher",                 // プラグインの名前
-    0x00010000,                   // プラグインのバージョン
-    1,                            // 入力バッファの数
-    1,                            // 出力バッファの数
-    GeneticReverb_Create,            // DSP生成時のコールバック
-    BitCrasher_Release,           // DSP解放時のコールバック
-    nullptr,                      // DSPリセット時のコールバック
-    nullptr,                      // DSP読み取り時のコールバック
-    BitCrasher_Process,           // DSPプロセス時のコールバック
-    nullptr,                      // 位置設定コールバック
-    NUM_PARAMETERS,               // パラメータの数
-    s_Params,                     // パラメータの説明
-    BitCrasher_SetParameterFloat, // setFloatによってパラメータが設定されたときのコールバック
-    nullptr,                      // setIntによってパラメータが設定されたときのコールバック
-    nullptr,                      // setBoolによってパラメータが設定されたときのコールバック
-    nullptr,                      // setDataによってパラメータが設定されたときのコールバック
-    BitCrasher_GetParameterFloat, // getFloatによってパラメータが取得されたときのコールバック
-    nullptr,                      // getIntによってパラメータが取得されたときの
-    nullptr,                      // getBoolによってパラメータが取得されたときのコールバック
-    nullptr,                      // getDataによってパラメータが取得されたときのコールバック
-    nullptr,                      // shouldiprocessによってプロセスするかどうかを決定するコールバック
-    nullptr,                      // ユーザーデータ
-    nullptr,                      // DSPがロードor登録されたときに呼ばれるコールバック
-    nullptr,                      // DSPがアンロードor登録解除されたときに呼ばれるコールバック
-    nullptr,                      // ミキサー実行開始時に呼ばれるコールバック
-};
 
 /**
- * @brief BitCrasher DSPプラグインの作成関数
- * @param dsp_state
- * @return
+ * @brief 入力が止まってから出力が無音になるまでのサンプル数
+ * @param downsampling ダウンサンプリング係数
+ * @param quality 品質モード
  */
-FMOD_RESULT F_CALL GeneticReverb_Create(FMOD_DSP_STATE *dsp_state) {
-    InitParameterDescs();
+static unsigned int TailLength(int downsampling, int quality) {
+    // ホールド中の値は次の取り込みまで出力され続ける
+    auto tail = static_cast<unsigned int>(std::max(downsampling, 1));
 
-    // dsp_stateのfunctionsが有効か確認
-    if (!dsp_state->functions) {
-        return FMOD_ERR_INTERNAL;
+    // アンチエイリアスフィルタの残響（-120dBまで減衰する長さの目安）
+    if (quality == BITCRUSH_QUALITY_ANTI_ALIAS) {
+        tail += 8u * static_cast<unsigned int>(std::max(downsampling, 1));
     }
 
-    // BitCrasherStateのインスタンスを作成し、初期化する
-    FMOD_MEMORY_ALLOC_CALLBACK alloc_callback = dsp_state->functions->alloc;
-    if (!alloc_callback) {
-        return FMOD_ERR_INTERNAL;
+    // ノイズシェーピングの誤差は1サンプル遅れて出力に現れる
+    if (quality == BITCRUSH_QUALITY_NOISE_SHAPED) {
+        tail += 1;
     }
 
-    // 開放用コールバック
-    FMOD_MEMORY_FREE_CALLBACK free_callback = dsp_state->functions->free;
-    if (!free_callback) {
-        return FMOD_ERR_INTERNAL;
-    }
+    return tail;
+}
 
-    // メモリを確保
-    auto *state = static_cast<BitCrasherState*>(alloc_callback(sizeof(BitCrasherState), FMOD_MEMORY_NORMAL, __FILE__));
-    if (state == nullptr) {
-        return FMOD_ERR_MEMORY;
+/**
+ * @brief BitCrasher DSPプラグイン
+ */
+class BitCrasher : public FmodPluginBase<BitCrasher> {
+public:
+    static constexpr const char* kName = "BitCrasher";
+    static constexpr unsigned int kVersion = 0x00010000;
+
+    /**
+     * @brief パラメータ説明を初期化して返す
+     * @param count パラメータの数を受け取る
+     * @return パラメータ説明の配列
+     */
+    static FMOD_DSP_PARAMETER_DESC** ParameterDescs(int& count) {
+        InitParameterDescs();
+        count = NUM_PARAMETERS;
+        return s_Params;
     }
 
-    // dsp_stateにポインタを渡す
-    dsp_state->plugindata = state;
-    state->faustDspL = nullptr;
-    state->faustDspR = nullptr;
+private:
+    friend class FmodPluginBase<BitCrasher>;
+
+    /**
+     * @brief チャンネルごとの状態とスクラッチバッファを確保し、パラメータを対応付ける
+     */
+    FMOD_RESULT onCreate() {
+        m_quality.store(s_Quality.intdesc.defaultval, std::memory_order_relaxed);
+
+        // チャンネルごとの DSP のメモリを最大チャンネル幅の分だけ確保して初期化
+        if (AllocateChannelStates(kMaxChannels) != FMOD_OK) {
+            return FMOD_ERR_MEMORY;
+        }
+
+# if !BITCRASHER_USE_FAUST_KERNEL
+        // オーバーサンプラーはバッファが大きいので、ミキサーのチャンネル数の分だけ確保する
+        if (ReserveOversampler(mixerChannels()) != FMOD_OK) {
+            return FMOD_ERR_MEMORY;
+        }
+# endif
+
+        // FMODパラメータとFaustのスライダーをラベルで対応付ける
+        for (int i = 0 ; i < NUM_PARAMETERS ; ++i) {
+            m_faustParam[i] = s_FaustLabels[i] ? m_params.indexOf(s_FaustLabels[i]) : -1;
+        }
+
+        // ブロック処理用のスクラッチバッファを確保
+        m_scratchIn = allocateFloats(blockSize());
+        m_scratchOut = allocateFloats(blockSize());
+        if (m_scratchIn == nullptr || m_scratchOut == nullptr) {
+            return FMOD_ERR_MEMORY;
+        }
 
-    // サンプルレートを取得
-    int sampleRate = 48000;
-    if (dsp_state->functions->getsamplerate) {
-        dsp_state->functions->getsamplerate(dsp_state, &sampleRate);
+        return FMOD_OK;
     }
 
-    // Lチャンネル用の DSP のメモリを確保して初期化
-    void* faust_mem_L = alloc_callback(sizeof(mydsp), FMOD_MEMORY_NORMAL, __FILE__);
-    if (faust_mem_L == nullptr) {
-        free_callback(state, FMOD_MEMORY_NORMAL, __FILE__);
-        return FMOD_ERR_MEMORY;
+    /**
+     * @brief 確保したメモリをすべて解放する
+     */
+    void onRelease() {
+        DestroyChannelStates();
+        deallocate(m_kernel.held);
+        deallocate(m_scratchIn);
+        deallocate(m_scratchOut);
+        deallocate(m_oversamplerMem);
     }
 
-    state->faustDspL = new(faust_mem_L) mydsp();
-    state->faustDspL->init(sampleRate);
+    /**
+     * @brief サンプルホールドやフィルタの状態をクリアする
+     */
+    FMOD_RESULT onReset() {
+        if (!m_faustDsps) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
 
-    // Rチャンネル用の DSP のメモリを確保して初期化
-    void* faust_mem_R = alloc_callback(sizeof(mydsp), FMOD_MEMORY_NORMAL, __FILE__);
-    if (faust_mem_R == nullptr) {
-        state->faustDspL->~mydsp();
-        free_callback(faust_mem_L, FMOD_MEMORY_NORMAL, __FILE__);
-        free_callback(state, FMOD_MEMORY_NORMAL, __FILE__);
+# if !BITCRASHER_USE_FAUST_KERNEL
+        // ミキサーのチャンネル数が増えていたらオーバーサンプラーを確保し直してから、状態のクリアに進む
+        if (dspState()->functions->getspeakermode) {
+            FMOD_SPEAKERMODE mixerMode = FMOD_SPEAKERMODE_STEREO;
+            FMOD_SPEAKERMODE outputMode = FMOD_SPEAKERMODE_STEREO;
+            dspState()->functions->getspeakermode(dspState(), &mixerMode, &outputMode);
 
-        return FMOD_ERR_MEMORY;
+            if (ReserveOversampler(ChannelCountFromSpeakerMode(mixerMode)) != FMOD_OK) {
+                return FMOD_ERR_MEMORY;
+            }
+        }
+# endif
+
+        for (int ch = 0 ; ch < m_numChannels ; ++ch) {
+            m_faustDsps[ch].instanceClear();
+        }
+        BitCrushKernel_Clear(m_kernel);
+        m_oversampler.Reset();
+
+        return FMOD_OK;
     }
 
-    state->faustDspR = new(faust_mem_R) mydsp();
-    state->faustDspR->init(sampleRate);
+    /**
+     * @brief バッファのチャンネル数に合わせて、確保済みの状態を使う準備をする（ミキサースレッドなので確保はしない）
+     */
+    FMOD_RESULT onChannels(int chs) {
+        // 作成時に最大チャンネル幅の分を確保しているので、超えるのはFMODの範囲外の入力だけ
+        if (chs > m_numChannels) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
 
-    // 正常終了を返す
-    return FMOD_OK;
-}
+# if !BITCRASHER_USE_FAUST_KERNEL
+        // 確保したオーバーサンプラーより多いチャンネルのバッファは元のレートで処理する
+        m_bufferFactor = (chs <= m_oversamplerReserved) ? m_factor : 1;
 
-/**
- * @brief BitCrasher DSPプラグインの解放関数
- * @param dsp_state
- * @return
- */
-FMOD_RESULT F_CALL BitCrasher_Release(FMOD_DSP_STATE *dsp_state) {
-    if (!dsp_state->functions) {
-        return FMOD_ERR_INTERNAL;
+        // 倍率かチャンネル数が変わったらオーバーサンプラーを初期化し直す（メモリは確保済み）
+        if (m_bufferFactor != 1 && (m_bufferFactor != m_oversampler.Factor() || chs != m_oversamplerChannels)) {
+            ConfigureOversampler(m_bufferFactor, chs);
+        }
+# endif
+
+        return FMOD_OK;
     }
 
-    // BitCrasherStateのインスタンスを取得
-    FMOD_MEMORY_FREE_CALLBACK free_callback = dsp_state->functions->free;
-    if (!free_callback) {
-        return FMOD_ERR_MEMORY;
+    /**
+     * @brief APIスレッドで設定されたパラメータをバッファ先頭で反映する
+     */
+    void onProcessStart() {
+        m_params.apply();
+        m_bits = static_cast<int>(m_params.value(m_faustParam[BITCRASHER_PARAM_BITS]));
+        m_downsampling = static_cast<int>(m_params.value(m_faustParam[BITCRASHER_PARAM_DOWNSAMPLING]));
+        m_blockQuality = m_quality.load(std::memory_order_relaxed);
+        m_factor = 1 << m_oversampling.load(std::memory_order_relaxed);
     }
 
-    // BitCrasherStateのインスタンスを取得
-    auto *state = static_cast<BitCrasherState *>(dsp_state->plugindata);
-    if (state) {
-        // Lチャンネル用DSPの解放
-        if (state->faustDspL) {
-            state->faustDspL->~mydsp();
-            free_callback(state->faustDspL, FMOD_MEMORY_NORMAL, __FILE__);
-        }
-        // Rチャンネル用DSPの解放
-        if (state->faustDspR) {
-            state->faustDspR->~mydsp();
-            free_callback(state->faustDspR, FMOD_MEMORY_NORMAL, __FILE__);
+    /**
+     * @brief インタリーブされたブロックを処理する
+     */
+    void processBlock(const float* in, float* out, unsigned int frames, int chs) {
+# if BITCRASHER_USE_FAUST_KERNEL
+        ProcessFaust(in, out, frames, chs);
+# else
+        // チャンネルをレーンに割り当ててインタリーブのまま処理する
+        if (m_bufferFactor == 1) {
+            Crush(in, out, frames, chs, m_downsampling);
+            return;
         }
 
-        free_callback(state, FMOD_MEMORY_NORMAL, __FILE__);
+        // 高いレートではホールド長を倍率分伸ばして、元のレートと同じ音程感にする
+        m_oversampler.Process(in, out, frames, [&](float* buffer, unsigned int n) {
+            Crush(buffer, buffer, n, chs, m_downsampling * m_bufferFactor);
+        });
+# endif
     }
 
-    // 内部データもクリア
-    dsp_state->plugindata = nullptr;
+    /**
+     * @brief 入力が止まってから出力が無音になるまでのサンプル数
+     */
+    unsigned int tailLength() const {
+        // 倍率1に戻したときはオーバーサンプラーを通らないので、前の倍率のレイテンシを足さない
+        const unsigned int latency = (m_factor > 1) ? static_cast<unsigned int>(std::ceil(m_oversampler.Latency())) : 0;
+        return TailLength(m_downsampling, m_blockQuality) + latency;
+    }
 
-    // 正常終了を返す
-    return FMOD_OK;
-}
+    /**
+     * @brief 出し切ったらフィルタなどの状態を0に戻し、再開時に非正規化数を引きずらないようにする
+     */
+    void onTailEnd() {
+        const uint64_t sampleCount = m_kernel.sampleCount;
+        BitCrushKernel_Clear(m_kernel);
+        m_kernel.sampleCount = sampleCount;
+        m_oversampler.Reset();
+    }
 
-/**
- * @brief BitCrasher DSPプラグインのプロセス関数
- * @param dsp_state DSPの内部データ
- * @param length 処理するサンプル数
- * @param inBuffers 入力バッファ配列
- * @param outBuffers 出力バッファ配列
- * @param inputsIdle 入力がアイドル状態かどうか
- * @param op プロセス操作の種類
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はエラーコードを返す
- */
-FMOD_RESULT F_CALL BitCrasher_Process(FMOD_DSP_STATE* dsp_state, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inBuffers, FMOD_DSP_BUFFER_ARRAY* outBuffers, FMOD_BOOL inputsIdle, FMOD_DSP_PROCESS_OPERATION op) {
-    // FMOD_DSP_PROCESS_QUERYの場合、入出力フォーマットのミラーを行う
-    if (op == FMOD_DSP_PROCESS_QUERY) {
-        if (inBuffers && outBuffers) {
-            const int nb = std::min(inBuffers->numbuffers, outBuffers->numbuffers);
-            for (int i = 0; i < nb; ++i) {
-                outBuffers->buffernumchannels[i] = inBuffers->buffernumchannels[i];
-                outBuffers->bufferchannelmask[i] = inBuffers->bufferchannelmask[i];
+    /**
+     * @brief 品質モードに応じたSIMDカーネルでインタリーブバッファを処理する
+     */
+    void Crush(const float* in, float* out, unsigned int frames, int chs, int downsampling) {
+        if (m_blockQuality == BITCRUSH_QUALITY_CLASSIC) {
+            BitCrushKernel_Process(m_kernel, in, out, frames, chs, m_bits, downsampling);
+        }
+        else {
+            BitCrushKernel_ProcessQuality(m_kernel, in, out, frames, chs, m_bits, downsampling, m_blockQuality);
+        }
+    }
+
+# if BITCRASHER_USE_FAUST_KERNEL
+    /**
+     * @brief Faustが生成したDSPでインタリーブバッファを処理する
+     * @param in インタリーブされた入力
+     * @param out インタリーブされた出力
+     * @param frames 処理するフレーム数（ブロックサイズ以下）
+     * @param chs チャンネル数
+     */
+    void ProcessFaust(const float* in, float* out, unsigned int frames, int chs) {
+        for (int ch = 0 ; ch < chs ; ++ch) {
+            // チャンネルごとにデインタリーブ
+            for (unsigned int i = 0 ; i < frames ; ++i) {
+                m_scratchIn[i] = in[i * chs + ch];
+            }
+
+            // 1チャンネル分をまとめてFaustで処理
+            FAUSTFLOAT* fin[1] = { reinterpret_cast<FAUSTFLOAT*>(m_scratchIn) };
+            FAUSTFLOAT* fout[1] = { reinterpret_cast<FAUSTFLOAT*>(m_scratchOut) };
+            // 具象型で呼び出して仮想関数呼び出しを避ける
+            m_faustDsps[ch].mydsp::compute(static_cast<int>(frames), fin, fout);
+
+            // インタリーブして出力
+            for (unsigned int i = 0 ; i < frames ; ++i) {
+                out[i * chs + ch] = m_scratchOut[i];
             }
-            outBuffers->speakermode = inBuffers ? inBuffers->speakermode : outBuffers->speakermode;
         }
+    }
+# else
+    /**
+     * @brief 最大倍率でチャンネル数分のオーバーサンプラーのメモリを確保する
+     * @param numChannels チャンネル数
+     * @return 処理が成功した場合はFMOD_OKを返す、それ以外はエラーコードを返す
+     * @note 作成時とリセット時（ミキサーのチャンネル数が増えたとき）だけ確保し、ミキサースレッドでは確保しない
+     */
+    FMOD_RESULT ReserveOversampler(int numChannels) {
+        numChannels = std::min(numChannels, kMaxChannels);
+        if (numChannels <= m_oversamplerReserved) {
+            return FMOD_OK;
+        }
+        const size_t bytes = Oversampler::MemorySize(1 << kMaxOversamplingStages, numChannels, blockSize());
+
+        void* mem = allocate(bytes);
+        if (mem == nullptr) {
+            return FMOD_ERR_MEMORY;
+        }
+        deallocate(m_oversamplerMem);
+        m_oversamplerMem = mem;
+        m_oversamplerReserved = numChannels;
+
+        // 古い領域を指さないよう倍率1に戻し、次のブロックで初期化し直させる
+        m_oversampler.Init(1, OVERSAMPLER_MINIMUM_PHASE, numChannels, blockSize(), nullptr);
+        m_oversamplerChannels = 0;
         return FMOD_OK;
     }
 
-    // 内部データを取得
-    auto *state = static_cast<BitCrasherState *>(dsp_state->plugindata);
-    if (!state || !state->faustDspL || !state->faustDspR || !inBuffers || !outBuffers ||
-        outBuffers->numbuffers == 0 || outBuffers->buffers == nullptr ||
-        inBuffers->numbuffers == 0 || inBuffers->buffers == nullptr) {
-        return FMOD_ERR_DSP_DONTPROCESS;
+    /**
+     * @brief オーバーサンプラーを倍率とチャンネル数に合わせて初期化し直す
+     * @param factor オーバーサンプリング倍率
+     * @param numChannels チャンネル数（ReserveOversampler で確保した数以下）
+     */
+    void ConfigureOversampler(int factor, int numChannels) {
+        m_oversampler.Init(factor, OVERSAMPLER_MINIMUM_PHASE, numChannels, blockSize(), m_oversamplerMem);
+        m_oversamplerChannels = numChannels;
     }
+# endif
+
+    /**
+     * @brief チャンネルごとのFaust DSPとSIMDカーネルの状態を確保する（作成時に1回だけ呼ぶ）
+     * @param numChannels 確保するチャンネル数
+     * @return 処理が成功した場合はFMOD_OKを返す、それ以外はエラーコードを返す
+     */
+    FMOD_RESULT AllocateChannelStates(int numChannels) {
+        // 全チャンネル分の状態を1回の確保でまとめて取る
+        void* faust_mem = allocate(sizeof(mydsp) * static_cast<size_t>(numChannels));
+        if (faust_mem == nullptr) {
+            return FMOD_ERR_MEMORY;
+        }
 
-    // 入力がアイドル状態の場合、出力バッファをゼロで埋める
-    if (inputsIdle || !inBuffers || inBuffers->numbuffers == 0 || !inBuffers->buffers) {
-        for (int i = 0 ; i < outBuffers->numbuffers ; ++i) {
-            const int chs = outBuffers->buffernumchannels[i];
-            float *out = outBuffers->buffers[i];
-            for (unsigned int k = 0 ; k < length * static_cast<unsigned int>(chs); ++k) { // ループ変数をiからkに変更
-                out[k] = 0.0f;
-            }
+        // SIMDカーネル用のチャンネル状態
+        float* kernel_mem = allocateFloats(kBitCrushStateFloatsPerChannel * static_cast<size_t>(numChannels));
+        if (kernel_mem == nullptr) {
+            deallocate(faust_mem);
+            return FMOD_ERR_MEMORY;
         }
 
-        return FMOD_ERR_DSP_SILENCE;
-    }
+        auto* faustDsps = static_cast<mydsp*>(faust_mem);
+        for (int ch = 0 ; ch < numChannels ; ++ch) {
+            mydsp* faustDsp = new(&faustDsps[ch]) mydsp();
+            faustDsp->init(sampleRate());
+        }
 
-    // FMODがDSP_PROCESS_PERFORMの場合、エフェクト処理を行う
-    const int nb = std::min(outBuffers->numbuffers, outBuffers->numbuffers);
-    for (int b = 0 ; b < nb ; ++b) {
-        const int chs = std::min(inBuffers->buffernumchannels[b], outBuffers->buffernumchannels[b]);
-        float* in = inBuffers->buffers[b];
-        float* out = outBuffers->buffers[b];
-
-        for (unsigned int i = 0 ; i < length ; ++i) {
-            for (int ch = 0 ; ch < chs ; ++ch) {
-                const int index = static_cast<int>(i) * chs + ch;
-                float inSample = in[index];
-                float outSample = 0.0f;
-
-                FAUSTFLOAT* fin[1] = { reinterpret_cast<FAUSTFLOAT*>(&inSample) };
-                FAUSTFLOAT* fout[1] = { reinterpret_cast<FAUSTFLOAT*>(&outSample) };
-                if (ch == 0 && state->faustDspL) {
-                    state->faustDspL->compute(1, fin, fout);
-                }
-                else if (ch == 1 && state->faustDspR) {
-                    state->faustDspR->compute(1, fin, fout);
-                }
-                else if (state->faustDspL) {
-                    state->faustDspL->compute(1, fin, fout);
-                }
+        // インスタンスのゾーンを登録し、現在のパラメータ値を書き込む
+        m_params.bind(faustDsps, numChannels);
+
+        BitCrushKernel_Bind(m_kernel, kernel_mem, numChannels);
+        BitCrushKernel_Clear(m_kernel);
 
-                out[index] = outSample;
+        m_faustDsps = faustDsps;
+        m_numChannels = numChannels;
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief チャンネルごとのFaust DSPを破棄する
+     */
+    void DestroyChannelStates() {
+        if (m_faustDsps) {
+            for (int ch = 0 ; ch < m_numChannels ; ++ch) {
+                m_faustDsps[ch].~mydsp();
             }
+            deallocate(m_faustDsps);
         }
+        m_faustDsps = nullptr;
     }
 
-    return FMOD_OK;
-}
+    /**
+     * @brief floatパラメータの設定関数
+     */
+    FMOD_RESULT setParameterFloat(int index, float value) {
+        switch (index) {
+            case BITCRASHER_PARAM_BITS:
+            case BITCRASHER_PARAM_DOWNSAMPLING:
+                // ステージングするだけで、ミキサースレッドが次のブロック先頭で反映する
+                if (!m_params.set(m_faustParam[index], value)) {
+                    return FMOD_ERR_INVALID_PARAM;
+                }
+                break;
 
-/**
- * @brief BitCrasher DSPプラグインのパラメータ設定関数
- * @param dsp_state DSPの内部データ
- * @param index パラメータのインデックス
- * @param value 設定する値
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はFMOD_ERR_INVALID_PARAMを返す
- */
-FMOD_RESULT F_CALL BitCrasher_SetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float value) {
-    auto* state = static_cast<BitCrasherState*>(dsp_state->plugindata);
-    if (!state || !state->faustDspL || !state->faustDspR) {
-        return FMOD_ERR_INVALID_PARAM;
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
+
+        return FMOD_OK;
     }
 
-    switch (index) {
-        case BITCRASHER_PARAM_BITS:
-            state->faustDspL->fHslider1 = static_cast<FAUSTFLOAT>(value);
-            state->faustDspR->fHslider1 = static_cast<FAUSTFLOAT>(value);
-            break;
+    /**
+     * @brief floatパラメータの取得関数
+     */
+    FMOD_RESULT getParameterFloat(int index, float* value, char* valuestr) {
+        switch (index) {
+            case BITCRASHER_PARAM_BITS: {
+                const float bits = m_params.get(m_faustParam[index]);
+                if (value) *value = bits;
+                if (valuestr) snprintf(valuestr, 32, "%.0f bits", bits);
+                break;
+            }
 
-        case BITCRASHER_PARAM_DOWNSAMPLING:
-            state->faustDspL->fHslider0 = static_cast<FAUSTFLOAT>(value);
-            state->faustDspR->fHslider0 = static_cast<FAUSTFLOAT>(value);
-            break;
+            case BITCRASHER_PARAM_DOWNSAMPLING: {
+                const float downsampling = m_params.get(m_faustParam[index]);
+                if (value) *value = downsampling;
+                if (valuestr) snprintf(valuestr, 32, "%.0f x", downsampling);
+                break;
+            }
 
-        default:
-            return FMOD_ERR_INVALID_PARAM;
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
+
+        return FMOD_OK;
     }
 
-    return FMOD_OK;
-}
+    /**
+     * @brief 整数パラメータの設定関数
+     */
+    FMOD_RESULT setParameterInt(int index, int value) {
+        switch (index) {
+            case BITCRASHER_PARAM_QUALITY:
+                m_quality.store(std::clamp(value, 0, BITCRUSH_QUALITY_COUNT - 1), std::memory_order_relaxed);
+                break;
+
+            case BITCRASHER_PARAM_OVERSAMPLING:
+                m_oversampling.store(std::clamp(value, 0, kMaxOversamplingStages), std::memory_order_relaxed);
+                break;
+
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
 
-/**
- * @brief BitCrasher DSPプラグインのパラメータ取得関数
- * @param dsp_state DSPの内部データ
- * @param index パラメータのインデックス
- * @param value 取得する値を格納するポインタ
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はFMOD_ERR_INVALID_PARAMを返す
- */
-FMOD_RESULT F_CALL BitCrasher_GetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float* value, char* valuestr) {
-    auto* state = static_cast<BitCrasherState*>(dsp_state->plugindata);
-    if (!state || !state->faustDspL) return FMOD_ERR_INVALID_PARAM;
-
-    switch (index) {
-        case BITCRASHER_PARAM_BITS:
-            if (value) *value = static_cast<float>(state->faustDspL->fHslider1);
-            if (valuestr) snprintf(valuestr, 32, "%.0f bits", state->faustDspL->fHslider1);
-            break;
-
-        case BITCRASHER_PARAM_DOWNSAMPLING:
-            if (value) *value = static_cast<float>(state->faustDspL->fHslider0);
-            if (valuestr) snprintf(valuestr, 32, "%.0f x", state->faustDspL->fHslider0);
-            break;
-
-        default:
-            return FMOD_ERR_INVALID_PARAM;
+        return FMOD_OK;
     }
 
-    return FMOD_OK;
-}
+    /**
+     * @brief 整数パラメータの取得関数
+     */
+    FMOD_RESULT getParameterInt(int index, int* value, char* valuestr) {
+        switch (index) {
+            case BITCRASHER_PARAM_QUALITY: {
+                const int quality = m_quality.load(std::memory_order_relaxed);
+                if (value) *value = quality;
+                if (valuestr) snprintf(valuestr, 32, "%s", s_QualityNames[quality]);
+                break;
+            }
 
+            case BITCRASHER_PARAM_OVERSAMPLING: {
+                const int oversampling = m_oversampling.load(std::memory_order_relaxed);
+                if (value) *value = oversampling;
+                if (valuestr) snprintf(valuestr, 32, "%s", s_OversamplingNames[oversampling]);
+                break;
+            }
+
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
+
+        return FMOD_OK;
+    }
+
+    mydsp* m_faustDsps = nullptr;              // チャンネルごとのFaust DSP（1つの連続領域に確保）
+    BitCrushKernelState m_kernel { };          // SIMDカーネル用のチャンネル状態
+    int m_numChannels = 0;                     // 確保済みのチャンネル数（kMaxChannels）
+    FaustParamBridge m_params;                 // Faustのスライダーへの値の受け渡し
+    int m_faustParam[NUM_PARAMETERS] { };      // FMODパラメータに対応するブリッジのインデックス
+    std::atomic<int> m_quality { 0 };          // 品質モード（BitCrushQuality）
+    std::atomic<int> m_oversampling { 0 };     // オーバーサンプリングの段数
+    Oversampler m_oversampler;                 // SIMDカーネルを高いレートで動かすためのオーバーサンプラー
+    void* m_oversamplerMem = nullptr;          // オーバーサンプラーのバッファと状態
+    int m_oversamplerReserved = 0;             // m_oversamplerMem で扱えるチャンネル数
+    int m_oversamplerChannels = 0;             // オーバーサンプラーを初期化したチャンネル数
+    float* m_scratchIn = nullptr;              // デインタリーブした1チャンネル分の入力
+    float* m_scratchOut = nullptr;             // Faustが書き込む1チャンネル分の出力
+    int m_bits = 8;                            // 処理中のバッファのビット深度
+    int m_downsampling = 4;                    // 処理中のバッファのダウンサンプリング係数
+    int m_blockQuality = 0;                    // 処理中のバッファの品質モード
+    int m_factor = 1;                          // 処理中のバッファのオーバーサンプリング倍率
+    int m_bufferFactor = 1;                    // チャンネル数を考慮して実際に使う倍率（onChannels で決める）
+};
 
 /**
  * @brief ビルドしたDLLからFMODがDSPプラグインの説明を取得するためのエクスポート関数
- * @return BitCrasher DSPプラグインの説明構造体へのポインタ
  */
-#if defined(_WIN32)
-    #define FMOD_EXPORT __declspec(dllexport)
-#elif defined(__GNUC__) || defined(__clang__)
-    #define FMOD_EXPORT __attribute__((visibility("default")))
-#else
-    #define FMOD_EXPORT
-#endif
-
-extern "C" {
-    FMOD_EXPORT FMOD_DSP_DESCRIPTION* FMODGetDSPDescription() {
-        InitParameterDescs();
-        return &templateDesc;
-    }
-}
\ No newline at end of file
+FMOD_PLUGIN_EXPORT(BitCrasher)
@@ -0,0 +1,23 @@
+﻿/**
+ *  @file BitCrasherRuntime.cpp
+ *  @author Goto Kenta
+ *  @brief BitCrasher.dsp を読み込み時にlibfaustでコンパイルして使うBitCrasher
+ */
+
+# include "../Common/FaustRuntimeCompiler.h"
+# include "../Common/FaustFmodPlugin.h"
+
+// CMakeから BitCrasher.dsp の絶対パスが渡される
+# ifndef BITCRASHER_DSP_SOURCE
+    # define BITCRASHER_DSP_SOURCE "BitCrasher.dsp"
+# endif
+
+/**
+ * @brief 実行時コンパイルするソースの情報
+ */
+struct BitCrasherSource {
+    static const char* Name() { return "BitCrasher"; }
+    static const char* Path() { return BITCRASHER_DSP_SOURCE; }
+};
+
+FAUST_FMOD_PLUGIN(BitCrasherRuntime, FaustRuntimeDSP<BitCrasherSource>, "BitCrasher Runtime", 0x00010000)
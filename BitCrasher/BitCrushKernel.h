@@ -0,0 +1,523 @@
+/**
+ *  @file BitCrushKernel.h
+ *  @author Goto Kenta
+ *  @brief チャンネルをSIMDレーンに割り当てたビットクラッシュ処理カーネル
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <cmath>
+# include <cstdint>
+# include <cstring>
+
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    # define BITCRUSH_KERNEL_SSE2 1
+    # include <emmintrin.h>
+# endif
+# if defined(__AVX__)
+    # define BITCRUSH_KERNEL_AVX 1
+    # include <immintrin.h>
+# endif
+
+/**
+ * @brief ビットクラッシュの品質モード
+ */
+enum BitCrushQuality {
+    BITCRUSH_QUALITY_CLASSIC = 0,  // 切り捨て量子化とサンプルホールドのみ（Faust版と同じ）
+    BITCRUSH_QUALITY_DITHER,       // TPDFディザを加えて丸める
+    BITCRUSH_QUALITY_NOISE_SHAPED, // TPDFディザ + 1次のノイズシェーピング
+    BITCRUSH_QUALITY_ANTI_ALIAS,   // ホールド前にローパスをかけ、TPDFディザで丸める
+    BITCRUSH_QUALITY_COUNT,
+};
+
+// 1チャンネルあたりに必要な状態の要素数（すべて4バイト）
+constexpr int kBitCrushStateFloatsPerChannel = 7;
+
+/**
+ * @brief ビットクラッシュカーネルの状態
+ * @note 各配列はチャンネル数分の領域を BitCrushKernel_Bind で割り当てる
+ */
+struct BitCrushKernelState {
+    float* held;              // チャンネルごとのサンプルホールド値
+    float* quantized;         // held を量子化した出力値
+    float* shapingError;      // ノイズシェーピングの量子化誤差（ステップ単位）
+    float* filterZ1;          // アンチエイリアスフィルタの状態1
+    float* filterZ2;          // アンチエイリアスフィルタの状態2
+    uint32_t* noise;          // ディザ用の乱数状態（xorshift32 × 2系統）
+    int numChannels;          // 確保済みのチャンネル数
+    uint64_t sampleCount;     // 処理済みサンプル数（FaustのiRec1に相当）
+};
+
+/**
+ * @brief ビットクラッシュカーネルの状態を初期化する
+ * @param state カーネルの状態
+ */
+inline void BitCrushKernel_Clear(BitCrushKernelState& state) {
+    const int n = state.numChannels;
+    std::fill(state.held, state.held + n, 0.0f);
+    std::fill(state.quantized, state.quantized + n, 0.0f);
+    std::fill(state.shapingError, state.shapingError + n, 0.0f);
+    std::fill(state.filterZ1, state.filterZ1 + n, 0.0f);
+    std::fill(state.filterZ2, state.filterZ2 + n, 0.0f);
+
+    // 乱数はチャンネルごとに異なる0以外の種で始める
+    for (int ch = 0 ; ch < 2 * n ; ++ch) {
+        state.noise[ch] = 0x9E3779B9u * static_cast<uint32_t>(ch + 1);
+    }
+    state.sampleCount = 0;
+}
+
+/**
+ * @brief 呼び出し側が確保した領域に状態の配列を割り当てる
+ * @param state カーネルの状態
+ * @param memory kBitCrushStateFloatsPerChannel * numChannels 要素の領域
+ * @param numChannels チャンネル数
+ */
+inline void BitCrushKernel_Bind(BitCrushKernelState& state, float* memory, int numChannels) {
+    state.held = memory;
+    state.quantized = memory + numChannels;
+    state.shapingError = memory + 2 * numChannels;
+    state.filterZ1 = memory + 3 * numChannels;
+    state.filterZ2 = memory + 4 * numChannels;
+    state.noise = reinterpret_cast<uint32_t*>(memory + 5 * numChannels);
+    state.numChannels = numChannels;
+}
+
+/**
+ * @brief 1フレーム分の入力を取り込んで量子化する
+ * @param frame インタリーブされた入力フレーム
+ * @param held サンプルホールド値の書き込み先
+ * @param quantized 量子化値の書き込み先
+ * @param channels チャンネル数
+ * @param scale 量子化ステップ数（2^bits - 1）
+ * @param invScale scale の逆数
+ */
+inline void BitCrushKernel_Latch(const float* frame, float* held, float* quantized, int channels, float scale, float invScale) {
+    int ch = 0;
+
+# if BITCRUSH_KERNEL_AVX
+    // 8チャンネルずつAVXのレーンで処理
+    const __m256 scale8 = _mm256_set1_ps(scale);
+    const __m256 invScale8 = _mm256_set1_ps(invScale);
+    for ( ; ch + 8 <= channels ; ch += 8) {
+        const __m256 x = _mm256_loadu_ps(frame + ch);
+        const __m256 q = _mm256_mul_ps(invScale8, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_mul_ps(scale8, x))));
+        _mm256_storeu_ps(held + ch, x);
+        _mm256_storeu_ps(quantized + ch, q);
+    }
+# endif
+
+# if BITCRUSH_KERNEL_SSE2
+    // 4チャンネルずつSSE2のレーンで処理
+    const __m128 scale4 = _mm_set1_ps(scale);
+    const __m128 invScale4 = _mm_set1_ps(invScale);
+    for ( ; ch + 4 <= channels ; ch += 4) {
+        const __m128 x = _mm_loadu_ps(frame + ch);
+        const __m128 q = _mm_mul_ps(invScale4, _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(scale4, x))));
+        _mm_storeu_ps(held + ch, x);
+        _mm_storeu_ps(quantized + ch, q);
+    }
+# endif
+
+    // 残りのチャンネル
+    for ( ; ch < channels ; ++ch) {
+        held[ch] = frame[ch];
+        quantized[ch] = invScale * static_cast<float>(static_cast<int>(scale * frame[ch]));
+    }
+}
+
+/**
+ * @brief ホールド中の量子化値を複数フレームに書き込む
+ * @param out インタリーブされた出力先
+ * @param frames 書き込むフレーム数
+ * @param quantized チャンネルごとの量子化値
+ * @param channels チャンネル数
+ */
+inline void BitCrushKernel_Fill(float* out, unsigned int frames, const float* quantized, int channels) {
+    if (channels == 1) {
+        std::fill(out, out + frames, quantized[0]);
+        return;
+    }
+
+# if BITCRUSH_KERNEL_SSE2
+    // ステレオは2フレームを1レジスタにまとめて書き込む
+    if (channels == 2) {
+        const __m128 pair = _mm_setr_ps(quantized[0], quantized[1], quantized[0], quantized[1]);
+        unsigned int i = 0;
+        for ( ; i + 2 <= frames ; i += 2) {
+            _mm_storeu_ps(out + i * 2, pair);
+        }
+        if (i < frames) {
+            out[i * 2 + 0] = quantized[0];
+            out[i * 2 + 1] = quantized[1];
+        }
+        return;
+    }
+# endif
+
+    for (unsigned int i = 0 ; i < frames ; ++i) {
+        std::copy(quantized, quantized + channels, out + static_cast<size_t>(i) * channels);
+    }
+}
+
+/**
+ * @brief インタリーブされたバッファにビットクラッシュとダウンサンプリングを適用する
+ * @param state カーネルの状態
+ * @param in インタリーブされた入力
+ * @param out インタリーブされた出力（in と同じでもよい）
+ * @param frames 処理するフレーム数
+ * @param channels チャンネル数（state.numChannels 以下）
+ * @param bits ビット深度
+ * @param downsampling ダウンサンプリング係数
+ * @note FaustBitCrasher.h の mydsp::compute と同じ結果を返す。
+ *       剰余演算の代わりにカウントダウンで取り込みタイミングを求め、量子化は取り込み時だけ行う
+ */
+inline void BitCrushKernel_Process(BitCrushKernelState& state, const float* in, float* out, unsigned int frames, int channels, int bits, int downsampling) {
+    bits = std::clamp(bits, 1, 16);
+    downsampling = std::max(downsampling, 1);
+
+    // Faustと同じ手順で量子化係数を求める
+    const int levels = 1 << bits;
+    const auto scale = static_cast<float>(levels - 1);
+    const float invScale = 1.0f / (static_cast<float>(levels) + -1.0f);
+
+    // ビット深度が変わっている可能性があるため、ホールド値を量子化し直す
+    for (int ch = 0 ; ch < channels ; ++ch) {
+        state.quantized[ch] = invScale * static_cast<float>(static_cast<int>(scale * state.held[ch]));
+    }
+
+    // 次の取り込みまでの残りサンプル数
+    auto countdown = static_cast<unsigned int>(downsampling - static_cast<int>(state.sampleCount % static_cast<uint64_t>(downsampling)));
+
+    unsigned int i = 0;
+    while (i < frames) {
+        // 取り込みまではホールド値をそのまま出力
+        const unsigned int run = std::min(countdown - 1, frames - i);
+        BitCrushKernel_Fill(out + static_cast<size_t>(i) * channels, run, state.quantized, channels);
+        i += run;
+        countdown -= run;
+        if (i == frames) {
+            break;
+        }
+
+        // 取り込みフレーム
+        const float* frame = in + static_cast<size_t>(i) * channels;
+        BitCrushKernel_Latch(frame, state.held, state.quantized, channels, scale, invScale);
+        std::copy(state.quantized, state.quantized + channels, out + static_cast<size_t>(i) * channels);
+        ++i;
+        countdown = static_cast<unsigned int>(downsampling);
+    }
+
+    state.sampleCount += frames;
+}
+
+/**
+ * @brief 2次バターワースローパスの係数
+ */
+struct BitCrushFilterCoeffs {
+    float b0, b1, b2, a1, a2;
+};
+
+/**
+ * @brief ダウンサンプリング後のナイキスト周波数で切るローパスの係数を求める
+ * @param downsampling ダウンサンプリング係数（2以上）
+ * @return フィルタ係数
+ */
+inline BitCrushFilterCoeffs BitCrushKernel_AntiAliasCoeffs(int downsampling) {
+    // カットオフは fs / (2 * downsampling)、Q = 1/√2
+    const double w0 = 3.14159265358979323846 / static_cast<double>(downsampling);
+    const double alpha = std::sin(w0) / std::sqrt(2.0);
+    const double cosw0 = std::cos(w0);
+    const double a0 = 1.0 + alpha;
+
+    BitCrushFilterCoeffs c { };
+    c.b0 = static_cast<float>((1.0 - cosw0) * 0.5 / a0);
+    c.b1 = static_cast<float>((1.0 - cosw0) / a0);
+    c.b2 = c.b0;
+    c.a1 = static_cast<float>(-2.0 * cosw0 / a0);
+    c.a2 = static_cast<float>((1.0 - alpha) / a0);
+    return c;
+}
+
+/**
+ * @brief xorshift32で乱数状態を1ステップ進める
+ */
+inline uint32_t BitCrushKernel_NextNoise(uint32_t& s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+/**
+ * @brief 乱数の上位23ビットから [-0.5, 0.5) の一様乱数を作る
+ */
+inline float BitCrushKernel_NoiseToFloat(uint32_t r) {
+    const uint32_t bits = 0x3F800000u | (r >> 9);
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f - 1.5f;
+}
+
+/**
+ * @brief 現在の丸めモード（最近接偶数）で整数に丸める
+ * @note SIMDの _mm_cvtps_epi32 と同じく整数を経由するので、-0 にならない
+ */
+inline float BitCrushKernel_Round(float x) {
+# if BITCRUSH_KERNEL_SSE2
+    return static_cast<float>(_mm_cvtss_si32(_mm_set_ss(x)));
+# else
+    return static_cast<float>(std::lrint(x));
+# endif
+}
+
+# if BITCRUSH_KERNEL_SSE2
+/**
+ * @brief 4レーン分のxorshift32を1ステップ進める
+ */
+inline __m128i BitCrushKernel_NextNoise4(__m128i s) {
+    s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+    s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+    s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+    return s;
+}
+
+/**
+ * @brief 4レーン分の乱数から [-0.5, 0.5) の一様乱数を作る
+ */
+inline __m128 BitCrushKernel_NoiseToFloat4(__m128i r) {
+    const __m128i bits = _mm_or_si128(_mm_set1_epi32(0x3F800000), _mm_srli_epi32(r, 9));
+    return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.5f));
+}
+
+/**
+ * @brief 1・2チャンネルの品質モードを、フレーム方向に4サンプル（モノラル4フレーム / ステレオ2フレーム）ずつまとめて処理する
+ * @tparam Channels チャンネル数（1か2）
+ * @param state カーネルの状態
+ * @param in インタリーブされた入力
+ * @param out インタリーブされた出力（in と同じでもよい）
+ * @param frames 処理するフレーム数
+ * @param downsampling ダウンサンプリング係数
+ * @param scale 量子化ステップ数
+ * @param invScale scale の逆数
+ * @param shaped ノイズシェーピングを行うか
+ * @param filter アンチエイリアスフィルタの係数（かけない場合は nullptr）
+ * @param countdown 次の取り込みまでの残りサンプル数（処理した分だけ進める）
+ * @return 処理したフレーム数（残りは呼び出し側がフレームごとに処理する）
+ * @note レーン l はフレーム l / Channels のチャンネル l % Channels に対応する。
+ *       乱数はレーンごとにそのフレームの値を持ち、1回で1レジスタ分のフレーム数だけ進めるので、フレームごとの処理と同じ結果になる。
+ *       フィルタ・取り込み・ノイズシェーピングの誤差はフレーム間で依存するので、その部分だけ順番に計算する
+ */
+template <int Channels>
+inline unsigned int BitCrushKernel_ProcessQualityFrames(BitCrushKernelState& state, const float* in, float* out, unsigned int frames, int downsampling,
+                                                        float scale, float invScale, bool shaped, const BitCrushFilterCoeffs* filter, unsigned int& countdown) {
+    static_assert(Channels == 1 || Channels == 2, "4 channels or more are processed across channels");
+    constexpr unsigned int step = 4 / Channels;
+    if (frames < step) {
+        return 0;
+    }
+
+    // レーンごとの乱数（フレーム f のレーンは f + 1 回進めた値）
+    alignas(16) uint32_t noise1[4], noise2[4];
+    for (int ch = 0 ; ch < Channels ; ++ch) {
+        uint32_t s1 = state.noise[ch];
+        uint32_t s2 = state.noise[state.numChannels + ch];
+        for (unsigned int f = 0 ; f < step ; ++f) {
+            noise1[f * Channels + ch] = BitCrushKernel_NextNoise(s1);
+            noise2[f * Channels + ch] = BitCrushKernel_NextNoise(s2);
+        }
+    }
+    __m128i n1 = _mm_load_si128(reinterpret_cast<const __m128i*>(noise1));
+    __m128i n2 = _mm_load_si128(reinterpret_cast<const __m128i*>(noise2));
+    __m128i used1 = n1;
+    __m128i used2 = n2;
+
+    const __m128 scale4 = _mm_set1_ps(scale);
+    const __m128 invScale4 = _mm_set1_ps(invScale);
+
+    unsigned int i = 0;
+    for ( ; i + step <= frames ; i += step) {
+        const float* frame = in + static_cast<size_t>(i) * Channels;
+        float* outFrame = out + static_cast<size_t>(i) * Channels;
+
+        // フィルタと取り込みはフレームの順に進める
+        alignas(16) float held[4];
+        for (unsigned int f = 0 ; f < step ; ++f) {
+            const bool latch = (--countdown == 0);
+            if (latch) {
+                countdown = static_cast<unsigned int>(downsampling);
+            }
+            for (int ch = 0 ; ch < Channels ; ++ch) {
+                float x = frame[f * Channels + ch];
+                if (filter) {
+                    const float y = filter->b0 * x + state.filterZ1[ch];
+                    state.filterZ1[ch] = filter->b1 * x - filter->a1 * y + state.filterZ2[ch];
+                    state.filterZ2[ch] = filter->b2 * x - filter->a2 * y;
+                    x = y;
+                }
+                if (latch) {
+                    state.held[ch] = x;
+                }
+                held[f * Channels + ch] = state.held[ch];
+            }
+        }
+
+        // TPDFディザ（2系統の一様乱数の和）
+        const __m128 dither = _mm_add_ps(BitCrushKernel_NoiseToFloat4(n1), BitCrushKernel_NoiseToFloat4(n2));
+        used1 = n1;
+        used2 = n2;
+        for (unsigned int f = 0 ; f < step ; ++f) {
+            n1 = BitCrushKernel_NextNoise4(n1);
+            n2 = BitCrushKernel_NextNoise4(n2);
+        }
+
+        const __m128 v = _mm_mul_ps(_mm_load_ps(held), scale4);
+        if (!shaped) {
+            const __m128 q = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_add_ps(v, dither)));
+            _mm_storeu_ps(outFrame, _mm_mul_ps(q, invScale4));
+            continue;
+        }
+
+        // ノイズシェーピングは前のサンプルの誤差を使うので、レーンの順に量子化する
+        alignas(16) float values[4], dithers[4];
+        _mm_store_ps(values, v);
+        _mm_store_ps(dithers, dither);
+        for (int l = 0 ; l < 4 ; ++l) {
+            const int ch = l % Channels;
+            const float shapedValue = values[l] - state.shapingError[ch];
+            const float q = BitCrushKernel_Round(shapedValue + dithers[l]);
+            state.shapingError[ch] = q - shapedValue;
+            outFrame[l] = q * invScale;
+        }
+    }
+
+    // 最後に使ったフレームの乱数をチャンネルの状態に戻す
+    _mm_store_si128(reinterpret_cast<__m128i*>(noise1), used1);
+    _mm_store_si128(reinterpret_cast<__m128i*>(noise2), used2);
+    for (int ch = 0 ; ch < Channels ; ++ch) {
+        state.noise[ch] = noise1[(step - 1) * Channels + ch];
+        state.noise[state.numChannels + ch] = noise2[(step - 1) * Channels + ch];
+    }
+
+    return i;
+}
+# endif
+
+/**
+ * @brief ディザ・ノイズシェーピング・アンチエイリアスの各段を含むビットクラッシュ処理
+ * @param state カーネルの状態
+ * @param in インタリーブされた入力
+ * @param out インタリーブされた出力（in と同じでもよい）
+ * @param frames 処理するフレーム数
+ * @param channels チャンネル数（state.numChannels 以下）
+ * @param bits ビット深度
+ * @param downsampling ダウンサンプリング係数
+ * @param quality 品質モード（BITCRUSH_QUALITY_CLASSIC 以外）
+ * @note ディザを加えた値を毎サンプル量子化し直すため、量子化は最近接丸めで行う
+ */
+inline void BitCrushKernel_ProcessQuality(BitCrushKernelState& state, const float* in, float* out, unsigned int frames, int channels, int bits, int downsampling, int quality) {
+    bits = std::clamp(bits, 1, 16);
+    downsampling = std::max(downsampling, 1);
+
+    const auto scale = static_cast<float>((1 << bits) - 1);
+    const float invScale = 1.0f / scale;
+    const bool shaped = (quality == BITCRUSH_QUALITY_NOISE_SHAPED);
+    const bool filtered = (quality == BITCRUSH_QUALITY_ANTI_ALIAS) && downsampling > 1;
+    const BitCrushFilterCoeffs c = filtered ? BitCrushKernel_AntiAliasCoeffs(downsampling) : BitCrushFilterCoeffs { };
+
+    auto countdown = static_cast<unsigned int>(downsampling - static_cast<int>(state.sampleCount % static_cast<uint64_t>(downsampling)));
+
+    unsigned int i = 0;
+
+# if BITCRUSH_KERNEL_SSE2
+    // チャンネル方向では1レジスタを埋められないので、フレーム方向にまとめる
+    if (channels == 1) {
+        i = BitCrushKernel_ProcessQualityFrames<1>(state, in, out, frames, downsampling, scale, invScale, shaped, filtered ? &c : nullptr, countdown);
+    }
+    else if (channels == 2) {
+        i = BitCrushKernel_ProcessQualityFrames<2>(state, in, out, frames, downsampling, scale, invScale, shaped, filtered ? &c : nullptr, countdown);
+    }
+# endif
+
+    for ( ; i < frames ; ++i) {
+        const float* frame = in + static_cast<size_t>(i) * channels;
+        float* outFrame = out + static_cast<size_t>(i) * channels;
+        const bool latch = (--countdown == 0);
+        if (latch) {
+            countdown = static_cast<unsigned int>(downsampling);
+        }
+
+        int ch = 0;
+
+# if BITCRUSH_KERNEL_SSE2
+        const __m128 scale4 = _mm_set1_ps(scale);
+        const __m128 invScale4 = _mm_set1_ps(invScale);
+        for ( ; ch + 4 <= channels ; ch += 4) {
+            __m128 x = _mm_loadu_ps(frame + ch);
+
+            // アンチエイリアスフィルタ（転置直接形II）
+            if (filtered) {
+                const __m128 z1 = _mm_loadu_ps(state.filterZ1 + ch);
+                const __m128 z2 = _mm_loadu_ps(state.filterZ2 + ch);
+                const __m128 y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c.b0), x), z1);
+                _mm_storeu_ps(state.filterZ1 + ch, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c.b1), x), _mm_mul_ps(_mm_set1_ps(c.a1), y)), z2));
+                _mm_storeu_ps(state.filterZ2 + ch, _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c.b2), x), _mm_mul_ps(_mm_set1_ps(c.a2), y)));
+                x = y;
+            }
+
+            if (latch) {
+                _mm_storeu_ps(state.held + ch, x);
+            }
+
+            // TPDFディザ（2系統の一様乱数の和）
+            const __m128i n1 = BitCrushKernel_NextNoise4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state.noise + ch)));
+            const __m128i n2 = BitCrushKernel_NextNoise4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state.noise + state.numChannels + ch)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(state.noise + ch), n1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(state.noise + state.numChannels + ch), n2);
+            const __m128 dither = _mm_add_ps(BitCrushKernel_NoiseToFloat4(n1), BitCrushKernel_NoiseToFloat4(n2));
+
+            // ステップ単位で量子化し、シェーピング時は前回の誤差を差し引く
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(state.held + ch), scale4);
+            if (shaped) {
+                v = _mm_sub_ps(v, _mm_loadu_ps(state.shapingError + ch));
+            }
+            const __m128 q = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_add_ps(v, dither)));
+            if (shaped) {
+                _mm_storeu_ps(state.shapingError + ch, _mm_sub_ps(q, v));
+            }
+            _mm_storeu_ps(outFrame + ch, _mm_mul_ps(q, invScale4));
+        }
+# endif
+
+        // 残りのチャンネル
+        for ( ; ch < channels ; ++ch) {
+            float x = frame[ch];
+            if (filtered) {
+                const float y = c.b0 * x + state.filterZ1[ch];
+                state.filterZ1[ch] = c.b1 * x - c.a1 * y + state.filterZ2[ch];
+                state.filterZ2[ch] = c.b2 * x - c.a2 * y;
+                x = y;
+            }
+
+            if (latch) {
+                state.held[ch] = x;
+            }
+
+            const float dither = BitCrushKernel_NoiseToFloat(BitCrushKernel_NextNoise(state.noise[ch]))
+                               + BitCrushKernel_NoiseToFloat(BitCrushKernel_NextNoise(state.noise[state.numChannels + ch]));
+
+            float v = state.held[ch] * scale;
+            if (shaped) {
+                v -= state.shapingError[ch];
+            }
+            const float q = BitCrushKernel_Round(v + dither);
+            if (shaped) {
+                state.shapingError[ch] = q - v;
+            }
+            outFrame[ch] = q * invScale;
+        }
+    }
+
+    state.sampleCount += frames;
+}
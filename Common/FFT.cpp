@@ -0,0 +1,212 @@
+/**
+ *  @file FFT.cpp
+ *  @author Goto Kenta
+ *  @brief 組み込みの実数FFT（長さ size / 2 の複素FFTと前後処理）と実装の選択
+ */
+
+# include "FFT.h"
+# include "SimdDispatch.h"
+
+# include <cassert>
+# include <cmath>
+# include <cstdlib>
+# include <cstring>
+# include <utility>
+
+// 外部ライブラリの実装はCMakeが見つけたときだけ有効になる
+# ifndef FMOD_PLUGINS_FFT_PFFFT
+    # define FMOD_PLUGINS_FFT_PFFFT 0
+# endif
+# ifndef FMOD_PLUGINS_FFT_FFTW
+    # define FMOD_PLUGINS_FFT_FFTW 0
+# endif
+
+namespace {
+    const double kPi = 3.14159265358979323846;
+
+    /**
+     * @brief 組み込みの実数FFT（回転因子とビット反転表を保持する）
+     */
+    class BuiltinFFTPlan : public FFTPlan {
+    public:
+        explicit BuiltinFFTPlan(size_t size);
+
+        void forward(const float* in, float* re, float* im, float* work) const override;
+        void inverse(const float* re, const float* im, float* out, float* work) const override;
+
+    private:
+        /**
+         * @brief 長さ size / 2 の複素FFT（入力はビット反転順、出力は自然順）
+         */
+        void butterflies(float* re, float* im) const;
+
+        /**
+         * @brief 長さ size / 2 の複素数列をその場でビット反転順に並べ替える
+         */
+        void bitReverse(float* re, float* im) const;
+
+        std::vector<uint32_t> m_bitReverse; // 長さ size / 2 のビット反転
+        std::vector<float> m_stageCos;      // 段ごとに並べた回転因子（段 h は h - 1 番目から h 個）
+        std::vector<float> m_stageSin;
+        std::vector<float> m_realCos;       // 実数FFTの後処理用 exp(-2πik/size)
+        std::vector<float> m_realSin;
+    };
+}
+
+BuiltinFFTPlan::BuiltinFFTPlan(size_t size) : FFTPlan(size, size, FFTBackend::Builtin) {
+    assert(size >= 2 && (size & (size - 1)) == 0);
+
+    const size_t half = size / 2;
+
+    // ビット反転表
+    unsigned int bits = 0;
+    while ((static_cast<size_t>(1) << bits) < half) {
+        ++bits;
+    }
+    m_bitReverse.resize(half);
+    for (size_t i = 0 ; i < half ; ++i) {
+        uint32_t r = 0;
+        for (unsigned int b = 0 ; b < bits ; ++b) {
+            r |= static_cast<uint32_t>((i >> b) & 1u) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+
+    // 各段の回転因子 exp(-iπj/h)（精度のためdoubleで計算する）
+    m_stageCos.resize(half > 1 ? half - 1 : 0);
+    m_stageSin.resize(m_stageCos.size());
+    for (size_t h = 1 ; h < half ; h *= 2) {
+        for (size_t j = 0 ; j < h ; ++j) {
+            const double angle = -kPi * static_cast<double>(j) / static_cast<double>(h);
+            m_stageCos[h - 1 + j] = static_cast<float>(std::cos(angle));
+            m_stageSin[h - 1 + j] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    // 実数FFTの後処理用 exp(-2πik/size)（k = 0 .. size / 4）
+    m_realCos.resize(half / 2 + 1);
+    m_realSin.resize(half / 2 + 1);
+    for (size_t k = 0 ; k < m_realCos.size() ; ++k) {
+        const double angle = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(size);
+        m_realCos[k] = static_cast<float>(std::cos(angle));
+        m_realSin[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void BuiltinFFTPlan::butterflies(float* re, float* im) const {
+    const size_t half = size() / 2;
+    const SimdKernelTable& simd = SimdKernels();
+
+    // 各段は幅 h のバタフライを並べたもの（幅が広い段ほどSIMDの幅いっぱいに使える）
+    for (size_t h = 1 ; h < half ; h *= 2) {
+        simd.fftButterflyStage(re, im, m_stageCos.data() + (h - 1), m_stageSin.data() + (h - 1), half, h);
+    }
+}
+
+void BuiltinFFTPlan::bitReverse(float* re, float* im) const {
+    const size_t half = size() / 2;
+    for (size_t i = 0 ; i < half ; ++i) {
+        const size_t r = m_bitReverse[i];
+        if (i < r) {
+            std::swap(re[i], re[r]);
+            std::swap(im[i], im[r]);
+        }
+    }
+}
+
+void BuiltinFFTPlan::forward(const float* in, float* re, float* im, float*) const {
+    const size_t half = size() / 2;
+
+    // 偶数番目を実部、奇数番目を虚部にした長さ half の複素数列として変換する
+    for (size_t n = 0 ; n < half ; ++n) {
+        const uint32_t r = m_bitReverse[n];
+        re[r] = in[2 * n];
+        im[r] = in[2 * n + 1];
+    }
+    butterflies(re, im);
+
+    // 後処理: X[k] = E + W^k O, X[half - k] = conj(E - W^k O)
+    // E = (Z[k] + conj Z[half - k]) / 2, O = (Z[k] - conj Z[half - k]) / 2i
+    const float z0r = re[0];
+    const float z0i = im[0];
+    re[0] = z0r + z0i;
+    im[0] = 0.0f;
+    re[half] = z0r - z0i;
+    im[half] = 0.0f;
+    SimdKernels().realFFTForwardPost(re, im, m_realCos.data(), m_realSin.data(), half);
+}
+
+void BuiltinFFTPlan::inverse(const float* re, const float* im, float* out, float* work) const {
+    const size_t half = size() / 2;
+    float* zr = work;
+    float* zi = work + half;
+
+    // 前処理: Z[k] = E + iO, E = (X[k] + conj X[half - k]) / 2, O = (X[k] - conj X[half - k]) conj(W^k) / 2
+    // （自然順に作ってからビット反転順に並べ替える）
+    zr[0] = 0.5f * (re[0] + re[half]);
+    zi[0] = 0.5f * (re[0] - re[half]);
+    SimdKernels().realFFTInversePre(re, im, zr, zi, m_realCos.data(), m_realSin.data(), half);
+    bitReverse(zr, zi);
+
+    // 実部と虚部を入れ替えて順変換すると、正規化なしの逆変換になる
+    butterflies(zi, zr);
+
+    const float scale = 1.0f / static_cast<float>(half);
+    for (size_t n = 0 ; n < half ; ++n) {
+        out[2 * n] = zr[n] * scale;
+        out[2 * n + 1] = zi[n] * scale;
+    }
+}
+
+std::shared_ptr<const FFTPlan> FFTPlan::Create(size_t size, FFTBackend backend) {
+    std::shared_ptr<const FFTPlan> plan;
+# if FMOD_PLUGINS_FFT_PFFFT
+    if (backend == FFTBackend::PFFFT) plan = CreateFFTPlanPFFFT(size);
+# endif
+# if FMOD_PLUGINS_FFT_FFTW
+    if (backend == FFTBackend::FFTW) plan = CreateFFTPlanFFTW(size);
+# endif
+    (void)backend;
+
+    if (!plan) {
+        plan = std::make_shared<const BuiltinFFTPlan>(size);
+    }
+    return plan;
+}
+
+bool FFTPlan::IsAvailable(FFTBackend backend) {
+    switch (backend) {
+        case FFTBackend::Builtin: return true;
+        case FFTBackend::PFFFT: return FMOD_PLUGINS_FFT_PFFFT != 0;
+        case FFTBackend::FFTW: return FMOD_PLUGINS_FFT_FFTW != 0;
+        default: return false;
+    }
+}
+
+FFTBackend FFTPlan::DefaultBackend() {
+    static const FFTBackend backend = [] {
+        // 環境変数での指定を優先する（ビルドされていなければ無視）
+        if (const char* requested = std::getenv("FMOD_PLUGINS_FFT")) {
+            for (FFTBackend candidate : { FFTBackend::Builtin, FFTBackend::PFFFT, FFTBackend::FFTW }) {
+                if (std::strcmp(requested, BackendName(candidate)) == 0 && IsAvailable(candidate)) {
+                    return candidate;
+                }
+            }
+        }
+
+    # if defined(FMOD_PLUGINS_FFT_DEFAULT)
+        if (IsAvailable(FFTBackend::FMOD_PLUGINS_FFT_DEFAULT)) return FFTBackend::FMOD_PLUGINS_FFT_DEFAULT;
+    # endif
+        // FFTWはライセンスがGPLなので、明示しない限り選ばない
+        return IsAvailable(FFTBackend::PFFFT) ? FFTBackend::PFFFT : FFTBackend::Builtin;
+    }();
+    return backend;
+}
+
+const char* FFTPlan::BackendName(FFTBackend backend) {
+    switch (backend) {
+        case FFTBackend::PFFFT: return "pffft";
+        case FFTBackend::FFTW: return "fftw";
+        default: return "builtin";
+    }
+}
@@ -0,0 +1,192 @@
+/**
+ *  @file FFT.h
+ *  @author Goto Kenta
+ *  @brief 実数FFTのインタフェースと、サイズごとのFFTプランをプロセス全体で共有するキャッシュ
+ */
+
+# pragma once
+
+# include <cstddef>
+# include <cstdint>
+# include <map>
+# include <memory>
+# include <mutex>
+# include <utility>
+# include <vector>
+
+/**
+ * @brief FFTの実装
+ */
+enum class FFTBackend {
+    Builtin, // 組み込みの基数2 FFT（常に使える。バタフライと前後処理は SimdKernels() を使う）
+    PFFFT,   // ThirdParty/pffft があるときだけ
+    FFTW,    // libfftw3f があるときだけ（GPL）
+};
+
+/**
+ * @brief 2のべき乗サイズの実数FFT
+ * @note 作成後は読み取り専用なので、複数のスレッド・インスタンスから同時に使ってよい。
+ *       スペクトルは実部と虚部を別の配列（それぞれ complexSize() 要素）で扱い、
+ *       実装ごとの作業領域は呼び出し側が FFTWorkspace で用意する
+ */
+class FFTPlan {
+public:
+    virtual ~FFTPlan() = default;
+
+    /**
+     * @brief 指定した実装でプランを作る（その実装がない・そのサイズに対応しないときは組み込みの実装）
+     * @param size 変換の長さ（2以上の2のべき乗）
+     * @param backend 使いたい実装
+     */
+    static std::shared_ptr<const FFTPlan> Create(size_t size, FFTBackend backend);
+
+    /**
+     * @brief このビルドで使える実装かどうか
+     */
+    static bool IsAvailable(FFTBackend backend);
+
+    /**
+     * @brief 既定の実装（CMakeの FMOD_PLUGINS_FFT_BACKEND、環境変数 FMOD_PLUGINS_FFT で上書きできる）
+     */
+    static FFTBackend DefaultBackend();
+
+    /**
+     * @brief 実装の表示名
+     */
+    static const char* BackendName(FFTBackend backend);
+
+    /**
+     * @brief 変換の長さ
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief スペクトルの要素数（size / 2 + 1）
+     */
+    size_t complexSize() const { return m_size / 2 + 1; }
+
+    /**
+     * @brief forward / inverse に渡す作業領域の大きさ（float の数）
+     */
+    size_t workSize() const { return m_workSize; }
+
+    /**
+     * @brief 実際に使われている実装
+     */
+    FFTBackend backend() const { return m_backend; }
+
+    /**
+     * @brief 順変換
+     * @param in 時間領域の信号（size() 要素）
+     * @param re スペクトルの実部（complexSize() 要素）
+     * @param im スペクトルの虚部（complexSize() 要素）
+     * @param work 作業領域（workSize() 要素、64バイト境界）
+     */
+    virtual void forward(const float* in, float* re, float* im, float* work) const = 0;
+
+    /**
+     * @brief 逆変換（1/size で正規化するので forward → inverse で元に戻る）
+     * @param re スペクトルの実部（complexSize() 要素）
+     * @param im スペクトルの虚部（complexSize() 要素）
+     * @param out 時間領域の信号（size() 要素）
+     * @param work 作業領域（workSize() 要素、64バイト境界）
+     */
+    virtual void inverse(const float* re, const float* im, float* out, float* work) const = 0;
+
+protected:
+    FFTPlan(size_t size, size_t workSize, FFTBackend backend)
+        : m_size(size), m_workSize(workSize), m_backend(backend) { }
+
+private:
+    size_t m_size;
+    size_t m_workSize;
+    FFTBackend m_backend;
+};
+
+/**
+ * @brief プランが必要とする作業領域（64バイト境界にそろえる）
+ * @note 確保はプランを決めたとき（IRの設定時）に行い、処理中は確保しない
+ */
+class FFTWorkspace {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    /**
+     * @brief プランに合わせて確保する
+     */
+    void prepare(const FFTPlan& plan) {
+        m_storage.assign(plan.workSize() + kAlignment / sizeof(float), 0.0f);
+        const auto address = reinterpret_cast<uintptr_t>(m_storage.data());
+        m_data = reinterpret_cast<float*>((address + kAlignment - 1) & ~static_cast<uintptr_t>(kAlignment - 1));
+    }
+
+    /**
+     * @brief 解放する
+     */
+    void clear() {
+        m_storage.clear();
+        m_data = nullptr;
+    }
+
+    float* data() const { return m_data; }
+
+private:
+    std::vector<float> m_storage;
+    float* m_data = nullptr;
+};
+
+/**
+ * @brief サイズと実装ごとのFFTプランを共有するキャッシュ
+ * @note コンボリューターを何個作っても、同じサイズの回転因子表は1つだけになる。
+ *       使われるサイズはブロックサイズで決まる数種類なので、作ったプランは解放しない
+ */
+class FFTPlanCache {
+public:
+    using Plan = std::shared_ptr<const FFTPlan>;
+
+    /**
+     * @brief モジュール全体で共有するキャッシュを取得する
+     */
+    static FFTPlanCache& Shared() {
+        static FFTPlanCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief 既定の実装のプランを取得する（なければ作る）
+     * @param size 変換の長さ（2以上の2のべき乗）
+     */
+    Plan Get(size_t size) {
+        return Get(size, FFTPlan::DefaultBackend());
+    }
+
+    /**
+     * @brief 実装を指定してプランを取得する（なければ作る）
+     * @param size 変換の長さ（2以上の2のべき乗）
+     * @param backend 使いたい実装（使えなければ組み込みの実装になる）
+     */
+    Plan Get(size_t size, FFTBackend backend) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Plan& plan = m_plans[std::make_pair(size, backend)];
+        if (!plan) {
+            plan = FFTPlan::Create(size, backend);
+        }
+        return plan;
+    }
+
+    /**
+     * @brief 保持しているプランの数
+     */
+    size_t Count() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_plans.size();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::map<std::pair<size_t, FFTBackend>, Plan> m_plans;
+};
+
+// 外部ライブラリの実装はそのファイルをビルドしたときだけ定義される（対応しないサイズなら nullptr を返す）
+std::shared_ptr<const FFTPlan> CreateFFTPlanPFFFT(size_t size);
+std::shared_ptr<const FFTPlan> CreateFFTPlanFFTW(size_t size);
@@ -0,0 +1,98 @@
+/**
+ *  @file FFTBackendFFTW.cpp
+ *  @author Goto Kenta
+ *  @brief FFTW（単精度）を使った実数FFT
+ *  @note FFTWはGPLなので、このファイルを含めたバイナリを配布するときはライセンスに注意すること
+ */
+
+# include "FFT.h"
+
+# include <mutex>
+
+# include <fftw3.h>
+
+namespace {
+    /**
+     * @brief FFTWのプラン作成・破棄はスレッドセーフではないので、このモジュールではこのロックの中で行う
+     */
+    std::mutex& PlannerMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /**
+     * @brief FFTWのプラン（実部と虚部を別の配列で扱う guru インタフェースを使う）
+     * @note 実行時の配列は境界がそろっていないことがあるので FFTW_UNALIGNED で作る
+     */
+    class FftwPlan : public FFTPlan {
+    public:
+        FftwPlan(size_t size, fftwf_plan forwardPlan, fftwf_plan inversePlan)
+            : FFTPlan(size, 2 * (size / 2 + 1), FFTBackend::FFTW), m_forward(forwardPlan), m_inverse(inversePlan) { }
+
+        ~FftwPlan() override {
+            std::lock_guard<std::mutex> lock(PlannerMutex());
+            fftwf_destroy_plan(m_forward);
+            fftwf_destroy_plan(m_inverse);
+        }
+
+        void forward(const float* in, float* re, float* im, float*) const override {
+            // 実数→複素の変換は入力を書き換えない
+            fftwf_execute_split_dft_r2c(m_forward, const_cast<float*>(in), re, im);
+        }
+
+        void inverse(const float* re, const float* im, float* out, float* work) const override {
+            // 複素→実数の変換は入力を壊すので作業領域にコピーしてから行う
+            const size_t count = complexSize();
+            float* ri = work;
+            float* ii = work + count;
+            for (size_t k = 0 ; k < count ; ++k) {
+                ri[k] = re[k];
+                ii[k] = im[k];
+            }
+            fftwf_execute_split_dft_c2r(m_inverse, ri, ii, out);
+
+            // FFTWの逆変換は正規化しない
+            const size_t n = size();
+            const float scale = 1.0f / static_cast<float>(n);
+            for (size_t i = 0 ; i < n ; ++i) {
+                out[i] *= scale;
+            }
+        }
+
+    private:
+        fftwf_plan m_forward;
+        fftwf_plan m_inverse;
+    };
+}
+
+std::shared_ptr<const FFTPlan> CreateFFTPlanFFTW(size_t size) {
+    const int n = static_cast<int>(size);
+    const int count = n / 2 + 1;
+
+    std::lock_guard<std::mutex> lock(PlannerMutex());
+
+    // FFTW_MEASURE は計測のために配列を書き換えるので、作成用の配列を別に用意する
+    float* data = fftwf_alloc_real(static_cast<size_t>(n));
+    float* re = fftwf_alloc_real(static_cast<size_t>(count));
+    float* im = fftwf_alloc_real(static_cast<size_t>(count));
+
+    fftwf_iodim dim;
+    dim.n = n;
+    dim.is = 1;
+    dim.os = 1;
+
+    const unsigned int flags = FFTW_MEASURE | FFTW_UNALIGNED;
+    fftwf_plan forwardPlan = fftwf_plan_guru_split_dft_r2c(1, &dim, 0, nullptr, data, re, im, flags);
+    fftwf_plan inversePlan = fftwf_plan_guru_split_dft_c2r(1, &dim, 0, nullptr, re, im, data, flags);
+
+    fftwf_free(data);
+    fftwf_free(re);
+    fftwf_free(im);
+
+    if (!forwardPlan || !inversePlan) {
+        if (forwardPlan) fftwf_destroy_plan(forwardPlan);
+        if (inversePlan) fftwf_destroy_plan(inversePlan);
+        return nullptr;
+    }
+    return std::make_shared<const FftwPlan>(size, forwardPlan, inversePlan);
+}
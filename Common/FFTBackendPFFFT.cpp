@@ -0,0 +1,86 @@
+/**
+ *  @file FFTBackendPFFFT.cpp
+ *  @author Goto Kenta
+ *  @brief PFFFTを使った実数FFT（SSE/NEONで最適化されている）
+ */
+
+# include "FFT.h"
+
+# include <pffft.h>
+
+namespace {
+    /**
+     * @brief PFFFTのプラン
+     * @note PFFFTは入出力と作業領域が16バイト境界である必要があるので、作業領域（3 * size）の中で変換してから詰め替える
+     */
+    class PffftPlan : public FFTPlan {
+    public:
+        PffftPlan(size_t size, PFFFT_Setup* setup)
+            : FFTPlan(size, 3 * size, FFTBackend::PFFFT), m_setup(setup) { }
+
+        ~PffftPlan() override {
+            pffft_destroy_setup(m_setup);
+        }
+
+        void forward(const float* in, float* re, float* im, float* work) const override {
+            const size_t n = size();
+            float* input = work;
+            float* output = work + n;
+            float* scratch = work + 2 * n;
+
+            for (size_t i = 0 ; i < n ; ++i) {
+                input[i] = in[i];
+            }
+            pffft_transform_ordered(m_setup, input, output, scratch, PFFFT_FORWARD);
+
+            // 並びは [r0, r(n/2), r1, i1, r2, i2, ...]
+            const size_t half = n / 2;
+            re[0] = output[0];
+            im[0] = 0.0f;
+            re[half] = output[1];
+            im[half] = 0.0f;
+            for (size_t k = 1 ; k < half ; ++k) {
+                re[k] = output[2 * k];
+                im[k] = output[2 * k + 1];
+            }
+        }
+
+        void inverse(const float* re, const float* im, float* out, float* work) const override {
+            const size_t n = size();
+            const size_t half = n / 2;
+            float* input = work;
+            float* output = work + n;
+            float* scratch = work + 2 * n;
+
+            input[0] = re[0];
+            input[1] = re[half];
+            for (size_t k = 1 ; k < half ; ++k) {
+                input[2 * k] = re[k];
+                input[2 * k + 1] = im[k];
+            }
+            pffft_transform_ordered(m_setup, input, output, scratch, PFFFT_BACKWARD);
+
+            // PFFFTの逆変換は正規化しない
+            const float scale = 1.0f / static_cast<float>(n);
+            for (size_t i = 0 ; i < n ; ++i) {
+                out[i] = output[i] * scale;
+            }
+        }
+
+    private:
+        PFFFT_Setup* m_setup;
+    };
+}
+
+std::shared_ptr<const FFTPlan> CreateFFTPlanPFFFT(size_t size) {
+    // 実数FFTは32の倍数のサイズにしか対応しない
+    if (size < 32 || size % 32 != 0) {
+        return nullptr;
+    }
+
+    PFFFT_Setup* setup = pffft_new_setup(static_cast<int>(size), PFFFT_REAL);
+    if (!setup) {
+        return nullptr;
+    }
+    return std::make_shared<const PffftPlan>(size, setup);
+}
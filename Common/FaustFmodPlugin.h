@@ -0,0 +1,381 @@
+/**
+ *  @file FaustFmodPlugin.h
+ *  @author Goto Kenta
+ *  @brief Faustが生成したDSPクラスをそのままFMOD DSPプラグインとして公開するテンプレート
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <cstdio>
+# include <cstring>
+# include <new>
+
+# include "FaustParamBridge.h"
+# include "FmodPluginBase.h"
+
+/**
+ * @brief Faust DSPをFMOD DSPプラグインにするアダプタ
+ * @tparam DSP Faustが生成したDSPクラス（init / instanceClear / compute / buildUserInterface を持つ）
+ * @note パラメータはbuildUserInterfaceから自動で作る。スライダーと数値入力はfloat、
+ *       ボタンとチェックボックスはbool、バーグラフは読み取り専用のfloatパラメータになる。
+ *       DSPの入力数をKとすると、Kチャンネルずつを1インスタンスに割り当てる（モノラルDSPならチャンネルごと）。
+ *       インスタンスはFMODの最大チャンネル幅の分を create で作っておき、ミキサースレッドでは作らない
+ *       （FaustRuntimeDSP の createDSPInstance はJITのメモリを確保するため）
+ */
+template <class DSP>
+class FaustFmodPlugin : public FmodPluginBase<FaustFmodPlugin<DSP>> {
+    static_assert(sizeof(FAUSTFLOAT) == sizeof(float), "FaustFmodPlugin requires FAUSTFLOAT to be float");
+
+    using Base = FmodPluginBase<FaustFmodPlugin<DSP>>;
+    friend Base;
+
+public:
+    static constexpr const char* kName = "Faust";
+    static constexpr unsigned int kVersion = 0x00010000;
+    static constexpr int kMaxLanes = 32; // 1インスタンスが持てる入出力数の上限
+    static constexpr int kMaxChannels = FMOD_MAX_CHANNEL_WIDTH; // 作成時にインスタンスを用意しておくチャンネル数
+
+    /**
+     * @brief FMODに渡すプラグインの説明構造体を取得する
+     * @param name プラグインの名前
+     * @param version プラグインのバージョン
+     * @return プラグインの説明構造体へのポインタ
+     */
+    static FMOD_DSP_DESCRIPTION* Description(const char* name, unsigned int version) {
+        FMOD_DSP_DESCRIPTION* desc = Base::Description();
+        std::strncpy(desc->name, name, sizeof(desc->name) - 1);
+        desc->version = version;
+        return desc;
+    }
+
+    /**
+     * @brief DSPのUI定義から作ったパラメータ説明を返す
+     * @param count パラメータの数を受け取る
+     * @return パラメータ説明の配列
+     */
+    static FMOD_DSP_PARAMETER_DESC** ParameterDescs(int& count) {
+        Layout& layout = GetLayout();
+        count = layout.numParams;
+        return layout.params;
+    }
+
+private:
+    /**
+     * @brief DSPの型ごとに1つだけ持つパラメータ定義
+     */
+    struct Layout {
+        FaustParamBridge::ParamInfo info[FaustParamBridge::kMaxParams];
+        FMOD_DSP_PARAMETER_DESC descs[FaustParamBridge::kMaxParams];
+        FMOD_DSP_PARAMETER_DESC* params[FaustParamBridge::kMaxParams];
+        int numParams;
+        int numInputs;  // 1インスタンスの入力数
+        int numOutputs; // 1インスタンスの出力数
+    };
+
+    /**
+     * @brief DSPの型ごとのレイアウトを取得する（初回に作る）
+     * @note params と説明文は layout 自身の中を指すので、コピーせずに静的変数の中で直接作る
+     */
+    static Layout& GetLayout() {
+        static Layout layout { };
+        static const bool built = (BuildLayout(layout), true);
+        (void)built;
+        return layout;
+    }
+
+    /**
+     * @brief 一時インスタンスのUI定義からパラメータ説明を作る
+     * @param layout 結果（params と説明文は layout の中を指す）
+     */
+    static void BuildLayout(Layout& layout) {
+        // 大きな遅延線を持つDSPもあるのでヒープに置く
+        DSP* probe = new DSP();
+        layout.numInputs = std::min(probe->getNumInputs(), static_cast<int>(kMaxLanes));
+        layout.numOutputs = std::min(probe->getNumOutputs(), static_cast<int>(kMaxLanes));
+
+        FaustParamBridge* bridge = new FaustParamBridge();
+        bridge->bind(probe, 1);
+        layout.numParams = bridge->count();
+        for (int p = 0 ; p < layout.numParams ; ++p) {
+            layout.info[p] = bridge->info(p);
+        }
+        delete bridge;
+        delete probe;
+
+        for (int p = 0 ; p < layout.numParams ; ++p) {
+            const FaustParamBridge::ParamInfo& info = layout.info[p];
+            FMOD_DSP_PARAMETER_DESC& desc = layout.descs[p];
+            switch (info.kind) {
+                case FaustParamBridge::PARAM_BUTTON:
+                case FaustParamBridge::PARAM_CHECKBOX:
+                    FMOD_DSP_INIT_PARAMDESC_BOOL(desc, info.label, info.unit, info.label, info.init != 0.0f, nullptr);
+                    break;
+
+                default:
+                    FMOD_DSP_INIT_PARAMDESC_FLOAT(desc, info.label, info.unit, info.label, info.min, info.max, info.init);
+                    break;
+            }
+            layout.params[p] = &desc;
+        }
+    }
+
+    /**
+     * @brief 1インスタンスが受け持つチャンネル数
+     */
+    static int ChannelsPerInstance() {
+        const Layout& layout = GetLayout();
+        return std::max(1, std::max(layout.numInputs, layout.numOutputs));
+    }
+
+    /**
+     * @brief 最大チャンネル幅の分のインスタンスと、デインタリーブ用のスクラッチを確保する
+     */
+    FMOD_RESULT onCreate() {
+        if (AllocateInstances(kMaxChannels) != FMOD_OK) {
+            return FMOD_ERR_MEMORY;
+        }
+
+        // 1グループ分の入出力をデインタリーブするスクラッチ
+        const size_t lanes = static_cast<size_t>(GetLayout().numInputs + GetLayout().numOutputs);
+        m_scratch = this->allocateFloats(lanes * this->blockSize());
+        if (m_scratch == nullptr) {
+            return FMOD_ERR_MEMORY;
+        }
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief インスタンスとスクラッチを解放する
+     */
+    void onRelease() {
+        DestroyInstances();
+        this->deallocate(m_scratch);
+    }
+
+    /**
+     * @brief すべてのインスタンスの状態をクリアする（作成時に確保できていなければ、ここで作り直す）
+     */
+    FMOD_RESULT onReset() {
+        if (!m_instances && AllocateInstances(kMaxChannels) != FMOD_OK) {
+            return FMOD_ERR_MEMORY;
+        }
+
+        for (int i = 0 ; i < m_numInstances ; ++i) {
+            m_instances[i].instanceClear();
+        }
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief インスタンスは作成時に最大チャンネル幅の分を用意しているので、ここでは確保しない（PERFORMから呼ばれる）
+     */
+    FMOD_RESULT onChannels(int chs) {
+        if (chs > m_numInstances * ChannelsPerInstance()) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief APIスレッドで設定されたパラメータをバッファ先頭で反映する
+     */
+    void onProcessStart() {
+        m_params.apply();
+    }
+
+    /**
+     * @brief バーグラフの値をAPIスレッドへ公開する
+     */
+    void onProcessEnd() {
+        m_params.publish();
+    }
+
+    /**
+     * @brief チャンネル数に足りるだけのDSPインスタンスを確保し直す（create / reset からだけ呼ぶ）
+     * @param numChannels 処理するチャンネル数
+     * @return 処理が成功した場合はFMOD_OKを返す、それ以外はエラーコードを返す
+     */
+    FMOD_RESULT AllocateInstances(int numChannels) {
+        const int perInstance = ChannelsPerInstance();
+        const int numInstances = std::min((numChannels + perInstance - 1) / perInstance, FaustParamBridge::kMaxInstances);
+
+        void* mem = this->allocate(sizeof(DSP) * static_cast<size_t>(numInstances));
+        if (mem == nullptr) {
+            return FMOD_ERR_MEMORY;
+        }
+
+        auto* instances = static_cast<DSP*>(mem);
+        for (int i = 0 ; i < numInstances ; ++i) {
+            DSP* dsp = new(&instances[i]) DSP();
+            dsp->init(this->sampleRate());
+        }
+
+        // 新しいインスタンスのゾーンを登録し、現在のパラメータ値を書き込む
+        m_params.bind(instances, numInstances);
+
+        DestroyInstances();
+        m_instances = instances;
+        m_numInstances = numInstances;
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief 確保済みのDSPインスタンスを破棄する
+     */
+    void DestroyInstances() {
+        if (m_instances) {
+            for (int i = 0 ; i < m_numInstances ; ++i) {
+                m_instances[i].~DSP();
+            }
+            this->deallocate(m_instances);
+        }
+        m_instances = nullptr;
+        m_numInstances = 0;
+    }
+
+    /**
+     * @brief インタリーブされたブロックをチャンネルグループごとにFaustで処理する
+     * @param in インタリーブされた入力
+     * @param out インタリーブされた出力
+     * @param frames 処理するフレーム数（ブロックサイズ以下）
+     * @param chs チャンネル数
+     */
+    void processBlock(const float* in, float* out, unsigned int frames, int chs) {
+        const Layout& layout = GetLayout();
+        const int perInstance = ChannelsPerInstance();
+        const size_t stride = this->blockSize();
+
+        FAUSTFLOAT* fin[kMaxLanes];
+        FAUSTFLOAT* fout[kMaxLanes];
+        for (int i = 0 ; i < layout.numInputs ; ++i) {
+            fin[i] = reinterpret_cast<FAUSTFLOAT*>(m_scratch + static_cast<size_t>(i) * stride);
+        }
+        for (int o = 0 ; o < layout.numOutputs ; ++o) {
+            fout[o] = reinterpret_cast<FAUSTFLOAT*>(m_scratch + static_cast<size_t>(layout.numInputs + o) * stride);
+        }
+
+        for (int g = 0 ; g < m_numInstances ; ++g) {
+            const int base = g * perInstance;
+            if (base >= chs) break;
+
+            // グループのチャンネルをデインタリーブ（足りない入力は無音）
+            for (int i = 0 ; i < layout.numInputs ; ++i) {
+                const int ch = base + i;
+                float* dst = reinterpret_cast<float*>(fin[i]);
+                if (ch < chs) {
+                    for (unsigned int k = 0 ; k < frames ; ++k) dst[k] = in[k * chs + ch];
+                }
+                else {
+                    std::fill(dst, dst + frames, 0.0f);
+                }
+            }
+
+            // 具象型で呼び出して仮想関数呼び出しを避ける
+            m_instances[g].DSP::compute(static_cast<int>(frames), fin, fout);
+
+            // インタリーブして出力（DSPの出力がないチャンネルは無音）
+            for (int o = 0 ; o < perInstance && base + o < chs ; ++o) {
+                const int ch = base + o;
+                if (o < layout.numOutputs) {
+                    const float* src = reinterpret_cast<const float*>(fout[o]);
+                    for (unsigned int k = 0 ; k < frames ; ++k) out[k * chs + ch] = src[k];
+                }
+                else {
+                    for (unsigned int k = 0 ; k < frames ; ++k) out[k * chs + ch] = 0.0f;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief floatパラメータの設定関数
+     */
+    FMOD_RESULT setParameterFloat(int index, float value) {
+        if (index < 0 || index >= GetLayout().numParams ||
+            GetLayout().descs[index].type != FMOD_DSP_PARAMETER_TYPE_FLOAT) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
+
+        // バーグラフは書き込み不可
+        return m_params.set(index, value) ? FMOD_OK : FMOD_ERR_INVALID_PARAM;
+    }
+
+    /**
+     * @brief floatパラメータの取得関数
+     */
+    FMOD_RESULT getParameterFloat(int index, float* value, char* valuestr) {
+        if (index < 0 || index >= GetLayout().numParams ||
+            GetLayout().descs[index].type != FMOD_DSP_PARAMETER_TYPE_FLOAT) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
+
+        const FaustParamBridge::ParamInfo& info = GetLayout().info[index];
+        const float v = m_params.get(index);
+        if (value) *value = v;
+        if (valuestr) {
+            // 整数刻みのパラメータは小数点以下を表示しない
+            const bool integral = info.step >= 1.0f;
+            snprintf(valuestr, 32, integral ? "%.0f %s" : "%.2f %s", v, info.unit);
+        }
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief boolパラメータの設定関数
+     */
+    FMOD_RESULT setParameterBool(int index, FMOD_BOOL value) {
+        if (index < 0 || index >= GetLayout().numParams ||
+            GetLayout().descs[index].type != FMOD_DSP_PARAMETER_TYPE_BOOL) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
+
+        return m_params.set(index, value ? 1.0f : 0.0f) ? FMOD_OK : FMOD_ERR_INVALID_PARAM;
+    }
+
+    /**
+     * @brief boolパラメータの取得関数
+     */
+    FMOD_RESULT getParameterBool(int index, FMOD_BOOL* value, char* valuestr) {
+        if (index < 0 || index >= GetLayout().numParams ||
+            GetLayout().descs[index].type != FMOD_DSP_PARAMETER_TYPE_BOOL) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
+
+        const bool on = m_params.get(index) != 0.0f;
+        if (value) *value = on;
+        if (valuestr) snprintf(valuestr, 32, "%s", on ? "On" : "Off");
+
+        return FMOD_OK;
+    }
+
+    DSP* m_instances = nullptr;    // チャンネルグループごとのDSP（1つの連続領域に確保）
+    int m_numInstances = 0;        // 確保済みのインスタンス数
+    FaustParamBridge m_params;     // パラメータの受け渡し
+    float* m_scratch = nullptr;    // 入出力のデインタリーブ用バッファ（(入力数 + 出力数) × ブロックサイズ）
+};
+
+/**
+ * @brief Faust DSPクラスをFMODプラグインとしてエクスポートする
+ * @param ID まとめたライブラリで使う識別子（ID_GetDSPDescription を定義する）
+ * @param DSP Faustが生成したDSPクラス
+ * @param NAME プラグインの名前
+ * @param VERSION プラグインのバージョン
+ * @note FMOD_PLUGIN_EXPORT と同じく、単体のライブラリでは FMODGetDSPDescription を、
+ *       FMOD_PLUGINS_COMBINED=1 では AllPlugins.cpp から参照する ID_GetDSPDescription を定義する
+ */
+# if FMOD_PLUGINS_COMBINED
+    # define FAUST_FMOD_PLUGIN(ID, DSP, NAME, VERSION) \
+        FMOD_DSP_DESCRIPTION* F_CALL ID##_GetDSPDescription() { \
+            return FaustFmodPlugin<DSP>::Description(NAME, VERSION); \
+        }
+# else
+    # define FAUST_FMOD_PLUGIN(ID, DSP, NAME, VERSION) \
+        extern "C" FMOD_EXPORT FMOD_DSP_DESCRIPTION* F_CALL FMODGetDSPDescription() { \
+            return FaustFmodPlugin<DSP>::Description(NAME, VERSION); \
+        }
+# endif
@@ -0,0 +1,321 @@
+/**
+ *  @file FaustParamBridge.h
+ *  @author Goto Kenta
+ *  @brief Faustが生成したDSPのパラメータを、APIスレッドからミキサースレッドへロックフリーで受け渡すブリッジ
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <cstdlib>
+# include <cstring>
+
+# ifndef FAUSTFLOAT
+    # define FAUSTFLOAT float
+# endif
+
+# include <faust/gui/UI.h>
+
+/**
+ * @brief Faust DSPのUI定義（buildUserInterface）からパラメータ一覧を作り、値の受け渡しを仲介するクラス
+ * @note set / get はAPIスレッド、bind / apply / publish はミキサースレッドから呼ぶ。
+ *       APIスレッドはatomicのステージング値にだけ書き込み、Faustのゾーンへの書き込みはブロック先頭の apply で行う
+ */
+class FaustParamBridge {
+public:
+    static constexpr int kMaxParams = 16;    // 扱えるパラメータ数の上限
+    static constexpr int kMaxInstances = 32; // 同時に駆動できるDSPインスタンス数の上限（FMODの最大チャンネル幅）
+    static constexpr int kLabelLength = 32;  // ラベルの最大長
+    static constexpr int kUnitLength = 16;   // 単位の最大長
+
+    /**
+     * @brief パラメータの種類
+     */
+    enum ParamKind {
+        PARAM_SLIDER = 0, // スライダー・数値入力
+        PARAM_BUTTON,     // ボタン
+        PARAM_CHECKBOX,   // チェックボックス
+        PARAM_BARGRAPH,   // バーグラフ（DSPからの出力）
+    };
+
+    /**
+     * @brief パラメータの定義情報
+     */
+    struct ParamInfo {
+        char label[kLabelLength];
+        char unit[kUnitLength];
+        ParamKind kind;
+        float init;
+        float min;
+        float max;
+        float step;
+        float smoothing; // 1ブロックあたりの1次平滑化係数（0で平滑化なし）
+    };
+
+    FaustParamBridge() = default;
+    FaustParamBridge(const FaustParamBridge&) = delete;
+    FaustParamBridge& operator=(const FaustParamBridge&) = delete;
+
+    /**
+     * @brief DSPインスタンスの配列を登録する
+     * @tparam DSP buildUserInterface を持つFaust DSPの型
+     * @param instances DSPインスタンスの配列
+     * @param count インスタンス数
+     * @note 初回の呼び出しでパラメータ一覧を作る。2回目以降はゾーンだけを取り直し、現在値を新しいインスタンスへ反映する
+     */
+    template <class DSP>
+    void bind(DSP* instances, int count) {
+        count = std::clamp(count, 0, kMaxInstances);
+        const bool describe = (m_numParams == 0);
+
+        for (int i = 0 ; i < count ; ++i) {
+            Collector collector(*this, i, describe && i == 0);
+            instances[i].buildUserInterface(&collector);
+        }
+        m_numInstances = count;
+
+        // 初回はステージング値と現在値を初期値で揃える
+        if (describe) {
+            for (int p = 0 ; p < m_numParams ; ++p) {
+                m_staged[p].store(m_info[p].init, std::memory_order_relaxed);
+                m_current[p] = m_info[p].init;
+            }
+        }
+
+        writeZones();
+    }
+
+    /**
+     * @brief パラメータ数を取得する
+     */
+    int count() const {
+        return m_numParams;
+    }
+
+    /**
+     * @brief パラメータの定義情報を取得する
+     * @param index パラメータのインデックス
+     */
+    const ParamInfo& info(int index) const {
+        return m_info[index];
+    }
+
+    /**
+     * @brief ラベルからパラメータのインデックスを探す
+     * @param label Faustのラベル
+     * @return 見つからない場合は -1
+     */
+    int indexOf(const char* label) const {
+        for (int p = 0 ; p < m_numParams ; ++p) {
+            if (std::strcmp(m_info[p].label, label) == 0)
+                return p;
+        }
+
+        return -1;
+    }
+
+    /**
+     * @brief パラメータの平滑化係数を設定する
+     * @param index パラメータのインデックス
+     * @param smoothing 1ブロックあたりの1次平滑化係数（0〜1、0で平滑化なし）
+     */
+    void setSmoothing(int index, float smoothing) {
+        if (index < 0 || index >= m_numParams)
+            return;
+
+        m_info[index].smoothing = std::clamp(smoothing, 0.0f, 0.999f);
+    }
+
+    /**
+     * @brief 目標値を設定する（APIスレッド）
+     * @param index パラメータのインデックス
+     * @param value 設定する値（範囲外はクランプする）
+     * @return インデックスが有効で、書き込み可能なパラメータの場合は true
+     */
+    bool set(int index, float value) {
+        if (index < 0 || index >= m_numParams || m_info[index].kind == PARAM_BARGRAPH)
+            return false;
+
+        value = std::clamp(value, m_info[index].min, m_info[index].max);
+        m_staged[index].store(value, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief 目標値、またはバーグラフの最新値を取得する（APIスレッド）
+     * @param index パラメータのインデックス
+     */
+    float get(int index) const {
+        if (index < 0 || index >= m_numParams)
+            return 0.0f;
+
+        return m_staged[index].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief ミキサースレッドで現在適用されている値を取得する
+     * @param index パラメータのインデックス
+     */
+    float value(int index) const {
+        if (index < 0 || index >= m_numParams)
+            return 0.0f;
+
+        return m_current[index];
+    }
+
+    /**
+     * @brief ステージング値を平滑化しながら全インスタンスのゾーンへ書き込む（ミキサースレッド、ブロック先頭）
+     */
+    void apply() {
+        for (int p = 0 ; p < m_numParams ; ++p) {
+            const ParamInfo& info = m_info[p];
+            if (info.kind == PARAM_BARGRAPH)
+                continue;
+
+            const float target = m_staged[p].load(std::memory_order_relaxed);
+            float current = target;
+
+            // ボタン類は平滑化しない
+            if (info.kind == PARAM_SLIDER && info.smoothing > 0.0f) {
+                current = target + info.smoothing * (m_current[p] - target);
+                if (std::fabs(current - target) <= (info.max - info.min) * 1e-5f)
+                    current = target;
+            }
+
+            m_current[p] = current;
+        }
+
+        writeZones();
+    }
+
+    /**
+     * @brief バーグラフの値をAPIスレッドから読めるように公開する（ミキサースレッド、ブロック末尾）
+     */
+    void publish() {
+        if (m_numInstances == 0)
+            return;
+
+        for (int p = 0 ; p < m_numParams ; ++p) {
+            if (m_info[p].kind == PARAM_BARGRAPH && m_zones[p][0]) {
+                m_staged[p].store(static_cast<float>(*m_zones[p][0]), std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief buildUserInterface からゾーンとパラメータ定義を集めるUI
+     */
+    class Collector : public UI {
+    public:
+        Collector(FaustParamBridge& bridge, int instance, bool describe)
+            : m_bridge(bridge), m_instance(instance), m_describe(describe) { }
+
+        void openTabBox(const char*) override { }
+        void openHorizontalBox(const char*) override { }
+        void openVerticalBox(const char*) override { }
+        void closeBox() override { }
+
+        void addButton(const char* label, FAUSTFLOAT* zone) override {
+            add(PARAM_BUTTON, label, zone, 0.0f, 0.0f, 1.0f, 1.0f);
+        }
+
+        void addCheckButton(const char* label, FAUSTFLOAT* zone) override {
+            add(PARAM_CHECKBOX, label, zone, 0.0f, 0.0f, 1.0f, 1.0f);
+        }
+
+        void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) override {
+            add(PARAM_SLIDER, label, zone, init, min, max, step);
+        }
+
+        void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) override {
+            add(PARAM_SLIDER, label, zone, init, min, max, step);
+        }
+
+        void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) override {
+            add(PARAM_SLIDER, label, zone, init, min, max, step);
+        }
+
+        void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) override {
+            add(PARAM_BARGRAPH, label, zone, min, min, max, 0.0f);
+        }
+
+        void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) override {
+            add(PARAM_BARGRAPH, label, zone, min, min, max, 0.0f);
+        }
+
+        void addSoundfile(const char*, const char*, Soundfile**) override { }
+
+        // [unit:dB] や [smooth:0.9] のメタデータを次のウィジェットに適用する
+        void declare(FAUSTFLOAT*, const char* key, const char* value) override {
+            if (!m_describe || !key || !value)
+                return;
+
+            if (std::strcmp(key, "unit") == 0) {
+                std::strncpy(m_pendingUnit, value, kUnitLength - 1);
+                m_pendingUnit[kUnitLength - 1] = '\0';
+            }
+            else if (std::strcmp(key, "smooth") == 0) {
+                m_pendingSmoothing = static_cast<float>(std::atof(value));
+            }
+        }
+
+    private:
+        void add(ParamKind kind, const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) {
+            if (m_next >= kMaxParams)
+                return;
+
+            if (m_describe) {
+                ParamInfo& info = m_bridge.m_info[m_next];
+                std::strncpy(info.label, label ? label : "", kLabelLength - 1);
+                info.label[kLabelLength - 1] = '\0';
+                std::memcpy(info.unit, m_pendingUnit, sizeof(info.unit));
+                info.kind = kind;
+                info.init = static_cast<float>(init);
+                info.min = static_cast<float>(min);
+                info.max = static_cast<float>(max);
+                info.step = static_cast<float>(step);
+                info.smoothing = std::clamp(m_pendingSmoothing, 0.0f, 0.999f);
+                m_bridge.m_numParams = m_next + 1;
+            }
+
+            m_bridge.m_zones[m_next][m_instance] = zone;
+            ++m_next;
+
+            m_pendingUnit[0] = '\0';
+            m_pendingSmoothing = 0.0f;
+        }
+
+        FaustParamBridge& m_bridge;
+        int m_instance;
+        bool m_describe;
+        int m_next = 0;
+        char m_pendingUnit[kUnitLength] = { };
+        float m_pendingSmoothing = 0.0f;
+    };
+
+    /**
+     * @brief 現在値を全インスタンスのゾーンへ書き込む
+     */
+    void writeZones() {
+        for (int p = 0 ; p < m_numParams ; ++p) {
+            if (m_info[p].kind == PARAM_BARGRAPH)
+                continue;
+
+            const auto v = static_cast<FAUSTFLOAT>(m_current[p]);
+            for (int i = 0 ; i < m_numInstances ; ++i) {
+                if (m_zones[p][i])
+                    *m_zones[p][i] = v;
+            }
+        }
+    }
+
+    ParamInfo m_info[kMaxParams] { };                    // パラメータ定義
+    FAUSTFLOAT* m_zones[kMaxParams][kMaxInstances] { }; // インスタンスごとのゾーン
+    std::atomic<float> m_staged[kMaxParams] { };         // APIスレッドからの目標値
+    float m_current[kMaxParams] { };                     // ミキサースレッドで適用中の値
+    int m_numParams = 0;
+    int m_numInstances = 0;
+};
@@ -0,0 +1,210 @@
+/**
+ *  @file FaustRuntimeCompiler.cpp
+ *  @author Goto Kenta
+ *  @brief libfaustによる実行時コンパイルとキャッシュの実装
+ */
+
+# include "FaustRuntimeCompiler.h"
+
+# include <cstdio>
+# include <cstdlib>
+# include <filesystem>
+# include <fstream>
+# include <random>
+# include <sstream>
+# include <vector>
+
+# include <faust/dsp/libfaust.h>
+# if FAUST_RUNTIME_BACKEND_LLVM
+    # include <faust/dsp/llvm-dsp.h>
+# else
+    # include <faust/dsp/interpreter-dsp.h>
+# endif
+
+namespace {
+    // すべての環境で同じ結果になるよう、libfaustに渡すオプションは固定する
+    const char* const s_CompileOptions[] = { "-single", "-ftz", "2" };
+    constexpr int s_NumCompileOptions = static_cast<int>(sizeof(s_CompileOptions) / sizeof(s_CompileOptions[0]));
+
+    /**
+     * @brief FNV-1a 64bitハッシュに文字列を加える
+     */
+    unsigned long long HashAppend(unsigned long long hash, const std::string& text) {
+        for (const unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+
+        // 区切りを入れて "ab" + "c" と "a" + "bc" を区別する
+        hash ^= 0xFFu;
+        hash *= 1099511628211ULL;
+        return hash;
+    }
+
+    /**
+     * @brief ファイルの中身をすべて読み込む
+     */
+    bool ReadFile(const std::string& path, std::string& text) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        text = stream.str();
+        return true;
+    }
+
+    /**
+     * @brief コンパイルターゲット（インタプリタはマシン非依存）
+     */
+    std::string CompileTarget() {
+# if FAUST_RUNTIME_BACKEND_LLVM
+        return getDSPMachineTarget();
+# else
+        return "interp";
+# endif
+    }
+
+    /**
+     * @brief 一時ファイル名の接尾辞（同じソースを同時にコンパイルする別のプロセスと重ならないようにする）
+     */
+    std::string TempSuffix() {
+        std::random_device device;
+        const unsigned long long value = (static_cast<unsigned long long>(device()) << 32) ^ device();
+        char suffix[24];
+        std::snprintf(suffix, sizeof(suffix), ".%016llx.tmp", value);
+        return suffix;
+    }
+
+    /**
+     * @brief コンパイルオプションを1つの文字列にまとめる
+     */
+    std::string JoinedOptions(const std::vector<const char*>& argv) {
+        std::string joined;
+        for (const char* arg : argv) {
+            joined += arg;
+            joined += ' ';
+        }
+        return joined;
+    }
+}
+
+std::string FaustRuntimeCompiler::CacheDirectory() {
+    if (const char* dir = std::getenv("FAUST_FMOD_CACHE_DIR")) {
+        return dir;
+    }
+
+    std::error_code ec;
+    const std::filesystem::path temp = std::filesystem::temp_directory_path(ec);
+    return ec ? std::string(".") : (temp / "FMODCustomPlugins").string();
+}
+
+unsigned long long FaustRuntimeCompiler::CacheKey(const std::string& source, const std::string& options, const std::string& target) {
+    unsigned long long hash = 14695981039346656037ULL;
+    hash = HashAppend(hash, source);
+    hash = HashAppend(hash, options);
+    hash = HashAppend(hash, target);
+    hash = HashAppend(hash, getCLibFaustVersion());
+    return hash;
+}
+
+dsp_factory* FaustRuntimeCompiler::Load(const char* name, const char* sourcePath, std::string& error) {
+    // サウンドチームが編集中のソースを指定できるようにする
+    std::string path = sourcePath ? sourcePath : "";
+    if (const char* overridePath = std::getenv("FAUST_FMOD_DSP_PATH")) {
+        path = overridePath;
+    }
+
+    std::string source;
+    if (!ReadFile(path, source)) {
+        error = "cannot read " + path;
+        return nullptr;
+    }
+
+    // import("stdfaust.lib") 以外のライブラリはソースと同じディレクトリから探す
+    const std::string sourceDir = std::filesystem::path(path).parent_path().string();
+    std::vector<const char*> argv(s_CompileOptions, s_CompileOptions + s_NumCompileOptions);
+    if (!sourceDir.empty()) {
+        argv.push_back("-I");
+        argv.push_back(sourceDir.c_str());
+    }
+
+    const int argc = static_cast<int>(argv.size());
+
+    // sourceDir から import したライブラリを編集してもキャッシュが古くならないよう、展開したソースをキーにする
+    std::string shaKey;
+    const std::string expanded = expandDSPFromString(name, source, argc, argv.data(), shaKey, error);
+    if (expanded.empty()) {
+        if (error.empty()) {
+            error = "cannot expand " + path;
+        }
+        return nullptr;
+    }
+
+    const std::string target = CompileTarget();
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", CacheKey(expanded, JoinedOptions(argv), target));
+
+    const std::filesystem::path cacheDir = CacheDirectory();
+# if FAUST_RUNTIME_BACKEND_LLVM
+    const std::filesystem::path cachePath = cacheDir / (std::string(name) + "-" + key + ".fmc");
+# else
+    const std::filesystem::path cachePath = cacheDir / (std::string(name) + "-" + key + ".fbc");
+# endif
+
+    // キャッシュがあればコンパイルせずに読み込む
+    std::error_code ec;
+    if (std::filesystem::exists(cachePath, ec)) {
+        std::string readError;
+# if FAUST_RUNTIME_BACKEND_LLVM
+        dsp_factory* cached = readDSPFactoryFromMachineFile(cachePath.string(), target, readError);
+# else
+        dsp_factory* cached = readInterpreterDSPFactoryFromBitcodeFile(cachePath.string(), readError);
+# endif
+        if (cached) {
+            return cached;
+        }
+        // 壊れたキャッシュは作り直す
+        std::filesystem::remove(cachePath, ec);
+    }
+
+# if FAUST_RUNTIME_BACKEND_LLVM
+    llvm_dsp_factory* factory = createDSPFactoryFromString(name, source, argc, argv.data(), target, error, -1);
+# else
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromString(name, source, argc, argv.data(), error);
+# endif
+    if (!factory) {
+        return nullptr;
+    }
+
+    // 一時ファイルに書いてから置き換え、他のプロセスが書きかけを読まないようにする
+    std::filesystem::create_directories(cacheDir, ec);
+    const std::filesystem::path tempPath = cachePath.string() + TempSuffix();
+# if FAUST_RUNTIME_BACKEND_LLVM
+    const bool written = writeDSPFactoryToMachineFile(factory, tempPath.string(), target);
+# else
+    const bool written = writeInterpreterDSPFactoryToBitcodeFile(factory, tempPath.string());
+# endif
+    if (written) {
+        std::filesystem::rename(tempPath, cachePath, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(tempPath, ec);
+    }
+
+    return factory;
+}
+
+void FaustRuntimeCompiler::Release(dsp_factory* factory) {
+    if (!factory) {
+        return;
+    }
+
+# if FAUST_RUNTIME_BACKEND_LLVM
+    deleteDSPFactory(static_cast<llvm_dsp_factory*>(factory));
+# else
+    deleteInterpreterDSPFactory(static_cast<interpreter_dsp_factory*>(factory));
+# endif
+}
@@ -0,0 +1,132 @@
+/**
+ *  @file FaustRuntimeCompiler.h
+ *  @author Goto Kenta
+ *  @brief libfaustで.dspソースを実行時にコンパイルし、コンパイル結果をディスクにキャッシュする
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <string>
+
+# ifndef FAUSTFLOAT
+    # define FAUSTFLOAT float
+# endif
+
+# include <faust/dsp/dsp.h>
+
+// 1ならLLVMバックエンド（ネイティブコード）、0ならインタプリタバックエンドを使う
+# ifndef FAUST_RUNTIME_BACKEND_LLVM
+    # define FAUST_RUNTIME_BACKEND_LLVM 1
+# endif
+
+/**
+ * @brief .dspソースをlibfaustでコンパイルし、ファクトリを返すクラス
+ * @note キャッシュのキーは展開したソース（import したライブラリを含む）・コンパイルオプション・ターゲット・libfaustのバージョンのハッシュ。
+ *       2回目以降の起動ではキャッシュを読み込むだけなので、JITのコストがかからない
+ */
+class FaustRuntimeCompiler {
+public:
+    /**
+     * @brief .dspソースを読み込み、キャッシュがあればそれを、なければコンパイルしたファクトリを返す
+     * @param name ファクトリの名前（キャッシュファイル名にも使う）
+     * @param sourcePath .dspファイルのパス（環境変数 FAUST_FMOD_DSP_PATH があればそちらを優先する）
+     * @param error 失敗したときのエラーメッセージ
+     * @return ファクトリ。失敗した場合は nullptr
+     */
+    static dsp_factory* Load(const char* name, const char* sourcePath, std::string& error);
+
+    /**
+     * @brief Load で作ったファクトリを破棄する
+     * @param factory 破棄するファクトリ
+     */
+    static void Release(dsp_factory* factory);
+
+    /**
+     * @brief キャッシュのキーを計算する
+     * @param source 展開した.dspソース（expandDSPFromString の結果）
+     * @param options コンパイルオプション
+     * @param target コンパイルターゲット
+     * @return 64bitハッシュ
+     */
+    static unsigned long long CacheKey(const std::string& source, const std::string& options, const std::string& target);
+
+    /**
+     * @brief キャッシュを置くディレクトリ（環境変数 FAUST_FMOD_CACHE_DIR、なければ一時ディレクトリ）
+     */
+    static std::string CacheDirectory();
+};
+
+/**
+ * @brief 実行時にコンパイルしたFaust DSPを、生成済みのクラスと同じように扱うラッパー
+ * @tparam Source static const char* Name() と static const char* Path() を持つ型
+ * @note FaustFmodPlugin<FaustRuntimeDSP<Source>> でそのままFMODプラグインになる。
+ *       コンパイルに失敗した場合は1入力1出力のパススルーとして振る舞う
+ */
+template <class Source>
+class FaustRuntimeDSP {
+public:
+    FaustRuntimeDSP() {
+        if (dsp_factory* factory = Factory()) {
+            m_dsp = factory->createDSPInstance();
+        }
+    }
+
+    ~FaustRuntimeDSP() {
+        delete m_dsp;
+    }
+
+    FaustRuntimeDSP(const FaustRuntimeDSP&) = delete;
+    FaustRuntimeDSP& operator=(const FaustRuntimeDSP&) = delete;
+
+    int getNumInputs() { return m_dsp ? m_dsp->getNumInputs() : 1; }
+    int getNumOutputs() { return m_dsp ? m_dsp->getNumOutputs() : 1; }
+
+    void buildUserInterface(UI* ui) {
+        if (m_dsp) m_dsp->buildUserInterface(ui);
+    }
+
+    void init(int sampleRate) {
+        if (m_dsp) m_dsp->init(sampleRate);
+    }
+
+    void instanceClear() {
+        if (m_dsp) m_dsp->instanceClear();
+    }
+
+    void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {
+        if (m_dsp) {
+            m_dsp->compute(count, inputs, outputs);
+        }
+        else {
+            std::copy(inputs[0], inputs[0] + count, outputs[0]);
+        }
+    }
+
+    /**
+     * @brief ソースごとのファクトリ（初回にコンパイルまたはキャッシュから読み込む）
+     */
+    static dsp_factory* Factory() {
+        static FactoryHolder holder;
+        return holder.factory;
+    }
+
+private:
+    /**
+     * @brief モジュールのアンロード時にファクトリを破棄する
+     */
+    struct FactoryHolder {
+        dsp_factory* factory = nullptr;
+        std::string error;
+
+        FactoryHolder() {
+            factory = FaustRuntimeCompiler::Load(Source::Name(), Source::Path(), error);
+        }
+
+        ~FactoryHolder() {
+            FaustRuntimeCompiler::Release(factory);
+        }
+    };
+
+    dsp* m_dsp = nullptr;
+};
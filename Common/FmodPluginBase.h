@@ -0,0 +1,446 @@
+/**
+ *  @file FmodPluginBase.h
+ *  @author Goto Kenta
+ *  @brief FMOD DSPプラグインの共通処理をまとめたCRTP基底クラス
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <cstddef>
+# include <cstring>
+# include <new>
+
+# include <fmod_common.h>
+# include <fmod_dsp.h>
+
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    # define FMOD_PLUGIN_SSE2 1
+    # include <emmintrin.h>
+# endif
+
+# ifndef FMOD_EXPORT
+    # if defined(_WIN32)
+        # define FMOD_EXPORT __declspec(dllexport)
+    # elif defined(__GNUC__) || defined(__clang__)
+        # define FMOD_EXPORT __attribute__((visibility("default")))
+    # else
+        # define FMOD_EXPORT
+    # endif
+# endif
+
+# if FMOD_PLUGIN_SSE2
+/**
+ * @brief MapSamples に渡す処理関数が受け取る4サンプル分のレーン
+ * @note float と同じ演算子を持つので、処理関数を auto 引数のラムダで1回書けばSIMDと端数の両方に使える
+ */
+struct FmodLane4 {
+    __m128 v;
+
+    FmodLane4(__m128 x) : v(x) { }
+    FmodLane4(float x) : v(_mm_set1_ps(x)) { }
+};
+
+inline FmodLane4 operator+(FmodLane4 a, FmodLane4 b) { return _mm_add_ps(a.v, b.v); }
+inline FmodLane4 operator-(FmodLane4 a, FmodLane4 b) { return _mm_sub_ps(a.v, b.v); }
+inline FmodLane4 operator*(FmodLane4 a, FmodLane4 b) { return _mm_mul_ps(a.v, b.v); }
+inline FmodLane4 operator+(FmodLane4 a, float b) { return _mm_add_ps(a.v, _mm_set1_ps(b)); }
+inline FmodLane4 operator-(FmodLane4 a, float b) { return _mm_sub_ps(a.v, _mm_set1_ps(b)); }
+inline FmodLane4 operator*(FmodLane4 a, float b) { return _mm_mul_ps(a.v, _mm_set1_ps(b)); }
+inline FmodLane4 operator*(float a, FmodLane4 b) { return _mm_mul_ps(_mm_set1_ps(a), b.v); }
+# endif
+
+/**
+ * @brief FMOD DSPプラグインの基底クラス
+ * @tparam Derived 派生クラス（プラグイン本体）
+ * @note 派生クラスは次のものを用意する（基底から呼べるよう friend class FmodPluginBase<Derived> を宣言する）。
+ *       - static constexpr const char* kName / static constexpr unsigned int kVersion
+ *       - static FMOD_DSP_PARAMETER_DESC** ParameterDescs(int& count)
+ *       - void processBlock(const float* in, float* out, unsigned int frames, int chs)  （インタリーブ、frames はブロックサイズ以下）
+ *       必要に応じて onCreate / onRelease / onReset / onChannels / onProcessStart / onProcessEnd / tailLength / onTailEnd と
+ *       setParameterFloat などのパラメータ関数を同じ名前で定義すると、基底の既定の実装の代わりに呼ばれる。
+ *       インスタンスはFMODのallocで確保した領域にplacement newで作られる
+ */
+template <class Derived>
+class FmodPluginBase {
+public:
+    /**
+     * @brief FMODに渡すプラグインの説明構造体を取得する
+     */
+    static FMOD_DSP_DESCRIPTION* Description() {
+        static FMOD_DSP_DESCRIPTION desc = BuildDescription();
+        return &desc;
+    }
+
+protected:
+    FmodPluginBase() = default;
+    FmodPluginBase(const FmodPluginBase&) = delete;
+    FmodPluginBase& operator=(const FmodPluginBase&) = delete;
+
+    /* 派生クラスで上書きできる処理（既定の実装） */
+    FMOD_RESULT onCreate() { return FMOD_OK; }
+    void onRelease() { }
+    FMOD_RESULT onReset() { return FMOD_OK; }
+    FMOD_RESULT onChannels(int /*chs*/) { return FMOD_OK; }
+    void onProcessStart() { }
+    void onProcessEnd() { }
+    unsigned int tailLength() const { return 0; }
+    void onTailEnd() { }
+
+    FMOD_RESULT setParameterFloat(int, float) { return FMOD_ERR_INVALID_PARAM; }
+    FMOD_RESULT getParameterFloat(int, float*, char*) { return FMOD_ERR_INVALID_PARAM; }
+    FMOD_RESULT setParameterInt(int, int) { return FMOD_ERR_INVALID_PARAM; }
+    FMOD_RESULT getParameterInt(int, int*, char*) { return FMOD_ERR_INVALID_PARAM; }
+    FMOD_RESULT setParameterBool(int, FMOD_BOOL) { return FMOD_ERR_INVALID_PARAM; }
+    FMOD_RESULT getParameterBool(int, FMOD_BOOL*, char*) { return FMOD_ERR_INVALID_PARAM; }
+
+    /**
+     * @brief FMODのアロケータでメモリを確保する
+     * @param bytes バイト数
+     * @return 確保した領域。失敗した場合は nullptr
+     */
+    void* allocate(size_t bytes) {
+        return m_dspState->functions->alloc(static_cast<unsigned int>(bytes), FMOD_MEMORY_NORMAL, __FILE__);
+    }
+
+    /**
+     * @brief 0で初期化したfloat配列をFMODのアロケータで確保する
+     * @param count 要素数
+     */
+    float* allocateFloats(size_t count) {
+        auto* p = static_cast<float*>(allocate(sizeof(float) * count));
+        if (p) std::fill(p, p + count, 0.0f);
+        return p;
+    }
+
+    /**
+     * @brief allocate で確保したメモリを解放する（nullptr は無視する）
+     */
+    void deallocate(void* p) {
+        if (p) m_dspState->functions->free(p, FMOD_MEMORY_NORMAL, __FILE__);
+    }
+
+    FMOD_DSP_STATE* dspState() const { return m_dspState; }
+    int sampleRate() const { return m_sampleRate; }
+    unsigned int blockSize() const { return m_blockSize; }
+    int mixerChannels() const { return m_mixerChannels; }
+
+    /**
+     * @brief スピーカーモードからチャンネル数を求める
+     * @param speakerMode スピーカーモード
+     * @return チャンネル数（不明な場合はステレオとみなす）
+     */
+    static int ChannelCountFromSpeakerMode(FMOD_SPEAKERMODE speakerMode) {
+        switch (speakerMode) {
+            case FMOD_SPEAKERMODE_MONO:          return 1;
+            case FMOD_SPEAKERMODE_STEREO:        return 2;
+            case FMOD_SPEAKERMODE_QUAD:          return 4;
+            case FMOD_SPEAKERMODE_SURROUND:      return 5;
+            case FMOD_SPEAKERMODE_5POINT1:       return 6;
+            case FMOD_SPEAKERMODE_7POINT1:       return 8;
+            case FMOD_SPEAKERMODE_7POINT1POINT4: return 12;
+            default:                             return 2;
+        }
+    }
+
+    /**
+     * @brief サンプルごとの処理を4サンプル単位（SSE2）と端数に分けて回す
+     * @param in 入力
+     * @param out 出力（in と同じでもよい）
+     * @param count サンプル数（インタリーブなら フレーム数 × チャンネル数）
+     * @param f auto 引数で書いた処理関数 x -> y
+     */
+    template <class F>
+    static void MapSamples(const float* in, float* out, size_t count, F&& f) {
+        size_t i = 0;
+# if FMOD_PLUGIN_SSE2
+        for ( ; i + 4 <= count ; i += 4) {
+            const FmodLane4 y = f(FmodLane4(_mm_loadu_ps(in + i)));
+            _mm_storeu_ps(out + i, y.v);
+        }
+# endif
+        for ( ; i < count ; ++i) {
+            out[i] = f(in[i]);
+        }
+    }
+
+    /**
+     * @brief 2つの入力を取るサンプルごとの処理を4サンプル単位と端数に分けて回す
+     * @param a 入力1
+     * @param b 入力2
+     * @param out 出力（a や b と同じでもよい）
+     * @param count サンプル数
+     * @param f auto 引数で書いた処理関数 (x, y) -> z
+     */
+    template <class F>
+    static void MapSamples2(const float* a, const float* b, float* out, size_t count, F&& f) {
+        size_t i = 0;
+# if FMOD_PLUGIN_SSE2
+        for ( ; i + 4 <= count ; i += 4) {
+            const FmodLane4 y = f(FmodLane4(_mm_loadu_ps(a + i)), FmodLane4(_mm_loadu_ps(b + i)));
+            _mm_storeu_ps(out + i, y.v);
+        }
+# endif
+        for ( ; i < count ; ++i) {
+            out[i] = f(a[i], b[i]);
+        }
+    }
+
+private:
+    /**
+     * @brief 派生クラスの情報から説明構造体を作る
+     */
+    static FMOD_DSP_DESCRIPTION BuildDescription() {
+        FMOD_DSP_DESCRIPTION desc { };
+        int numParams = 0;
+        FMOD_DSP_PARAMETER_DESC** params = Derived::ParameterDescs(numParams);
+
+        desc.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+        std::strncpy(desc.name, Derived::kName, sizeof(desc.name) - 1);
+        desc.version = Derived::kVersion;
+        desc.numinputbuffers = 1;
+        desc.numoutputbuffers = 1;
+        desc.create = Plugin_Create;
+        desc.release = Plugin_Release;
+        desc.reset = Plugin_Reset;
+        desc.process = Plugin_Process;
+        desc.numparameters = numParams;
+        desc.paramdesc = params;
+        desc.setparameterfloat = Plugin_SetParameterFloat;
+        desc.setparameterint = Plugin_SetParameterInt;
+        desc.setparameterbool = Plugin_SetParameterBool;
+        desc.getparameterfloat = Plugin_GetParameterFloat;
+        desc.getparameterint = Plugin_GetParameterInt;
+        desc.getparameterbool = Plugin_GetParameterBool;
+        return desc;
+    }
+
+    /**
+     * @brief dsp_state からプラグインのインスタンスを取り出す
+     * @note APIスレッドとミキサースレッドの両方から呼ばれるので読むだけにする（m_dspState は Plugin_Create で設定済み）
+     */
+    static Derived* From(FMOD_DSP_STATE* dsp_state) {
+        return static_cast<Derived*>(dsp_state->plugindata);
+    }
+
+    /**
+     * @brief プラグインの作成関数
+     */
+    static FMOD_RESULT F_CALL Plugin_Create(FMOD_DSP_STATE* dsp_state) {
+        if (!dsp_state->functions || !dsp_state->functions->alloc || !dsp_state->functions->free) {
+            return FMOD_ERR_INTERNAL;
+        }
+
+        // FMODのアロケータで確保した領域にインスタンスを作る
+        void* mem = dsp_state->functions->alloc(sizeof(Derived), FMOD_MEMORY_NORMAL, __FILE__);
+        if (mem == nullptr) {
+            return FMOD_ERR_MEMORY;
+        }
+        auto* self = new(mem) Derived();
+        dsp_state->plugindata = self;
+        self->m_dspState = dsp_state;
+
+        // サンプルレート、ブロックサイズ、ミキサーのチャンネル数を取得
+        if (dsp_state->functions->getsamplerate) {
+            dsp_state->functions->getsamplerate(dsp_state, &self->m_sampleRate);
+        }
+        if (self->m_sampleRate <= 0) {
+            self->m_sampleRate = 48000;
+        }
+        if (dsp_state->functions->getblocksize) {
+            dsp_state->functions->getblocksize(dsp_state, &self->m_blockSize);
+        }
+        if (self->m_blockSize == 0) {
+            self->m_blockSize = 1024;
+        }
+        if (dsp_state->functions->getspeakermode) {
+            FMOD_SPEAKERMODE mixerMode = FMOD_SPEAKERMODE_STEREO;
+            FMOD_SPEAKERMODE outputMode = FMOD_SPEAKERMODE_STEREO;
+            dsp_state->functions->getspeakermode(dsp_state, &mixerMode, &outputMode);
+            self->m_mixerChannels = ChannelCountFromSpeakerMode(mixerMode);
+        }
+
+        const FMOD_RESULT result = self->onCreate();
+        if (result != FMOD_OK) {
+            Plugin_Release(dsp_state);
+            return result;
+        }
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief プラグインの解放関数
+     */
+    static FMOD_RESULT F_CALL Plugin_Release(FMOD_DSP_STATE* dsp_state) {
+        if (!dsp_state->functions || !dsp_state->functions->free) {
+            return FMOD_ERR_INTERNAL;
+        }
+
+        if (Derived* self = From(dsp_state)) {
+            self->onRelease();
+            self->~Derived();
+            dsp_state->functions->free(self, FMOD_MEMORY_NORMAL, __FILE__);
+        }
+        dsp_state->plugindata = nullptr;
+
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief プラグインのリセット関数
+     */
+    static FMOD_RESULT F_CALL Plugin_Reset(FMOD_DSP_STATE* dsp_state) {
+        Derived* self = From(dsp_state);
+        if (!self) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
+
+        self->m_tailRemaining = 0;
+        return self->onReset();
+    }
+
+    /**
+     * @brief プラグインのプロセス関数
+     * @note QUERYでは入出力フォーマットをミラーし、入力が止まって残りの音も出し切ったら DONTPROCESS を返してFMODに処理を飛ばしてもらう。
+     *       PERFORMではバッファをブロックサイズ以下に分けて processBlock を呼び、残りの音を出している間は無音を入力として処理する
+     */
+    static FMOD_RESULT F_CALL Plugin_Process(FMOD_DSP_STATE* dsp_state, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inBuffers, FMOD_DSP_BUFFER_ARRAY* outBuffers, FMOD_BOOL inputsIdle, FMOD_DSP_PROCESS_OPERATION op) {
+        Derived* self = From(dsp_state);
+
+        if (op == FMOD_DSP_PROCESS_QUERY) {
+            if (inBuffers && outBuffers) {
+                const int nb = std::min(inBuffers->numbuffers, outBuffers->numbuffers);
+                for (int i = 0 ; i < nb ; ++i) {
+                    outBuffers->buffernumchannels[i] = inBuffers->buffernumchannels[i];
+                    outBuffers->bufferchannelmask[i] = inBuffers->bufferchannelmask[i];
+                }
+                outBuffers->speakermode = inBuffers->speakermode;
+            }
+
+            if (inputsIdle && (!self || self->m_tailRemaining == 0)) {
+                return FMOD_ERR_DSP_DONTPROCESS;
+            }
+            return FMOD_OK;
+        }
+
+        if (!self || !inBuffers || !outBuffers ||
+            inBuffers->numbuffers == 0 || !inBuffers->buffers ||
+            outBuffers->numbuffers == 0 || !outBuffers->buffers) {
+            return FMOD_ERR_DSP_DONTPROCESS;
+        }
+
+        // 入力が止まり、残りの音もない場合は無音を報告する
+        if (inputsIdle && self->m_tailRemaining == 0) {
+            for (int b = 0 ; b < outBuffers->numbuffers ; ++b) {
+                const size_t samples = static_cast<size_t>(length) * outBuffers->buffernumchannels[b];
+                std::fill(outBuffers->buffers[b], outBuffers->buffers[b] + samples, 0.0f);
+            }
+            return FMOD_ERR_DSP_SILENCE;
+        }
+
+        self->onProcessStart();
+
+        const int nb = std::min(inBuffers->numbuffers, outBuffers->numbuffers);
+        for (int b = 0 ; b < nb ; ++b) {
+            const int chs = std::min(inBuffers->buffernumchannels[b], outBuffers->buffernumchannels[b]);
+            const float* in = inBuffers->buffers[b];
+            float* out = outBuffers->buffers[b];
+            if (!in || !out || chs <= 0) continue;
+
+            // チャンネル数に合わせて派生クラスの状態を用意する
+            const FMOD_RESULT result = self->onChannels(chs);
+            if (result != FMOD_OK) {
+                // onProcessStart と必ず対にする
+                self->onProcessEnd();
+                return result;
+            }
+
+            // 残りの音を出している間は、無音を入力としてその場で処理する
+            if (inputsIdle) {
+                std::fill(out, out + static_cast<size_t>(length) * chs, 0.0f);
+                in = out;
+            }
+
+            for (unsigned int offset = 0 ; offset < length ; offset += self->m_blockSize) {
+                const unsigned int frames = std::min(length - offset, self->m_blockSize);
+                const size_t base = static_cast<size_t>(offset) * chs;
+                self->processBlock(in + base, out + base, frames, chs);
+            }
+        }
+
+        self->onProcessEnd();
+
+        // 入力がある間は残りの長さを満たし、止まってからは減らしていく
+        if (!inputsIdle) {
+            self->m_tailRemaining = self->tailLength();
+        }
+        else {
+            self->m_tailRemaining -= std::min(self->m_tailRemaining, length);
+            if (self->m_tailRemaining == 0) {
+                self->onTailEnd();
+            }
+        }
+
+        return FMOD_OK;
+    }
+
+    static FMOD_RESULT F_CALL Plugin_SetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float value) {
+        Derived* self = From(dsp_state);
+        return self ? self->setParameterFloat(index, value) : FMOD_ERR_INVALID_PARAM;
+    }
+
+    static FMOD_RESULT F_CALL Plugin_GetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float* value, char* valuestr) {
+        Derived* self = From(dsp_state);
+        return self ? self->getParameterFloat(index, value, valuestr) : FMOD_ERR_INVALID_PARAM;
+    }
+
+    static FMOD_RESULT F_CALL Plugin_SetParameterInt(FMOD_DSP_STATE* dsp_state, int index, int value) {
+        Derived* self = From(dsp_state);
+        return self ? self->setParameterInt(index, value) : FMOD_ERR_INVALID_PARAM;
+    }
+
+    static FMOD_RESULT F_CALL Plugin_GetParameterInt(FMOD_DSP_STATE* dsp_state, int index, int* value, char* valuestr) {
+        Derived* self = From(dsp_state);
+        return self ? self->getParameterInt(index, value, valuestr) : FMOD_ERR_INVALID_PARAM;
+    }
+
+    static FMOD_RESULT F_CALL Plugin_SetParameterBool(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL value) {
+        Derived* self = From(dsp_state);
+        return self ? self->setParameterBool(index, value) : FMOD_ERR_INVALID_PARAM;
+    }
+
+    static FMOD_RESULT F_CALL Plugin_GetParameterBool(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL* value, char* valuestr) {
+        Derived* self = From(dsp_state);
+        return self ? self->getParameterBool(index, value, valuestr) : FMOD_ERR_INVALID_PARAM;
+    }
+
+    FMOD_DSP_STATE* m_dspState = nullptr;
+    int m_sampleRate = 48000;
+    unsigned int m_blockSize = 1024;
+    int m_mixerChannels = 2;
+    unsigned int m_tailRemaining = 0; // 入力が止まってから、まだ音が残っているサンプル数
+};
+
+// 1にすると全エフェクトを1つのライブラリにまとめ、FMODGetPluginDescriptionList でまとめて公開する
+# ifndef FMOD_PLUGINS_COMBINED
+    # define FMOD_PLUGINS_COMBINED 0
+# endif
+
+/**
+ * @brief FmodPluginBase を継承したプラグインをFMODにエクスポートする
+ * @param PLUGIN プラグインのクラス
+ * @note 単体のライブラリでは FMODGetDSPDescription を、まとめたライブラリでは
+ *       AllPlugins.cpp から参照する PLUGIN_GetDSPDescription を定義する
+ */
+# if FMOD_PLUGINS_COMBINED
+    # define FMOD_PLUGIN_EXPORT(PLUGIN) \
+        FMOD_DSP_DESCRIPTION* F_CALL PLUGIN##_GetDSPDescription() { \
+            return PLUGIN::Description(); \
+        }
+# else
+    # define FMOD_PLUGIN_EXPORT(PLUGIN) \
+        extern "C" FMOD_EXPORT FMOD_DSP_DESCRIPTION* F_CALL FMODGetDSPDescription() { \
+            return PLUGIN::Description(); \
+        }
+# endif
@@ -0,0 +1,107 @@
+/**
+ *  @file IRCache.h
+ *  @author Goto Kenta
+ *  @brief 生成したインパルス応答をプラグインのインスタンス間で共有するキャッシュ
+ */
+
+# pragma once
+
+# include <cstddef>
+# include <cstdint>
+# include <list>
+# include <memory>
+# include <mutex>
+# include <utility>
+# include <vector>
+
+/**
+ * @brief 生成条件のハッシュをキーにしてIRを保持するLRUキャッシュ
+ * @note 同じ目標パラメータのリバーブを複数置いたとき、2つ目以降は生成を待たずに同じIRを使える。
+ *       IRは読み取り専用の shared_ptr で渡すので、追い出されても使用中のインスタンスには影響しない
+ */
+class IRCache {
+public:
+    using IR = std::shared_ptr<const std::vector<float>>;
+
+    static constexpr size_t kDefaultCapacity = 16; // 保持するIRの数
+
+    /**
+     * @brief モジュール全体で共有するキャッシュを取得する
+     */
+    static IRCache& Shared() {
+        static IRCache cache(kDefaultCapacity);
+        return cache;
+    }
+
+    /**
+     * @param capacity 保持するIRの数
+     */
+    explicit IRCache(size_t capacity) : m_capacity(capacity) { }
+
+    /**
+     * @brief IRを探す
+     * @param key 生成条件のハッシュ
+     * @return 見つかったIR。なければ nullptr
+     */
+    IR Find(uint64_t key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_entries.begin() ; it != m_entries.end() ; ++it) {
+            if (it->first == key) {
+                // 最近使ったものを先頭に移す
+                m_entries.splice(m_entries.begin(), m_entries, it);
+                return m_entries.front().second;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief IRを登録する（同じキーがあれば置き換える）
+     * @param key 生成条件のハッシュ
+     * @param samples IRのサンプル列
+     * @return 登録したIR
+     */
+    IR Insert(uint64_t key, std::vector<float> samples) {
+        IR ir = std::make_shared<const std::vector<float>>(std::move(samples));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.remove_if([key](const Entry& entry) { return entry.first == key; });
+        m_entries.emplace_front(key, ir);
+        while (m_entries.size() > m_capacity) {
+            m_entries.pop_back();
+        }
+        return ir;
+    }
+
+    /**
+     * @brief すべてのIRを破棄する
+     */
+    void Clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+
+    /**
+     * @brief FNV-1a 64bitでハッシュに値を加える（キーを作るための補助関数）
+     * @param hash これまでのハッシュ（最初は kHashSeed）
+     * @param data 値の先頭
+     * @param bytes 値のバイト数
+     */
+    static uint64_t HashAppend(uint64_t hash, const void* data, size_t bytes) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0 ; i < bytes ; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static constexpr uint64_t kHashSeed = 14695981039346656037ULL;
+
+private:
+    using Entry = std::pair<uint64_t, IR>;
+
+    const size_t m_capacity;
+    std::mutex m_mutex;
+    std::list<Entry> m_entries; // 先頭ほど最近使ったもの
+};
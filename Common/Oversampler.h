@@ -0,0 +1,539 @@
+/**
+ *  @file Oversampler.h
+ *  @author Goto Kenta
+ *  @brief 非線形エフェクトの処理ループを包むための、多段ハーフバンドフィルタによるオーバーサンプラー
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <cmath>
+# include <cstddef>
+# include <cstring>
+
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    # define OVERSAMPLER_SSE2 1
+    # include <emmintrin.h>
+# endif
+
+/**
+ * @brief ハーフバンドフィルタの位相特性
+ */
+enum OversamplerPhase {
+    OVERSAMPLER_LINEAR_PHASE = 0, // 対称FIR（位相歪みなし、レイテンシ大）
+    OVERSAMPLER_MINIMUM_PHASE,    // オールパスを並べたIIR（レイテンシ小、低域以外は位相が回る）
+};
+
+/**
+ * @brief 2倍ごとのハーフバンドフィルタを最大3段重ねて、2x / 4x / 8x のオーバーサンプリングを行うクラス
+ * @note メモリは確保しない。MemorySize で必要な大きさを求め、呼び出し側（FMODのalloc）で確保した領域を Init に渡す。
+ *       インタリーブのまま処理し、FIRはタップ方向、IIRはチャンネル方向にSIMD化している
+ */
+class Oversampler {
+public:
+    static constexpr int kMaxStages = 3;     // 8xまで
+    static constexpr int kMaxFirTaps = 32;   // 1段あたりの非ゼロタップ数の上限（中央タップを除く）
+    static constexpr int kMaxIirCoeffs = 12; // 1段あたりのオールパス係数の上限
+
+    /**
+     * @brief 必要なメモリの大きさを求める
+     * @param factor オーバーサンプリング倍率（1, 2, 4, 8）
+     * @param channels チャンネル数
+     * @param maxFrames 1回に処理する最大フレーム数（元のレート）
+     * @return バイト数
+     */
+    static size_t MemorySize(int factor, int channels, unsigned int maxFrames) {
+        const int stages = StageCount(factor);
+        if (stages == 0) {
+            return 0;
+        }
+
+        // ピンポン用の2本のバッファと、各段のフィルタ状態
+        const size_t buffer = static_cast<size_t>(maxFrames) * static_cast<size_t>(factor) * static_cast<size_t>(channels);
+        return sizeof(float) * (2 * buffer + static_cast<size_t>(stages) * StageStateFloats(channels));
+    }
+
+    /**
+     * @brief 倍率と位相特性を決めて、確保済みの領域を割り当てる
+     * @param factor オーバーサンプリング倍率（1, 2, 4, 8）
+     * @param phase 位相特性
+     * @param channels チャンネル数
+     * @param maxFrames 1回に処理する最大フレーム数（元のレート）
+     * @param memory MemorySize 以上の大きさの領域（倍率1の場合は nullptr でよい）
+     */
+    void Init(int factor, OversamplerPhase phase, int channels, unsigned int maxFrames, void* memory) {
+        m_stages = StageCount(factor);
+        m_factor = 1 << m_stages;
+        m_phase = phase;
+        m_channels = channels;
+        m_maxFrames = maxFrames;
+        m_latency = 0.0f;
+
+        if (m_stages == 0 || memory == nullptr) {
+            m_stages = 0;
+            m_factor = 1;
+            return;
+        }
+
+        auto* floats = static_cast<float*>(memory);
+        const size_t buffer = static_cast<size_t>(maxFrames) * static_cast<size_t>(m_factor) * static_cast<size_t>(channels);
+        m_buffers[0] = floats;
+        m_buffers[1] = floats + buffer;
+
+        float* state = floats + 2 * buffer;
+        for (int s = 0 ; s < m_stages ; ++s) {
+            Stage& stage = m_stageData[s];
+            stage.state = state;
+            state += StageStateFloats(channels);
+
+            // 段が進むほど遷移帯域に余裕があるので、フィルタを短くする
+            if (phase == OVERSAMPLER_LINEAR_PHASE) {
+                DesignFir(stage, s);
+
+                // 中央タップの遅延は各段のレートで c サンプル、元のレートでは c / 2^s サンプル（アップとダウンの合計）
+                m_latency += static_cast<float>(stage.firTaps - 1) / static_cast<float>(1 << s);
+            }
+            else {
+                DesignIir(stage, s);
+                m_latency += IirGroupDelay(stage) / static_cast<float>(1 << s);
+            }
+        }
+
+        Reset();
+    }
+
+    /**
+     * @brief フィルタの状態をクリアする
+     */
+    void Reset() {
+        for (int s = 0 ; s < m_stages ; ++s) {
+            std::fill(m_stageData[s].state, m_stageData[s].state + StageStateFloats(m_channels), 0.0f);
+            m_stageData[s].firPosUp = 0;
+            m_stageData[s].firPosDown = 0;
+        }
+    }
+
+    /**
+     * @brief オーバーサンプリング倍率
+     */
+    int Factor() const {
+        return m_factor;
+    }
+
+    /**
+     * @brief アップサンプルからダウンサンプルまでのレイテンシ（元のレートのサンプル数）
+     * @note 最小位相の場合は低域での群遅延
+     */
+    float Latency() const {
+        return m_latency;
+    }
+
+    /**
+     * @brief インタリーブバッファを倍率分アップサンプルする
+     * @param in 元のレートの入力（frames × channels）
+     * @param frames フレーム数（maxFrames 以下）
+     * @return 内部バッファへのポインタ（frames × Factor() × channels）
+     */
+    float* Upsample(const float* in, unsigned int frames) {
+        if (m_stages == 0) {
+            return nullptr;
+        }
+
+        const float* src = in;
+        unsigned int n = frames;
+        for (int s = 0 ; s < m_stages ; ++s) {
+            float* dst = m_buffers[s & 1];
+            if (m_phase == OVERSAMPLER_LINEAR_PHASE) {
+                UpsampleFir(m_stageData[s], src, dst, n);
+            }
+            else {
+                UpsampleIir(m_stageData[s], src, dst, n);
+            }
+            src = dst;
+            n *= 2;
+        }
+
+        return m_buffers[(m_stages - 1) & 1];
+    }
+
+    /**
+     * @brief Upsample が返したバッファを元のレートに戻す
+     * @param out 元のレートの出力（frames × channels）
+     * @param frames フレーム数（Upsample に渡したものと同じ）
+     */
+    void Downsample(float* out, unsigned int frames) {
+        if (m_stages == 0) {
+            return;
+        }
+
+        unsigned int n = frames << m_stages;
+        for (int s = m_stages - 1 ; s >= 0 ; --s) {
+            const float* src = m_buffers[s & 1];
+            float* dst = (s == 0) ? out : m_buffers[(s - 1) & 1];
+            if (m_phase == OVERSAMPLER_LINEAR_PHASE) {
+                DownsampleFir(m_stageData[s], src, dst, n);
+            }
+            else {
+                DownsampleIir(m_stageData[s], src, dst, n);
+            }
+            n /= 2;
+        }
+    }
+
+    /**
+     * @brief 高いレートで処理関数を呼び出し、元のレートに戻す
+     * @param in 元のレートの入力
+     * @param out 元のレートの出力（in と同じでもよい）
+     * @param frames フレーム数（maxFrames を超える場合は分割する）
+     * @param process void(float* buffer, unsigned int frames) の処理関数。高いレートのインタリーブバッファをその場で書き換える
+     */
+    template <class Fn>
+    void Process(const float* in, float* out, unsigned int frames, Fn&& process) {
+        if (m_stages == 0) {
+            if (in != out) {
+                std::copy(in, in + static_cast<size_t>(frames) * m_channels, out);
+            }
+            process(out, frames);
+            return;
+        }
+
+        for (unsigned int offset = 0 ; offset < frames ; offset += m_maxFrames) {
+            const unsigned int count = std::min(frames - offset, m_maxFrames);
+            float* up = Upsample(in + static_cast<size_t>(offset) * m_channels, count);
+            process(up, count * static_cast<unsigned int>(m_factor));
+            Downsample(out + static_cast<size_t>(offset) * m_channels, count);
+        }
+    }
+
+private:
+    /**
+     * @brief 1段分のフィルタ係数と状態
+     * @note FIRの状態はチャンネルごとに [アップ入力 | ダウン偶数 | ダウン奇数] をそれぞれ2周分持つリングバッファ、
+     *       IIRの状態は [アップx | アップy | ダウンx | ダウンy] を係数ごと・チャンネルごとに並べる
+     */
+    struct Stage {
+        float fir[kMaxFirTaps];             // 中央以外の非ゼロタップ g[j] = h[2j]
+        int firTaps;                        // 非ゼロタップ数 K = 2M + 2
+        int firCenter;                      // 中央タップの位置 M（低いレートでの遅延）
+        int firPosUp;                       // アップ側リングバッファの書き込み位置
+        int firPosDown;                     // ダウン側リングバッファの書き込み位置
+        float iir[kMaxIirCoeffs];           // オールパス係数（偶数番目が経路0、奇数番目が経路1）
+        int iirCoeffs;
+        float* state;
+    };
+
+    static int StageCount(int factor) {
+        if (factor >= 8) return 3;
+        if (factor >= 4) return 2;
+        if (factor >= 2) return 1;
+        return 0;
+    }
+
+    static size_t StageStateFloats(int channels) {
+        const size_t fir = static_cast<size_t>(channels) * 6 * kMaxFirTaps;
+        const size_t iir = static_cast<size_t>(channels) * 4 * kMaxIirCoeffs;
+        return std::max(fir, iir);
+    }
+
+    /**
+     * @brief カイザー窓で設計したハーフバンドFIR（タップ数 4M + 3、中央は 2M + 1）
+     */
+    static void DesignFir(Stage& stage, int index) {
+        // 3段目は M = 3 だと 0.4 fs のイメージが約60dBしか落ちないので、1段目の遷移帯域で決まる約83dBにそろえる
+        static const int s_HalfOrders[kMaxStages] = { 15, 7, 4 };
+        const int m = s_HalfOrders[index];
+        const int center = 2 * m + 1;
+        const double beta = 10.06; // 約100dBの阻止域減衰
+
+        const auto bessel0 = [](double x) {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1 ; k < 32 ; ++k) {
+                term *= (x * 0.5 / k) * (x * 0.5 / k);
+                sum += term;
+            }
+            return sum;
+        };
+
+        // 偶数番目のタップ h[2j] だけが非ゼロ（中央の h[center] = 0.5 は遅延として扱う）
+        stage.firTaps = 2 * m + 2;
+        stage.firCenter = m;
+        double sum = 0.0;
+        for (int j = 0 ; j < stage.firTaps ; ++j) {
+            const int k = 2 * j;
+            const double t = static_cast<double>(k - center);
+            const double r = static_cast<double>(k - center) / static_cast<double>(center);
+            const double window = bessel0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel0(beta);
+            const double h = std::sin(3.14159265358979323846 * t * 0.5) / (3.14159265358979323846 * t) * window;
+            stage.fir[j] = static_cast<float>(h);
+            sum += h;
+        }
+
+        // 偶数タップの和を0.5に揃えて、直流のゲインをちょうど1にする
+        for (int j = 0 ; j < stage.firTaps ; ++j) {
+            stage.fir[j] = static_cast<float>(stage.fir[j] * (0.5 / sum));
+        }
+        for (int j = stage.firTaps ; j < kMaxFirTaps ; ++j) {
+            stage.fir[j] = 0.0f;
+        }
+    }
+
+    /**
+     * @brief 楕円関数による多相オールパスハーフバンドIIRの係数（Valenzuela & Constantinides）
+     */
+    static void DesignIir(Stage& stage, int index) {
+        static const int s_Coeffs[kMaxStages] = { 12, 6, 4 };
+        static const double s_Transitions[kMaxStages] = { 0.02, 0.1, 0.2 };
+        const int count = s_Coeffs[index];
+        const double pi = 3.14159265358979323846;
+
+        double k = std::tan((1.0 - s_Transitions[index] * 2.0) * pi / 4.0);
+        k *= k;
+        const double kksqrt = std::pow(1.0 - k * k, 0.25);
+        const double e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+        const double e4 = e * e * e * e;
+        const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+        const int order = count * 2 + 1;
+        for (int i = 0 ; i < count ; ++i) {
+            const int c = i + 1;
+
+            double num = 0.0;
+            double sign = 1.0;
+            for (int n = 0 ; n < 64 ; ++n) {
+                const double term = std::pow(q, n * (n + 1)) * std::sin((n * 2 + 1) * c * pi / order) * sign;
+                num += term;
+                sign = -sign;
+                if (std::fabs(term) < 1e-100) break;
+            }
+            num *= std::pow(q, 0.25);
+
+            double den = 0.0;
+            sign = -1.0;
+            for (int n = 1 ; n < 64 ; ++n) {
+                const double term = std::pow(q, n * n) * std::cos(n * 2 * c * pi / order) * sign;
+                den += term;
+                sign = -sign;
+                if (std::fabs(term) < 1e-100) break;
+            }
+            den += 0.5;
+
+            const double ww = num / den;
+            const double wwsq = ww * ww;
+            const double x = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+            stage.iir[i] = static_cast<float>((1.0 - x) / (1.0 + x));
+        }
+        stage.iirCoeffs = count;
+    }
+
+    /**
+     * @brief IIR段の直流付近の群遅延（その段の入力側、低いレートのサンプル数。アップとダウンの合計）
+     */
+    static float IirGroupDelay(const Stage& stage) {
+        // 1次オールパス (a + z^-1) / (1 + a z^-1) の直流での群遅延は (1 - a) / (1 + a)
+        double path0 = 0.0, path1 = 0.0;
+        for (int i = 0 ; i < stage.iirCoeffs ; ++i) {
+            const double a = stage.iir[i];
+            ((i & 1) ? path1 : path0) += (1.0 - a) / (1.0 + a);
+        }
+
+        // アップでは経路1が高いレートで1サンプル遅れ、ダウンでは経路0に新しい方のサンプルを通して1サンプル取り戻す。
+        // 往復では両経路の平均の2倍、つまり path0 + path1 になる
+        return static_cast<float>(path0 + path1);
+    }
+
+    /**
+     * @brief 連続したK個の値と係数の内積
+     */
+    static float Dot(const float* x, const float* g, int taps) {
+        int j = 0;
+        float sum = 0.0f;
+# if OVERSAMPLER_SSE2
+        __m128 acc = _mm_setzero_ps();
+        for ( ; j + 4 <= taps ; j += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + j), _mm_loadu_ps(g + j)));
+        }
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        sum = _mm_cvtss_f32(acc);
+# endif
+        for ( ; j < taps ; ++j) {
+            sum += x[j] * g[j];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief FIRハーフバンドで2倍にする（偶数番目はFIR、奇数番目は中央タップの遅延）
+     */
+    void UpsampleFir(Stage& stage, const float* in, float* out, unsigned int frames) const {
+        const int taps = stage.firTaps;
+        const int chs = m_channels;
+        int pos = stage.firPosUp;
+
+        for (unsigned int n = 0 ; n < frames ; ++n) {
+            pos = (pos == 0) ? taps - 1 : pos - 1;
+            const float* frame = in + static_cast<size_t>(n) * chs;
+            float* outEven = out + static_cast<size_t>(2 * n) * chs;
+            float* outOdd = outEven + chs;
+
+            for (int ch = 0 ; ch < chs ; ++ch) {
+                // hist[pos + j] = x[n - j]
+                float* hist = stage.state + static_cast<size_t>(ch) * 6 * kMaxFirTaps;
+                hist[pos] = frame[ch];
+                hist[pos + taps] = frame[ch];
+
+                outEven[ch] = 2.0f * Dot(hist + pos, stage.fir, taps);
+                outOdd[ch] = hist[pos + stage.firCenter];
+            }
+        }
+
+        stage.firPosUp = pos;
+    }
+
+    /**
+     * @brief FIRハーフバンドで1/2に間引く（frames は高いレートのフレーム数）
+     */
+    void DownsampleFir(Stage& stage, const float* in, float* out, unsigned int frames) const {
+        const int taps = stage.firTaps;
+        const int chs = m_channels;
+        int pos = stage.firPosDown;
+
+        for (unsigned int n = 0 ; n < frames / 2 ; ++n) {
+            pos = (pos == 0) ? taps - 1 : pos - 1;
+            const float* inEven = in + static_cast<size_t>(2 * n) * chs;
+            const float* inOdd = inEven + chs;
+            float* frame = out + static_cast<size_t>(n) * chs;
+
+            for (int ch = 0 ; ch < chs ; ++ch) {
+                float* even = stage.state + static_cast<size_t>(ch) * 6 * kMaxFirTaps + 2 * kMaxFirTaps;
+                float* odd = even + 2 * kMaxFirTaps;
+                even[pos] = inEven[ch];
+                even[pos + taps] = inEven[ch];
+                odd[pos] = inOdd[ch];
+                odd[pos + taps] = inOdd[ch];
+
+                // y[n] = Σ g[j] e[n - j] + 0.5 o[n - M - 1]
+                frame[ch] = Dot(even + pos, stage.fir, taps) + 0.5f * odd[pos + stage.firCenter + 1];
+            }
+        }
+
+        stage.firPosDown = pos;
+    }
+
+    /**
+     * @brief IIRハーフバンドで2倍にする（2つのオールパス経路の出力を交互に並べる）
+     */
+    void UpsampleIir(Stage& stage, const float* in, float* out, unsigned int frames) const {
+        const int chs = m_channels;
+        const int coeffs = stage.iirCoeffs;
+        float* x = stage.state;
+        float* y = x + static_cast<size_t>(kMaxIirCoeffs) * chs;
+
+        for (unsigned int n = 0 ; n < frames ; ++n) {
+            const float* frame = in + static_cast<size_t>(n) * chs;
+            float* outEven = out + static_cast<size_t>(2 * n) * chs;
+            float* outOdd = outEven + chs;
+            int ch = 0;
+
+# if OVERSAMPLER_SSE2
+            for ( ; ch + 4 <= chs ; ch += 4) {
+                __m128 even = _mm_loadu_ps(frame + ch);
+                __m128 odd = even;
+                for (int i = 0 ; i < coeffs ; i += 2) {
+                    even = AllpassStep4(even, stage.iir[i], x + i * chs + ch, y + i * chs + ch);
+                    if (i + 1 < coeffs) {
+                        odd = AllpassStep4(odd, stage.iir[i + 1], x + (i + 1) * chs + ch, y + (i + 1) * chs + ch);
+                    }
+                }
+                _mm_storeu_ps(outEven + ch, even);
+                _mm_storeu_ps(outOdd + ch, odd);
+            }
+# endif
+            for ( ; ch < chs ; ++ch) {
+                float even = frame[ch];
+                float odd = even;
+                for (int i = 0 ; i < coeffs ; i += 2) {
+                    even = AllpassStep(even, stage.iir[i], x[i * chs + ch], y[i * chs + ch]);
+                    if (i + 1 < coeffs) {
+                        odd = AllpassStep(odd, stage.iir[i + 1], x[(i + 1) * chs + ch], y[(i + 1) * chs + ch]);
+                    }
+                }
+                outEven[ch] = even;
+                outOdd[ch] = odd;
+            }
+        }
+    }
+
+    /**
+     * @brief IIRハーフバンドで1/2に間引く（frames は高いレートのフレーム数）
+     */
+    void DownsampleIir(Stage& stage, const float* in, float* out, unsigned int frames) const {
+        const int chs = m_channels;
+        const int coeffs = stage.iirCoeffs;
+        float* x = stage.state + static_cast<size_t>(2 * kMaxIirCoeffs) * chs;
+        float* y = x + static_cast<size_t>(kMaxIirCoeffs) * chs;
+
+        for (unsigned int n = 0 ; n < frames / 2 ; ++n) {
+            const float* inEven = in + static_cast<size_t>(2 * n) * chs;
+            const float* inOdd = inEven + chs;
+            float* frame = out + static_cast<size_t>(n) * chs;
+            int ch = 0;
+
+            // 新しい方のサンプルを経路0、古い方を経路1に通して平均する
+# if OVERSAMPLER_SSE2
+            for ( ; ch + 4 <= chs ; ch += 4) {
+                __m128 path0 = _mm_loadu_ps(inOdd + ch);
+                __m128 path1 = _mm_loadu_ps(inEven + ch);
+                for (int i = 0 ; i < coeffs ; i += 2) {
+                    path0 = AllpassStep4(path0, stage.iir[i], x + i * chs + ch, y + i * chs + ch);
+                    if (i + 1 < coeffs) {
+                        path1 = AllpassStep4(path1, stage.iir[i + 1], x + (i + 1) * chs + ch, y + (i + 1) * chs + ch);
+                    }
+                }
+                _mm_storeu_ps(frame + ch, _mm_mul_ps(_mm_add_ps(path0, path1), _mm_set1_ps(0.5f)));
+            }
+# endif
+            for ( ; ch < chs ; ++ch) {
+                float path0 = inOdd[ch];
+                float path1 = inEven[ch];
+                for (int i = 0 ; i < coeffs ; i += 2) {
+                    path0 = AllpassStep(path0, stage.iir[i], x[i * chs + ch], y[i * chs + ch]);
+                    if (i + 1 < coeffs) {
+                        path1 = AllpassStep(path1, stage.iir[i + 1], x[(i + 1) * chs + ch], y[(i + 1) * chs + ch]);
+                    }
+                }
+                frame[ch] = 0.5f * (path0 + path1);
+            }
+        }
+    }
+
+    /**
+     * @brief 1次オールパス y[n] = a (x[n] - y[n-1]) + x[n-1]
+     * @param x1 前回の入力
+     * @param y1 前回の出力
+     */
+    static float AllpassStep(float in, float a, float& x1, float& y1) {
+        const float out = a * (in - y1) + x1;
+        x1 = in;
+        y1 = out;
+        return out;
+    }
+
+# if OVERSAMPLER_SSE2
+    static __m128 AllpassStep4(__m128 in, float a, float* x1, float* y1) {
+        const __m128 out = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a), _mm_sub_ps(in, _mm_loadu_ps(y1))), _mm_loadu_ps(x1));
+        _mm_storeu_ps(x1, in);
+        _mm_storeu_ps(y1, out);
+        return out;
+    }
+# endif
+
+    Stage m_stageData[kMaxStages] { };
+    float* m_buffers[2] { };
+    int m_stages = 0;
+    int m_factor = 1;
+    OversamplerPhase m_phase = OVERSAMPLER_MINIMUM_PHASE;
+    int m_channels = 0;
+    unsigned int m_maxFrames = 0;
+    float m_latency = 0.0f;
+};
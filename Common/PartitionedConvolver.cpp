@@ -0,0 +1,124 @@
+/**
+ *  @file PartitionedConvolver.cpp
+ *  @author Goto Kenta
+ *  @brief 一様分割の周波数領域畳み込みの実装
+ */
+
+# include "PartitionedConvolver.h"
+# include "SimdDispatch.h"
+
+# include <algorithm>
+# include <cstring>
+# include <utility>
+
+bool PartitionedConvolver::init(size_t blockSize, const float* ir, size_t irLength) {
+    return init(PartitionedIR::Create(blockSize, ir, irLength));
+}
+
+bool PartitionedConvolver::init(PartitionedIR::Ptr ir) {
+    reset();
+
+    if (!ir) {
+        return false;
+    }
+    if (ir->segmentCount() == 0) {
+        return true;
+    }
+
+    m_ir = std::move(ir);
+    m_plan = m_ir->plan();
+    m_blockSize = m_ir->blockSize();
+    m_complexSize = m_ir->complexSize();
+    m_segmentCount = m_ir->segmentCount();
+    m_current = 0;
+
+    const size_t spectra = m_segmentCount * m_complexSize;
+    m_segmentRe.assign(spectra, 0.0f);
+    m_segmentIm.assign(spectra, 0.0f);
+    m_premultipliedRe.assign(m_complexSize, 0.0f);
+    m_premultipliedIm.assign(m_complexSize, 0.0f);
+    m_convRe.assign(m_complexSize, 0.0f);
+    m_convIm.assign(m_complexSize, 0.0f);
+    m_fftBuffer.assign(2 * m_blockSize, 0.0f);
+    m_fftWork.prepare(*m_plan);
+    m_overlap.assign(m_blockSize, 0.0f);
+    m_inputBuffer.assign(m_blockSize, 0.0f);
+    m_inputBufferFill = 0;
+
+    return true;
+}
+
+void PartitionedConvolver::process(const float* input, float* output, size_t length) {
+    if (m_segmentCount == 0) {
+        std::fill(output, output + length, 0.0f);
+        return;
+    }
+
+    const SimdKernelTable& simd = SimdKernels();
+
+    size_t processed = 0;
+    while (processed < length) {
+        const bool inputBufferWasEmpty = (m_inputBufferFill == 0);
+        const size_t processing = std::min(length - processed, m_blockSize - m_inputBufferFill);
+        const size_t inputBufferPos = m_inputBufferFill;
+        std::memcpy(m_inputBuffer.data() + inputBufferPos, input + processed, processing * sizeof(float));
+
+        // 現在の区間（後半は0）のスペクトル
+        std::memcpy(m_fftBuffer.data(), m_inputBuffer.data(), m_blockSize * sizeof(float));
+        std::fill(m_fftBuffer.begin() + static_cast<std::ptrdiff_t>(m_blockSize), m_fftBuffer.end(), 0.0f);
+        float* segRe = &m_segmentRe[m_current * m_complexSize];
+        float* segIm = &m_segmentIm[m_current * m_complexSize];
+        m_plan->forward(m_fftBuffer.data(), segRe, segIm, m_fftWork.data());
+
+        // 過去の区間とIRの2つ目以降の積はブロックの先頭で1回だけ計算する
+        if (inputBufferWasEmpty) {
+            std::fill(m_premultipliedRe.begin(), m_premultipliedRe.end(), 0.0f);
+            std::fill(m_premultipliedIm.begin(), m_premultipliedIm.end(), 0.0f);
+            for (size_t i = 1 ; i < m_segmentCount ; ++i) {
+                const size_t seg = (m_current + i) % m_segmentCount;
+                simd.complexMultiplyAccumulate(m_premultipliedRe.data(), m_premultipliedIm.data(),
+                                               m_ir->re(i), m_ir->im(i),
+                                               &m_segmentRe[seg * m_complexSize], &m_segmentIm[seg * m_complexSize],
+                                               m_complexSize);
+            }
+        }
+        std::memcpy(m_convRe.data(), m_premultipliedRe.data(), m_complexSize * sizeof(float));
+        std::memcpy(m_convIm.data(), m_premultipliedIm.data(), m_complexSize * sizeof(float));
+        simd.complexMultiplyAccumulate(m_convRe.data(), m_convIm.data(), m_ir->re(0), m_ir->im(0), segRe, segIm, m_complexSize);
+
+        // 時間領域に戻して、前のブロックのはみ出しを足す
+        m_plan->inverse(m_convRe.data(), m_convIm.data(), m_fftBuffer.data(), m_fftWork.data());
+        simd.add(m_fftBuffer.data() + inputBufferPos, m_overlap.data() + inputBufferPos, output + processed, processing);
+
+        // ブロックが埋まったら次の区間へ
+        m_inputBufferFill += processing;
+        if (m_inputBufferFill == m_blockSize) {
+            std::fill(m_inputBuffer.begin(), m_inputBuffer.end(), 0.0f);
+            m_inputBufferFill = 0;
+            std::memcpy(m_overlap.data(), m_fftBuffer.data() + m_blockSize, m_blockSize * sizeof(float));
+            m_current = (m_current > 0) ? (m_current - 1) : (m_segmentCount - 1);
+        }
+
+        processed += processing;
+    }
+}
+
+void PartitionedConvolver::reset() {
+    m_ir.reset();
+    m_plan.reset();
+    m_blockSize = 0;
+    m_complexSize = 0;
+    m_segmentCount = 0;
+    m_current = 0;
+    m_segmentRe.clear();
+    m_segmentIm.clear();
+    m_premultipliedRe.clear();
+    m_premultipliedIm.clear();
+    m_convRe.clear();
+    m_convIm.clear();
+    m_fftBuffer.clear();
+    m_fftWork.clear();
+    m_overlap.clear();
+    m_inputBuffer.clear();
+    m_inputBufferFill = 0;
+}
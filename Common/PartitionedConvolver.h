@@ -0,0 +1,69 @@
+/**
+ *  @file PartitionedConvolver.h
+ *  @author Goto Kenta
+ *  @brief 一様分割の周波数領域畳み込み（レイテンシなし）
+ */
+
+# pragma once
+
+# include "PartitionedIR.h"
+
+# include <cstddef>
+# include <vector>
+
+/**
+ * @brief IRをブロックサイズごとに分割して周波数領域で畳み込むコンボリューター
+ * @note ブロックの途中で呼ばれても、その時点までの入力で出力を作るのでレイテンシは0。
+ *       FFTの回転因子表は FFTPlanCache で全インスタンスが共有する。
+ *       IRのスペクトルは PartitionedIR として受け取るので、解析で計算済みのものや左右のチャンネルで同じものを使える
+ */
+class PartitionedConvolver {
+public:
+    /**
+     * @brief IRを設定して内部状態を初期化する
+     * @param blockSize 分割の長さ（2のべき乗に切り上げる）
+     * @param ir インパルス応答
+     * @param irLength インパルス応答の長さ
+     * @return 成功したかどうか（blockSize が0なら失敗）
+     */
+    bool init(size_t blockSize, const float* ir, size_t irLength);
+
+    /**
+     * @brief 計算済みのIRのスペクトルを設定して内部状態を初期化する（IRのFFTは行わない）
+     * @param ir 分割したIRのスペクトル（ブロックサイズはその分割の長さになる）
+     * @return 成功したかどうか（ir が nullptr なら失敗）
+     */
+    bool init(PartitionedIR::Ptr ir);
+
+    /**
+     * @brief 畳み込みを行う（長さは任意）
+     * @param input 入力
+     * @param output 出力（input と同じでもよい）
+     * @param length サンプル数
+     */
+    void process(const float* input, float* output, size_t length);
+
+    /**
+     * @brief IRと内部状態を破棄する（以降は無音を出力する）
+     */
+    void reset();
+
+private:
+    PartitionedIR::Ptr m_ir;
+    FFTPlanCache::Plan m_plan;
+    size_t m_blockSize = 0;
+    size_t m_complexSize = 0;
+    size_t m_segmentCount = 0;
+    size_t m_current = 0;
+
+    // 入力の各区間のスペクトル（区間ごとに complexSize 個の実部と虚部）
+    std::vector<float> m_segmentRe, m_segmentIm;
+
+    std::vector<float> m_premultipliedRe, m_premultipliedIm; // 2つ目以降の区間の積の和（ブロックごとに1回）
+    std::vector<float> m_convRe, m_convIm;
+    std::vector<float> m_fftBuffer;   // 2 * blockSize
+    FFTWorkspace m_fftWork;           // FFTの実装が使う作業領域
+    std::vector<float> m_overlap;     // 前のブロックのはみ出し
+    std::vector<float> m_inputBuffer; // 現在のブロックの入力
+    size_t m_inputBufferFill = 0;
+};
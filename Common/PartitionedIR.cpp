@@ -0,0 +1,59 @@
+/**
+ *  @file PartitionedIR.cpp
+ *  @author Goto Kenta
+ *  @brief 分割したIRのスペクトルの計算
+ */
+
+# include "PartitionedIR.h"
+
+# include <algorithm>
+# include <cstring>
+
+size_t PartitionedIR::RoundBlockSize(size_t blockSize) {
+    size_t rounded = 1;
+    while (rounded < blockSize) {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+PartitionedIR::Ptr PartitionedIR::Create(size_t blockSize, const float* ir, size_t irLength) {
+    if (blockSize == 0) {
+        return nullptr;
+    }
+
+    auto result = std::make_shared<PartitionedIR>();
+
+    // 末尾の無音は畳み込まない
+    while (irLength > 0 && ir[irLength - 1] == 0.0f) {
+        --irLength;
+    }
+    if (irLength == 0) {
+        return result;
+    }
+
+    result->m_blockSize = RoundBlockSize(blockSize);
+    result->m_plan = FFTPlanCache::Shared().Get(2 * result->m_blockSize);
+    result->m_complexSize = result->m_plan->complexSize();
+    result->m_segmentCount = (irLength + result->m_blockSize - 1) / result->m_blockSize;
+    result->m_irLength = irLength;
+
+    const size_t spectra = result->m_segmentCount * result->m_complexSize;
+    result->m_re.assign(spectra, 0.0f);
+    result->m_im.assign(spectra, 0.0f);
+
+    std::vector<float> buffer(2 * result->m_blockSize);
+    FFTWorkspace work;
+    work.prepare(*result->m_plan);
+
+    // 各区間（後半は0）のスペクトル
+    for (size_t i = 0 ; i < result->m_segmentCount ; ++i) {
+        const size_t offset = i * result->m_blockSize;
+        const size_t count = std::min(result->m_blockSize, irLength - offset);
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        std::memcpy(buffer.data(), ir + offset, count * sizeof(float));
+        result->m_plan->forward(buffer.data(), &result->m_re[i * result->m_complexSize], &result->m_im[i * result->m_complexSize], work.data());
+    }
+
+    return result;
+}
@@ -0,0 +1,70 @@
+/**
+ *  @file PartitionedIR.h
+ *  @author Goto Kenta
+ *  @brief ブロックサイズごとに分割したIRのスペクトル（コンボリューターと解析で共有する）
+ */
+
+# pragma once
+
+# include "FFT.h"
+
+# include <cstddef>
+# include <memory>
+# include <vector>
+
+/**
+ * @brief IRを長さ blockSize の区間に分け、それぞれを 2 * blockSize 点で順変換したスペクトル
+ * @note PartitionedConvolver はこれをそのまま使うので、解析のために作ったスペクトルを
+ *       FFTをやり直さずにコンボリューターへ渡せる。作成後は読み取り専用なので複数のコンボリューター
+ *       （ステレオの左右など）で共有してよい
+ */
+class PartitionedIR {
+public:
+    using Ptr = std::shared_ptr<const PartitionedIR>;
+
+    /**
+     * @brief 分割の長さ（2のべき乗に切り上げる）
+     */
+    static size_t RoundBlockSize(size_t blockSize);
+
+    /**
+     * @brief IRを分割して各区間のスペクトルを計算する
+     * @param blockSize 分割の長さ（2のべき乗に切り上げる）
+     * @param ir インパルス応答
+     * @param irLength インパルス応答の長さ（末尾の無音は除く）
+     * @return 作ったスペクトル（blockSize が0なら nullptr、無音なら区間数0）
+     */
+    static Ptr Create(size_t blockSize, const float* ir, size_t irLength);
+
+    size_t blockSize() const { return m_blockSize; }
+    size_t complexSize() const { return m_complexSize; }
+    size_t segmentCount() const { return m_segmentCount; }
+
+    /**
+     * @brief 末尾の無音を除いたIRの長さ
+     */
+    size_t irLength() const { return m_irLength; }
+
+    /**
+     * @brief 変換に使ったFFTプラン（コンボリューターも同じものを使う）
+     */
+    const FFTPlanCache::Plan& plan() const { return m_plan; }
+
+    /**
+     * @brief 区間 segment のスペクトルの実部（complexSize() 要素）
+     */
+    const float* re(size_t segment) const { return m_re.data() + segment * m_complexSize; }
+
+    /**
+     * @brief 区間 segment のスペクトルの虚部（complexSize() 要素）
+     */
+    const float* im(size_t segment) const { return m_im.data() + segment * m_complexSize; }
+
+private:
+    FFTPlanCache::Plan m_plan;
+    size_t m_blockSize = 0;
+    size_t m_complexSize = 0;
+    size_t m_segmentCount = 0;
+    size_t m_irLength = 0;
+    std::vector<float> m_re, m_im; // 区間ごとに complexSize 個ずつ
+};
@@ -0,0 +1,615 @@
+/**
+ *  @file SimdDispatch.cpp
+ *  @author Goto Kenta
+ *  @brief SIMDカーネルの選択と、ベースライン（SSE2、非x86ではスカラー）の実装
+ */
+
+# include "SimdDispatch.h"
+
+# include <cstdlib>
+# include <cstring>
+
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    # define SIMD_BASELINE_SSE2 1
+    # include <emmintrin.h>
+# else
+    # define SIMD_BASELINE_SSE2 0
+# endif
+
+# if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    # include <intrin.h>
+    # define SIMD_HAS_CPUID 1
+# elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    # include <cpuid.h>
+    # define SIMD_HAS_CPUID 1
+# else
+    # define SIMD_HAS_CPUID 0
+# endif
+
+// AVX2/AVX-512の翻訳単位はCMakeがx86でビルドするときだけ追加する
+# ifndef FMOD_PLUGINS_SIMD_DISPATCH
+    # define FMOD_PLUGINS_SIMD_DISPATCH 0
+# endif
+
+namespace {
+
+# if SIMD_HAS_CPUID
+    /**
+     * @brief cpuid を実行する
+     */
+    void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+    # if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0 ; i < 4 ; ++i) regs[i] = static_cast<unsigned int>(r[i]);
+    # else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    # endif
+    }
+
+    /**
+     * @brief OSが保存するレジスタの状態（XCR0）を取得する
+     */
+    unsigned long long ReadXcr0() {
+    # if defined(_MSC_VER)
+        return _xgetbv(0);
+    # else
+        unsigned int eax = 0, edx = 0;
+        __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+    # endif
+    }
+# endif
+
+    // ---ベースラインのカーネル---
+
+    void MixDryWet(const float* dry, const float* wet, float* out, size_t count, float dryGain, float wetGain, float volume) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        const __m128 d = _mm_set1_ps(dryGain);
+        const __m128 w = _mm_set1_ps(wetGain);
+        const __m128 v = _mm_set1_ps(volume);
+        for ( ; i + 4 <= count ; i += 4) {
+            const __m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(dry + i), d), _mm_mul_ps(_mm_loadu_ps(wet + i), w));
+            _mm_storeu_ps(out + i, _mm_mul_ps(x, v));
+        }
+    # endif
+        for ( ; i < count ; ++i) {
+            out[i] = (dry[i] * dryGain + wet[i] * wetGain) * volume;
+        }
+    }
+
+    void Deinterleave2(const float* in, float* left, float* right, size_t frames) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= frames ; i += 4) {
+            const __m128 a = _mm_loadu_ps(in + 2 * i);
+            const __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+    # endif
+        for ( ; i < frames ; ++i) {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void Interleave2(const float* left, const float* right, float* out, size_t frames) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= frames ; i += 4) {
+            const __m128 l = _mm_loadu_ps(left + i);
+            const __m128 r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+        }
+    # endif
+        for ( ; i < frames ; ++i) {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void Multiply(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= count ; i += 4) {
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+    # endif
+        for ( ; i < count ; ++i) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    void SelectLess(const float* r, float threshold, const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        const __m128 t = _mm_set1_ps(threshold);
+        for ( ; i + 4 <= count ; i += 4) {
+            const __m128 mask = _mm_cmplt_ps(_mm_loadu_ps(r + i), t);
+            const __m128 picked = _mm_or_ps(_mm_and_ps(mask, _mm_loadu_ps(a + i)), _mm_andnot_ps(mask, _mm_loadu_ps(b + i)));
+            _mm_storeu_ps(out + i, picked);
+        }
+    # endif
+        for ( ; i < count ; ++i) {
+            out[i] = (r[i] < threshold) ? a[i] : b[i];
+        }
+    }
+
+    void SquareToDouble(const float* in, double* out, size_t count) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= count ; i += 4) {
+            const __m128 x = _mm_loadu_ps(in + i);
+            const __m128d lo = _mm_cvtps_pd(x);
+            const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+            _mm_storeu_pd(out + i, _mm_mul_pd(lo, lo));
+            _mm_storeu_pd(out + i + 2, _mm_mul_pd(hi, hi));
+        }
+    # endif
+        for ( ; i < count ; ++i) {
+            out[i] = static_cast<double>(in[i]) * static_cast<double>(in[i]);
+        }
+    }
+
+    double SumSquares(const float* in, size_t count) {
+        size_t i = 0;
+        double sum = 0.0;
+    # if SIMD_BASELINE_SSE2
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        for ( ; i + 4 <= count ; i += 4) {
+            const __m128 x = _mm_loadu_ps(in + i);
+            const __m128d lo = _mm_cvtps_pd(x);
+            const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(lo, lo));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(hi, hi));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+        sum = lanes[0] + lanes[1];
+    # endif
+        for ( ; i < count ; ++i) {
+            sum += static_cast<double>(in[i]) * static_cast<double>(in[i]);
+        }
+        return sum;
+    }
+
+    void Add(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= count ; i += 4) {
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+    # endif
+        for ( ; i < count ; ++i) {
+            out[i] = a[i] + b[i];
+        }
+    }
+
+    void ComplexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm, const float* bRe, const float* bIm, size_t count) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= count ; i += 4) {
+            const __m128 ar = _mm_loadu_ps(aRe + i);
+            const __m128 ai = _mm_loadu_ps(aIm + i);
+            const __m128 br = _mm_loadu_ps(bRe + i);
+            const __m128 bi = _mm_loadu_ps(bIm + i);
+            const __m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+            const __m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+            _mm_storeu_ps(accRe + i, _mm_add_ps(_mm_loadu_ps(accRe + i), re));
+            _mm_storeu_ps(accIm + i, _mm_add_ps(_mm_loadu_ps(accIm + i), im));
+        }
+    # endif
+        for ( ; i < count ; ++i) {
+            accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+            accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+        }
+    }
+
+    void Interleave8(const float* const* in, float* out, size_t frames) {
+        size_t i = 0;
+    # if SIMD_BASELINE_SSE2
+        for ( ; i + 4 <= frames ; i += 4) {
+            // 4x4の転置を2回（レーン0〜3と4〜7）
+            for (size_t half = 0 ; half < 8 ; half += 4) {
+                __m128 r0 = _mm_loadu_ps(in[half] + i);
+                __m128 r1 = _mm_loadu_ps(in[half + 1] + i);
+                __m128 r2 = _mm_loadu_ps(in[half + 2] + i);
+                __m128 r3 = _mm_loadu_ps(in[half + 3] + i);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(out + (i + 0) * 8 + half, r0);
+                _mm_storeu_ps(out + (i + 1) * 8 + half, r1);
+                _mm_storeu_ps(out + (i + 2) * 8 + half, r2);
+                _mm_storeu_ps(out + (i + 3) * 8 + half, r3);
+            }
+        }
+    # endif
+        for ( ; i < frames ; ++i) {
+            for (size_t lane = 0 ; lane < 8 ; ++lane) {
+                out[i * 8 + lane] = in[lane][i];
+            }
+        }
+    }
+
+    void ReverseEnergySum8(const float* in, double* edc, size_t frames) {
+    # if SIMD_BASELINE_SSE2
+        __m128d acc[4] = { _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd() };
+        for (size_t i = frames ; i-- > 0 ; ) {
+            const __m128 lo = _mm_loadu_ps(in + i * 8);
+            const __m128 hi = _mm_loadu_ps(in + i * 8 + 4);
+            const __m128d x[4] = { _mm_cvtps_pd(lo), _mm_cvtps_pd(_mm_movehl_ps(lo, lo)), _mm_cvtps_pd(hi), _mm_cvtps_pd(_mm_movehl_ps(hi, hi)) };
+            for (int k = 0 ; k < 4 ; ++k) {
+                acc[k] = _mm_add_pd(acc[k], _mm_mul_pd(x[k], x[k]));
+                _mm_storeu_pd(edc + i * 8 + 2 * k, acc[k]);
+            }
+        }
+    # else
+        double acc[8] = { };
+        for (size_t i = frames ; i-- > 0 ; ) {
+            for (size_t lane = 0 ; lane < 8 ; ++lane) {
+                const double x = static_cast<double>(in[i * 8 + lane]);
+                acc[lane] += x * x;
+                edc[i * 8 + lane] = acc[lane];
+            }
+        }
+    # endif
+    }
+
+    void BlockSumSquares(const float* in, size_t count, size_t blockSize, double* out) {
+        for (size_t offset = 0 ; offset < count ; offset += blockSize, ++out) {
+            const size_t end = (count - offset < blockSize) ? count : offset + blockSize;
+            size_t i = offset;
+            double sum = 0.0;
+        # if SIMD_BASELINE_SSE2
+            __m128d acc = _mm_setzero_pd();
+            for ( ; i + 4 <= end ; i += 4) {
+                const __m128 x = _mm_loadu_ps(in + i);
+                const __m128d lo = _mm_cvtps_pd(x);
+                const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+                acc = _mm_add_pd(acc, _mm_add_pd(_mm_mul_pd(lo, lo), _mm_mul_pd(hi, hi)));
+            }
+            double lanes[2];
+            _mm_storeu_pd(lanes, acc);
+            sum = lanes[0] + lanes[1];
+        # endif
+            for ( ; i < end ; ++i) {
+                sum += static_cast<double>(in[i]) * static_cast<double>(in[i]);
+            }
+            *out = sum;
+        }
+    }
+
+    void ReverseEnergySum8Float(const float* in, float* edc, size_t frames) {
+        // カハンの補償加算（コンパイラがFMAに縮約しないこと）
+    # if SIMD_BASELINE_SSE2
+        __m128 sum[2] = { _mm_setzero_ps(), _mm_setzero_ps() };
+        __m128 comp[2] = { _mm_setzero_ps(), _mm_setzero_ps() };
+        for (size_t i = frames ; i-- > 0 ; ) {
+            for (int k = 0 ; k < 2 ; ++k) {
+                const __m128 x = _mm_loadu_ps(in + i * 8 + 4 * k);
+                const __m128 y = _mm_sub_ps(_mm_mul_ps(x, x), comp[k]);
+                const __m128 t = _mm_add_ps(sum[k], y);
+                comp[k] = _mm_sub_ps(_mm_sub_ps(t, sum[k]), y);
+                sum[k] = t;
+                _mm_storeu_ps(edc + i * 8 + 4 * k, t);
+            }
+        }
+    # else
+        float sum[8] = { };
+        float comp[8] = { };
+        for (size_t i = frames ; i-- > 0 ; ) {
+            for (size_t lane = 0 ; lane < 8 ; ++lane) {
+                const float x = in[i * 8 + lane];
+                const float y = x * x - comp[lane];
+                const float t = sum[lane] + y;
+                comp[lane] = (t - sum[lane]) - y;
+                sum[lane] = t;
+                edc[i * 8 + lane] = t;
+            }
+        }
+    # endif
+    }
+
+# if SIMD_BASELINE_SSE2
+    /**
+     * @brief 4つのバタフライ（b に回転因子を掛けて a ± b）
+     */
+    void Butterfly4(__m128& ar, __m128& ai, __m128& br, __m128& bi, __m128 wr, __m128 wi) {
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+        br = _mm_sub_ps(ar, tr);
+        bi = _mm_sub_ps(ai, ti);
+        ar = _mm_add_ps(ar, tr);
+        ai = _mm_add_ps(ai, ti);
+    }
+
+    /**
+     * @brief 幅1・2の段を、8要素ずつ a と b に並べ替えてまとめて処理する
+     * @return 処理し終えた要素数（残りは呼び出し側がスカラーで処理する）
+     */
+    size_t FFTNarrowStage(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span) {
+        size_t s = 0;
+        if (span == 1) {
+            // [a0 b0 a1 b1] [a2 b2 a3 b3] → [a0 a1 a2 a3] [b0 b1 b2 b3]
+            const __m128 wr = _mm_set1_ps(wRe[0]);
+            const __m128 wi = _mm_set1_ps(wIm[0]);
+            for ( ; s + 8 <= count ; s += 8) {
+                const __m128 r0 = _mm_loadu_ps(re + s);
+                const __m128 r1 = _mm_loadu_ps(re + s + 4);
+                const __m128 i0 = _mm_loadu_ps(im + s);
+                const __m128 i1 = _mm_loadu_ps(im + s + 4);
+                __m128 ar = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 br = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1));
+                __m128 ai = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 bi = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(3, 1, 3, 1));
+                Butterfly4(ar, ai, br, bi, wr, wi);
+                _mm_storeu_ps(re + s, _mm_unpacklo_ps(ar, br));
+                _mm_storeu_ps(re + s + 4, _mm_unpackhi_ps(ar, br));
+                _mm_storeu_ps(im + s, _mm_unpacklo_ps(ai, bi));
+                _mm_storeu_ps(im + s + 4, _mm_unpackhi_ps(ai, bi));
+            }
+        }
+        else if (span == 2) {
+            // [a0 a1 b0 b1] [a2 a3 b2 b3] → [a0 a1 a2 a3] [b0 b1 b2 b3]
+            const __m128 wr = _mm_setr_ps(wRe[0], wRe[1], wRe[0], wRe[1]);
+            const __m128 wi = _mm_setr_ps(wIm[0], wIm[1], wIm[0], wIm[1]);
+            for ( ; s + 8 <= count ; s += 8) {
+                const __m128 r0 = _mm_loadu_ps(re + s);
+                const __m128 r1 = _mm_loadu_ps(re + s + 4);
+                const __m128 i0 = _mm_loadu_ps(im + s);
+                const __m128 i1 = _mm_loadu_ps(im + s + 4);
+                __m128 ar = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 0, 1, 0));
+                __m128 br = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 2, 3, 2));
+                __m128 ai = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(1, 0, 1, 0));
+                __m128 bi = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(3, 2, 3, 2));
+                Butterfly4(ar, ai, br, bi, wr, wi);
+                _mm_storeu_ps(re + s, _mm_shuffle_ps(ar, br, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(re + s + 4, _mm_shuffle_ps(ar, br, _MM_SHUFFLE(3, 2, 3, 2)));
+                _mm_storeu_ps(im + s, _mm_shuffle_ps(ai, bi, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(im + s + 4, _mm_shuffle_ps(ai, bi, _MM_SHUFFLE(3, 2, 3, 2)));
+            }
+        }
+        return s;
+    }
+# endif
+
+    void FFTButterflyStage(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span) {
+        size_t s = 0;
+    # if SIMD_BASELINE_SSE2
+        s = FFTNarrowStage(re, im, wRe, wIm, count, span);
+    # endif
+        for ( ; s < count ; s += 2 * span) {
+            float* ar = re + s;
+            float* ai = im + s;
+            float* br = ar + span;
+            float* bi = ai + span;
+
+            size_t j = 0;
+        # if SIMD_BASELINE_SSE2
+            for ( ; j + 4 <= span ; j += 4) {
+                const __m128 xr = _mm_loadu_ps(br + j);
+                const __m128 xi = _mm_loadu_ps(bi + j);
+                const __m128 wr = _mm_loadu_ps(wRe + j);
+                const __m128 wi = _mm_loadu_ps(wIm + j);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                const __m128 yr = _mm_loadu_ps(ar + j);
+                const __m128 yi = _mm_loadu_ps(ai + j);
+                _mm_storeu_ps(br + j, _mm_sub_ps(yr, tr));
+                _mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+                _mm_storeu_ps(ar + j, _mm_add_ps(yr, tr));
+                _mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+            }
+        # endif
+            for ( ; j < span ; ++j) {
+                const float tr = br[j] * wRe[j] - bi[j] * wIm[j];
+                const float ti = br[j] * wIm[j] + bi[j] * wRe[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] = ar[j] + tr;
+                ai[j] = ai[j] + ti;
+            }
+        }
+    }
+
+# if SIMD_BASELINE_SSE2
+    /**
+     * @brief 4要素の順番を逆にする
+     */
+    __m128 Reverse4(__m128 x) {
+        return _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+# endif
+
+    void RealFFTForwardPost(float* re, float* im, const float* wRe, const float* wIm, size_t half) {
+        size_t k = 1;
+    # if SIMD_BASELINE_SSE2
+        // k の4要素と、逆順に並べた half - k の4要素が重ならない間だけまとめて処理できる
+        const __m128 plusHalf = _mm_set1_ps(0.5f);
+        const __m128 minusHalf = _mm_set1_ps(-0.5f);
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        for ( ; 2 * (k + 3) < half ; k += 4) {
+            const size_t m = half - k - 3;
+            const __m128 kr = _mm_loadu_ps(re + k);
+            const __m128 ki = _mm_loadu_ps(im + k);
+            const __m128 mr = Reverse4(_mm_loadu_ps(re + m));
+            const __m128 mi = Reverse4(_mm_loadu_ps(im + m));
+            const __m128 er = _mm_mul_ps(plusHalf, _mm_add_ps(kr, mr));
+            const __m128 ei = _mm_mul_ps(plusHalf, _mm_sub_ps(ki, mi));
+            const __m128 or_ = _mm_mul_ps(plusHalf, _mm_add_ps(ki, mi));
+            const __m128 oi = _mm_mul_ps(minusHalf, _mm_sub_ps(kr, mr));
+
+            const __m128 wr = _mm_loadu_ps(wRe + k);
+            const __m128 wi = _mm_loadu_ps(wIm + k);
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(wr, or_), _mm_mul_ps(wi, oi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(wr, oi), _mm_mul_ps(wi, or_));
+
+            _mm_storeu_ps(re + k, _mm_add_ps(er, tr));
+            _mm_storeu_ps(im + k, _mm_add_ps(ei, ti));
+            _mm_storeu_ps(re + m, Reverse4(_mm_sub_ps(er, tr)));
+            _mm_storeu_ps(im + m, Reverse4(_mm_xor_ps(_mm_sub_ps(ei, ti), sign)));
+        }
+    # endif
+        for ( ; k <= half / 2 ; ++k) {
+            const size_t m = half - k;
+            const float er = 0.5f * (re[k] + re[m]);
+            const float ei = 0.5f * (im[k] - im[m]);
+            const float or_ = 0.5f * (im[k] + im[m]);
+            const float oi = -0.5f * (re[k] - re[m]);
+
+            const float tr = wRe[k] * or_ - wIm[k] * oi;
+            const float ti = wRe[k] * oi + wIm[k] * or_;
+
+            re[k] = er + tr;
+            im[k] = ei + ti;
+            re[m] = er - tr;
+            im[m] = -(ei - ti);
+        }
+    }
+
+    void RealFFTInversePre(const float* re, const float* im, float* zRe, float* zIm, const float* wRe, const float* wIm, size_t half) {
+        size_t k = 1;
+    # if SIMD_BASELINE_SSE2
+        const __m128 plusHalf = _mm_set1_ps(0.5f);
+        for ( ; 2 * (k + 3) < half ; k += 4) {
+            const size_t m = half - k - 3;
+            const __m128 kr = _mm_loadu_ps(re + k);
+            const __m128 ki = _mm_loadu_ps(im + k);
+            const __m128 mr = Reverse4(_mm_loadu_ps(re + m));
+            const __m128 mi = Reverse4(_mm_loadu_ps(im + m));
+            const __m128 er = _mm_mul_ps(plusHalf, _mm_add_ps(kr, mr));
+            const __m128 ei = _mm_mul_ps(plusHalf, _mm_sub_ps(ki, mi));
+            const __m128 dr = _mm_mul_ps(plusHalf, _mm_sub_ps(kr, mr));
+            const __m128 di = _mm_mul_ps(plusHalf, _mm_add_ps(ki, mi));
+
+            const __m128 wr = _mm_loadu_ps(wRe + k);
+            const __m128 wi = _mm_loadu_ps(wIm + k);
+            const __m128 or_ = _mm_add_ps(_mm_mul_ps(dr, wr), _mm_mul_ps(di, wi));
+            const __m128 oi = _mm_sub_ps(_mm_mul_ps(di, wr), _mm_mul_ps(dr, wi));
+
+            _mm_storeu_ps(zRe + k, _mm_sub_ps(er, oi));
+            _mm_storeu_ps(zIm + k, _mm_add_ps(ei, or_));
+            _mm_storeu_ps(zRe + m, Reverse4(_mm_add_ps(er, oi)));
+            _mm_storeu_ps(zIm + m, Reverse4(_mm_sub_ps(or_, ei)));
+        }
+    # endif
+        for ( ; k <= half / 2 ; ++k) {
+            const size_t m = half - k;
+            const float er = 0.5f * (re[k] + re[m]);
+            const float ei = 0.5f * (im[k] - im[m]);
+            const float dr = 0.5f * (re[k] - re[m]);
+            const float di = 0.5f * (im[k] + im[m]);
+
+            // O = d * conj(W^k)
+            const float or_ = dr * wRe[k] + di * wIm[k];
+            const float oi = di * wRe[k] - dr * wIm[k];
+
+            // Z[k] = E + iO, Z[half - k] = conj(E) + i conj(O)
+            zRe[k] = er - oi;
+            zIm[k] = ei + or_;
+            zRe[m] = er + oi;
+            zIm[m] = or_ - ei;
+        }
+    }
+
+    const SimdKernelTable s_baseline = {
+        SIMD_BASELINE_SSE2 ? SimdLevel::SSE2 : SimdLevel::Scalar,
+        MixDryWet,
+        Deinterleave2,
+        Interleave2,
+        Multiply,
+        SelectLess,
+        SquareToDouble,
+        SumSquares,
+        Add,
+        ComplexMultiplyAccumulate,
+        Interleave8,
+        ReverseEnergySum8,
+        BlockSumSquares,
+        ReverseEnergySum8Float,
+        FFTButterflyStage,
+        RealFFTForwardPost,
+        RealFFTInversePre,
+    };
+
+    /**
+     * @brief 環境変数 FMOD_PLUGINS_SIMD で指定された上限（未指定なら AVX512）
+     */
+    SimdLevel RequestedSimdLevel() {
+        const char* requested = std::getenv("FMOD_PLUGINS_SIMD");
+        if (!requested) return SimdLevel::AVX512;
+        if (std::strcmp(requested, "sse2") == 0) return SimdLevel::SSE2;
+        if (std::strcmp(requested, "avx2") == 0) return SimdLevel::AVX2;
+        return SimdLevel::AVX512;
+    }
+
+    /**
+     * @brief 使える中で最も新しい命令セットのカーネルを選ぶ
+     */
+    const SimdKernelTable& SelectKernels() {
+        const SimdLevel detected = DetectSimdLevel();
+        const SimdLevel requested = RequestedSimdLevel();
+        const SimdLevel level = (requested < detected) ? requested : detected;
+        (void)level;
+
+    # if FMOD_PLUGINS_SIMD_DISPATCH
+        if (level >= SimdLevel::AVX512) {
+            if (const SimdKernelTable* table = SimdKernelTableAVX512()) return *table;
+        }
+        if (level >= SimdLevel::AVX2) {
+            if (const SimdKernelTable* table = SimdKernelTableAVX2()) return *table;
+        }
+    # endif
+        return s_baseline;
+    }
+
+    // ミキサースレッドで初めて呼ばれないよう、読み込み時に選んでおく
+    [[maybe_unused]] const SimdKernelTable& s_selectedAtLoad = SimdKernels();
+}
+
+const SimdKernelTable& SimdKernels() {
+    static const SimdKernelTable& table = SelectKernels();
+    return table;
+}
+
+SimdLevel DetectSimdLevel() {
+# if SIMD_HAS_CPUID
+    unsigned int regs[4];
+    Cpuid(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+
+    Cpuid(1, 0, regs);
+    const bool sse2 = (regs[3] & (1u << 26)) != 0;
+    const bool osxsave = (regs[2] & (1u << 27)) != 0;
+    const bool avx = (regs[2] & (1u << 28)) != 0;
+    if (!sse2) return SimdLevel::Scalar;
+    if (!osxsave || !avx || maxLeaf < 7) return SimdLevel::SSE2;
+
+    // OSがYMM（とAVX-512ならopmask/ZMM）のレジスタを保存していること
+    const unsigned long long xcr0 = ReadXcr0();
+    const bool ymmState = (xcr0 & 0x6) == 0x6;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    Cpuid(7, 0, regs);
+    const bool avx2 = (regs[1] & (1u << 5)) != 0;
+    const bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+    if (avx512f && zmmState) return SimdLevel::AVX512;
+    if (avx2 && ymmState) return SimdLevel::AVX2;
+    return SimdLevel::SSE2;
+# else
+    return SIMD_BASELINE_SSE2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+# endif
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        default: return "Scalar";
+    }
+}
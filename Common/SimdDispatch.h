@@ -0,0 +1,98 @@
+/**
+ *  @file SimdDispatch.h
+ *  @author Goto Kenta
+ *  @brief 実行中のCPUに合わせてSIMDカーネル（SSE2/AVX2/AVX-512）を選ぶ
+ */
+
+# pragma once
+
+# include <cstddef>
+
+/**
+ * @brief 使用する命令セット
+ */
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512,
+};
+
+/**
+ * @brief 命令セットごとに用意するカーネルの一覧
+ * @note 要素ごとの演算（mixDryWet など）はどの命令セットでも同じ結果になる（FMAで縮約しない）。
+ *       総和（sumSquares / blockSumSquares）だけは足す順番が変わるので、最下位ビットが異なることがある
+ */
+struct SimdKernelTable {
+    SimdLevel level;
+
+    /** @brief out[i] = (dry[i] * dryGain + wet[i] * wetGain) * volume */
+    void (*mixDryWet)(const float* dry, const float* wet, float* out, size_t count, float dryGain, float wetGain, float volume);
+
+    /** @brief ステレオのインタリーブを左右に分ける */
+    void (*deinterleave2)(const float* in, float* left, float* right, size_t frames);
+
+    /** @brief 左右をステレオのインタリーブにまとめる */
+    void (*interleave2)(const float* left, const float* right, float* out, size_t frames);
+
+    /** @brief out[i] = a[i] * b[i] */
+    void (*multiply)(const float* a, const float* b, float* out, size_t count);
+
+    /** @brief out[i] = (r[i] < threshold) ? a[i] : b[i] （一様交叉） */
+    void (*selectLess)(const float* r, float threshold, const float* a, const float* b, float* out, size_t count);
+
+    /** @brief out[i] = (double)in[i] * (double)in[i] */
+    void (*squareToDouble)(const float* in, double* out, size_t count);
+
+    /** @brief in[i] の2乗の総和（doubleで累積） */
+    double (*sumSquares)(const float* in, size_t count);
+
+    /** @brief out[i] = a[i] + b[i] */
+    void (*add)(const float* a, const float* b, float* out, size_t count);
+
+    /** @brief acc[i] += a[i] * b[i] （複素数。実部と虚部は別の配列） */
+    void (*complexMultiplyAccumulate)(float* accRe, float* accIm, const float* aRe, const float* aIm, const float* bRe, const float* bIm, size_t count);
+
+    /** @brief out[i * 8 + lane] = in[lane][i] （8本の信号を1サンプルずつ交互に並べる） */
+    void (*interleave8)(const float* const* in, float* out, size_t frames);
+
+    /** @brief edc[i * 8 + lane] = in[j * 8 + lane] の2乗の j >= i での総和（末尾から doubleで累積。レーンごとの足す順番は命令セットによらない） */
+    void (*reverseEnergySum8)(const float* in, double* edc, size_t frames);
+
+    /** @brief out[b] = in[b * blockSize 〜 (b + 1) * blockSize) の2乗の総和（doubleで累積、最後のブロックは短くてよい） */
+    void (*blockSumSquares)(const float* in, size_t count, size_t blockSize, double* out);
+
+    /** @brief reverseEnergySum8 のfloat版（カハンの補償加算で誤差を抑える。結果は命令セットによらない） */
+    void (*reverseEnergySum8Float)(const float* in, float* edc, size_t frames);
+
+    /** @brief 長さ count の複素FFTの1段（幅 span のバタフライ。a = x[s + j], b = x[s + span + j] に対し a ± b * w[j]） */
+    void (*fftButterflyStage)(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span);
+
+    /** @brief 実数FFTの後処理（長さ half の複素FFTの結果から X[k] と X[half - k] を k = 1 .. half / 2 で求める。その場で書き換える） */
+    void (*realFFTForwardPost)(float* re, float* im, const float* wRe, const float* wIm, size_t half);
+
+    /** @brief 実数逆FFTの前処理（X[k] と X[half - k] から長さ half の複素数列 Z を k = 1 .. half / 2 で求める。出力は自然順） */
+    void (*realFFTInversePre)(const float* re, const float* im, float* zRe, float* zIm, const float* wRe, const float* wIm, size_t half);
+};
+
+/**
+ * @brief 実行中のCPUで使えるカーネルを取得する
+ * @note モジュールの読み込み時に1度だけ選ぶ。環境変数 FMOD_PLUGINS_SIMD（sse2 / avx2 / avx512）で上限を下げられる
+ */
+const SimdKernelTable& SimdKernels();
+
+/**
+ * @brief CPUとOSが対応している命令セットを調べる（cpuid / xgetbv）
+ */
+SimdLevel DetectSimdLevel();
+
+/**
+ * @brief 命令セットの表示名
+ */
+const char* SimdLevelName(SimdLevel level);
+
+// 命令セットごとの翻訳単位が定義する（その命令セットでコンパイルされていなければ nullptr を返す）
+// これらの翻訳単位はインライン関数を共有するとベースラインの呼び出し側に拡張命令が混ざるので、
+// このヘッダーにはインライン関数を置かないこと
+const SimdKernelTable* SimdKernelTableAVX2();
+const SimdKernelTable* SimdKernelTableAVX512();
@@ -0,0 +1,468 @@
+/**
+ *  @file SimdKernelsAVX2.cpp
+ *  @author Goto Kenta
+ *  @brief AVX2用のSIMDカーネル（このファイルだけ -mavx2 / /arch:AVX2 でコンパイルする）
+ *  @note 標準ライブラリのインライン関数を使うと、AVX2でコンパイルされた実体がベースライン側でも使われることがあるので、
+ *        ここでは組み込み関数と SimdDispatch.h だけを使う
+ */
+
+# include "SimdDispatch.h"
+
+# if defined(__AVX2__)
+
+# include <immintrin.h>
+
+namespace {
+    void MixDryWet(const float* dry, const float* wet, float* out, size_t count, float dryGain, float wetGain, float volume) {
+        size_t i = 0;
+        const __m256 d = _mm256_set1_ps(dryGain);
+        const __m256 w = _mm256_set1_ps(wetGain);
+        const __m256 v = _mm256_set1_ps(volume);
+        for ( ; i + 8 <= count ; i += 8) {
+            const __m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(dry + i), d), _mm256_mul_ps(_mm256_loadu_ps(wet + i), w));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(x, v));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = (dry[i] * dryGain + wet[i] * wetGain) * volume;
+        }
+    }
+
+    void Deinterleave2(const float* in, float* left, float* right, size_t frames) {
+        size_t i = 0;
+        for ( ; i + 8 <= frames ; i += 8) {
+            const __m256 a = _mm256_loadu_ps(in + 2 * i);     // l0 r0 l1 r1 | l2 r2 l3 r3
+            const __m256 b = _mm256_loadu_ps(in + 2 * i + 8); // l4 r4 l5 r5 | l6 r6 l7 r7
+            const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)); // l0 l1 l4 l5 | l2 l3 l6 l7
+            const __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm256_storeu_ps(left + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+            _mm256_storeu_ps(right + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+        }
+        for ( ; i < frames ; ++i) {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void Interleave2(const float* left, const float* right, float* out, size_t frames) {
+        size_t i = 0;
+        for ( ; i + 8 <= frames ; i += 8) {
+            const __m256 l = _mm256_loadu_ps(left + i);
+            const __m256 r = _mm256_loadu_ps(right + i);
+            const __m256 lo = _mm256_unpacklo_ps(l, r); // l0 r0 l1 r1 | l4 r4 l5 r5
+            const __m256 hi = _mm256_unpackhi_ps(l, r); // l2 r2 l3 r3 | l6 r6 l7 r7
+            _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        for ( ; i < frames ; ++i) {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void Multiply(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+        for ( ; i + 8 <= count ; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    void SelectLess(const float* r, float threshold, const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+        const __m256 t = _mm256_set1_ps(threshold);
+        for ( ; i + 8 <= count ; i += 8) {
+            const __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(r + i), t, _CMP_LT_OQ);
+            _mm256_storeu_ps(out + i, _mm256_blendv_ps(_mm256_loadu_ps(b + i), _mm256_loadu_ps(a + i), mask));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = (r[i] < threshold) ? a[i] : b[i];
+        }
+    }
+
+    void SquareToDouble(const float* in, double* out, size_t count) {
+        size_t i = 0;
+        for ( ; i + 8 <= count ; i += 8) {
+            const __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(in + i));
+            const __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(in + i + 4));
+            _mm256_storeu_pd(out + i, _mm256_mul_pd(lo, lo));
+            _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(hi, hi));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = static_cast<double>(in[i]) * static_cast<double>(in[i]);
+        }
+    }
+
+    double SumSquares(const float* in, size_t count) {
+        size_t i = 0;
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        for ( ; i + 8 <= count ; i += 8) {
+            const __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(in + i));
+            const __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(in + i + 4));
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(lo, lo));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(hi, hi));
+        }
+        const __m256d acc = _mm256_add_pd(acc0, acc1);
+        const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        double sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+        for ( ; i < count ; ++i) {
+            sum += static_cast<double>(in[i]) * static_cast<double>(in[i]);
+        }
+        return sum;
+    }
+
+    void Add(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+        for ( ; i + 8 <= count ; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = a[i] + b[i];
+        }
+    }
+
+    void ComplexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm, const float* bRe, const float* bIm, size_t count) {
+        size_t i = 0;
+        for ( ; i + 8 <= count ; i += 8) {
+            const __m256 ar = _mm256_loadu_ps(aRe + i);
+            const __m256 ai = _mm256_loadu_ps(aIm + i);
+            const __m256 br = _mm256_loadu_ps(bRe + i);
+            const __m256 bi = _mm256_loadu_ps(bIm + i);
+            const __m256 re = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+            const __m256 im = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+            _mm256_storeu_ps(accRe + i, _mm256_add_ps(_mm256_loadu_ps(accRe + i), re));
+            _mm256_storeu_ps(accIm + i, _mm256_add_ps(_mm256_loadu_ps(accIm + i), im));
+        }
+        for ( ; i < count ; ++i) {
+            accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+            accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+        }
+    }
+
+    void Interleave8(const float* const* in, float* out, size_t frames) {
+        size_t i = 0;
+        for ( ; i + 8 <= frames ; i += 8) {
+            // 8x8の転置
+            const __m256 r0 = _mm256_loadu_ps(in[0] + i);
+            const __m256 r1 = _mm256_loadu_ps(in[1] + i);
+            const __m256 r2 = _mm256_loadu_ps(in[2] + i);
+            const __m256 r3 = _mm256_loadu_ps(in[3] + i);
+            const __m256 r4 = _mm256_loadu_ps(in[4] + i);
+            const __m256 r5 = _mm256_loadu_ps(in[5] + i);
+            const __m256 r6 = _mm256_loadu_ps(in[6] + i);
+            const __m256 r7 = _mm256_loadu_ps(in[7] + i);
+
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+            const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+            const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+            const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+            const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm256_storeu_ps(out + (i + 0) * 8, _mm256_permute2f128_ps(u0, u4, 0x20));
+            _mm256_storeu_ps(out + (i + 1) * 8, _mm256_permute2f128_ps(u1, u5, 0x20));
+            _mm256_storeu_ps(out + (i + 2) * 8, _mm256_permute2f128_ps(u2, u6, 0x20));
+            _mm256_storeu_ps(out + (i + 3) * 8, _mm256_permute2f128_ps(u3, u7, 0x20));
+            _mm256_storeu_ps(out + (i + 4) * 8, _mm256_permute2f128_ps(u0, u4, 0x31));
+            _mm256_storeu_ps(out + (i + 5) * 8, _mm256_permute2f128_ps(u1, u5, 0x31));
+            _mm256_storeu_ps(out + (i + 6) * 8, _mm256_permute2f128_ps(u2, u6, 0x31));
+            _mm256_storeu_ps(out + (i + 7) * 8, _mm256_permute2f128_ps(u3, u7, 0x31));
+        }
+        for ( ; i < frames ; ++i) {
+            for (size_t lane = 0 ; lane < 8 ; ++lane) {
+                out[i * 8 + lane] = in[lane][i];
+            }
+        }
+    }
+
+    void ReverseEnergySum8(const float* in, double* edc, size_t frames) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        for (size_t i = frames ; i-- > 0 ; ) {
+            const __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(in + i * 8));
+            const __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(in + i * 8 + 4));
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(lo, lo));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(hi, hi));
+            _mm256_storeu_pd(edc + i * 8, acc0);
+            _mm256_storeu_pd(edc + i * 8 + 4, acc1);
+        }
+    }
+
+    void BlockSumSquares(const float* in, size_t count, size_t blockSize, double* out) {
+        for (size_t offset = 0 ; offset < count ; offset += blockSize, ++out) {
+            const size_t end = (count - offset < blockSize) ? count : offset + blockSize;
+            size_t i = offset;
+            __m256d acc = _mm256_setzero_pd();
+            for ( ; i + 8 <= end ; i += 8) {
+                const __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(in + i));
+                const __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(in + i + 4));
+                acc = _mm256_add_pd(acc, _mm256_add_pd(_mm256_mul_pd(lo, lo), _mm256_mul_pd(hi, hi)));
+            }
+            const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+            double sum = _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+            for ( ; i < end ; ++i) {
+                sum += static_cast<double>(in[i]) * static_cast<double>(in[i]);
+            }
+            *out = sum;
+        }
+    }
+
+    void ReverseEnergySum8Float(const float* in, float* edc, size_t frames) {
+        // カハンの補償加算（8レーンで1レジスタ）
+        __m256 sum = _mm256_setzero_ps();
+        __m256 comp = _mm256_setzero_ps();
+        for (size_t i = frames ; i-- > 0 ; ) {
+            const __m256 x = _mm256_loadu_ps(in + i * 8);
+            const __m256 y = _mm256_sub_ps(_mm256_mul_ps(x, x), comp);
+            const __m256 t = _mm256_add_ps(sum, y);
+            comp = _mm256_sub_ps(_mm256_sub_ps(t, sum), y);
+            sum = t;
+            _mm256_storeu_ps(edc + i * 8, t);
+        }
+    }
+
+    /**
+     * @brief 4つのバタフライ（b に回転因子を掛けて a ± b）
+     */
+    void Butterfly4(__m128& ar, __m128& ai, __m128& br, __m128& bi, __m128 wr, __m128 wi) {
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+        br = _mm_sub_ps(ar, tr);
+        bi = _mm_sub_ps(ai, ti);
+        ar = _mm_add_ps(ar, tr);
+        ai = _mm_add_ps(ai, ti);
+    }
+
+    /**
+     * @brief 幅1・2の段を、8要素ずつ a と b に並べ替えてまとめて処理する
+     * @return 処理し終えた要素数（残りは呼び出し側がスカラーで処理する）
+     */
+    size_t FFTNarrowStage(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span) {
+        size_t s = 0;
+        if (span == 1) {
+            // [a0 b0 a1 b1] [a2 b2 a3 b3] → [a0 a1 a2 a3] [b0 b1 b2 b3]
+            const __m128 wr = _mm_set1_ps(wRe[0]);
+            const __m128 wi = _mm_set1_ps(wIm[0]);
+            for ( ; s + 8 <= count ; s += 8) {
+                const __m128 r0 = _mm_loadu_ps(re + s);
+                const __m128 r1 = _mm_loadu_ps(re + s + 4);
+                const __m128 i0 = _mm_loadu_ps(im + s);
+                const __m128 i1 = _mm_loadu_ps(im + s + 4);
+                __m128 ar = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 br = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1));
+                __m128 ai = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 bi = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(3, 1, 3, 1));
+                Butterfly4(ar, ai, br, bi, wr, wi);
+                _mm_storeu_ps(re + s, _mm_unpacklo_ps(ar, br));
+                _mm_storeu_ps(re + s + 4, _mm_unpackhi_ps(ar, br));
+                _mm_storeu_ps(im + s, _mm_unpacklo_ps(ai, bi));
+                _mm_storeu_ps(im + s + 4, _mm_unpackhi_ps(ai, bi));
+            }
+        }
+        else if (span == 2) {
+            // [a0 a1 b0 b1] [a2 a3 b2 b3] → [a0 a1 a2 a3] [b0 b1 b2 b3]
+            const __m128 wr = _mm_setr_ps(wRe[0], wRe[1], wRe[0], wRe[1]);
+            const __m128 wi = _mm_setr_ps(wIm[0], wIm[1], wIm[0], wIm[1]);
+            for ( ; s + 8 <= count ; s += 8) {
+                const __m128 r0 = _mm_loadu_ps(re + s);
+                const __m128 r1 = _mm_loadu_ps(re + s + 4);
+                const __m128 i0 = _mm_loadu_ps(im + s);
+                const __m128 i1 = _mm_loadu_ps(im + s + 4);
+                __m128 ar = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 0, 1, 0));
+                __m128 br = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 2, 3, 2));
+                __m128 ai = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(1, 0, 1, 0));
+                __m128 bi = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(3, 2, 3, 2));
+                Butterfly4(ar, ai, br, bi, wr, wi);
+                _mm_storeu_ps(re + s, _mm_shuffle_ps(ar, br, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(re + s + 4, _mm_shuffle_ps(ar, br, _MM_SHUFFLE(3, 2, 3, 2)));
+                _mm_storeu_ps(im + s, _mm_shuffle_ps(ai, bi, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(im + s + 4, _mm_shuffle_ps(ai, bi, _MM_SHUFFLE(3, 2, 3, 2)));
+            }
+        }
+        return s;
+    }
+
+    void FFTButterflyStage(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span) {
+        for (size_t s = FFTNarrowStage(re, im, wRe, wIm, count, span) ; s < count ; s += 2 * span) {
+            float* ar = re + s;
+            float* ai = im + s;
+            float* br = ar + span;
+            float* bi = ai + span;
+
+            size_t j = 0;
+            for ( ; j + 8 <= span ; j += 8) {
+                const __m256 xr = _mm256_loadu_ps(br + j);
+                const __m256 xi = _mm256_loadu_ps(bi + j);
+                const __m256 wr = _mm256_loadu_ps(wRe + j);
+                const __m256 wi = _mm256_loadu_ps(wIm + j);
+                const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(xr, wr), _mm256_mul_ps(xi, wi));
+                const __m256 ti = _mm256_add_ps(_mm256_mul_ps(xr, wi), _mm256_mul_ps(xi, wr));
+                const __m256 yr = _mm256_loadu_ps(ar + j);
+                const __m256 yi = _mm256_loadu_ps(ai + j);
+                _mm256_storeu_ps(br + j, _mm256_sub_ps(yr, tr));
+                _mm256_storeu_ps(bi + j, _mm256_sub_ps(yi, ti));
+                _mm256_storeu_ps(ar + j, _mm256_add_ps(yr, tr));
+                _mm256_storeu_ps(ai + j, _mm256_add_ps(yi, ti));
+            }
+            // 幅4の段
+            for ( ; j + 4 <= span ; j += 4) {
+                const __m128 xr = _mm_loadu_ps(br + j);
+                const __m128 xi = _mm_loadu_ps(bi + j);
+                const __m128 wr = _mm_loadu_ps(wRe + j);
+                const __m128 wi = _mm_loadu_ps(wIm + j);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                const __m128 yr = _mm_loadu_ps(ar + j);
+                const __m128 yi = _mm_loadu_ps(ai + j);
+                _mm_storeu_ps(br + j, _mm_sub_ps(yr, tr));
+                _mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+                _mm_storeu_ps(ar + j, _mm_add_ps(yr, tr));
+                _mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+            }
+            for ( ; j < span ; ++j) {
+                const float tr = br[j] * wRe[j] - bi[j] * wIm[j];
+                const float ti = br[j] * wIm[j] + bi[j] * wRe[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] = ar[j] + tr;
+                ai[j] = ai[j] + ti;
+            }
+        }
+    }
+
+    /**
+     * @brief 8要素の順番を逆にする
+     */
+    __m256 Reverse8(__m256 x) {
+        return _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    void RealFFTForwardPost(float* re, float* im, const float* wRe, const float* wIm, size_t half) {
+        size_t k = 1;
+        const __m256 plusHalf = _mm256_set1_ps(0.5f);
+        const __m256 minusHalf = _mm256_set1_ps(-0.5f);
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        for ( ; 2 * (k + 7) < half ; k += 8) {
+            const size_t m = half - k - 7;
+            const __m256 kr = _mm256_loadu_ps(re + k);
+            const __m256 ki = _mm256_loadu_ps(im + k);
+            const __m256 mr = Reverse8(_mm256_loadu_ps(re + m));
+            const __m256 mi = Reverse8(_mm256_loadu_ps(im + m));
+            const __m256 er = _mm256_mul_ps(plusHalf, _mm256_add_ps(kr, mr));
+            const __m256 ei = _mm256_mul_ps(plusHalf, _mm256_sub_ps(ki, mi));
+            const __m256 or_ = _mm256_mul_ps(plusHalf, _mm256_add_ps(ki, mi));
+            const __m256 oi = _mm256_mul_ps(minusHalf, _mm256_sub_ps(kr, mr));
+
+            const __m256 wr = _mm256_loadu_ps(wRe + k);
+            const __m256 wi = _mm256_loadu_ps(wIm + k);
+            const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(wr, or_), _mm256_mul_ps(wi, oi));
+            const __m256 ti = _mm256_add_ps(_mm256_mul_ps(wr, oi), _mm256_mul_ps(wi, or_));
+
+            _mm256_storeu_ps(re + k, _mm256_add_ps(er, tr));
+            _mm256_storeu_ps(im + k, _mm256_add_ps(ei, ti));
+            _mm256_storeu_ps(re + m, Reverse8(_mm256_sub_ps(er, tr)));
+            _mm256_storeu_ps(im + m, Reverse8(_mm256_xor_ps(_mm256_sub_ps(ei, ti), sign)));
+        }
+        for ( ; k <= half / 2 ; ++k) {
+            const size_t m = half - k;
+            const float er = 0.5f * (re[k] + re[m]);
+            const float ei = 0.5f * (im[k] - im[m]);
+            const float or_ = 0.5f * (im[k] + im[m]);
+            const float oi = -0.5f * (re[k] - re[m]);
+
+            const float tr = wRe[k] * or_ - wIm[k] * oi;
+            const float ti = wRe[k] * oi + wIm[k] * or_;
+
+            re[k] = er + tr;
+            im[k] = ei + ti;
+            re[m] = er - tr;
+            im[m] = -(ei - ti);
+        }
+    }
+
+    void RealFFTInversePre(const float* re, const float* im, float* zRe, float* zIm, const float* wRe, const float* wIm, size_t half) {
+        size_t k = 1;
+        const __m256 plusHalf = _mm256_set1_ps(0.5f);
+        for ( ; 2 * (k + 7) < half ; k += 8) {
+            const size_t m = half - k - 7;
+            const __m256 kr = _mm256_loadu_ps(re + k);
+            const __m256 ki = _mm256_loadu_ps(im + k);
+            const __m256 mr = Reverse8(_mm256_loadu_ps(re + m));
+            const __m256 mi = Reverse8(_mm256_loadu_ps(im + m));
+            const __m256 er = _mm256_mul_ps(plusHalf, _mm256_add_ps(kr, mr));
+            const __m256 ei = _mm256_mul_ps(plusHalf, _mm256_sub_ps(ki, mi));
+            const __m256 dr = _mm256_mul_ps(plusHalf, _mm256_sub_ps(kr, mr));
+            const __m256 di = _mm256_mul_ps(plusHalf, _mm256_add_ps(ki, mi));
+
+            const __m256 wr = _mm256_loadu_ps(wRe + k);
+            const __m256 wi = _mm256_loadu_ps(wIm + k);
+            const __m256 or_ = _mm256_add_ps(_mm256_mul_ps(dr, wr), _mm256_mul_ps(di, wi));
+            const __m256 oi = _mm256_sub_ps(_mm256_mul_ps(di, wr), _mm256_mul_ps(dr, wi));
+
+            _mm256_storeu_ps(zRe + k, _mm256_sub_ps(er, oi));
+            _mm256_storeu_ps(zIm + k, _mm256_add_ps(ei, or_));
+            _mm256_storeu_ps(zRe + m, Reverse8(_mm256_add_ps(er, oi)));
+            _mm256_storeu_ps(zIm + m, Reverse8(_mm256_sub_ps(or_, ei)));
+        }
+        for ( ; k <= half / 2 ; ++k) {
+            const size_t m = half - k;
+            const float er = 0.5f * (re[k] + re[m]);
+            const float ei = 0.5f * (im[k] - im[m]);
+            const float dr = 0.5f * (re[k] - re[m]);
+            const float di = 0.5f * (im[k] + im[m]);
+
+            const float or_ = dr * wRe[k] + di * wIm[k];
+            const float oi = di * wRe[k] - dr * wIm[k];
+
+            zRe[k] = er - oi;
+            zIm[k] = ei + or_;
+            zRe[m] = er + oi;
+            zIm[m] = or_ - ei;
+        }
+    }
+
+    const SimdKernelTable s_avx2 = {
+        SimdLevel::AVX2,
+        MixDryWet,
+        Deinterleave2,
+        Interleave2,
+        Multiply,
+        SelectLess,
+        SquareToDouble,
+        SumSquares,
+        Add,
+        ComplexMultiplyAccumulate,
+        Interleave8,
+        ReverseEnergySum8,
+        BlockSumSquares,
+        ReverseEnergySum8Float,
+        FFTButterflyStage,
+        RealFFTForwardPost,
+        RealFFTInversePre,
+    };
+}
+
+const SimdKernelTable* SimdKernelTableAVX2() {
+    return &s_avx2;
+}
+
+# else
+
+const SimdKernelTable* SimdKernelTableAVX2() {
+    return nullptr;
+}
+
+# endif
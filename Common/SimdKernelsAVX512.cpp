@@ -0,0 +1,483 @@
+/**
+ *  @file SimdKernelsAVX512.cpp
+ *  @author Goto Kenta
+ *  @brief AVX-512用のSIMDカーネル（このファイルだけ -mavx512f / /arch:AVX512 でコンパイルする）
+ *  @note AVX-512FだけでSkylake-X以降とZen 4の両方で動く。インライン関数の扱いは SimdKernelsAVX2.cpp と同じ
+ */
+
+# include "SimdDispatch.h"
+
+# if defined(__AVX512F__)
+
+# include <immintrin.h>
+
+namespace {
+    // GCC 12 の _mm512_cvtps_pd・_mm512_reduce_add_pd・_mm512_insertf64x4・_mm512_permutexvar_ps・256bitとのキャストは _mm512_undefined_pd などを経由し、
+    // -Wall で -Wmaybe-uninitialized が出るので、0で埋める版（maskz 付き）の組み合わせで書く
+
+    /**
+     * @brief 8サンプルを読み込んでdoubleにする
+     */
+    __m512d LoadDouble(const float* in) {
+        return _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(in));
+    }
+
+    /**
+     * @brief 8レーンの総和（_mm512_reduce_add_pd と同じ順番で足す）
+     */
+    double ReduceAdd(__m512d v) {
+        const __m256d half = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, v, 1), _mm512_maskz_extractf64x4_pd(0xF, v, 0));
+        const __m128d quarter = _mm_add_pd(_mm256_extractf128_pd(half, 1), _mm256_castpd256_pd128(half));
+        return _mm_cvtsd_f64(_mm_add_sd(quarter, _mm_unpackhi_pd(quarter, quarter)));
+    }
+
+    void MixDryWet(const float* dry, const float* wet, float* out, size_t count, float dryGain, float wetGain, float volume) {
+        size_t i = 0;
+        const __m512 d = _mm512_set1_ps(dryGain);
+        const __m512 w = _mm512_set1_ps(wetGain);
+        const __m512 v = _mm512_set1_ps(volume);
+        for ( ; i + 16 <= count ; i += 16) {
+            const __m512 x = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(dry + i), d), _mm512_mul_ps(_mm512_loadu_ps(wet + i), w));
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(x, v));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = (dry[i] * dryGain + wet[i] * wetGain) * volume;
+        }
+    }
+
+    void Deinterleave2(const float* in, float* left, float* right, size_t frames) {
+        size_t i = 0;
+        const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        for ( ; i + 16 <= frames ; i += 16) {
+            const __m512 a = _mm512_loadu_ps(in + 2 * i);
+            const __m512 b = _mm512_loadu_ps(in + 2 * i + 16);
+            _mm512_storeu_ps(left + i, _mm512_permutex2var_ps(a, even, b));
+            _mm512_storeu_ps(right + i, _mm512_permutex2var_ps(a, odd, b));
+        }
+        for ( ; i < frames ; ++i) {
+            left[i] = in[2 * i];
+            right[i] = in[2 * i + 1];
+        }
+    }
+
+    void Interleave2(const float* left, const float* right, float* out, size_t frames) {
+        size_t i = 0;
+        const __m512i lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        for ( ; i + 16 <= frames ; i += 16) {
+            const __m512 l = _mm512_loadu_ps(left + i);
+            const __m512 r = _mm512_loadu_ps(right + i);
+            _mm512_storeu_ps(out + 2 * i, _mm512_permutex2var_ps(l, lo, r));
+            _mm512_storeu_ps(out + 2 * i + 16, _mm512_permutex2var_ps(l, hi, r));
+        }
+        for ( ; i < frames ; ++i) {
+            out[2 * i] = left[i];
+            out[2 * i + 1] = right[i];
+        }
+    }
+
+    void Multiply(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+        for ( ; i + 16 <= count ; i += 16) {
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    void SelectLess(const float* r, float threshold, const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+        const __m512 t = _mm512_set1_ps(threshold);
+        for ( ; i + 16 <= count ; i += 16) {
+            const __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(r + i), t, _CMP_LT_OQ);
+            _mm512_storeu_ps(out + i, _mm512_mask_blend_ps(mask, _mm512_loadu_ps(b + i), _mm512_loadu_ps(a + i)));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = (r[i] < threshold) ? a[i] : b[i];
+        }
+    }
+
+    void SquareToDouble(const float* in, double* out, size_t count) {
+        size_t i = 0;
+        for ( ; i + 16 <= count ; i += 16) {
+            const __m512d lo = LoadDouble(in + i);
+            const __m512d hi = LoadDouble(in + i + 8);
+            _mm512_storeu_pd(out + i, _mm512_mul_pd(lo, lo));
+            _mm512_storeu_pd(out + i + 8, _mm512_mul_pd(hi, hi));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = static_cast<double>(in[i]) * static_cast<double>(in[i]);
+        }
+    }
+
+    double SumSquares(const float* in, size_t count) {
+        size_t i = 0;
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        for ( ; i + 16 <= count ; i += 16) {
+            const __m512d lo = LoadDouble(in + i);
+            const __m512d hi = LoadDouble(in + i + 8);
+            acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(lo, lo));
+            acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(hi, hi));
+        }
+        double sum = ReduceAdd(_mm512_add_pd(acc0, acc1));
+        for ( ; i < count ; ++i) {
+            sum += static_cast<double>(in[i]) * static_cast<double>(in[i]);
+        }
+        return sum;
+    }
+
+    void Add(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+        for ( ; i + 16 <= count ; i += 16) {
+            _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        }
+        for ( ; i < count ; ++i) {
+            out[i] = a[i] + b[i];
+        }
+    }
+
+    void ComplexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm, const float* bRe, const float* bIm, size_t count) {
+        size_t i = 0;
+        for ( ; i + 16 <= count ; i += 16) {
+            const __m512 ar = _mm512_loadu_ps(aRe + i);
+            const __m512 ai = _mm512_loadu_ps(aIm + i);
+            const __m512 br = _mm512_loadu_ps(bRe + i);
+            const __m512 bi = _mm512_loadu_ps(bIm + i);
+            const __m512 re = _mm512_sub_ps(_mm512_mul_ps(ar, br), _mm512_mul_ps(ai, bi));
+            const __m512 im = _mm512_add_ps(_mm512_mul_ps(ar, bi), _mm512_mul_ps(ai, br));
+            _mm512_storeu_ps(accRe + i, _mm512_add_ps(_mm512_loadu_ps(accRe + i), re));
+            _mm512_storeu_ps(accIm + i, _mm512_add_ps(_mm512_loadu_ps(accIm + i), im));
+        }
+        for ( ; i < count ; ++i) {
+            accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+            accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+        }
+    }
+
+    /**
+     * @brief 2本の信号の8サンプルを1つのレジスタに読み込む（下位が a、上位が b）
+     */
+    __m512 LoadPair(const float* a, const float* b) {
+        const __m512d lo = _mm512_maskz_insertf64x4(0xFF, _mm512_setzero_pd(), _mm256_castps_pd(_mm256_loadu_ps(a)), 0);
+        return _mm512_castpd_ps(_mm512_maskz_insertf64x4(0xFF, lo, _mm256_castps_pd(_mm256_loadu_ps(b)), 1));
+    }
+
+    void Interleave8(const float* const* in, float* out, size_t frames) {
+        size_t i = 0;
+        // 出力の位置 p には信号 p % 4（上位4レーンは +4）のサンプル p / 8 を集める
+        const __m512i base = _mm512_setr_epi32(0, 8, 16, 24, 0, 8, 16, 24, 1, 9, 17, 25, 1, 9, 17, 25);
+        for ( ; i + 8 <= frames ; i += 8) {
+            const __m512 r01 = LoadPair(in[0] + i, in[1] + i);
+            const __m512 r23 = LoadPair(in[2] + i, in[3] + i);
+            const __m512 r45 = LoadPair(in[4] + i, in[5] + i);
+            const __m512 r67 = LoadPair(in[6] + i, in[7] + i);
+            for (int k = 0 ; k < 4 ; ++k) {
+                const __m512i index = _mm512_add_epi32(base, _mm512_set1_epi32(2 * k));
+                const __m512 lower = _mm512_permutex2var_ps(r01, index, r23);
+                const __m512 upper = _mm512_permutex2var_ps(r45, index, r67);
+                _mm512_storeu_ps(out + (i + 2 * k) * 8, _mm512_mask_blend_ps(0xF0F0, lower, upper));
+            }
+        }
+        for ( ; i < frames ; ++i) {
+            for (size_t lane = 0 ; lane < 8 ; ++lane) {
+                out[i * 8 + lane] = in[lane][i];
+            }
+        }
+    }
+
+    void ReverseEnergySum8(const float* in, double* edc, size_t frames) {
+        __m512d acc = _mm512_setzero_pd();
+        for (size_t i = frames ; i-- > 0 ; ) {
+            const __m512d x = LoadDouble(in + i * 8);
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+            _mm512_storeu_pd(edc + i * 8, acc);
+        }
+    }
+
+    void BlockSumSquares(const float* in, size_t count, size_t blockSize, double* out) {
+        for (size_t offset = 0 ; offset < count ; offset += blockSize, ++out) {
+            const size_t end = (count - offset < blockSize) ? count : offset + blockSize;
+            size_t i = offset;
+            __m512d acc = _mm512_setzero_pd();
+            for ( ; i + 8 <= end ; i += 8) {
+                const __m512d x = LoadDouble(in + i);
+                acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+            }
+            double sum = ReduceAdd(acc);
+            for ( ; i < end ; ++i) {
+                sum += static_cast<double>(in[i]) * static_cast<double>(in[i]);
+            }
+            *out = sum;
+        }
+    }
+
+    void ReverseEnergySum8Float(const float* in, float* edc, size_t frames) {
+        // カハンの補償加算（8レーンで1レジスタ）
+        __m256 sum = _mm256_setzero_ps();
+        __m256 comp = _mm256_setzero_ps();
+        for (size_t i = frames ; i-- > 0 ; ) {
+            const __m256 x = _mm256_loadu_ps(in + i * 8);
+            const __m256 y = _mm256_sub_ps(_mm256_mul_ps(x, x), comp);
+            const __m256 t = _mm256_add_ps(sum, y);
+            comp = _mm256_sub_ps(_mm256_sub_ps(t, sum), y);
+            sum = t;
+            _mm256_storeu_ps(edc + i * 8, t);
+        }
+    }
+
+    /**
+     * @brief 4つのバタフライ（b に回転因子を掛けて a ± b）
+     */
+    void Butterfly4(__m128& ar, __m128& ai, __m128& br, __m128& bi, __m128 wr, __m128 wi) {
+        const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+        const __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+        br = _mm_sub_ps(ar, tr);
+        bi = _mm_sub_ps(ai, ti);
+        ar = _mm_add_ps(ar, tr);
+        ai = _mm_add_ps(ai, ti);
+    }
+
+    /**
+     * @brief 幅1・2の段を、8要素ずつ a と b に並べ替えてまとめて処理する
+     * @return 処理し終えた要素数（残りは呼び出し側がスカラーで処理する）
+     */
+    size_t FFTNarrowStage(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span) {
+        size_t s = 0;
+        if (span == 1) {
+            // [a0 b0 a1 b1] [a2 b2 a3 b3] → [a0 a1 a2 a3] [b0 b1 b2 b3]
+            const __m128 wr = _mm_set1_ps(wRe[0]);
+            const __m128 wi = _mm_set1_ps(wIm[0]);
+            for ( ; s + 8 <= count ; s += 8) {
+                const __m128 r0 = _mm_loadu_ps(re + s);
+                const __m128 r1 = _mm_loadu_ps(re + s + 4);
+                const __m128 i0 = _mm_loadu_ps(im + s);
+                const __m128 i1 = _mm_loadu_ps(im + s + 4);
+                __m128 ar = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 br = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1));
+                __m128 ai = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 bi = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(3, 1, 3, 1));
+                Butterfly4(ar, ai, br, bi, wr, wi);
+                _mm_storeu_ps(re + s, _mm_unpacklo_ps(ar, br));
+                _mm_storeu_ps(re + s + 4, _mm_unpackhi_ps(ar, br));
+                _mm_storeu_ps(im + s, _mm_unpacklo_ps(ai, bi));
+                _mm_storeu_ps(im + s + 4, _mm_unpackhi_ps(ai, bi));
+            }
+        }
+        else if (span == 2) {
+            // [a0 a1 b0 b1] [a2 a3 b2 b3] → [a0 a1 a2 a3] [b0 b1 b2 b3]
+            const __m128 wr = _mm_setr_ps(wRe[0], wRe[1], wRe[0], wRe[1]);
+            const __m128 wi = _mm_setr_ps(wIm[0], wIm[1], wIm[0], wIm[1]);
+            for ( ; s + 8 <= count ; s += 8) {
+                const __m128 r0 = _mm_loadu_ps(re + s);
+                const __m128 r1 = _mm_loadu_ps(re + s + 4);
+                const __m128 i0 = _mm_loadu_ps(im + s);
+                const __m128 i1 = _mm_loadu_ps(im + s + 4);
+                __m128 ar = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 0, 1, 0));
+                __m128 br = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 2, 3, 2));
+                __m128 ai = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(1, 0, 1, 0));
+                __m128 bi = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(3, 2, 3, 2));
+                Butterfly4(ar, ai, br, bi, wr, wi);
+                _mm_storeu_ps(re + s, _mm_shuffle_ps(ar, br, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(re + s + 4, _mm_shuffle_ps(ar, br, _MM_SHUFFLE(3, 2, 3, 2)));
+                _mm_storeu_ps(im + s, _mm_shuffle_ps(ai, bi, _MM_SHUFFLE(1, 0, 1, 0)));
+                _mm_storeu_ps(im + s + 4, _mm_shuffle_ps(ai, bi, _MM_SHUFFLE(3, 2, 3, 2)));
+            }
+        }
+        return s;
+    }
+
+    void FFTButterflyStage(float* re, float* im, const float* wRe, const float* wIm, size_t count, size_t span) {
+        for (size_t s = FFTNarrowStage(re, im, wRe, wIm, count, span) ; s < count ; s += 2 * span) {
+            float* ar = re + s;
+            float* ai = im + s;
+            float* br = ar + span;
+            float* bi = ai + span;
+
+            size_t j = 0;
+            for ( ; j + 16 <= span ; j += 16) {
+                const __m512 xr = _mm512_loadu_ps(br + j);
+                const __m512 xi = _mm512_loadu_ps(bi + j);
+                const __m512 wr = _mm512_loadu_ps(wRe + j);
+                const __m512 wi = _mm512_loadu_ps(wIm + j);
+                const __m512 tr = _mm512_sub_ps(_mm512_mul_ps(xr, wr), _mm512_mul_ps(xi, wi));
+                const __m512 ti = _mm512_add_ps(_mm512_mul_ps(xr, wi), _mm512_mul_ps(xi, wr));
+                const __m512 yr = _mm512_loadu_ps(ar + j);
+                const __m512 yi = _mm512_loadu_ps(ai + j);
+                _mm512_storeu_ps(br + j, _mm512_sub_ps(yr, tr));
+                _mm512_storeu_ps(bi + j, _mm512_sub_ps(yi, ti));
+                _mm512_storeu_ps(ar + j, _mm512_add_ps(yr, tr));
+                _mm512_storeu_ps(ai + j, _mm512_add_ps(yi, ti));
+            }
+            // 幅8の段
+            for ( ; j + 8 <= span ; j += 8) {
+                const __m256 xr = _mm256_loadu_ps(br + j);
+                const __m256 xi = _mm256_loadu_ps(bi + j);
+                const __m256 wr = _mm256_loadu_ps(wRe + j);
+                const __m256 wi = _mm256_loadu_ps(wIm + j);
+                const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(xr, wr), _mm256_mul_ps(xi, wi));
+                const __m256 ti = _mm256_add_ps(_mm256_mul_ps(xr, wi), _mm256_mul_ps(xi, wr));
+                const __m256 yr = _mm256_loadu_ps(ar + j);
+                const __m256 yi = _mm256_loadu_ps(ai + j);
+                _mm256_storeu_ps(br + j, _mm256_sub_ps(yr, tr));
+                _mm256_storeu_ps(bi + j, _mm256_sub_ps(yi, ti));
+                _mm256_storeu_ps(ar + j, _mm256_add_ps(yr, tr));
+                _mm256_storeu_ps(ai + j, _mm256_add_ps(yi, ti));
+            }
+            // 幅4の段
+            for ( ; j + 4 <= span ; j += 4) {
+                const __m128 xr = _mm_loadu_ps(br + j);
+                const __m128 xi = _mm_loadu_ps(bi + j);
+                const __m128 wr = _mm_loadu_ps(wRe + j);
+                const __m128 wi = _mm_loadu_ps(wIm + j);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                const __m128 yr = _mm_loadu_ps(ar + j);
+                const __m128 yi = _mm_loadu_ps(ai + j);
+                _mm_storeu_ps(br + j, _mm_sub_ps(yr, tr));
+                _mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+                _mm_storeu_ps(ar + j, _mm_add_ps(yr, tr));
+                _mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+            }
+            for ( ; j < span ; ++j) {
+                const float tr = br[j] * wRe[j] - bi[j] * wIm[j];
+                const float ti = br[j] * wIm[j] + bi[j] * wRe[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] = ar[j] + tr;
+                ai[j] = ai[j] + ti;
+            }
+        }
+    }
+
+    /**
+     * @brief 16要素の順番を逆にする
+     */
+    __m512 Reverse16(__m512 x) {
+        return _mm512_maskz_permutexvar_ps(0xFFFF, _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), x);
+    }
+
+    /**
+     * @brief 符号を反転する（_mm512_xor_ps は AVX-512DQ なので整数のxorで行う）
+     */
+    __m512 Negate(__m512 x) {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), _mm512_set1_epi32(static_cast<int>(0x80000000u))));
+    }
+
+    void RealFFTForwardPost(float* re, float* im, const float* wRe, const float* wIm, size_t half) {
+        size_t k = 1;
+        const __m512 plusHalf = _mm512_set1_ps(0.5f);
+        const __m512 minusHalf = _mm512_set1_ps(-0.5f);
+        for ( ; 2 * (k + 15) < half ; k += 16) {
+            const size_t m = half - k - 15;
+            const __m512 kr = _mm512_loadu_ps(re + k);
+            const __m512 ki = _mm512_loadu_ps(im + k);
+            const __m512 mr = Reverse16(_mm512_loadu_ps(re + m));
+            const __m512 mi = Reverse16(_mm512_loadu_ps(im + m));
+            const __m512 er = _mm512_mul_ps(plusHalf, _mm512_add_ps(kr, mr));
+            const __m512 ei = _mm512_mul_ps(plusHalf, _mm512_sub_ps(ki, mi));
+            const __m512 or_ = _mm512_mul_ps(plusHalf, _mm512_add_ps(ki, mi));
+            const __m512 oi = _mm512_mul_ps(minusHalf, _mm512_sub_ps(kr, mr));
+
+            const __m512 wr = _mm512_loadu_ps(wRe + k);
+            const __m512 wi = _mm512_loadu_ps(wIm + k);
+            const __m512 tr = _mm512_sub_ps(_mm512_mul_ps(wr, or_), _mm512_mul_ps(wi, oi));
+            const __m512 ti = _mm512_add_ps(_mm512_mul_ps(wr, oi), _mm512_mul_ps(wi, or_));
+
+            _mm512_storeu_ps(re + k, _mm512_add_ps(er, tr));
+            _mm512_storeu_ps(im + k, _mm512_add_ps(ei, ti));
+            _mm512_storeu_ps(re + m, Reverse16(_mm512_sub_ps(er, tr)));
+            _mm512_storeu_ps(im + m, Reverse16(Negate(_mm512_sub_ps(ei, ti))));
+        }
+        for ( ; k <= half / 2 ; ++k) {
+            const size_t m = half - k;
+            const float er = 0.5f * (re[k] + re[m]);
+            const float ei = 0.5f * (im[k] - im[m]);
+            const float or_ = 0.5f * (im[k] + im[m]);
+            const float oi = -0.5f * (re[k] - re[m]);
+
+            const float tr = wRe[k] * or_ - wIm[k] * oi;
+            const float ti = wRe[k] * oi + wIm[k] * or_;
+
+            re[k] = er + tr;
+            im[k] = ei + ti;
+            re[m] = er - tr;
+            im[m] = -(ei - ti);
+        }
+    }
+
+    void RealFFTInversePre(const float* re, const float* im, float* zRe, float* zIm, const float* wRe, const float* wIm, size_t half) {
+        size_t k = 1;
+        const __m512 plusHalf = _mm512_set1_ps(0.5f);
+        for ( ; 2 * (k + 15) < half ; k += 16) {
+            const size_t m = half - k - 15;
+            const __m512 kr = _mm512_loadu_ps(re + k);
+            const __m512 ki = _mm512_loadu_ps(im + k);
+            const __m512 mr = Reverse16(_mm512_loadu_ps(re + m));
+            const __m512 mi = Reverse16(_mm512_loadu_ps(im + m));
+            const __m512 er = _mm512_mul_ps(plusHalf, _mm512_add_ps(kr, mr));
+            const __m512 ei = _mm512_mul_ps(plusHalf, _mm512_sub_ps(ki, mi));
+            const __m512 dr = _mm512_mul_ps(plusHalf, _mm512_sub_ps(kr, mr));
+            const __m512 di = _mm512_mul_ps(plusHalf, _mm512_add_ps(ki, mi));
+
+            const __m512 wr = _mm512_loadu_ps(wRe + k);
+            const __m512 wi = _mm512_loadu_ps(wIm + k);
+            const __m512 or_ = _mm512_add_ps(_mm512_mul_ps(dr, wr), _mm512_mul_ps(di, wi));
+            const __m512 oi = _mm512_sub_ps(_mm512_mul_ps(di, wr), _mm512_mul_ps(dr, wi));
+
+            _mm512_storeu_ps(zRe + k, _mm512_sub_ps(er, oi));
+            _mm512_storeu_ps(zIm + k, _mm512_add_ps(ei, or_));
+            _mm512_storeu_ps(zRe + m, Reverse16(_mm512_add_ps(er, oi)));
+            _mm512_storeu_ps(zIm + m, Reverse16(_mm512_sub_ps(or_, ei)));
+        }
+        for ( ; k <= half / 2 ; ++k) {
+            const size_t m = half - k;
+            const float er = 0.5f * (re[k] + re[m]);
+            const float ei = 0.5f * (im[k] - im[m]);
+            const float dr = 0.5f * (re[k] - re[m]);
+            const float di = 0.5f * (im[k] + im[m]);
+
+            const float or_ = dr * wRe[k] + di * wIm[k];
+            const float oi = di * wRe[k] - dr * wIm[k];
+
+            zRe[k] = er - oi;
+            zIm[k] = ei + or_;
+            zRe[m] = er + oi;
+            zIm[m] = or_ - ei;
+        }
+    }
+
+    const SimdKernelTable s_avx512 = {
+        SimdLevel::AVX512,
+        MixDryWet,
+        Deinterleave2,
+        Interleave2,
+        Multiply,
+        SelectLess,
+        SquareToDouble,
+        SumSquares,
+        Add,
+        ComplexMultiplyAccumulate,
+        Interleave8,
+        ReverseEnergySum8,
+        BlockSumSquares,
+        ReverseEnergySum8Float,
+        FFTButterflyStage,
+        RealFFTForwardPost,
+        RealFFTInversePre,
+    };
+}
+
+const SimdKernelTable* SimdKernelTableAVX512() {
+    return &s_avx512;
+}
+
+# else
+
+const SimdKernelTable* SimdKernelTableAVX512() {
+    return nullptr;
+}
+
+# endif
@@ -0,0 +1,173 @@
+/**
+ *  @file WorkerPool.h
+ *  @author Goto Kenta
+ *  @brief プラグイン間で共有するバックグラウンド処理用のスレッドプール
+ */
+
+# pragma once
+
+# include <algorithm>
+# include <atomic>
+# include <condition_variable>
+# include <deque>
+# include <functional>
+# include <future>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+/**
+ * @brief IR生成などの重い処理をミキサースレッドの外で実行するスレッドプール
+ * @note Shared() はモジュールごとに1つなので、全エフェクトを1つのライブラリにまとめると
+ *       すべてのインスタンスが同じワーカーを使う。スレッドは最初のジョブで起動する
+ */
+class WorkerPool {
+    static constexpr int kQueued = 0;    // キューで待っている
+    static constexpr int kStarted = 1;   // ワーカーが実行を始めた
+    static constexpr int kCancelled = 2; // 始まる前に取り消された
+
+public:
+    /**
+     * @brief Submit で投入したジョブのハンドル
+     */
+    class Job {
+    public:
+        Job() = default;
+
+        /**
+         * @brief 取り消されておらず、待つ対象があるか
+         */
+        bool valid() const { return m_done.valid(); }
+
+        /**
+         * @brief まだ始まっていなければ取り消す（ワーカーはキューから取り出しても実行しない）
+         * @return 取り消せたら true（ハンドルは空になるので wait は待たない）。実行中・完了済みなら false
+         * @note 待たずに戻るので、共有プールで他のプラグインのジョブの後ろに並んでいてもブロックしない
+         */
+        bool cancel() {
+            if (!m_state) {
+                return false;
+            }
+            int expected = kQueued;
+            if (!m_state->compare_exchange_strong(expected, kCancelled, std::memory_order_acq_rel)) {
+                return false;
+            }
+            m_state.reset();
+            m_done = std::future<void>();
+            return true;
+        }
+
+        /**
+         * @brief 完了を待つ（取り消したジョブは待たない）
+         */
+        void wait() const {
+            if (m_done.valid()) {
+                m_done.wait();
+            }
+        }
+
+    private:
+        friend class WorkerPool;
+
+        Job(std::shared_ptr<std::atomic<int>> state, std::future<void> done) : m_state(std::move(state)), m_done(std::move(done)) { }
+
+        std::shared_ptr<std::atomic<int>> m_state;
+        std::future<void> m_done;
+    };
+
+    /**
+     * @brief モジュール全体で共有するプールを取得する
+     */
+    static WorkerPool& Shared() {
+        static WorkerPool pool(DefaultThreadCount());
+        return pool;
+    }
+
+    /**
+     * @brief 使うスレッド数の既定値（ミキサーとAPIスレッドの分を残す）
+     */
+    static unsigned int DefaultThreadCount() {
+        const unsigned int hw = std::thread::hardware_concurrency();
+        return std::clamp(hw > 2 ? hw - 2 : 1u, 1u, 4u);
+    }
+
+    /**
+     * @param numThreads ワーカースレッドの数
+     */
+    explicit WorkerPool(unsigned int numThreads) : m_numThreads(std::max(numThreads, 1u)) { }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief ジョブを投入する
+     * @param job 実行する処理
+     * @return 完了を待つ・始まる前に取り消すためのハンドル
+     */
+    Job Submit(std::function<void()> job) {
+        auto task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+        auto state = std::make_shared<std::atomic<int>>(kQueued);
+        Job handle(state, task->get_future());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_workers.empty()) {
+                for (unsigned int i = 0 ; i < m_numThreads ; ++i) {
+                    m_workers.emplace_back([this] { Run(); });
+                }
+            }
+            m_queue.emplace_back([task, state] {
+                // 取り消されたジョブは実行しない（呼び出し側はもう待っていない）
+                int expected = kQueued;
+                if (state->compare_exchange_strong(expected, kStarted, std::memory_order_acq_rel)) {
+                    (*task)();
+                }
+            });
+        }
+        m_wake.notify_one();
+        return handle;
+    }
+
+    /**
+     * @brief ワーカースレッドの数
+     */
+    unsigned int ThreadCount() const { return m_numThreads; }
+
+private:
+    /**
+     * @brief ワーカースレッドの本体
+     */
+    void Run() {
+        for ( ;; ) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty()) {
+                    return;
+                }
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            job();
+        }
+    }
+
+    const unsigned int m_numThreads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_queue;
+    std::vector<std::thread> m_workers;
+    bool m_stopping = false;
+};
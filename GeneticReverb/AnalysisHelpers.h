@@ -6,6 +6,9 @@
 # include <algorithm>
 # include <iostream>
 
+# include "../Common/PartitionedIR.h"
+# include "../Common/SimdDispatch.h"
+
 /**
  * @brief シュレーダーの残響曲線を計算する関数
  * @param ir インパルス応答のベクトル
@@ -20,9 +23,7 @@ inline std::vector<float> calculateSchroederDecay(const std::vector<float>& ir)
     std::vector<double> edc(n);
 
     // 各サンプルのエネルギーを計算
-    for (size_t i = 0 ; i < n ; ++i) {
-        edc[i] = static_cast<double>(ir[i]) * static_cast<double>(ir[i]);
-    }
+    SimdKernels().squareToDouble(ir.data(), edc.data(), n);
 
     // 逆順に累積和を計算する
     std::reverse(edc.begin(), edc.end());
@@ -125,22 +126,278 @@ inline float calculateEDT(const std::vector<float>& edc_dB, float sampleRate) {
 inline float calculateC80(const std::vector<float>& ir, float sampleRate) {
     int samples_80ms = static_cast<int>(0.08f * sampleRate);
 
-    // エネルギーを計算
-    double earlyEnergy = 0.0;
-    double lateEnergy = 0.0;
     const double minEnergy = 1e-20;
 
     // 早期エネルギーと後期エネルギーを分けて計算
-    for (size_t i = 0 ; i < ir.size() ; ++i) {
-        double energy = static_cast<double>(ir[i]) * static_cast<double>(ir[i]);
-        if (i < samples_80ms)
-            earlyEnergy += energy;
-        else
-            lateEnergy += energy;
-    }
+    const size_t earlyCount = std::min(ir.size(), static_cast<size_t>(std::max(samples_80ms, 0)));
+    const SimdKernelTable& simd = SimdKernels();
+    double earlyEnergy = simd.sumSquares(ir.data(), earlyCount);
+    double lateEnergy = simd.sumSquares(ir.data() + earlyCount, ir.size() - earlyCount);
 
     // C80を計算
     return static_cast<float>(
         10.0 * std::log10(std::max(earlyEnergy, minEnergy) / std::max(lateEnergy, minEnergy))
     );
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 分割したIRのスペクトルから求める周波数特性
+ */
+struct SpectralMetrics {
+    float bassRatio = 1.0f;  // 低域（125 / 250Hz帯）と中域（500 / 1kHz帯）の残響時間の比
+    float brightness = 1.0f; // 高域（2k / 4kHz帯）と中域の残響時間の比
+    float coloration = 0.0f; // 100Hz〜10kHzのエネルギースペクトルのばらつき（dBの標準偏差）
+};
+
+/**
+ * @brief 区間ごとの帯域エネルギーを計算する関数
+ * @param spectrum 分割したIRのスペクトル
+ * @param sampleRate サンプリングレート
+ * @param lowHz 帯域の下端
+ * @param highHz 帯域の上端
+ * @return 区間ごとのエネルギー（区間数の要素）
+ */
+inline std::vector<double> calculateBandEnergies(const PartitionedIR& spectrum, float sampleRate, float lowHz, float highHz) {
+    std::vector<double> energies(spectrum.segmentCount(), 0.0);
+    if (spectrum.segmentCount() == 0) {
+        return energies;
+    }
+
+    // 変換の長さは 2 * blockSize なので、ビン k の周波数は k * sampleRate / (2 * blockSize)
+    const double binHz = static_cast<double>(sampleRate) / static_cast<double>(2 * spectrum.blockSize());
+    const auto firstBin = static_cast<size_t>(std::ceil(lowHz / binHz));
+    const size_t lastBin = std::min(static_cast<size_t>(std::ceil(highHz / binHz)), spectrum.complexSize());
+
+    for (size_t s = 0 ; s < spectrum.segmentCount() ; ++s) {
+        const float* re = spectrum.re(s);
+        const float* im = spectrum.im(s);
+        double energy = 0.0;
+        for (size_t k = firstBin ; k < lastBin ; ++k) {
+            energy += static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+        }
+        energies[s] = energy;
+    }
+
+    return energies;
+}
+
+/**
+ * @brief ブロックごとのエネルギーからシュレーダーの残響曲線を計算する関数
+ * @param energies ブロックごとのエネルギー（IRを一定の長さのブロックに分けた2乗の和、または帯域エネルギー）
+ * @return 各ブロックの先頭から最後までのエネルギーの和（dBには変換しない）
+ */
+inline std::vector<double> calculateBlockDecay(const std::vector<double>& energies) {
+    std::vector<double> edc(energies.size());
+    double remaining = 0.0;
+    for (size_t i = energies.size() ; i-- > 0 ; ) {
+        remaining += energies[i];
+        edc[i] = remaining;
+    }
+    return edc;
+}
+
+/**
+ * @brief ブロックごとの残響曲線が db を下回る位置を求める関数
+ * @param edc calculateBlockDecay の結果（空でなく、edc[0] が正）
+ * @param db 0以下のdB値
+ * @return 位置（ブロック単位、ブロックの境界の間はdBで線形補間する。下回らなければ最後のブロック）
+ * @note EDCは単調に減るので、下回る区間は二分探索で探し、dBに変換するのはその前後だけにする
+ */
+inline double findBlockDecayPosition(const std::vector<double>& edc, double db) {
+    const double minEnergy = 1e-20;
+    if (db >= 0.0) {
+        return 0.0;
+    }
+
+    auto decayDB = [&](size_t i) -> double {
+        return 10.0 * std::log10(std::max(edc[i] / edc[0], minEnergy));
+    };
+
+    const double threshold = std::pow(10.0, db / 10.0) * edc[0];
+    size_t lo = 1;
+    size_t hi = edc.size();
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (edc[mid] <= threshold) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    if (lo == edc.size()) {
+        return static_cast<double>(edc.size() - 1);
+    }
+
+    const double before = decayDB(lo - 1);
+    const double after = decayDB(lo);
+    const double frac = (before - db) / std::max(before - after, 1e-12);
+    return static_cast<double>(lo - 1) + std::min(std::max(frac, 0.0), 1.0);
+}
+
+/**
+ * @brief ブロックごとのエネルギーから残響時間を計算する関数
+ * @param energies ブロックごとのエネルギー
+ * @param blockSize ブロックの長さ
+ * @param sampleRate サンプリングレート
+ * @return T60の値（秒、-5dBと-35dBの時間はブロックの境界の間で補間する）
+ */
+inline float calculateBlockT60(const std::vector<double>& energies, size_t blockSize, float sampleRate) {
+    const std::vector<double> edc = calculateBlockDecay(energies);
+    if (edc.empty() || edc[0] < 1e-20) {
+        return 0.0f;
+    }
+
+    const double t30Blocks = findBlockDecayPosition(edc, -35.0) - findBlockDecayPosition(edc, -5.0);
+    if (t30Blocks <= 0.0) {
+        return 0.0f;
+    }
+
+    return static_cast<float>(2.0 * t30Blocks * static_cast<double>(blockSize) / static_cast<double>(sampleRate));
+}
+
+/**
+ * @brief ブロックごとのエネルギーからEDTを計算する関数
+ * @param energies ブロックごとのエネルギー
+ * @param blockSize ブロックの長さ
+ * @param sampleRate サンプリングレート
+ * @return EDTの値（秒、-10dBの時間はブロックの境界の間で補間する）
+ */
+inline float calculateBlockEDT(const std::vector<double>& energies, size_t blockSize, float sampleRate) {
+    const std::vector<double> edc = calculateBlockDecay(energies);
+    if (edc.empty() || edc[0] < 1e-20) {
+        return 0.0f;
+    }
+
+    const double t10Blocks = findBlockDecayPosition(edc, -10.0);
+    if (t10Blocks <= 0.0) {
+        return 0.0f;
+    }
+
+    return static_cast<float>(6.0 * t10Blocks * static_cast<double>(blockSize) / static_cast<double>(sampleRate));
+}
+
+/**
+ * @brief ブロックごとのエネルギーを、先頭から boundary サンプルまでとそれ以降に分ける関数
+ * @param energies ブロックごとのエネルギー
+ * @param blockSize ブロックの長さ
+ * @param boundary 境界（サンプル数）
+ * @param earlyEnergy 境界より前のエネルギー
+ * @param lateEnergy 境界以降のエネルギー
+ * @note 境界をまたぐブロックは長さの比で分ける
+ */
+inline void splitBlockEnergy(const std::vector<double>& energies, size_t blockSize, size_t boundary, double& earlyEnergy, double& lateEnergy) {
+    const size_t fullBlocks = std::min(boundary / blockSize, energies.size());
+
+    earlyEnergy = 0.0;
+    lateEnergy = 0.0;
+    for (size_t b = 0 ; b < energies.size() ; ++b) {
+        if (b < fullBlocks) {
+            earlyEnergy += energies[b];
+        }
+        else if (b == fullBlocks) {
+            const double earlyPart = static_cast<double>(boundary - fullBlocks * blockSize) / static_cast<double>(blockSize);
+            earlyEnergy += energies[b] * earlyPart;
+            lateEnergy += energies[b] * (1.0 - earlyPart);
+        }
+        else {
+            lateEnergy += energies[b];
+        }
+    }
+}
+
+/**
+ * @brief ブロックごとのエネルギーからC80を計算する関数
+ * @param energies ブロックごとのエネルギー
+ * @param blockSize ブロックの長さ
+ * @param sampleRate サンプリングレート
+ * @return C80の値（dB、80msをまたぐブロックは長さの比で分ける）
+ */
+inline float calculateBlockC80(const std::vector<double>& energies, size_t blockSize, float sampleRate) {
+    const double minEnergy = 1e-20;
+    const auto samples_80ms = static_cast<size_t>(std::max(static_cast<int>(0.08f * sampleRate), 0));
+
+    double earlyEnergy = 0.0;
+    double lateEnergy = 0.0;
+    splitBlockEnergy(energies, blockSize, samples_80ms, earlyEnergy, lateEnergy);
+
+    return static_cast<float>(
+        10.0 * std::log10(std::max(earlyEnergy, minEnergy) / std::max(lateEnergy, minEnergy))
+    );
+}
+
+/**
+ * @brief ブロックごとのエネルギーからD50（明瞭度）を計算する関数
+ * @param energies ブロックごとのエネルギー
+ * @param blockSize ブロックの長さ
+ * @param sampleRate サンプリングレート
+ * @return D50の値（最初の50msのエネルギーの割合、0〜1。無音なら0）
+ */
+inline float calculateBlockD50(const std::vector<double>& energies, size_t blockSize, float sampleRate) {
+    const auto samples_50ms = static_cast<size_t>(std::max(static_cast<int>(0.05f * sampleRate), 0));
+
+    double earlyEnergy = 0.0;
+    double lateEnergy = 0.0;
+    splitBlockEnergy(energies, blockSize, samples_50ms, earlyEnergy, lateEnergy);
+
+    const double total = earlyEnergy + lateEnergy;
+    if (total < 1e-20) {
+        return 0.0f;
+    }
+    return static_cast<float>(earlyEnergy / total);
+}
+
+/**
+ * @brief 分割したIRのスペクトルから周波数特性を計算する関数
+ * @param spectrum 分割したIRのスペクトル
+ * @param sampleRate サンプリングレート
+ * @return 周波数特性
+ * @note 時間分解能は区間の長さ、周波数分解能は sampleRate / (2 * blockSize) になる。
+ *       ブロックサイズが小さいと低域の帯域に入るビンが少なく、隣の帯域の漏れでBRが1に近づく
+ *       （48kHzで256だと2倍の差が約1.4倍になる）。帯域にビンが1つもないときは比を1とする
+ */
+inline SpectralMetrics calculateSpectralMetrics(const PartitionedIR& spectrum, float sampleRate) {
+    SpectralMetrics metrics;
+    if (spectrum.segmentCount() == 0) {
+        return metrics;
+    }
+
+    // オクターブ帯域をまとめた低域・中域・高域
+    const float nyquist = sampleRate * 0.5f;
+    const float lowT60 = calculateBlockT60(calculateBandEnergies(spectrum, sampleRate, 88.0f, 355.0f), spectrum.blockSize(), sampleRate);
+    const float midT60 = calculateBlockT60(calculateBandEnergies(spectrum, sampleRate, 355.0f, 1414.0f), spectrum.blockSize(), sampleRate);
+    const float highT60 = calculateBlockT60(calculateBandEnergies(spectrum, sampleRate, 1414.0f, std::min(5657.0f, nyquist)), spectrum.blockSize(), sampleRate);
+
+    if (midT60 > 0.0f) {
+        if (lowT60 > 0.0f) metrics.bassRatio = lowT60 / midT60;
+        if (highT60 > 0.0f) metrics.brightness = highT60 / midT60;
+    }
+
+    // 全区間を合わせたエネルギースペクトルのばらつき
+    const double binHz = static_cast<double>(sampleRate) / static_cast<double>(2 * spectrum.blockSize());
+    const auto firstBin = static_cast<size_t>(std::ceil(100.0 / binHz));
+    const size_t lastBin = std::min(static_cast<size_t>(std::ceil(std::min(10000.0f, nyquist) / binHz)), spectrum.complexSize());
+    if (lastBin > firstBin + 1) {
+        std::vector<double> binEnergy(lastBin - firstBin, 0.0);
+        for (size_t s = 0 ; s < spectrum.segmentCount() ; ++s) {
+            const float* re = spectrum.re(s);
+            const float* im = spectrum.im(s);
+            for (size_t k = firstBin ; k < lastBin ; ++k) {
+                binEnergy[k - firstBin] += static_cast<double>(re[k]) * re[k] + static_cast<double>(im[k]) * im[k];
+            }
+        }
+
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        for (double& e : binEnergy) {
+            e = 10.0 * std::log10(std::max(e, 1e-20));
+            sum += e;
+            sumSquares += e * e;
+        }
+        const auto count = static_cast<double>(binEnergy.size());
+        const double mean = sum / count;
+        metrics.coloration = static_cast<float>(std::sqrt(std::max(sumSquares / count - mean * mean, 0.0)));
+    }
+
+    return metrics;
+}
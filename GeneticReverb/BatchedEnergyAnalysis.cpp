@@ -0,0 +1,123 @@
+﻿/**
+ * @file BatchedEnergyAnalysis.cpp
+ * @author Goto Kenta
+ * @brief 複数のIRのエネルギー指標をまとめて計算する処理の実装
+ */
+
+# include "BatchedEnergyAnalysis.h"
+# include "../Common/SimdDispatch.h"
+
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+
+// EDCをfloatのカハン加算で求める（CMakeの FMOD_PLUGINS_FLOAT_ENERGY）
+# ifndef FMOD_PLUGINS_FLOAT_ENERGY
+    # define FMOD_PLUGINS_FLOAT_ENERGY 0
+# endif
+
+namespace {
+# if FMOD_PLUGINS_FLOAT_ENERGY
+    using EnergyValue = float;
+# else
+    using EnergyValue = double;
+# endif
+}
+
+void BatchedEnergyAnalysis::analyze(const float* const* irs, const size_t* lengths, size_t count, float sampleRate, EnergyMetrics* metrics) {
+    count = std::min(count, kLanes);
+    if (count == 0) {
+        return;
+    }
+
+    size_t frames = 0;
+    for (size_t lane = 0 ; lane < count ; ++lane) {
+        frames = std::max(frames, lengths[lane]);
+    }
+
+    // 長さがそろっていないレーンと空きレーンは0で埋めたコピーを使う（末尾の0はEDCの値を変えない）
+    const float* sources[kLanes];
+    size_t paddedCount = 0;
+    for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+        if (lane >= count || lengths[lane] < frames) {
+            ++paddedCount;
+        }
+    }
+    m_padded.assign(paddedCount * frames, 0.0f);
+    float* padded = m_padded.data();
+    for (size_t lane = 0 ; lane < kLanes ; ++lane) {
+        if (lane < count && lengths[lane] == frames) {
+            sources[lane] = irs[lane];
+            continue;
+        }
+        if (lane < count) {
+            std::memcpy(padded, irs[lane], lengths[lane] * sizeof(float));
+        }
+        sources[lane] = padded;
+        padded += frames;
+    }
+
+    const SimdKernelTable& simd = SimdKernels();
+    m_interleaved.resize(frames * kLanes);
+    simd.interleave8(sources, m_interleaved.data(), frames);
+# if FMOD_PLUGINS_FLOAT_ENERGY
+    m_edcFloat.resize(frames * kLanes);
+    simd.reverseEnergySum8Float(m_interleaved.data(), m_edcFloat.data(), frames);
+    const EnergyValue* edc = m_edcFloat.data();
+# else
+    m_edc.resize(frames * kLanes);
+    simd.reverseEnergySum8(m_interleaved.data(), m_edc.data(), frames);
+    const EnergyValue* edc = m_edc.data();
+# endif
+
+    const double minEnergy = 1e-20;
+    const int samples_80ms = static_cast<int>(0.08f * sampleRate);
+
+    for (size_t lane = 0 ; lane < count ; ++lane) {
+        const size_t length = lengths[lane];
+        const double totalEnergy = edc[lane];
+
+        // calculateSchroederDecay と同じdB値（全エネルギーが非常に小さいときは -100dB）
+        auto decayDB = [&](size_t i) -> float {
+            if (totalEnergy < minEnergy) {
+                return -100.0f;
+            }
+            const double ratio = std::max(static_cast<double>(edc[i * kLanes + lane]) / std::max(totalEnergy, minEnergy), minEnergy);
+            return static_cast<float>(10.0 * std::log10(ratio));
+        };
+
+        // db 以下になる最初のサンプル（なければ最後のサンプル）
+        auto findTimeForDB = [&](float db) -> int {
+            size_t lo = 0;
+            size_t hi = length;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (decayDB(mid) <= db) {
+                    hi = mid;
+                }
+                else {
+                    lo = mid + 1;
+                }
+            }
+            return static_cast<int>(std::min(lo, length - 1));
+        };
+
+        EnergyMetrics& result = metrics[lane];
+
+        // T60（-5dBから-35dBまでの時間の2倍）
+        const auto t30_samples = static_cast<float>(findTimeForDB(-35.0f) - findTimeForDB(-5.0f));
+        result.t60 = (t30_samples <= 0.0f) ? 0.0f : (t30_samples / sampleRate) * 2.0f;
+
+        // EDT（0dBから-10dBまでの時間の6倍）
+        const auto t10_samples = static_cast<float>(findTimeForDB(-10.0f) - findTimeForDB(0.0f));
+        result.edt = (t10_samples <= 0.0f) ? 0.0f : (t10_samples / sampleRate) * 6.0f;
+
+        // C80（80ms以降のエネルギーはEDCの値そのもの）
+        const size_t earlyCount = std::min(length, static_cast<size_t>(std::max(samples_80ms, 0)));
+        const double lateEnergy = (earlyCount < length) ? static_cast<double>(edc[earlyCount * kLanes + lane]) : 0.0;
+        const double earlyEnergy = totalEnergy - lateEnergy;
+        result.c80 = static_cast<float>(
+            10.0 * std::log10(std::max(earlyEnergy, minEnergy) / std::max(lateEnergy, minEnergy))
+        );
+    }
+}
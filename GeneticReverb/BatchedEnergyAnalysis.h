@@ -0,0 +1,48 @@
+﻿/**
+ * @file BatchedEnergyAnalysis.h
+ * @author Goto Kenta
+ * @brief 複数のIRのエネルギー指標（T60・EDT・C80）をSIMDのレーンに並べてまとめて計算する
+ */
+
+# pragma once
+
+# include <cstddef>
+# include <vector>
+
+/**
+ * @brief エネルギー減衰から求める指標
+ */
+struct EnergyMetrics {
+    float t60 = 0.0f;
+    float edt = 0.0f;
+    float c80 = 0.0f;
+};
+
+/**
+ * @brief 最大8本のIRを1サンプルずつ交互に並べ（転置）、シュレーダー積分を8レーン同時に行う
+ * @note T60とEDTは calculateSchroederDecay → calculateT60 / calculateEDT と同じ値になる。
+ *       EDCは単調に減るので、-5dBなどを下回る位置は二分探索で求め、全サンプルのdB変換は行わない。
+ *       C80はEDCの値から求めるので、calculateC80 とは最下位ビットが異なることがある。
+ *       FMOD_PLUGINS_FLOAT_ENERGY=1 でビルドすると、EDCをfloatのカハン加算で求める（doubleとの差は相対 1e-7 程度で、
+ *       -5dBなどを下回る位置がずれるのはEDCが境界とほぼ等しいときだけ）
+ */
+class BatchedEnergyAnalysis {
+public:
+    static constexpr size_t kLanes = 8;
+
+    /**
+     * @brief IRの指標をまとめて計算する
+     * @param irs インパルス応答（count 本）
+     * @param lengths 各インパルス応答の長さ（1以上）
+     * @param count インパルス応答の数（1〜kLanes）
+     * @param sampleRate サンプリングレート
+     * @param metrics 結果（count 個）
+     */
+    void analyze(const float* const* irs, const size_t* lengths, size_t count, float sampleRate, EnergyMetrics* metrics);
+
+private:
+    std::vector<float> m_padded;      // 短いIR・空きレーンを最長の長さまで0で埋めたもの
+    std::vector<float> m_interleaved; // [サンプル][レーン]
+    std::vector<double> m_edc;        // [サンプル][レーン]
+    std::vector<float> m_edcFloat;    // FMOD_PLUGINS_FLOAT_ENERGY のときはこちらを使う
+};
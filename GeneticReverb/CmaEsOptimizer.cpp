@@ -0,0 +1,290 @@
+﻿/**
+ * @file CmaEsOptimizer.cpp
+ * @author Goto Kenta
+ * @brief CMA-ESによる最適化の実装
+ * @note 更新式と既定の定数は Hansen, "The CMA Evolution Strategy: A Tutorial" に従う
+ */
+
+# include "CmaEsOptimizer.h"
+
+# include <algorithm>
+# include <cmath>
+# include <limits>
+# include <numeric>
+
+CmaEsOptimizer::CmaEsOptimizer(float sampleRate)
+    : IROptimizer(sampleRate)
+{
+}
+
+CmaEsOptimizer::~CmaEsOptimizer() = default;
+
+void CmaEsOptimizer::setSurrogate(bool enabled) {
+    m_surrogateEnabled = enabled;
+}
+
+/**
+ * @brief 目標に合うIRのパラメータを探す関数
+ * @param targetParams 目標とする残響特性のパラメータ
+ * @param numGenerations 世代数（1世代で8個体。代理モデルを使うときは評価するのは kSurrogateGenerations + 1 世代に1回）
+ * @return 最良のパラメータから作ったIR
+ */
+std::vector<float> CmaEsOptimizer::compute(const ReverbTargetParams& targetParams, int numGenerations) {
+    m_bestSpectrum.reset();
+    m_model.prepare(m_sampleRate, targetParams, static_cast<uint32_t>(m_rng()));
+    m_surrogate.reset();
+    reportProgress(0, numGenerations, 1e10);
+
+    const auto n = static_cast<double>(kDimension);
+
+    // 上位 kMu 個体の重み（対数で下げる）
+    std::array<double, kMu> weights;
+    for (size_t i = 0 ; i < kMu ; ++i) {
+        weights[i] = std::log(static_cast<double>(kMu) + 0.5) - std::log(static_cast<double>(i + 1));
+    }
+    const double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double weightSquareSum = 0.0;
+    for (double& w : weights) {
+        w /= weightSum;
+        weightSquareSum += w * w;
+    }
+    const double mueff = 1.0 / weightSquareSum;
+
+    // 学習率
+    const double cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+    const double cs = (mueff + 2.0) / (n + mueff + 5.0);
+    const double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff);
+    const double cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff));
+    const double damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    const double chiN = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    Vector mean;
+    m_model.initialGuess(mean.data());
+    double sigma = kInitialSigma;
+
+    Matrix covariance{}, basis{};
+    Vector scales, pathC{}, pathSigma{};
+    for (size_t i = 0 ; i < kDimension ; ++i) {
+        covariance[i][i] = 1.0;
+        basis[i][i] = 1.0;
+        scales[i] = 1.0;
+    }
+
+    Vector best = mean;
+    double bestFitness = std::numeric_limits<double>::infinity();
+
+    std::array<Vector, kLambda> steps, candidates;
+    std::array<double, kLambda> fitness;
+    std::array<double, kLambda> penalties;
+    std::array<EnergyMetrics, kLambda> predicted, measured;
+    std::array<size_t, kLambda> order;
+    const float* irs[kLambda];
+    size_t lengths[kLambda];
+
+    for (int gen = 0 ; gen < numGenerations ; ++gen) {
+        // 最初と最後の世代は必ず評価する
+        const bool evaluated = !m_surrogateEnabled || gen % (kSurrogateGenerations + 1) == 0 || gen + 1 == numGenerations;
+
+        // x = m + σ B D z
+        for (size_t k = 0 ; k < kLambda ; ++k) {
+            Vector z;
+            for (double& v : z) {
+                v = m_distNormal(m_rng);
+            }
+
+            Vector clamped;
+            penalties[k] = 0.0;
+            for (size_t i = 0 ; i < kDimension ; ++i) {
+                double y = 0.0;
+                for (size_t j = 0 ; j < kDimension ; ++j) {
+                    y += basis[i][j] * scales[j] * z[j];
+                }
+                steps[k][i] = y;
+                candidates[k][i] = mean[i] + sigma * y;
+
+                clamped[i] = std::min(std::max(candidates[k][i], 0.0), 1.0);
+                const double outside = candidates[k][i] - clamped[i];
+                penalties[k] += kBoundaryPenalty * outside * outside;
+            }
+
+            if (m_surrogateEnabled)
+                predicted[k] = m_model.predict(clamped.data());
+            if (evaluated) {
+                m_model.render(clamped.data(), m_irs[k]);
+                irs[k] = m_irs[k].data();
+                lengths[k] = m_irs[k].size();
+            }
+        }
+
+        if (evaluated) {
+            m_evaluator.evaluate(irs, lengths, kLambda, targetParams, fitness.data(), nullptr, measured.data());
+            if (m_surrogateEnabled) {
+                for (size_t k = 0 ; k < kLambda ; ++k) {
+                    m_surrogate.addSample(predicted[k], measured[k]);
+                }
+                m_surrogate.recalibrate();
+            }
+        }
+        else {
+            for (size_t k = 0 ; k < kLambda ; ++k) {
+                fitness[k] = m_surrogate.predictFitness(predicted[k], targetParams);
+            }
+        }
+
+        for (size_t k = 0 ; k < kLambda ; ++k) {
+            fitness[k] += penalties[k];
+            if (evaluated && fitness[k] < bestFitness) {
+                bestFitness = fitness[k];
+                for (size_t i = 0 ; i < kDimension ; ++i) {
+                    best[i] = std::min(std::max(candidates[k][i], 0.0), 1.0);
+                }
+            }
+        }
+
+        std::iota(order.begin(), order.end(), size_t { 0 });
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fitness[a] < fitness[b]; });
+
+        // 平均の移動（歩幅で割ったもの）
+        Vector meanStep{};
+        for (size_t r = 0 ; r < kMu ; ++r) {
+            for (size_t i = 0 ; i < kDimension ; ++i) {
+                meanStep[i] += weights[r] * steps[order[r]][i];
+            }
+        }
+        for (size_t i = 0 ; i < kDimension ; ++i) {
+            mean[i] += sigma * meanStep[i];
+        }
+
+        // 歩幅の進化経路（C^(-1/2) = B D^(-1) B^T で白色化する）
+        Vector whitened{};
+        for (size_t j = 0 ; j < kDimension ; ++j) {
+            double projected = 0.0;
+            for (size_t i = 0 ; i < kDimension ; ++i) {
+                projected += basis[i][j] * meanStep[i];
+            }
+            projected /= scales[j];
+            for (size_t i = 0 ; i < kDimension ; ++i) {
+                whitened[i] += basis[i][j] * projected;
+            }
+        }
+
+        const double sigmaRate = std::sqrt(cs * (2.0 - cs) * mueff);
+        double pathSigmaNorm = 0.0;
+        for (size_t i = 0 ; i < kDimension ; ++i) {
+            pathSigma[i] = (1.0 - cs) * pathSigma[i] + sigmaRate * whitened[i];
+            pathSigmaNorm += pathSigma[i] * pathSigma[i];
+        }
+        pathSigmaNorm = std::sqrt(pathSigmaNorm);
+
+        // 歩幅の経路が長すぎるときは共分散の経路を止める
+        const double correction = std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (gen + 1)));
+        const bool hsig = pathSigmaNorm / correction / chiN < 1.4 + 2.0 / (n + 1.0);
+
+        const double covarianceRate = std::sqrt(cc * (2.0 - cc) * mueff);
+        for (size_t i = 0 ; i < kDimension ; ++i) {
+            pathC[i] = (1.0 - cc) * pathC[i] + (hsig ? covarianceRate * meanStep[i] : 0.0);
+        }
+
+        // 共分散の更新（ランク1とランクμ）
+        const double rankOneCorrection = hsig ? 0.0 : cc * (2.0 - cc);
+        for (size_t i = 0 ; i < kDimension ; ++i) {
+            for (size_t j = 0 ; j <= i ; ++j) {
+                double rankMu = 0.0;
+                for (size_t r = 0 ; r < kMu ; ++r) {
+                    rankMu += weights[r] * steps[order[r]][i] * steps[order[r]][j];
+                }
+                const double value = (1.0 - c1 - cmu) * covariance[i][j]
+                                   + c1 * (pathC[i] * pathC[j] + rankOneCorrection * covariance[i][j])
+                                   + cmu * rankMu;
+                covariance[i][j] = value;
+                covariance[j][i] = value;
+            }
+        }
+
+        sigma *= std::exp((cs / damps) * (pathSigmaNorm / chiN - 1.0));
+        sigma = std::min(std::max(sigma, 1e-10), 1.0);
+
+        Eigen(covariance, basis, scales);
+        for (double& s : scales) {
+            s = std::sqrt(std::max(s, 1e-20));
+        }
+
+        reportProgress(gen + 1, numGenerations, bestFitness);
+
+        if (bestFitness < 0.001)
+            break;
+
+        // キャンセルが要求された場合はループを抜ける
+        if (isCancelled())
+            break;
+    }
+
+    reportProgress(numGenerations, numGenerations, bestFitness);
+
+    std::vector<float> ir;
+    m_model.render(best.data(), ir);
+    storeBestSpectrum(ir, nullptr);
+    return ir;
+}
+
+/**
+ * @brief 対称行列の固有値分解（ヤコビ法）
+ * @param matrix 対称行列
+ * @param vectors 固有ベクトル（列ごと）
+ * @param values 固有値
+ */
+void CmaEsOptimizer::Eigen(const Matrix& matrix, Matrix& vectors, Vector& values) {
+    Matrix a = matrix;
+    for (size_t i = 0 ; i < kDimension ; ++i) {
+        for (size_t j = 0 ; j < kDimension ; ++j) {
+            vectors[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0 ; sweep < 50 ; ++sweep) {
+        double offDiagonal = 0.0;
+        for (size_t p = 0 ; p < kDimension ; ++p) {
+            for (size_t q = p + 1 ; q < kDimension ; ++q) {
+                offDiagonal += a[p][q] * a[p][q];
+            }
+        }
+        if (offDiagonal < 1e-30)
+            break;
+
+        for (size_t p = 0 ; p < kDimension ; ++p) {
+            for (size_t q = p + 1 ; q < kDimension ; ++q) {
+                if (std::abs(a[p][q]) < 1e-300)
+                    continue;
+
+                // a[p][q] を0にする回転
+                const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                const double t = ((theta >= 0.0) ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+
+                for (size_t k = 0 ; k < kDimension ; ++k) {
+                    const double akp = a[k][p];
+                    const double akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (size_t k = 0 ; k < kDimension ; ++k) {
+                    const double apk = a[p][k];
+                    const double aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0 ; k < kDimension ; ++k) {
+                    const double vkp = vectors[k][p];
+                    const double vkq = vectors[k][q];
+                    vectors[k][p] = c * vkp - s * vkq;
+                    vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0 ; i < kDimension ; ++i) {
+        values[i] = a[i][i];
+    }
+}
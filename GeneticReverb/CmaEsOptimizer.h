@@ -0,0 +1,53 @@
+﻿/**
+ * @file CmaEsOptimizer.h
+ * @author Goto Kenta
+ * @brief 減衰のパラメータをCMA-ESで探す最適化
+ */
+
+# pragma once
+
+# include "FitnessSurrogate.h"
+# include "IROptimizer.h"
+# include "ParametricIR.h"
+
+# include <array>
+# include <random>
+# include <vector>
+
+/**
+ * @brief ParametricIRModel のパラメータを (μ/μ_w, λ)-CMA-ES で探す
+ * @note 1世代の個体数 λ は8で、BatchedEnergyAnalysis の1回分にそろえている。
+ *       範囲外の候補は端に寄せたIRで評価し、はみ出した距離の2乗に比例する罰則を加える。
+ *       代理モデル（FitnessSurrogate）を使うときは、kSurrogateGenerations 世代を代理モデルの予測だけで進め、
+ *       その次の1世代だけIRを作って評価する。評価した世代の個体で代理モデルを補正し直し、最良の個体も評価した世代から選ぶ
+ */
+class CmaEsOptimizer : public IROptimizer {
+public:
+    explicit CmaEsOptimizer(float sampleRate);
+    ~CmaEsOptimizer() override;
+
+    OptimizerBackend backend() const override { return OptimizerBackend::CMAES; }
+    std::vector<float> compute(const ReverbTargetParams& targetParams, int numGenerations) override;
+
+    // 代理モデルで世代を進めるかどうか（既定で有効）
+    void setSurrogate(bool enabled);
+
+private:
+    static constexpr size_t kDimension = ParametricIRModel::kParameterCount;
+    static constexpr size_t kLambda = BatchedEnergyAnalysis::kLanes; // 1世代の個体数
+    static constexpr size_t kMu = kLambda / 2;                       // 平均の更新に使う上位の個体数
+    static constexpr double kInitialSigma = 0.3;                     // 正規化したパラメータでの初期の歩幅
+    static constexpr double kBoundaryPenalty = 100.0;
+    static constexpr int kSurrogateGenerations = 3;                  // 評価する世代の間に代理モデルだけで進める世代の数
+
+    using Vector = std::array<double, kDimension>;
+    using Matrix = std::array<Vector, kDimension>;
+
+    std::normal_distribution<double> m_distNormal{0.0, 1.0};
+    ParametricIRModel m_model;
+    std::array<std::vector<float>, kLambda> m_irs;
+    FitnessSurrogate m_surrogate;
+    bool m_surrogateEnabled = true;
+
+    static void Eigen(const Matrix& matrix, Matrix& vectors, Vector& values);
+};
@@ -1,4 +1,6 @@
 ﻿# include "ConvolutionProcessor.h"
+# include "../Common/IRCache.h"
+# include "../Common/WorkerPool.h"
 
 # include <cstring>
 
@@ -6,20 +8,15 @@
  * @brief コンボリューションプロセッサークラスの実装
  */
 ConvolutionProcessor::ConvolutionProcessor() {
-    m_geneticAlgorithm.emplace(50, 0.001f, 44100.0f);
+    m_optimizer = IROptimizer::Create(IROptimizer::DefaultBackend(), 44100.0f);
+    m_optimizer->setSpectralAnalysis(m_maxBlockSize, m_spectralWeights);
 }
 
 /**
  * @brief デストラクタ
  */
 ConvolutionProcessor::~ConvolutionProcessor() {
-    if (m_isGenerating.load(std::memory_order_acquire)) {
-        if (m_geneticAlgorithm)
-            m_geneticAlgorithm->cancel();
-    }
-
-    if (m_gaThread.joinable())
-        m_gaThread.join();
+    cancelGenerate();
 }
 
 /**
@@ -28,27 +25,23 @@ ConvolutionProcessor::~ConvolutionProcessor() {
  * @param maxBlockSize 最大ブロックサイズ
  */
 void ConvolutionProcessor::prepare(double sampleRate, unsigned int maxBlockSize) {
-    if (m_isGenerating.load(std::memory_order_acquire)) {
-        if (m_geneticAlgorithm)
-            m_geneticAlgorithm->cancel();
-    }
-
-    if (m_gaThread.joinable())
-        m_gaThread.join();
-
-    m_isGenerating.store(false, std::memory_order_release);
-    m_progress.store(0.0f, std::memory_order_release);
+    cancelGenerate();
 
-    m_geneticAlgorithm.emplace(50, 0.001f, static_cast<float>(sampleRate));
+    m_optimizer = IROptimizer::Create(IROptimizer::DefaultBackend(), static_cast<float>(sampleRate));
     m_sampleRate = sampleRate;
     m_maxBlockSize = maxBlockSize;
 
+    // 選ばれたIRはコンボリューターと同じ分割でスペクトルにしてもらい、読み込み時のFFTを省く
+    // （重みがあれば、評価でも同じスペクトルからBR・明るさ・色付きを求める）
+    m_optimizer->setSpectralAnalysis(m_maxBlockSize, m_spectralWeights);
+
     // 既存のコンボリューターをクリア
     {
         std::unique_lock<std::shared_mutex> lock(m_convolverMutex);
         m_convolverL.reset();
         m_convolverR.reset();
         m_isIRReady.store(false, std::memory_order_relaxed);
+        m_irLength.store(0, std::memory_order_relaxed);
     }
 }
 
@@ -78,21 +71,13 @@ void ConvolutionProcessor::process(float* inBufferL, float* inBufferR, float* ou
  * @brief コンボリューションプロセッサーのリリースを行う
  */
 void ConvolutionProcessor::release() {
-    if (m_isGenerating.load(std::memory_order_acquire)) {
-        if (m_geneticAlgorithm)
-            m_geneticAlgorithm->cancel();
-    }
-
-    if (m_gaThread.joinable())
-        m_gaThread.join();
-
-    m_isGenerating.store(false, std::memory_order_release);
-    m_progress.store(0.0f, std::memory_order_release);
+    cancelGenerate();
 
     std::unique_lock<std::shared_mutex> lock(m_convolverMutex);
     m_convolverL.reset();
     m_convolverR.reset();
     m_isIRReady.store(false, std::memory_order_relaxed);
+    m_irLength.store(0, std::memory_order_relaxed);
 }
 
 /**
@@ -104,12 +89,25 @@ void ConvolutionProcessor::setIR(const float* ir, size_t length) {
     if (!ir || length == 0)
         return;
 
+    // スペクトルは1度だけ計算して左右で共有する
+    setIR(PartitionedIR::Create(m_maxBlockSize, ir, length));
+}
+
+/**
+ * @brief 分割済みのインパルス応答のスペクトルを設定する
+ * @param spectrum 分割したIRのスペクトル（分割の長さがブロックサイズになる）
+ */
+void ConvolutionProcessor::setIR(PartitionedIR::Ptr spectrum) {
+    if (!spectrum)
+        return;
+
     // コンボリューターを初期化
     std::unique_lock<std::shared_mutex> lock(m_convolverMutex);
-    bool okL = m_convolverL.init(m_maxBlockSize, ir, length);
-    bool okR = m_convolverR.init(m_maxBlockSize, ir, length);
+    bool okL = m_convolverL.init(spectrum);
+    bool okR = m_convolverR.init(spectrum);
 
     // IR準備完了フラグを設定
+    m_irLength.store((okL && okR) ? spectrum->irLength() : 0, std::memory_order_relaxed);
     m_isIRReady.store(okL && okR, std::memory_order_release);
 }
 
@@ -117,52 +115,118 @@ void ConvolutionProcessor::setTargetParams(const ReverbTargetParams& params) {
     m_params = params;
 }
 
+void ConvolutionProcessor::setSpectralWeights(const SpectralWeights& weights) {
+    m_spectralWeights = weights;
+}
+
 void ConvolutionProcessor::startGenerate() {
     if (m_isGenerating.load(std::memory_order_acquire))
         return;
 
-    if (!m_geneticAlgorithm)
+    if (!m_optimizer)
         return;
 
-    if (m_gaThread.joinable())
-        m_gaThread.join();
+    waitForGenerate();
+
+    // 前の生成が終わってから評価の設定を変える
+    m_optimizer->setSpectralAnalysis(m_maxBlockSize, m_spectralWeights);
 
     m_isGenerating.store(true, std::memory_order_release);
     m_progress.store(0.0f, std::memory_order_release);
 
-    m_gaThread = std::thread([this]() {
-        // GAインスタンスを取得
-        auto* ga = m_geneticAlgorithm ? &*m_geneticAlgorithm : nullptr;
-        if (!ga) {
+    // キャンセルフラグはここでリセットし、キューで待っている間のキャンセルも効くようにする
+    m_optimizer->resetCancel();
+
+    const int numGenerations = 250;
+    const ReverbTargetParams params = m_params;
+    const uint64_t key = irCacheKey(params, numGenerations);
+
+    m_gaTask = WorkerPool::Shared().Submit([this, params, numGenerations, key]() {
+        // 同じ条件で生成済みのIRがあればそれを使う
+        if (IRCache::IR cached = IRCache::Shared().Find(key)) {
+            setIR(cached->data(), cached->size());
+            m_progress.store(1.0f, std::memory_order_release);
             m_isGenerating.store(false, std::memory_order_release);
             return;
         }
 
-        // キャンセルフラグをリセット
-        ga->resetCancel();
+        IROptimizer* optimizer = m_optimizer.get();
 
         // 進捗コールバックを設定
-        ga->setProgressCallback([this](int cur, int total, double) {
+        optimizer->setProgressCallback([this](int cur, int total, double) {
             const float p = (total > 0) ? (static_cast<float>(cur) / static_cast<float>(total)) : 0.0f;
             m_progress.store(p, std::memory_order_release);
         });
 
-        // 遺伝的アルゴリズムで最適なIRを計算
-        const int numGenerations = 250;
-        auto bestIR = ga->compute(m_params, numGenerations);
+        // 遺伝的アルゴリズム（または選ばれた最適化）で最適なIRを計算
+        auto bestIR = optimizer->compute(params, numGenerations);
 
         // 最終更新（成功時は 1.0、キャンセル/失敗時は据え置き）
         if (!bestIR.empty()) {
-            setIR(bestIR.data(), bestIR.size());
+            // 最適化が同じ分割で計算したスペクトルがあれば、FFTをやり直さずにそのまま使う
+            if (PartitionedIR::Ptr spectrum = optimizer->bestSpectrum())
+                setIR(std::move(spectrum));
+            else
+                setIR(bestIR.data(), bestIR.size());
+
+            // キャンセルで途中終了したIRはキャッシュしない
+            if (!optimizer->isCancelled())
+                IRCache::Shared().Insert(key, std::move(bestIR));
+
             m_progress.store(1.0f, std::memory_order_release);
         }
 
         // 進捗コールバックをクリア
-        ga->setProgressCallback(nullptr);
+        optimizer->setProgressCallback(nullptr);
         m_isGenerating.store(false, std::memory_order_release);
     });
 }
 
+/**
+ * @brief 実行中またはキューで待っているIR生成の完了を待つ
+ */
+void ConvolutionProcessor::waitForGenerate() {
+    m_gaTask.wait();
+    m_gaTask = WorkerPool::Job();
+}
+
+/**
+ * @brief IR生成を止める
+ * @note 共有プールで他のインスタンスのジョブの後ろに並んでいるだけなら、キューから外して待たずに戻る。
+ *       実行中なら最適化を止め、今の世代が終わるまで待つ
+ */
+void ConvolutionProcessor::cancelGenerate() {
+    if (!m_gaTask.cancel()) {
+        if (m_isGenerating.load(std::memory_order_acquire) && m_optimizer)
+            m_optimizer->cancel();
+
+        waitForGenerate();
+    }
+
+    m_isGenerating.store(false, std::memory_order_release);
+    m_progress.store(0.0f, std::memory_order_release);
+}
+
+/**
+ * @brief IRキャッシュのキー（目標パラメータ・周波数領域の評価の重み・サンプリングレート・世代数・最適化の方法が同じなら同じIRを使う）
+ */
+uint64_t ConvolutionProcessor::irCacheKey(const ReverbTargetParams& params, int numGenerations) const {
+    uint64_t key = IRCache::kHashSeed;
+    key = IRCache::HashAppend(key, &params.t60, sizeof(params.t60));
+    key = IRCache::HashAppend(key, &params.edt, sizeof(params.edt));
+    key = IRCache::HashAppend(key, &params.c80, sizeof(params.c80));
+    key = IRCache::HashAppend(key, &params.br, sizeof(params.br));
+    key = IRCache::HashAppend(key, &params.brightness, sizeof(params.brightness));
+    key = IRCache::HashAppend(key, &m_spectralWeights.bassRatio, sizeof(m_spectralWeights.bassRatio));
+    key = IRCache::HashAppend(key, &m_spectralWeights.brightness, sizeof(m_spectralWeights.brightness));
+    key = IRCache::HashAppend(key, &m_spectralWeights.coloration, sizeof(m_spectralWeights.coloration));
+    key = IRCache::HashAppend(key, &m_sampleRate, sizeof(m_sampleRate));
+    key = IRCache::HashAppend(key, &numGenerations, sizeof(numGenerations));
+    const OptimizerBackend backend = m_optimizer ? m_optimizer->backend() : OptimizerBackend::GeneticAlgorithm;
+    key = IRCache::HashAppend(key, &backend, sizeof(backend));
+    return key;
+}
+
 bool ConvolutionProcessor::isGenerating() const {
     return m_isGenerating.load(std::memory_order_acquire);
 }
@@ -171,18 +235,15 @@ float ConvolutionProcessor::progress() const {
     return m_progress.load(std::memory_order_acquire);
 }
 
+size_t ConvolutionProcessor::irLength() const {
+    return m_irLength.load(std::memory_order_relaxed);
+}
+
 void ConvolutionProcessor::cancelIR() {
     if (!m_isGenerating.load(std::memory_order_acquire))
         return;
 
-    if (m_geneticAlgorithm)
-        m_geneticAlgorithm->cancel();
-
-    if (m_gaThread.joinable())
-        m_gaThread.join();
-
-    m_isGenerating.store(false, std::memory_order_release);
-    m_progress.store(0.0f, std::memory_order_release);
+    cancelGenerate();
 }
 
 /**
@@ -195,7 +256,7 @@ void ConvolutionProcessor::generateAndLoadIR_Async() {
     int numGenerations = 250;
 
     // 遺伝的アルゴリズムで最適なIRを計算
-    std::vector<float> bestIR = m_geneticAlgorithm->compute(params, numGenerations);
+    std::vector<float> bestIR = m_optimizer->compute(params, numGenerations);
     if (bestIR.empty()) return;
 
     // 計算したIRをコンボリューターに設定
@@ -1,14 +1,14 @@
 ﻿# pragma once
 
-# include "GeneticAlgorithm.h"
-# include "../ThirdParty/FFTConvolver/FFTConvolver.h"
+# include "IROptimizer.h"
+# include "../Common/PartitionedConvolver.h"
+# include "../Common/WorkerPool.h"
 
 # include <vector>
 # include <atomic>
+# include <future>
 # include <mutex>
 # include <memory>
-# include <optional>
-# include <thread>
 # include <shared_mutex>
 
 class ConvolutionProcessor {
@@ -20,8 +20,10 @@ public:
     void process(float* inBufferL, float* inBufferR, float* outBufferL, float* outBufferR, unsigned int numSamples);
     void release();
     void setIR(const float* ir, size_t length);
+    void setIR(PartitionedIR::Ptr spectrum); // 計算済みの分割スペクトルを左右で共有する
 
     void setTargetParams(const ReverbTargetParams& params);
+    void setSpectralWeights(const SpectralWeights& weights); // 次の startGenerate から使う
     void startGenerate();
 
     // 進捗コールバック関数の設定
@@ -29,11 +31,16 @@ public:
     float progress() const;
     void cancelIR();
 
+    // 読み込み済みのIRの長さ（未準備なら0）
+    size_t irLength() const;
+
 private:
-    std::optional<GeneticAlgorithm> m_geneticAlgorithm;
+    std::unique_ptr<IROptimizer> m_optimizer; // GA または CMA-ES / 差分進化（環境変数 FMOD_PLUGINS_OPTIMIZER）
     ReverbTargetParams m_params{ };
+    SpectralWeights m_spectralWeights{ };
     std::atomic<bool> m_isIRReady { false };
-    std::thread m_gaThread;
+    std::atomic<size_t> m_irLength { 0 };
+    WorkerPool::Job m_gaTask; // 共有ワーカープールで実行中（またはキューで待っている）IR生成
     unsigned int m_maxBlockSize { 1024 };
     double m_sampleRate { 44100.0 };
 
@@ -41,9 +48,12 @@ private:
     std::atomic<bool> m_isGenerating { false };
     std::atomic<float> m_progress { 0.0f };
 
-    fftconvolver::FFTConvolver m_convolverL;
-    fftconvolver::FFTConvolver m_convolverR;
+    PartitionedConvolver m_convolverL;
+    PartitionedConvolver m_convolverR;
 
     std::shared_mutex m_convolverMutex;
     void generateAndLoadIR_Async();
+    void waitForGenerate();
+    void cancelGenerate();
+    uint64_t irCacheKey(const ReverbTargetParams& params, int numGenerations) const;
 };
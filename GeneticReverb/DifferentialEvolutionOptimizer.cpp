@@ -0,0 +1,163 @@
+﻿/**
+ * @file DifferentialEvolutionOptimizer.cpp
+ * @author Goto Kenta
+ * @brief 差分進化による最適化の実装
+ */
+
+# include "DifferentialEvolutionOptimizer.h"
+
+# include <algorithm>
+# include <limits>
+
+DifferentialEvolutionOptimizer::DifferentialEvolutionOptimizer(float sampleRate)
+    : IROptimizer(sampleRate)
+{
+}
+
+DifferentialEvolutionOptimizer::~DifferentialEvolutionOptimizer() = default;
+
+void DifferentialEvolutionOptimizer::setSurrogate(bool enabled) {
+    m_surrogateEnabled = enabled;
+}
+
+/**
+ * @brief 目標に合うIRのパラメータを探す関数
+ * @param targetParams 目標とする残響特性のパラメータ
+ * @param numGenerations 世代数（1世代で24個体を評価する）
+ * @return 最良のパラメータから作ったIR
+ */
+std::vector<float> DifferentialEvolutionOptimizer::compute(const ReverbTargetParams& targetParams, int numGenerations) {
+    m_bestSpectrum.reset();
+    m_model.prepare(m_sampleRate, targetParams, static_cast<uint32_t>(m_rng()));
+    m_surrogate.reset();
+    reportProgress(0, numGenerations, 1e10);
+
+    // 初期集団（1つは目標のT60で単純に減衰するIR、残りは一様乱数）
+    m_population.resize(kPopulation);
+    m_model.initialGuess(m_population[0].data());
+    for (size_t p = 1 ; p < kPopulation ; ++p) {
+        for (double& x : m_population[p]) {
+            x = m_dist0To1(m_rng);
+        }
+    }
+    m_fitness.resize(kPopulation);
+    m_predicted.resize(kPopulation);
+    m_pending.resize(kPopulation);
+    for (size_t p = 0 ; p < kPopulation ; ++p) {
+        m_predicted[p] = m_model.predict(m_population[p].data());
+        m_pending[p] = p;
+    }
+    evaluate(m_population, targetParams, m_fitness);
+    m_surrogate.recalibrate();
+
+    std::uniform_int_distribution<size_t> distIndex(0, kPopulation - 1);
+    std::uniform_int_distribution<size_t> distDimension(0, kDimension - 1);
+    m_trials.resize(kPopulation);
+
+    auto bestIndex = [&]() {
+        return static_cast<size_t>(std::min_element(m_fitness.begin(), m_fitness.end()) - m_fitness.begin());
+    };
+
+    for (int gen = 0 ; gen < numGenerations ; ++gen) {
+        // 試行個体 = x_r1 + F (x_r2 - x_r3) を成分ごとに CR の確率で採用する
+        for (size_t p = 0 ; p < kPopulation ; ++p) {
+            size_t r1, r2, r3;
+            do { r1 = distIndex(m_rng); } while (r1 == p);
+            do { r2 = distIndex(m_rng); } while (r2 == p || r2 == r1);
+            do { r3 = distIndex(m_rng); } while (r3 == p || r3 == r1 || r3 == r2);
+
+            const size_t forced = distDimension(m_rng); // 最低1成分は必ず変える
+            for (size_t i = 0 ; i < kDimension ; ++i) {
+                if (i != forced && m_dist0To1(m_rng) >= kCrossoverRate) {
+                    m_trials[p][i] = m_population[p][i];
+                    continue;
+                }
+
+                const double base = m_population[r1][i];
+                double x = base + kDifferentialWeight * (m_population[r2][i] - m_population[r3][i]);
+                if (x < 0.0)
+                    x = base * m_dist0To1(m_rng);
+                else if (x > 1.0)
+                    x = base + (1.0 - base) * m_dist0To1(m_rng);
+                m_trials[p][i] = x;
+            }
+        }
+
+        // 代理モデルで親に勝てそうにない試行個体はIRを作らずに捨てる
+        m_trialFitness.assign(kPopulation, std::numeric_limits<double>::infinity());
+        m_pending.clear();
+        for (size_t p = 0 ; p < kPopulation ; ++p) {
+            if (m_surrogateEnabled) {
+                m_predicted[p] = m_model.predict(m_trials[p].data());
+                const double predicted = m_surrogate.predictFitness(m_predicted[p], targetParams);
+                if (predicted > m_fitness[p] * kScreenRelativeMargin + kScreenAbsoluteMargin)
+                    continue;
+            }
+            m_pending.push_back(p);
+        }
+
+        evaluate(m_trials, targetParams, m_trialFitness);
+        if ((gen + 1) % kRecalibrationInterval == 0)
+            m_surrogate.recalibrate();
+
+        // 親より悪くなければ置き換える
+        for (size_t p = 0 ; p < kPopulation ; ++p) {
+            if (m_trialFitness[p] <= m_fitness[p]) {
+                m_population[p] = m_trials[p];
+                m_fitness[p] = m_trialFitness[p];
+            }
+        }
+
+        const double bestFitness = m_fitness[bestIndex()];
+        reportProgress(gen + 1, numGenerations, bestFitness);
+
+        if (bestFitness < 0.001)
+            break;
+
+        // キャンセルが要求された場合はループを抜ける
+        if (isCancelled())
+            break;
+    }
+
+    const size_t best = bestIndex();
+    reportProgress(numGenerations, numGenerations, m_fitness[best]);
+
+    std::vector<float> ir;
+    m_model.render(m_population[best].data(), ir);
+    storeBestSpectrum(ir, nullptr);
+    return ir;
+}
+
+/**
+ * @brief m_pending の番号の候補のIRを作ってまとめて評価する関数
+ * @param candidates 正規化したパラメータ
+ * @param targetParams 目標とする残響特性のパラメータ
+ * @param fitness 結果（m_pending の番号の要素だけ書き換える）
+ * @note 評価した個体は、m_predicted の見積もりとの組にして代理モデルの補正に使う
+ */
+void DifferentialEvolutionOptimizer::evaluate(const std::vector<Vector>& candidates, const ReverbTargetParams& targetParams, std::vector<double>& fitness) {
+    const size_t count = m_pending.size();
+    if (count == 0)
+        return;
+
+    m_irs.resize(count);
+    m_irPointers.resize(count);
+    m_lengths.resize(count);
+    m_measured.resize(count);
+    m_results.resize(count);
+
+    for (size_t k = 0 ; k < count ; ++k) {
+        m_model.render(candidates[m_pending[k]].data(), m_irs[k]);
+        m_irPointers[k] = m_irs[k].data();
+        m_lengths[k] = m_irs[k].size();
+    }
+
+    m_evaluator.evaluate(m_irPointers.data(), m_lengths.data(), count, targetParams, m_results.data(), nullptr, m_measured.data());
+
+    for (size_t k = 0 ; k < count ; ++k) {
+        const size_t index = m_pending[k];
+        fitness[index] = m_results[k];
+        if (m_surrogateEnabled)
+            m_surrogate.addSample(m_predicted[index], m_measured[k]);
+    }
+}
@@ -0,0 +1,63 @@
+﻿/**
+ * @file DifferentialEvolutionOptimizer.h
+ * @author Goto Kenta
+ * @brief 減衰のパラメータを差分進化で探す最適化
+ */
+
+# pragma once
+
+# include "FitnessSurrogate.h"
+# include "IROptimizer.h"
+# include "ParametricIR.h"
+
+# include <array>
+# include <random>
+# include <vector>
+
+/**
+ * @brief ParametricIRModel のパラメータを DE/rand/1/bin で探す
+ * @note 個体数は24（BatchedEnergyAnalysis の3回分）。範囲外に出た成分は、
+ *       基準の個体とはみ出した側の端の間の乱数に置き換える。
+ *       試行個体は先に代理モデル（FitnessSurrogate）で適応度を予測し、親に勝ちそうなものだけIRを作って評価する
+ */
+class DifferentialEvolutionOptimizer : public IROptimizer {
+public:
+    explicit DifferentialEvolutionOptimizer(float sampleRate);
+    ~DifferentialEvolutionOptimizer() override;
+
+    OptimizerBackend backend() const override { return OptimizerBackend::DifferentialEvolution; }
+    std::vector<float> compute(const ReverbTargetParams& targetParams, int numGenerations) override;
+
+    // 代理モデルによる事前の選別の有効/無効（既定で有効）
+    void setSurrogate(bool enabled);
+
+private:
+    static constexpr size_t kDimension = ParametricIRModel::kParameterCount;
+    static constexpr size_t kPopulation = 3 * BatchedEnergyAnalysis::kLanes;
+    static constexpr double kDifferentialWeight = 0.7; // F
+    static constexpr double kCrossoverRate = 0.9;      // CR
+    static constexpr double kScreenRelativeMargin = 1.25; // 親の適応度の何倍までを評価するか
+    static constexpr double kScreenAbsoluteMargin = 0.1;
+    static constexpr int kRecalibrationInterval = 4;     // 代理モデルを補正し直す世代の間隔
+
+    using Vector = std::array<double, kDimension>;
+
+    std::uniform_real_distribution<double> m_dist0To1{0.0, 1.0};
+    ParametricIRModel m_model;
+
+    std::vector<Vector> m_population;
+    std::vector<Vector> m_trials;
+    std::vector<double> m_fitness;
+    std::vector<double> m_trialFitness;
+    std::vector<EnergyMetrics> m_predicted; // 代理モデルの見積もり（個体ごと）
+    std::vector<EnergyMetrics> m_measured;  // 評価で測った指標（m_pending の順）
+    std::vector<double> m_results;          // 評価の結果（m_pending の順）
+    std::vector<size_t> m_pending;          // 評価する個体の番号
+    FitnessSurrogate m_surrogate;
+    bool m_surrogateEnabled = true;
+    std::vector<std::vector<float>> m_irs;
+    std::vector<const float*> m_irPointers;
+    std::vector<size_t> m_lengths;
+
+    void evaluate(const std::vector<Vector>& candidates, const ReverbTargetParams& targetParams, std::vector<double>& fitness);
+};
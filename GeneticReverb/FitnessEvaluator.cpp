@@ -0,0 +1,61 @@
+﻿/**
+ * @file FitnessEvaluator.cpp
+ * @author Goto Kenta
+ * @brief 適応度の計算の実装
+ */
+
+# include "FitnessEvaluator.h"
+# include "AnalysisHelpers.h"
+
+# include <algorithm>
+# include <cmath>
+
+FitnessEvaluator::FitnessEvaluator(float sampleRate)
+    : m_sampleRate(sampleRate)
+{
+}
+
+double FitnessEvaluator::Score(float t60, float c80, const ReverbTargetParams& targetParams) {
+    // 目標パラメータとの差を計算
+    const double errorT60 = std::abs(t60 - targetParams.t60);
+    const double errorC80 = std::abs(c80 - targetParams.c80);
+
+    return (errorT60 * 100.0) + (errorC80 * 1.0);
+}
+
+void FitnessEvaluator::setSpectralAnalysis(size_t blockSize, const SpectralWeights& weights) {
+    m_spectralBlockSize = blockSize;
+    m_spectralWeights = weights;
+}
+
+void FitnessEvaluator::evaluate(const float* const* irs, const size_t* lengths, size_t count, const ReverbTargetParams& targetParams,
+                                double* fitness, PartitionedIR::Ptr* spectra, EnergyMetrics* metrics) {
+    EnergyMetrics batch[BatchedEnergyAnalysis::kLanes];
+    m_evaluationCount += count;
+
+    for (size_t first = 0 ; first < count ; first += BatchedEnergyAnalysis::kLanes) {
+        const size_t batched = std::min(BatchedEnergyAnalysis::kLanes, count - first);
+        m_energyAnalysis.analyze(irs + first, lengths + first, batched, m_sampleRate, batch);
+
+        for (size_t lane = 0 ; lane < batched ; ++lane) {
+            const size_t index = first + lane;
+            fitness[index] = Score(batch[lane].t60, batch[lane].c80, targetParams);
+            if (metrics)
+                metrics[index] = batch[lane];
+
+            // 周波数領域の評価（スペクトルはコンボリューターと同じ分割で計算し、呼び出し側が持っていれば使い回す）
+            if (m_spectralBlockSize > 0 && m_spectralWeights.any()) {
+                PartitionedIR::Ptr spectrum = spectra ? spectra[index] : nullptr;
+                if (!spectrum)
+                    spectrum = PartitionedIR::Create(m_spectralBlockSize, irs[index], lengths[index]);
+                if (spectra)
+                    spectra[index] = spectrum;
+
+                const SpectralMetrics spectral = calculateSpectralMetrics(*spectrum, m_sampleRate);
+                fitness[index] += std::abs(spectral.bassRatio - targetParams.br) * m_spectralWeights.bassRatio
+                                + std::abs(spectral.brightness - targetParams.brightness) * m_spectralWeights.brightness
+                                + spectral.coloration * m_spectralWeights.coloration;
+            }
+        }
+    }
+}
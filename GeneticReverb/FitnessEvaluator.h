@@ -0,0 +1,81 @@
+﻿/**
+ * @file FitnessEvaluator.h
+ * @author Goto Kenta
+ * @brief IRが目標の残響特性にどれだけ近いかを求める評価関数（GAとパラメータ最適化で共有する）
+ */
+
+# pragma once
+
+# include "BatchedEnergyAnalysis.h"
+# include "../Common/PartitionedIR.h"
+
+# include <cstddef>
+
+// GAのターゲットパラメータ構造体
+struct ReverbTargetParams {
+    float t60 = 0.4f;
+    float edt = 0.06f;
+    float c80 = 12.0f;
+    float br = 1.0f;         // 低域と中域の残響時間の比（BR）
+    float brightness = 1.0f; // 高域と中域の残響時間の比
+};
+
+/**
+ * @brief 周波数領域の評価の重み（0の項は適応度に含めない。全て0なら周波数領域の評価をしない）
+ */
+struct SpectralWeights {
+    double bassRatio = 0.0;  // |BR - 目標| の重み
+    double brightness = 0.0; // |高域と中域の残響時間の比 - 目標| の重み
+    double coloration = 0.0; // エネルギースペクトルのばらつき（dBの標準偏差）の重み
+
+    bool any() const { return bassRatio > 0.0 || brightness > 0.0 || coloration > 0.0; }
+};
+
+/**
+ * @brief IRの適応度（小さいほど良い）を計算する
+ * @note エネルギーの指標は BatchedEnergyAnalysis で8本ずつまとめて計算する
+ */
+class FitnessEvaluator {
+public:
+    explicit FitnessEvaluator(float sampleRate);
+
+    /**
+     * @brief T60とC80から適応度を求める（T60の誤差を重視する）
+     * @param t60 T60（秒）
+     * @param c80 C80（dB）
+     * @param targetParams 目標とする残響特性のパラメータ
+     * @return 適応度
+     */
+    static double Score(float t60, float c80, const ReverbTargetParams& targetParams);
+
+    /**
+     * @brief 周波数領域の評価の設定
+     * @param blockSize コンボリューターの分割の長さ（0なら周波数領域の解析をしない）
+     * @param weights BR・明るさ・色付きの重み
+     */
+    void setSpectralAnalysis(size_t blockSize, const SpectralWeights& weights);
+    size_t spectralBlockSize() const { return m_spectralBlockSize; }
+
+    // これまでに evaluate したIRの数（ふるい分けや代理モデルで減らせた評価の数を比べるのに使う）
+    size_t evaluationCount() const { return m_evaluationCount; }
+
+    /**
+     * @brief IRの適応度をまとめて計算する
+     * @param irs インパルス応答（count 本）
+     * @param lengths 各インパルス応答の長さ（1以上）
+     * @param count インパルス応答の数（いくつでもよい）
+     * @param targetParams 目標とする残響特性のパラメータ
+     * @param fitness 結果（count 個）
+     * @param spectra 分割スペクトル（count 個、nullptr 可）。周波数領域の評価で必要なときは空の要素にだけ計算して入れる
+     * @param metrics エネルギーの指標（count 個、nullptr 可）。代理モデルの補正に使う
+     */
+    void evaluate(const float* const* irs, const size_t* lengths, size_t count, const ReverbTargetParams& targetParams,
+                  double* fitness, PartitionedIR::Ptr* spectra, EnergyMetrics* metrics = nullptr);
+
+private:
+    float m_sampleRate;
+    BatchedEnergyAnalysis m_energyAnalysis;
+    size_t m_spectralBlockSize = 0;
+    SpectralWeights m_spectralWeights;
+    size_t m_evaluationCount = 0;
+};
@@ -0,0 +1,87 @@
+﻿/**
+ * @file FitnessSurrogate.cpp
+ * @author Goto Kenta
+ * @brief 代理モデルの補正の実装
+ */
+
+# include "FitnessSurrogate.h"
+
+# include <algorithm>
+# include <cmath>
+
+void FitnessSurrogate::reset() {
+    m_predicted.clear();
+    m_measured.clear();
+    m_next = 0;
+    m_t60 = Line{};
+    m_c80 = Line{};
+}
+
+void FitnessSurrogate::addSample(const EnergyMetrics& predicted, const EnergyMetrics& measured) {
+    if (m_predicted.size() < kWindow) {
+        m_predicted.push_back(predicted);
+        m_measured.push_back(measured);
+        return;
+    }
+    m_predicted[m_next] = predicted;
+    m_measured[m_next] = measured;
+    m_next = (m_next + 1) % kWindow;
+}
+
+void FitnessSurrogate::recalibrate() {
+    const size_t count = m_predicted.size();
+    if (count < kMinSamples)
+        return;
+
+    std::vector<double> x(count), y(count);
+    for (size_t i = 0 ; i < count ; ++i) {
+        x[i] = m_predicted[i].t60;
+        y[i] = m_measured[i].t60;
+    }
+    m_t60 = Fit(x, y);
+
+    for (size_t i = 0 ; i < count ; ++i) {
+        x[i] = m_predicted[i].c80;
+        y[i] = m_measured[i].c80;
+    }
+    m_c80 = Fit(x, y);
+}
+
+double FitnessSurrogate::predictFitness(const EnergyMetrics& predicted, const ReverbTargetParams& targetParams) const {
+    const auto t60 = static_cast<float>(m_t60.slope * predicted.t60 + m_t60.offset);
+    const auto c80 = static_cast<float>(m_c80.slope * predicted.c80 + m_c80.offset);
+    return FitnessEvaluator::Score(t60, c80, targetParams);
+}
+
+/**
+ * @brief 1次式の最小2乗の当てはめ
+ * @param x 見積もり
+ * @param y 実測
+ * @return 当てはめた式（x のばらつきが小さいか、傾きが1から大きく外れるときは傾き1で差の平均）
+ */
+FitnessSurrogate::Line FitnessSurrogate::Fit(const std::vector<double>& x, const std::vector<double>& y) {
+    const auto count = static_cast<double>(x.size());
+    double meanX = 0.0, meanY = 0.0;
+    for (size_t i = 0 ; i < x.size() ; ++i) {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= count;
+    meanY /= count;
+
+    double varianceX = 0.0, covariance = 0.0;
+    for (size_t i = 0 ; i < x.size() ; ++i) {
+        varianceX += (x[i] - meanX) * (x[i] - meanX);
+        covariance += (x[i] - meanX) * (y[i] - meanY);
+    }
+
+    Line line;
+    const double spread = 1e-3 * std::max(std::abs(meanX), 1.0);
+    if (varianceX > count * spread * spread) {
+        const double slope = covariance / varianceX;
+        if (slope > 0.5 && slope < 2.0)
+            line.slope = slope;
+    }
+    line.offset = meanY - line.slope * meanX;
+    return line;
+}
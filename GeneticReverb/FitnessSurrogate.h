@@ -0,0 +1,60 @@
+﻿/**
+ * @file FitnessSurrogate.h
+ * @author Goto Kenta
+ * @brief パラメータから見積もった指標を実測に合わせて補正する代理モデル
+ */
+
+# pragma once
+
+# include "BatchedEnergyAnalysis.h"
+# include "FitnessEvaluator.h"
+
+# include <cstddef>
+# include <vector>
+
+/**
+ * @brief ParametricIRModel::predict の見積もりを、実際に評価した個体の指標で補正して適応度を予測する
+ * @note 見積もりは雑音のエネルギーの期待値から求めるので、compute ごとに固定した雑音の分だけ偏る。
+ *       直近 kWindow 個の（見積もり, 実測）の組から、T60とC80それぞれに1次式を最小2乗で当てはめて補正する。
+ *       探索が狭い範囲に集まると当てはめが不安定になるので、見積もりのばらつきが小さいときは差の平均だけを使う
+ */
+class FitnessSurrogate {
+public:
+    static constexpr size_t kWindow = 32;     // 補正に使う直近の組の数
+    static constexpr size_t kMinSamples = 8;  // これより少ないときは補正しない
+
+    // 補正と集めた組を捨てる（compute の最初に呼ぶ）
+    void reset();
+
+    /**
+     * @brief 実際に評価した個体の組を加える（補正は recalibrate まで変わらない）
+     * @param predicted ParametricIRModel::predict の値
+     * @param measured FitnessEvaluator で測った値
+     */
+    void addSample(const EnergyMetrics& predicted, const EnergyMetrics& measured);
+
+    // 集めた組から補正の式を作り直す
+    void recalibrate();
+
+    /**
+     * @brief 補正した指標から適応度を予測する
+     * @param predicted ParametricIRModel::predict の値
+     * @param targetParams 目標とする残響特性のパラメータ
+     * @return 予測した適応度（周波数領域の評価の項は含まないので、実際の適応度の下限の目安になる）
+     */
+    double predictFitness(const EnergyMetrics& predicted, const ReverbTargetParams& targetParams) const;
+
+private:
+    // measured ≒ slope * predicted + offset
+    struct Line {
+        double slope = 1.0;
+        double offset = 0.0;
+    };
+
+    std::vector<EnergyMetrics> m_predicted; // 長さ kWindow のリングバッファ
+    std::vector<EnergyMetrics> m_measured;
+    size_t m_next = 0;
+    Line m_t60, m_c80;
+
+    static Line Fit(const std::vector<double>& x, const std::vector<double>& y);
+};
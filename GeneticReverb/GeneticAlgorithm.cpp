@@ -1,16 +1,20 @@
 ﻿# include "GeneticAlgorithm.h"
 # include "AnalysisHelpers.h"
+# include "../Common/SimdDispatch.h"
 
+# include <algorithm>
+# include <cmath>
+# include <limits>
 # include <random>
+# include <utility>
 
 /**
  * @brief 遺伝的アルゴリズムクラスの実装
  */
 GeneticAlgorithm::GeneticAlgorithm(int populationSize, float mutationRate, float sampleRate)
-    : m_popSize(populationSize),
-      m_mutationRate(mutationRate),
-      m_sampleRate(sampleRate),
-      m_rng(std::random_device{}())
+    : IROptimizer(sampleRate),
+      m_popSize(populationSize),
+      m_mutationRate(mutationRate)
 {
     m_population.resize(m_popSize);
 }
@@ -40,8 +44,11 @@ std::vector<float> GeneticAlgorithm::compute(const ReverbTargetParams& targetPar
         safedT60 = 0.001f;
     }
 
-    if (m_onProgress)
-        m_onProgress(0, numGenerations, 1e10);
+    m_bestSpectrum.reset();
+    m_screenThreshold = std::numeric_limits<double>::infinity();
+    m_coarseError = 0.0;
+
+    reportProgress(0, numGenerations, 1e10);
 
     // 初期集団をランダムに生成
     initializePopulation(targetParams.t60);
@@ -63,16 +70,13 @@ std::vector<float> GeneticAlgorithm::compute(const ReverbTargetParams& targetPar
             return { };
         }
 
-        if (m_onProgress) {
-            double best = m_population[0].fitness;
-            m_onProgress(gen + 1, numGenerations, best);
-        }
+        reportProgress(gen + 1, numGenerations, m_population[0].fitness);
 
         if (m_population[0].fitness < 0.001)
             break;
 
         // キャンセルが要求された場合はループを抜ける
-        if (m_cancel.load(std::memory_order_relaxed))
+        if (isCancelled())
             break;
 
         // 次世代の個体群を生成
@@ -83,41 +87,54 @@ std::vector<float> GeneticAlgorithm::compute(const ReverbTargetParams& targetPar
         }
     }
 
-    if (m_onProgress) {
-        const double best = (m_population.empty() || m_population[0].ir.empty()) ? 1e10 : m_population[0].fitness;
-        m_onProgress(numGenerations, numGenerations, best);
-    }
+    reportProgress(numGenerations, numGenerations, (m_population.empty() || m_population[0].ir.empty()) ? 1e10 : m_population[0].fitness);
 
     if (m_population.empty() || m_population[0].ir.empty()) {
         std::cerr << "GA: Returning empty IR" << std::endl;
         return { };
     }
 
-    return m_population[0].ir;
+    // 選ばれたIRの分割スペクトル（評価で計算済みならそれを使う）
+    const Individual& best = m_population[0];
+    storeBestSpectrum(best.ir, best.spectrum);
+
+    return best.ir;
 }
 
 /**
- * @brief 進捗コールバック関数の設定
- * @param callback コールバック関数
+ * @brief 粗い評価でのふるい分けを設定する関数
+ * @param enabled true なら、エリートの境界から遠い子は32サンプルごとのエネルギーでの評価だけで済ませる
  */
-void GeneticAlgorithm::setProgressCallback(std::function<void(int, int, double)> callback) {
-    m_onProgress = std::move(callback);
+void GeneticAlgorithm::setScreening(bool enabled) {
+    m_screening = enabled;
 }
 
 /**
- * @brief 処理のキャンセルを要求する関数
+ * @brief 親の選び方を設定する関数
+ * @param method 選び方
+ * @param tournamentSize トーナメントの大きさ（Tournament のときだけ使う、1以上）
  */
-void GeneticAlgorithm::cancel()
-{
-    m_cancel.store(true, std::memory_order_relaxed);
+void GeneticAlgorithm::setSelection(SelectionMethod method, int tournamentSize) {
+    m_selection = method;
+    m_tournamentSize = std::max(tournamentSize, 1);
 }
 
 /**
- * @brief キャンセルフラグをリセットする関数
+ * @brief 交叉の方法を設定する関数
+ * @param method 交叉の方法
+ * @param cutPoints 切れ目の数（Segment のときだけ使う、1以上）
  */
-void GeneticAlgorithm::resetCancel()
-{
-    m_cancel.store(false, std::memory_order_relaxed);
+void GeneticAlgorithm::setCrossover(CrossoverMethod method, int cutPoints) {
+    m_crossover = method;
+    m_crossoverCutPoints = std::max(cutPoints, 1);
+}
+
+/**
+ * @brief 突然変異の方法を設定する関数
+ * @param method 突然変異の方法
+ */
+void GeneticAlgorithm::setMutation(MutationMethod method) {
+    m_mutation = method;
 }
 
 /**
@@ -138,6 +155,18 @@ void GeneticAlgorithm::initializePopulation(float targetT60) {
     if (irLength < 1024)
         irLength = 1024;
 
+    // 指定されたT60に基づく指数関数的減衰（全個体で同じなので1度だけ計算する）
+    m_decayEnvelope.resize(irLength);
+    for (size_t i = 0 ; i < irLength ; ++i) {
+        float t = static_cast<float>(i) / m_sampleRate; // 時間
+        float decay = 1.0f;
+        if (targetT60 > 1e-6f)
+            decay = std::pow(10.0f, (-3.0f * t) / targetT60);
+        m_decayEnvelope[i] = decay;
+    }
+
+    const SimdKernelTable& simd = SimdKernels();
+
     // 各個体のIRをランダムに生成
     for (auto& individual : m_population) {
         individual.ir.clear();
@@ -145,19 +174,15 @@ void GeneticAlgorithm::initializePopulation(float targetT60) {
 
         // ランダムなインパルス応答を生成
         for (size_t i = 0 ; i < irLength ; ++i) {
-            float t = static_cast<float>(i) / m_sampleRate; // 時間
-            float randomNoise = m_distNeg1to1(m_rng);    // ランダムノイズ
-
-            // 指定されたT60に基づく指数関数的減衰
-            float decay = 1.0f;
-            if (targetT60 > 1e-6f)
-                decay = std::pow(10.0f, (-3.0f * t) / targetT60);
-            else
-                decay = 1.0f;
-
-            individual.ir[i] = randomNoise * decay;
+            individual.ir[i] = m_distNeg1to1(m_rng); // ランダムノイズ
         }
+        simd.multiply(individual.ir.data(), m_decayEnvelope.data(), individual.ir.data(), irLength);
+        updateEnvelope(individual, 0, (irLength + kEnvelopeBlockSize - 1) / kEnvelopeBlockSize);
 
+        individual.spectrum.reset();
+        individual.evaluated = false;
+        individual.mutationRate = m_mutationRate;
+        individual.mutationStep = kInitialMutationStep;
         individual.fitness = 1e10; // 初期適応度を高く設定
     }
 }
@@ -165,33 +190,187 @@ void GeneticAlgorithm::initializePopulation(float targetT60) {
 /**
  * @brief 個体群の適応度を計算する関数
  * @param targetParams 目標とする残響特性のパラメータ
+ * @note 前の世代から変わっていない個体（エリート）は評価し直さない。
+ *       新しい子は粗い評価がエリートの境界に近いものだけを詳しく評価し、残りは粗い評価の値を適応度にする。
+ *       境界からの余裕は、この compute で詳しく評価した個体の粗い評価の誤差の最大値にする
+ *       （集団が収束すると適応度の広がりが粗い評価の誤差と同じくらいになるので、固定の割合では何も落とせないか、エリートを落とす）
  */
 void GeneticAlgorithm::calculatePopulationFitness(const ReverbTargetParams& targetParams) {
     if (m_population.empty())
         return;
 
-    // 各個体の適応度を計算
+    m_pendingEvaluation.clear();
     for (auto& individual : m_population) {
         if (individual.ir.empty()) {
             individual.fitness = 1e10;
+            individual.evaluated = true;
             continue;
         }
 
-        // シュレーダーの残響曲線を計算
-        auto edc = calculateSchroederDecay(individual.ir);
-        if (edc.empty())
+        if (individual.evaluated)
             continue;
 
-        // T60とC80を計算
-        float t60 = calculateT60(edc, m_sampleRate);
-        float c80 = calculateC80(individual.ir, m_sampleRate);
+        // 粗い評価でエリートに入る見込みがない子は詳しく評価しない
+        if (m_screening && m_screenThreshold < std::numeric_limits<double>::infinity()) {
+            const double coarse = coarseFitness(individual, targetParams);
+            if (coarse > m_screenThreshold) {
+                individual.fitness = coarse;
+                continue;
+            }
+        }
+
+        m_pendingEvaluation.push_back(&individual);
+    }
+    evaluateFully(m_pendingEvaluation, targetParams);
+
+    // 粗い評価のままの個体がエリートに入ったときは、詳しく評価して並べ直す
+    const int elites = eliteCount();
+    for (;;) {
+        std::sort(m_population.begin(), m_population.end());
+
+        m_pendingEvaluation.clear();
+        for (int i = 0 ; i < elites ; ++i) {
+            if (!m_population[i].evaluated)
+                m_pendingEvaluation.push_back(&m_population[i]);
+        }
+        if (m_pendingEvaluation.empty())
+            break;
+
+        evaluateFully(m_pendingEvaluation, targetParams);
+    }
+
+    // 次の世代のふるい分けの基準（粗い評価がこれまでの最大の誤差だけずれていても、エリートに入る子は落とさない）
+    m_screenThreshold = m_population[elites - 1].fitness + m_coarseError;
+}
+
+/**
+ * @brief 個体の適応度を詳しく計算する関数
+ * @param individuals 評価する個体
+ * @param targetParams 目標とする残響特性のパラメータ
+ */
+void GeneticAlgorithm::evaluateFully(const std::vector<Individual*>& individuals, const ReverbTargetParams& targetParams) {
+    const size_t count = individuals.size();
+    m_pendingIRs.resize(count);
+    m_pendingLengths.resize(count);
+    m_pendingFitness.resize(count);
+    m_pendingSpectra.resize(count);
+    for (size_t i = 0 ; i < count ; ++i) {
+        m_pendingIRs[i] = individuals[i]->ir.data();
+        m_pendingLengths[i] = individuals[i]->ir.size();
+        m_pendingSpectra[i] = individuals[i]->spectrum;
+    }
+
+    // スペクトルは IR が変わらない限り個体が持って使い回す
+    m_evaluator.evaluate(m_pendingIRs.data(), m_pendingLengths.data(), count, targetParams, m_pendingFitness.data(), m_pendingSpectra.data());
+
+    for (size_t i = 0 ; i < count ; ++i) {
+        // 粗い評価の誤差の最大値（ふるい分けの余裕に使う。包絡から求めるので詳しい評価よりずっと軽い）
+        m_coarseError = std::max(m_coarseError, std::abs(m_pendingFitness[i] - coarseFitness(*individuals[i], targetParams)));
+
+        individuals[i]->fitness = m_pendingFitness[i];
+        individuals[i]->spectrum = std::move(m_pendingSpectra[i]);
+        individuals[i]->evaluated = true;
+    }
+}
+
+/**
+ * @brief エネルギー包絡から適応度を粗く見積もる関数
+ * @param individual 評価する個体
+ * @param targetParams 目標とする残響特性のパラメータ
+ * @return 粗い適応度（周波数領域の項は含めないので、詳しい評価より小さめになる）
+ */
+double GeneticAlgorithm::coarseFitness(const Individual& individual, const ReverbTargetParams& targetParams) {
+    const float t60 = calculateBlockT60(individual.envelope, kEnvelopeBlockSize, m_sampleRate);
+    const float c80 = calculateBlockC80(individual.envelope, kEnvelopeBlockSize, m_sampleRate);
+
+    return FitnessEvaluator::Score(t60, c80, targetParams);
+}
 
-        // 目標パラメータとの差を計算
-        double errorT60 = std::abs(t60 - targetParams.t60);
-        double errorC80 = std::abs(c80 - targetParams.c80);
+/**
+ * @brief そのまま次世代に残すエリートの数（上位20%、最低1）
+ */
+int GeneticAlgorithm::eliteCount() const {
+    int count = m_popSize * 20 / 100;
+    if (count < 1) count = 1;
+    if (count > m_popSize) count = m_popSize;
+    return count;
+}
 
-        // 適応度を計算（T60の誤差を重視）
-        individual.fitness = (errorT60 * 100.0) + (errorC80 * 1.0);
+/**
+ * @brief 親を選んで m_parents に入れる関数
+ * @param count 選ぶ親の数
+ * @note 個体群は適応度の順に並んでいるので、添字が小さいほど良い個体になる
+ */
+void GeneticAlgorithm::selectParents(size_t count) {
+    const int size = static_cast<int>(m_population.size());
+    m_parents.resize(count);
+    if (count == 0 || size == 0)
+        return;
+
+    switch (m_selection) {
+        case SelectionMethod::Elite: {
+            std::uniform_int_distribution<int> distElite(0, eliteCount() - 1);
+            for (int& parent : m_parents) {
+                parent = distElite(m_rng);
+            }
+            break;
+        }
+
+        case SelectionMethod::Tournament: {
+            // 並んでいるので、最も良い個体は引いた添字の最小値
+            std::uniform_int_distribution<int> distAll(0, size - 1);
+            for (int& parent : m_parents) {
+                int best = distAll(m_rng);
+                for (int k = 1 ; k < m_tournamentSize ; ++k) {
+                    best = std::min(best, distAll(m_rng));
+                }
+                parent = best;
+            }
+            break;
+        }
+
+        case SelectionMethod::LinearRanking: {
+            // 順位 r（0が最良）の重みは pressure - (2 * pressure - 2) * r / (size - 1)
+            m_selectionWeights.resize(size);
+            double total = 0.0;
+            for (int r = 0 ; r < size ; ++r) {
+                const double position = (size > 1) ? static_cast<double>(r) / static_cast<double>(size - 1) : 0.0;
+                total += kRankingPressure - (2.0 * kRankingPressure - 2.0) * position;
+                m_selectionWeights[r] = total;
+            }
+
+            std::uniform_real_distribution<double> distTotal(0.0, total);
+            for (int& parent : m_parents) {
+                const auto it = std::upper_bound(m_selectionWeights.begin(), m_selectionWeights.end(), distTotal(m_rng));
+                parent = std::min(static_cast<int>(it - m_selectionWeights.begin()), size - 1);
+            }
+            break;
+        }
+
+        case SelectionMethod::StochasticUniversal: {
+            // 適応度は小さいほど良いので逆数を重みにし、1回の乱数で等間隔に count 個選ぶ
+            m_selectionWeights.resize(size);
+            double total = 0.0;
+            for (int i = 0 ; i < size ; ++i) {
+                total += 1.0 / (m_population[i].fitness + 1e-3);
+                m_selectionWeights[i] = total;
+            }
+
+            const double step = total / static_cast<double>(count);
+            double pointer = std::uniform_real_distribution<double>(0.0, step)(m_rng);
+            int index = 0;
+            for (int& parent : m_parents) {
+                while (index < size - 1 && m_selectionWeights[index] <= pointer) {
+                    ++index;
+                }
+                parent = index;
+                pointer += step;
+            }
+
+            // 選んだ順のままだと良い個体同士が組になるので混ぜる
+            std::shuffle(m_parents.begin(), m_parents.end(), m_rng);
+            break;
+        }
     }
 }
 
@@ -207,19 +386,18 @@ std::vector<Individual> GeneticAlgorithm::createNextGeneration() {
     newPopulation.resize(m_popSize);
 
     // エリート選択: 上位20%をそのまま次世代にコピー
-    int eliteCount = m_popSize * 20 / 100;
-    if (eliteCount < 1) eliteCount = 1;
-    if (eliteCount > m_popSize) eliteCount = m_popSize;
+    const int eliteCount = this->eliteCount();
 
     for (int i = 0 ; i < eliteCount ; ++i) {
         newPopulation[i] = m_population[i];
     }
 
     // 交叉と突然変異で残りの個体を生成
-    std::uniform_int_distribution<int> distElite(0, eliteCount - 1);
+    selectParents(2 * static_cast<size_t>(m_popSize - eliteCount));
     for (int i = eliteCount ; i < m_popSize ; ++i) {
-        const Individual& parent1 = m_population[distElite(m_rng)];
-        const Individual& parent2 = m_population[distElite(m_rng)];
+        const size_t pair = 2 * static_cast<size_t>(i - eliteCount);
+        const Individual& parent1 = m_population[m_parents[pair]];
+        const Individual& parent2 = m_population[m_parents[pair + 1]];
 
         // 交叉操作
         Individual child = crossover(parent1, parent2);
@@ -228,7 +406,7 @@ std::vector<Individual> GeneticAlgorithm::createNextGeneration() {
         mutate(child);
 
         // 新しい個体を次世代に追加
-        newPopulation[i] = child;
+        newPopulation[i] = std::move(child);
     }
 
     return newPopulation;
@@ -239,9 +417,9 @@ std::vector<Individual> GeneticAlgorithm::createNextGeneration() {
  * @param parent1 親個体1
  * @param parent2 親個体2
  * @return 生成された子個体
+ * @note 子のエネルギー包絡は、親のブロックをそのまま写せるところは写し、それ以外だけ計算し直す
  */
 Individual GeneticAlgorithm::crossover(const Individual& parent1, const Individual& parent2) {
-    // 単純な一様交叉
     Individual child;
     size_t len1 = parent1.ir.size();
     size_t len2 = parent2.ir.size();
@@ -253,16 +431,98 @@ Individual GeneticAlgorithm::crossover(const Individual& parent1, const Individu
     }
 
     child.ir.resize(irLength);
+    child.envelope.resize((irLength + kEnvelopeBlockSize - 1) / kEnvelopeBlockSize);
+
+    // 突然変異のパラメータは両親の幾何平均を受け継ぐ
+    child.mutationRate = std::sqrt(parent1.mutationRate * parent2.mutationRate);
+    child.mutationStep = std::sqrt(parent1.mutationStep * parent2.mutationStep);
+
+    const SimdKernelTable& simd = SimdKernels();
+    const size_t common = std::min(len1, len2);
+    const size_t commonBlocks = common / kEnvelopeBlockSize; // 両親の範囲に収まるブロック
+
+    switch (m_crossover) {
+        case CrossoverMethod::Uniform: {
+            // ランダムに親の遺伝子を選択して子に割り当てる（乱数は遺伝子ごとに1つ、先に引いておく）
+            m_crossoverDraws.resize(common);
+            for (float& r : m_crossoverDraws) {
+                r = m_dist0To1(m_rng);
+            }
+            simd.selectLess(m_crossoverDraws.data(), 0.5f, parent1.ir.data(), parent2.ir.data(), child.ir.data(), common);
+            updateEnvelope(child, 0, commonBlocks);
+            break;
+        }
 
-    // ランダムに親の遺伝子を選択して子に割り当てる
-    for (size_t i = 0; i < irLength; ++i) {
-        if (bool pickFirst = (m_dist0To1(m_rng) < 0.5f)) {
-            child.ir[i] = (i < len1) ? parent1.ir[i] : ((i < len2) ? parent2.ir[i] : 0.0f);
-        } else {
-            child.ir[i] = (i < len2) ? parent2.ir[i] : ((i < len1) ? parent1.ir[i] : 0.0f);
+        case CrossoverMethod::Segment: {
+            // 切れ目をブロックの境界にそろえるので、区間ごとのコピーで済み、包絡も親のものをそのまま写せる
+            m_crossoverCuts.clear();
+            if (commonBlocks > 1) {
+                std::uniform_int_distribution<size_t> distCut(1, commonBlocks - 1);
+                for (int k = 0 ; k < m_crossoverCutPoints ; ++k) {
+                    m_crossoverCuts.push_back(distCut(m_rng));
+                }
+                std::sort(m_crossoverCuts.begin(), m_crossoverCuts.end());
+                m_crossoverCuts.erase(std::unique(m_crossoverCuts.begin(), m_crossoverCuts.end()), m_crossoverCuts.end());
+            }
+            m_crossoverCuts.push_back(commonBlocks);
+
+            bool fromFirst = m_dist0To1(m_rng) < 0.5f;
+            size_t begin = 0;
+            for (size_t end : m_crossoverCuts) {
+                const Individual& source = fromFirst ? parent1 : parent2;
+                std::copy(source.ir.begin() + static_cast<std::ptrdiff_t>(begin * kEnvelopeBlockSize),
+                          source.ir.begin() + static_cast<std::ptrdiff_t>(end * kEnvelopeBlockSize),
+                          child.ir.begin() + static_cast<std::ptrdiff_t>(begin * kEnvelopeBlockSize));
+                std::copy(source.envelope.begin() + static_cast<std::ptrdiff_t>(begin),
+                          source.envelope.begin() + static_cast<std::ptrdiff_t>(end),
+                          child.envelope.begin() + static_cast<std::ptrdiff_t>(begin));
+                begin = end;
+                fromFirst = !fromFirst;
+            }
+
+            // 共通範囲の端のブロックに満たない部分は最後の区間の次の親から
+            const Individual& source = fromFirst ? parent1 : parent2;
+            std::copy(source.ir.begin() + static_cast<std::ptrdiff_t>(commonBlocks * kEnvelopeBlockSize),
+                      source.ir.begin() + static_cast<std::ptrdiff_t>(common),
+                      child.ir.begin() + static_cast<std::ptrdiff_t>(commonBlocks * kEnvelopeBlockSize));
+            break;
+        }
+
+        case CrossoverMethod::Blend:
+        case CrossoverMethod::EnvelopePreserving: {
+            const float a = m_dist0To1(m_rng);
+            simd.mixDryWet(parent1.ir.data(), parent2.ir.data(), child.ir.data(), common, a, 1.0f - a, 1.0f);
+            updateEnvelope(child, 0, commonBlocks);
+            if (m_crossover == CrossoverMethod::Blend)
+                break;
+
+            // 相関のない2つを混ぜるとエネルギーが減るので、ブロックごとに両親のdB値を内分したエネルギーに戻す
+            const double minEnergy = 1e-30;
+            for (size_t b = 0 ; b < commonBlocks ; ++b) {
+                const double e1 = parent1.envelope[b];
+                const double e2 = parent2.envelope[b];
+                const double mixed = child.envelope[b];
+                if (e1 < minEnergy || e2 < minEnergy || mixed < minEnergy)
+                    continue;
+
+                const double logTarget = a * std::log(e1) + (1.0 - a) * std::log(e2);
+                const auto gain = static_cast<float>(std::exp(0.5 * (logTarget - std::log(mixed))));
+                float* block = child.ir.data() + b * kEnvelopeBlockSize;
+                simd.mixDryWet(block, block, block, kEnvelopeBlockSize, gain, 0.0f, 1.0f);
+            }
+            updateEnvelope(child, 0, commonBlocks);
+            break;
         }
     }
 
+    // 片方にしかない範囲は長い親からコピーし、包絡も長い親のものを写す（共通範囲の端のブロックは計算し直す）
+    const Individual& longer = (len1 > len2) ? parent1 : parent2;
+    std::copy(longer.ir.begin() + static_cast<std::ptrdiff_t>(common), longer.ir.end(), child.ir.begin() + static_cast<std::ptrdiff_t>(common));
+
+    const size_t mixedBlocks = (common + kEnvelopeBlockSize - 1) / kEnvelopeBlockSize;
+    updateEnvelope(child, commonBlocks, mixedBlocks);
+    std::copy(longer.envelope.begin() + static_cast<std::ptrdiff_t>(mixedBlocks), longer.envelope.end(), child.envelope.begin() + static_cast<std::ptrdiff_t>(mixedBlocks));
+
     // 初期適応度を高く設定
     child.fitness = 1e10;
     return child;
@@ -271,15 +531,78 @@ Individual GeneticAlgorithm::crossover(const Individual& parent1, const Individu
 /**
  * @brief 突然変異操作を行う関数
  * @param ind 突然変異を適用する個体
+ * @note 変えるサンプルの間隔を幾何分布で引くので、サンプルごとに乱数を引くのと同じ分布で、乱数は変えるサンプルの数だけで済む
  */
 void GeneticAlgorithm::mutate(Individual& ind) {
     if (ind.ir.empty())
         return;
 
-    for (float & i : ind.ir) {
-        if (m_dist0To1(m_rng) < m_mutationRate){
-            float randomNoise = (m_distNeg1to1(m_rng)) * 0.1f;
-            i += randomNoise;
+    ind.spectrum.reset();
+    ind.evaluated = false;
+
+    const bool adaptive = (m_mutation == MutationMethod::SelfAdaptive);
+    float rate = m_mutationRate;
+    float step = kFixedMutationStep;
+    if (adaptive) {
+        // 先にパラメータ自身を変え、変えた値で突然変異させる（良いパラメータを持つ個体が選択で残る）
+        ind.mutationRate = std::clamp(ind.mutationRate * std::exp(kSelfAdaptationRate * m_distNormal(m_rng)), kMinMutationRate, kMaxMutationRate);
+        ind.mutationStep = std::clamp(ind.mutationStep * std::exp(kSelfAdaptationRate * m_distNormal(m_rng)), kMinMutationStep, kMaxMutationStep);
+        rate = ind.mutationRate;
+        step = ind.mutationStep;
+    }
+    if (rate <= 0.0f)
+        return;
+
+    std::geometric_distribution<size_t> distSkip(std::min(static_cast<double>(rate), 1.0));
+    const size_t length = ind.ir.size();
+
+    // 変えたサンプルを含むブロックだけ包絡を計算し直す（前から順に変えるので、同じブロックは続けて現れる）
+    const size_t noBlock = std::numeric_limits<size_t>::max();
+    size_t dirtyBlock = noBlock;
+    float amplitude = step;
+    for (size_t i = distSkip(m_rng) ; i < length ; ) {
+        const size_t block = i / kEnvelopeBlockSize;
+        if (block != dirtyBlock) {
+            if (dirtyBlock != noBlock)
+                updateEnvelope(ind, dirtyBlock, dirtyBlock + 1);
+            dirtyBlock = block;
+
+            // 後ろの小さいサンプルに頭と同じ大きさの雑音を足さないよう、ブロックのRMSに比例させる
+            if (adaptive) {
+                const size_t blockLength = std::min(kEnvelopeBlockSize, length - block * kEnvelopeBlockSize);
+                amplitude = step * static_cast<float>(std::sqrt(ind.envelope[block] / static_cast<double>(blockLength)));
+            }
         }
+
+        if (adaptive)
+            ind.ir[i] += m_distNormal(m_rng) * amplitude;
+        else
+            ind.ir[i] += m_distNeg1to1(m_rng) * amplitude;
+
+        const size_t skip = distSkip(m_rng);
+        if (skip >= length - i - 1)
+            break;
+        i += skip + 1;
     }
+    if (dirtyBlock != noBlock)
+        updateEnvelope(ind, dirtyBlock, dirtyBlock + 1);
+}
+
+/**
+ * @brief 個体のエネルギー包絡の一部を計算し直す関数
+ * @param ind 個体（包絡の長さが足りなければ広げる）
+ * @param firstBlock 計算し直す最初のブロック
+ * @param lastBlock 計算し直す最後のブロックの次
+ */
+void GeneticAlgorithm::updateEnvelope(Individual& ind, size_t firstBlock, size_t lastBlock) {
+    const size_t length = ind.ir.size();
+    ind.envelope.resize((length + kEnvelopeBlockSize - 1) / kEnvelopeBlockSize);
+
+    lastBlock = std::min(lastBlock, ind.envelope.size());
+    if (firstBlock >= lastBlock)
+        return;
+
+    const size_t offset = firstBlock * kEnvelopeBlockSize;
+    const size_t count = std::min(lastBlock * kEnvelopeBlockSize, length) - offset;
+    SimdKernels().blockSumSquares(ind.ir.data() + offset, count, kEnvelopeBlockSize, ind.envelope.data() + firstBlock);
 }
\ No newline at end of file
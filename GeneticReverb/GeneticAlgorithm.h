@@ -6,22 +6,42 @@
 
 # pragma once
 
-# include <functional>
+# include "IROptimizer.h"
+
 # include <random>
 # include <vector>
 
-// GAのターゲットパラメータ構造体
-struct ReverbTargetParams {
-    float t60 = 0.4f;
-    float edt = 0.06f;
-    float c80 = 12.0f;
-    float br = 0.7f;
+// 親の選び方（エリートはどの方法でもそのまま次世代に残す）
+enum class SelectionMethod {
+    Elite,               // 上位20%から一様に選ぶ
+    Tournament,          // k個体を一様に選び、最も良いものを親にする
+    LinearRanking,       // 順位に比例して下がる確率でルーレット選択する
+    StochasticUniversal, // 適応度の逆数に比例する確率で、等間隔のポインタでまとめて選ぶ（SUS）
+};
+
+// 交叉の方法（長さが違う親では、長い親にしかない範囲はその親からコピーする）
+enum class CrossoverMethod {
+    Uniform,            // サンプルごとに親を選ぶ
+    Segment,            // エネルギー包絡のブロックの境界で k 箇所切り、区間ごとに親を交互に選ぶ
+    Blend,              // a * parent1 + (1 - a) * parent2（a は子ごとに一様乱数）
+    EnvelopePreserving, // Blend した後、ブロックごとのエネルギーを両親のdB値を a で内分した値にそろえる
+};
+
+// 突然変異の方法
+enum class MutationMethod {
+    Fixed,        // 突然変異率は一定、雑音は振幅0.1の一様乱数
+    SelfAdaptive, // 突然変異率と雑音の大きさを個体ごとに持たせて対数正規で変え、雑音はブロックのRMSに比例させる
 };
 
 // 個体(インパルス応答と適応度を保持する構造体)
 struct Individual {
     std::vector<float> ir; // インパルス応答
+    std::vector<double> envelope; // ir を GeneticAlgorithm::kEnvelopeBlockSize サンプルごとに区切った2乗の和（交叉・突然変異で変わったブロックだけ更新する）
     double fitness = 1e10; // 適応度
+    PartitionedIR::Ptr spectrum; // 周波数領域の評価で計算した分割スペクトル（ir を変えたら破棄する）
+    bool evaluated = false; // fitness が詳しい評価の値か（粗い評価だけ、または ir を変えたら false）
+    float mutationRate = 0.0f; // MutationMethod::SelfAdaptive での突然変異率
+    float mutationStep = 0.0f; // MutationMethod::SelfAdaptive での雑音の大きさ（ブロックのRMSに対する比）
 
     // 適応度の比較演算子
     bool operator<(const Individual& other) const {
@@ -29,37 +49,87 @@ struct Individual {
     }
 };
 
-class GeneticAlgorithm {
+class GeneticAlgorithm : public IROptimizer {
 public:
+    // 個体のエネルギー包絡の1ブロックの長さ
+    static constexpr size_t kEnvelopeBlockSize = 32;
+
     GeneticAlgorithm(int populationSize, float mutationRate, float sampleRate);
-    ~GeneticAlgorithm();
+    ~GeneticAlgorithm() override;
+
+    OptimizerBackend backend() const override { return OptimizerBackend::GeneticAlgorithm; }
+    std::vector<float> compute(const ReverbTargetParams& targetParams, int numGenerations) override;
+
+    // 粗い評価でのふるい分けの有無（既定で有効）
+    void setScreening(bool enabled);
 
-    std::vector<float> compute(const ReverbTargetParams& targetParams, int numGenerations);
+    // 親の選び方（既定は Elite、tournamentSize は Tournament のときだけ使う）
+    void setSelection(SelectionMethod method, int tournamentSize = 3);
 
-    // 進捗コールバック関数の設定
-    void setProgressCallback(std::function<void(int curGen, int totalGen, double bestFitness)> callback);
-    void cancel();
-    void resetCancel();
+    // 交叉の方法（既定は Segment、cutPoints は Segment のときだけ使う）
+    void setCrossover(CrossoverMethod method, int cutPoints = 2);
+
+    // 突然変異の方法（既定は SelfAdaptive）
+    void setMutation(MutationMethod method);
 
 private:
+    // 交叉・突然変異で少しずつ更新した包絡を、全体を計算し直した値と比べる（Bench/GAEnvelopeCheck.cpp）
+    friend struct GeneticAlgorithmCheckAccess;
+
     std::vector<Individual> m_population; // 個体群
     int m_popSize;                        // 個体群のサイズ
     float m_mutationRate;                 // 突然変異率
-    float m_sampleRate;                   // サンプリングレート
 
-    // 乱数生成器
-    std::mt19937 m_rng;
+    // 乱数の分布（生成器は IROptimizer::m_rng）
     std::uniform_real_distribution<float> m_distNeg1to1{-1.0f, 1.0f};
     std::uniform_real_distribution<float> m_dist0To1{0.0f, 1.0f};
+    std::normal_distribution<float> m_distNormal{0.0f, 1.0f};
+
+    std::vector<float> m_decayEnvelope;  // 初期集団の減衰カーブ
+
+    // 交叉
+    CrossoverMethod m_crossover = CrossoverMethod::Segment;
+    int m_crossoverCutPoints = 2;
+    std::vector<float> m_crossoverDraws; // Uniform で使う遺伝子ごとの乱数
+    std::vector<size_t> m_crossoverCuts; // Segment の切れ目（ブロック単位）
+
+    std::vector<Individual*> m_pendingEvaluation; // 詳しく評価する個体
+    std::vector<const float*> m_pendingIRs;
+    std::vector<size_t> m_pendingLengths;
+    std::vector<double> m_pendingFitness;
+    std::vector<PartitionedIR::Ptr> m_pendingSpectra;
+
+    // 粗い評価（エネルギー包絡）でのふるい分け
+    bool m_screening = true;
+    double m_coarseError = 0.0;     // 詳しく評価した個体での、粗い評価との差の最大値
+    double m_screenThreshold = 0.0; // これより粗い評価が悪い子は詳しく評価しない（初回は全個体を評価する）
+
+    // 突然変異
+    static constexpr float kFixedMutationStep = 0.1f;     // Fixed での雑音の振幅
+    static constexpr float kInitialMutationStep = 0.2f;   // SelfAdaptive の初期集団での雑音の大きさ
+    static constexpr float kSelfAdaptationRate = 0.3f;    // 突然変異率と雑音の大きさを変える対数正規分布の標準偏差
+    static constexpr float kMinMutationRate = 1e-5f;
+    static constexpr float kMaxMutationRate = 0.05f;
+    static constexpr float kMinMutationStep = 0.01f;
+    static constexpr float kMaxMutationStep = 2.0f;
+    MutationMethod m_mutation = MutationMethod::SelfAdaptive;
 
-    // 進捗コールバック関数
-    std::function<void(int, int, double)> m_onProgress;
-    std::atomic<bool> m_cancel { false };
+    // 親の選択（個体はコピーせず、適応度順に並んだ個体群の添字で扱う）
+    static constexpr double kRankingPressure = 1.8; // 線形ランキングで最良の個体が選ばれる確率の平均に対する倍率（1〜2）
+    SelectionMethod m_selection = SelectionMethod::Elite;
+    int m_tournamentSize = 3;
+    std::vector<int> m_parents;           // 2個ずつ組にして子を作る
+    std::vector<double> m_selectionWeights; // 個体ごとの選ばれる確率の累積
 
     // GAのロジックを実行する関数
     void initializePopulation(float targetT60);
     void calculatePopulationFitness(const ReverbTargetParams& targetParams);
+    void evaluateFully(const std::vector<Individual*>& individuals, const ReverbTargetParams& targetParams);
+    double coarseFitness(const Individual& individual, const ReverbTargetParams& targetParams);
+    int eliteCount() const;
+    void selectParents(size_t count);
     std::vector<Individual> createNextGeneration();
     Individual crossover(const Individual& parent1, const Individual& parent2);
     void mutate(Individual& ind);
+    static void updateEnvelope(Individual& ind, size_t firstBlock, size_t lastBlock);
 };
\ No newline at end of file
@@ -7,20 +7,11 @@
 # include "ConvolutionProcessor.h"
 
 # include <algorithm>
+# include <atomic>
 # include <cstdio>
-# include <cstring>
-# include <fmod.h>
-# include <fmod_dsp.h>
-
-/* コールバック関数 */
-FMOD_RESULT F_CALL GeneticReverb_Create(FMOD_DSP_STATE* dsp_state);
-FMOD_RESULT F_CALL GeneticReverb_Release(FMOD_DSP_STATE* dsp_state);
-FMOD_RESULT F_CALL GeneticReverb_Reset(FMOD_DSP_STATE* dsp_state);
-FMOD_RESULT F_CALL GeneticReverb_Process(FMOD_DSP_STATE* dsp_state, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inBuffers, FMOD_DSP_BUFFER_ARRAY* outBuffers, FMOD_BOOL inputsIdle, FMOD_DSP_PROCESS_OPERATION op);
-FMOD_RESULT F_CALL GeneticReverb_SetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float value);
-FMOD_RESULT F_CALL GeneticReverb_GetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float* value, char* valuestr);
-FMOD_RESULT F_CALL GeneticReverb_SetParameterBool(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL value);
-FMOD_RESULT F_CALL GeneticReverb_GetParameterBool(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL* value, char* valuestr);
+
+# include "../Common/FmodPluginBase.h"
+# include "../Common/SimdDispatch.h"
 
 /**
  * @brief インパルス応答ハンドル構造体
@@ -32,27 +23,6 @@ struct IRHandle {
     void release() { }
 };
 
-/**
- * @brief GeneticReverb DSPプラグインの内部データ
- */
-struct GeneticReverbState {
-    ConvolutionProcessor* processor{};
-    std::unique_ptr<float[]> scratchInL;
-    std::unique_ptr<float[]> scratchInR;
-    std::unique_ptr<float[]> scratchOutL;
-    std::unique_ptr<float[]> scratchOutR;
-    unsigned int scratchFrames = 0;
-
-    std::atomic<IRHandle*> irToSwap { nullptr };
-    int channels = 2;
-    float dry = 0.5f;
-    float wet = 0.5f;
-    float volume = 1.0f;
-
-    ReverbTargetParams params { 0.4f, 0.06f, 12.0f, 0.7f };
-    std::atomic<float> lastProgress { -1.0f };
-};
-
 /**
  * @brief GeneticReverb DSPプラグインのパラメータインデックス
  */
@@ -65,6 +35,9 @@ enum {
     GENETIC_REVERB_PARAM_GENERATE,
     GENETIC_REVERB_PARAM_CANCEL,
     GENETIC_REVERB_PARAM_PROGRESS,
+    GENETIC_REVERB_PARAM_BR,
+    GENETIC_REVERB_PARAM_BRIGHTNESS,
+    GENETIC_REVERB_PARAM_SPECTRAL,
     NUM_PARAMETERS,
 };
 
@@ -77,6 +50,9 @@ static FMOD_DSP_PARAMETER_DESC s_C80;
 static FMOD_DSP_PARAMETER_DESC s_Generate;
 static FMOD_DSP_PARAMETER_DESC s_Cancel;
 static FMOD_DSP_PARAMETER_DESC s_Progress;
+static FMOD_DSP_PARAMETER_DESC s_BR;
+static FMOD_DSP_PARAMETER_DESC s_Brightness;
+static FMOD_DSP_PARAMETER_DESC s_Spectral;
 static FMOD_DSP_PARAMETER_DESC* s_Params[NUM_PARAMETERS];
 
 /**
@@ -92,6 +68,11 @@ static void InitParameterDescs() {
     FMOD_DSP_INIT_PARAMDESC_FLOAT(s_T60, "T60", "s", "Target T60 [s]", 0.05f, 10.0f, 0.4f);
     FMOD_DSP_INIT_PARAMDESC_FLOAT(s_C80, "C80", "dB", "Target C80 [dB]", -40.0f, 40.0f, 12.0f);
 
+    // 周波数特性パラメータ（Spectral が0なら周波数領域の評価をしない）
+    FMOD_DSP_INIT_PARAMDESC_FLOAT(s_BR, "BR", "x", "Target low/mid T60 ratio", 0.5f, 2.0f, 1.0f);
+    FMOD_DSP_INIT_PARAMDESC_FLOAT(s_Brightness, "Brightness", "x", "Target high/mid T60 ratio", 0.5f, 2.0f, 1.0f);
+    FMOD_DSP_INIT_PARAMDESC_FLOAT(s_Spectral, "Spectral", "x", "Weight of BR, brightness and coloration", 0.0f, 10.0f, 0.0f);
+
     // 生成制御パラメータ
     FMOD_DSP_INIT_PARAMDESC_BOOL(s_Generate, "Generate", "btn", "Start IR Generation", false, nullptr);
     FMOD_DSP_INIT_PARAMDESC_BOOL(s_Cancel, "Cancel", "btn", "Cancel IR Generation", false, nullptr);
@@ -107,452 +88,351 @@ static void InitParameterDescs() {
     s_Params[GENETIC_REVERB_PARAM_GENERATE] = &s_Generate;
     s_Params[GENETIC_REVERB_PARAM_CANCEL] = &s_Cancel;
     s_Params[GENETIC_REVERB_PARAM_PROGRESS] = &s_Progress;
+    s_Params[GENETIC_REVERB_PARAM_BR] = &s_BR;
+    s_Params[GENETIC_REVERB_PARAM_BRIGHTNESS] = &s_Brightness;
+    s_Params[GENETIC_REVERB_PARAM_SPECTRAL] = &s_Spectral;
 }
 
 /**
- * @brief GeneticReverb DSPプラグインの説明構造体
+ * @brief GeneticReverb DSPプラグイン
+ * @note L/Rを畳み込み、3チャンネル目以降にはWetのモノラル平均を混ぜる
  */
-FMOD_DSP_DESCRIPTION geneticReverbDesc = {
-    FMOD_PLUGIN_SDK_VERSION,         // プラグインSDKのバージョン
-    "GeneticReverb",                 // プラグインの名前
-    0x00010000,                      // プラグインのバージョン
-    1,                               // 入力バッファの数
-    1,                               // 出力バッファの数
-    GeneticReverb_Create,            // DSP生成時のコールバック
-    GeneticReverb_Release,           // DSP解放時のコールバック
-    GeneticReverb_Reset,             // DSPリセット時のコールバック
-    nullptr,                         // DSP読み取り時のコールバック
-    GeneticReverb_Process,           // DSPプロセス時のコールバック
-    nullptr,                         // 位置設定コールバック
-    NUM_PARAMETERS,                  // パラメータの数
-    s_Params,                        // パラメータの説明
-    GeneticReverb_SetParameterFloat, // setFloatによってパラメータが設定されたときのコールバック
-    nullptr,                         // setIntによってパラメータが設定されたときのコールバック
-    GeneticReverb_SetParameterBool,  // setBoolによってパラメータが設定されたときのコールバック
-    nullptr,                         // setDataによってパラメータが設定されたときのコールバック
-    GeneticReverb_GetParameterFloat, // getFloatによってパラメータが取得されたときのコールバック
-    nullptr,                         // getIntによってパラメータが取得されたときの
-    GeneticReverb_GetParameterBool,  // getBoolによってパラメータが取得されたときのコールバック
-    nullptr,                         // getDataによってパラメータが取得されたときのコールバック
-    nullptr,                         // shouldiprocessによってプロセスするかどうかを決定するコールバック
-    nullptr,                         // ユーザーデータ
-    nullptr,                         // DSPがロードor登録されたときに呼ばれるコールバック
-    nullptr,                         // DSPがアンロードor登録解除されたときに呼ばれるコールバック
-    nullptr,                         // ミキサー実行開始時に呼ばれるコールバック
-};
-
-/**
- * @brief GeneticReverb DSPプラグインの作成関数
- * @param dsp_state DSPの内部データ
- * @return FMODの処理結果コード
- */
-FMOD_RESULT F_CALL GeneticReverb_Create(FMOD_DSP_STATE *dsp_state) {
-    InitParameterDescs();
-
-    // dsp_stateのfunctionsが有効か確認
-    if (!dsp_state->functions)
-        return FMOD_ERR_INTERNAL;
-
-    // Templateのインスタンスを作成し、初期化する
-    FMOD_MEMORY_ALLOC_CALLBACK alloc_callback = dsp_state->functions->alloc;
-    if (!alloc_callback)
-        return FMOD_ERR_INTERNAL;
-
-    // メモリを確保
-    auto *state = (GeneticReverbState*)alloc_callback(sizeof(GeneticReverbState), FMOD_MEMORY_NORMAL, __FILE__);
-    if (state == nullptr)
-        return FMOD_ERR_MEMORY;
-
-    // dsp_stateにポインタを渡す
-    dsp_state->plugindata = state;
-
-    // パラメータの初期値を設定
-    state->processor = new(std::nothrow) ConvolutionProcessor();
-    if (state->processor == nullptr) {
-        FMOD_MEMORY_FREE_CALLBACK free_callback = dsp_state->functions->free;
-        if (free_callback)
-            free_callback(state, FMOD_MEMORY_NORMAL, __FILE__);
-
-        return FMOD_ERR_MEMORY;
+class GeneticReverb : public FmodPluginBase<GeneticReverb> {
+public:
+    static constexpr const char* kName = "GeneticReverb";
+    static constexpr unsigned int kVersion = 0x00010000;
+
+    /**
+     * @brief パラメータ説明を初期化して返す
+     * @param count パラメータの数を受け取る
+     * @return パラメータ説明の配列
+     */
+    static FMOD_DSP_PARAMETER_DESC** ParameterDescs(int& count) {
+        InitParameterDescs();
+        count = NUM_PARAMETERS;
+        return s_Params;
     }
 
-    state->params = ReverbTargetParams{ 0.4f, 0.06f, 12.0f, 0.7f };
-    state->processor->setTargetParams(state->params);
-
-    state->lastProgress.store(0.0f);
-
-    // 正常終了を返す
-    return FMOD_OK;
-}
-
-/**
- * @brief GeneticReverb DSPプラグインの解放関数
- * @param dsp_state DSPの内部データ
- * @return FMODの処理結果コード
- */
-FMOD_RESULT F_CALL GeneticReverb_Release(FMOD_DSP_STATE *dsp_state) {
-    if (!dsp_state->functions)
-        return FMOD_ERR_INTERNAL;
-
-    // Templateのインスタンスを取得
-    FMOD_MEMORY_FREE_CALLBACK free_callback = dsp_state->functions->free;
-    if (!free_callback)
-        return FMOD_ERR_INTERNAL;
-
-    // Templateのインスタンスを取得
-    auto *state = static_cast<GeneticReverbState*>(dsp_state->plugindata);
-    if (state) {
-        if (state->processor) {
-            state->processor->release();
-            delete state->processor;
-            state->processor = nullptr;
+private:
+    friend class FmodPluginBase<GeneticReverb>;
+
+    /**
+     * @brief L/Rのスクラッチバッファを確保し、目標パラメータを渡す
+     */
+    FMOD_RESULT onCreate() {
+        const size_t frames = blockSize();
+        m_scratchInL = allocateFloats(frames);
+        m_scratchInR = allocateFloats(frames);
+        m_scratchOutL = allocateFloats(frames);
+        m_scratchOutR = allocateFloats(frames);
+        if (!m_scratchInL || !m_scratchInR || !m_scratchOutL || !m_scratchOutR) {
+            return FMOD_ERR_MEMORY;
         }
 
-        free_callback(state, FMOD_MEMORY_NORMAL, __FILE__);
-    }
-
-    // 内部データもクリア
-    dsp_state->plugindata = nullptr;
-
-    // 正常終了を返す
-    return FMOD_OK;
-}
-
-/**
- * @brief GeneticReverb DSPプラグインのプロセス関数
- * @param dsp_state DSPの内部データ
- * @param length 処理するサンプル数
- * @param inBuffers 入力バッファ配列
- * @param outBuffers 出力バッファ配列
- * @param inputsIdle 入力がアイドル状態かどうか
- * @param op プロセス操作の種類
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はエラーコードを返す
- */
-FMOD_RESULT F_CALL GeneticReverb_Process(FMOD_DSP_STATE* dsp_state, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inBuffers, FMOD_DSP_BUFFER_ARRAY* outBuffers, FMOD_BOOL inputsIdle, FMOD_DSP_PROCESS_OPERATION op) {
-    auto *state = static_cast<GeneticReverbState *>(dsp_state->plugindata);
-    if (!state || !inBuffers || !outBuffers) {
-        return FMOD_ERR_DSP_DONTPROCESS;
+        m_processor.setTargetParams(m_params);
+        m_processor.setSpectralWeights(SpectralWeightsFor(m_spectralWeight));
+        return FMOD_OK;
     }
 
-    // 安全のため、functions ポインタの有無を確認
-    if (!dsp_state->functions)
-        return FMOD_ERR_DSP_DONTPROCESS;
-
-    // 進捗更新（processorがない場合はスキップ）
-    if (state->processor) {
-        const float progress = state->processor->progress();
-        const float oldProgress = state->lastProgress.load();
-        if (progress != oldProgress) {
-            state->lastProgress.store(progress);
-        }
+    /**
+     * @brief Spectral パラメータを各項の重みに分ける
+     * @note 適応度は 100 * |dT60| + |dC80| なので、比の誤差 0.1 と色付き 1dB が weight = 1 で C80 の 1dB と同じくらいになるようにする
+     */
+    static SpectralWeights SpectralWeightsFor(float weight) {
+        SpectralWeights weights;
+        weights.bassRatio = 10.0 * weight;
+        weights.brightness = 10.0 * weight;
+        weights.coloration = 1.0 * weight;
+        return weights;
     }
 
-    // IRの差し替えが要求されていたら実行
-    if (IRHandle* ir = state->irToSwap.exchange(nullptr)) {
-        state->processor->setIR(ir->data, ir->length);
-        ir->release();
+    /**
+     * @brief 生成スレッドを止めて、スクラッチバッファを解放する
+     */
+    void onRelease() {
+        m_processor.release();
+        deallocate(m_scratchInL);
+        deallocate(m_scratchInR);
+        deallocate(m_scratchOutL);
+        deallocate(m_scratchOutR);
+        deallocate(m_scratchWet);
     }
 
-    // 出力バッファが無効な場合は何もしない
-    if (outBuffers->numbuffers == 0 || outBuffers->buffers == nullptr) {
+    /**
+     * @brief プロセッサをサンプリングレートとブロックサイズに合わせて準備し直す
+     */
+    FMOD_RESULT onReset() {
+        m_processor.prepare(sampleRate(), blockSize());
+        m_processor.setTargetParams(m_params);
+        m_processor.setSpectralWeights(SpectralWeightsFor(m_spectralWeight));
+        m_lastProgress.store(0.0f);
         return FMOD_OK;
     }
 
-    // 入力バッファが無効、またはアイドル状態の場合は出力をゼロで埋める
-    if (inBuffers->numbuffers == 0 || inBuffers->buffers == nullptr || inputsIdle) {
-        for (int i = 0 ; i < outBuffers->numbuffers ; ++i) {
-            const int chs = outBuffers->buffernumchannels[i];
-            float *out = outBuffers->buffers[i];
-            std::memset(out, 0, sizeof(float) * length * static_cast<unsigned int>(chs));
+    /**
+     * @brief チャンネル数に合わせてインタリーブしたWet信号のバッファを広げる
+     */
+    FMOD_RESULT onChannels(int chs) {
+        if (chs <= m_wetChannels) {
+            return FMOD_OK;
+        }
+
+        float* wet = allocateFloats(static_cast<size_t>(blockSize()) * chs);
+        if (wet == nullptr) {
+            return FMOD_ERR_MEMORY;
         }
+        deallocate(m_scratchWet);
+        m_scratchWet = wet;
+        m_wetChannels = chs;
         return FMOD_OK;
     }
 
-    // パラメータを取得
-    const float dry = state->dry;
-    const float wet = state->wet;
-    const float volume = state->volume;
-
-    // FMOD_DSP_PROCESS_PERFORMの場合、エフェクト処理を行う
-    if (op == FMOD_DSP_PROCESS_PERFORM) {
-        const int nb = std::min(inBuffers->numbuffers, outBuffers->numbuffers);
-
-        // 一時バッファが不足していたら拡張
-        if (state->scratchFrames < length || !state->scratchInL || !state->scratchInR || !state->scratchOutL || !state->scratchOutR) {
-            state->scratchFrames = length;
-            state->scratchInL.reset(new float[state->scratchFrames]);
-            state->scratchInR.reset(new float[state->scratchFrames]);
-            state->scratchOutL.reset(new float[state->scratchFrames]);
-            state->scratchOutR.reset(new float[state->scratchFrames]);
-        }
+    /**
+     * @brief 進捗の更新とIRの差し替えをバッファ先頭で行う
+     */
+    void onProcessStart() {
+        m_lastProgress.store(m_processor.progress());
 
-        for (int b = 0 ; b < nb ; ++b) {
-            const int chs = std::min(inBuffers->buffernumchannels[b], outBuffers->buffernumchannels[b]);
-            const float* in = inBuffers->buffers[b];
-            float* out = outBuffers->buffers[b];
-            if (!in || !out || chs <= 0) continue;
+        // IRの差し替えが要求されていたら実行
+        if (IRHandle* ir = m_irToSwap.exchange(nullptr)) {
+            m_processor.setIR(ir->data, ir->length);
+            ir->release();
+        }
+    }
 
-            const unsigned int frames = length;
+    /**
+     * @brief インタリーブされたブロックを畳み込み、Dry/Wet/Volumeを適用する
+     */
+    void processBlock(const float* in, float* out, unsigned int frames, int chs) {
+        const SimdKernelTable& simd = SimdKernels();
 
-            // デインタリーブ(Wet生成はL/Rのみ使用。Mono入力は複製)
+        // デインタリーブ(Wet生成はL/Rのみ使用。Mono入力は複製)
+        if (chs == 2) {
+            simd.deinterleave2(in, m_scratchInL, m_scratchInR, frames);
+        }
+        else {
             for (unsigned int i = 0 ; i < frames ; ++i) {
-                const unsigned int base = i * chs;
+                const size_t base = static_cast<size_t>(i) * chs;
                 const float inL = in[base + 0];
                 const float inR = (chs > 1) ? in[base + 1] : inL;
-                state->scratchInL[i] = inL;
-                state->scratchInR[i] = inR;
+                m_scratchInL[i] = inL;
+                m_scratchInR[i] = inR;
             }
+        }
 
-            // 畳み込み(IR未準備時は0)
-            state->processor->process(state->scratchInL.get(), state->scratchInR.get(),
-                                      state->scratchOutL.get(), state->scratchOutR.get(), frames);
+        // 畳み込み(IR未準備時は0)
+        m_processor.process(m_scratchInL, m_scratchInR, m_scratchOutL, m_scratchOutR, frames);
 
-            // インタリーブ + 全チャンネルにDry/Wet/Volume適用
+        // Wet信号を入力と同じ並びにインタリーブする（3チャンネル目以降はモノラル平均）
+        if (chs == 2) {
+            simd.interleave2(m_scratchOutL, m_scratchOutR, m_scratchWet, frames);
+        }
+        else {
             for (unsigned int i = 0 ; i < frames ; ++i) {
-                const unsigned int base = i * chs;
-
-                // Wet信号を取得
-                const float wetL = state->scratchOutL[i];
-                const float wetR = state->scratchOutR[i];
-                const float wetMono = 0.5f * (wetL + wetR);
-
-                // 各チャンネルに対してDry/WetミックスとVolume適用
-                for (int ch = 0; ch < chs; ++ch) {
-                    const float inSample = in[base + ch];
-                    float wetSig = wetMono;
-
-                    // チャンネルごとのWet信号を選択
-                    if (ch == 0) wetSig = wetL;
-                    else if (ch == 1) wetSig = wetR;
-
-                    // Dry/Wetミックス
-                    const float mixed = (dry * inSample) + (wet * wetSig);
-                    out[base + ch] = mixed * volume;
-                }
+                float* dst = m_scratchWet + static_cast<size_t>(i) * chs;
+                const float wetL = m_scratchOutL[i];
+                const float wetR = m_scratchOutR[i];
+                dst[0] = wetL;
+                if (chs > 1) dst[1] = wetR;
+                if (chs > 2) std::fill(dst + 2, dst + chs, 0.5f * (wetL + wetR));
             }
         }
+
+        // 全チャンネルにDry/WetミックスとVolumeを適用
+        const float dry = m_dry.load(std::memory_order_relaxed);
+        const float wet = m_wet.load(std::memory_order_relaxed);
+        const float volume = m_volume.load(std::memory_order_relaxed);
+        simd.mixDryWet(in, m_scratchWet, out, static_cast<size_t>(frames) * chs, dry, wet, volume);
     }
-    // FMOD_DSP_PROCESS_QUERYの場合、入出力フォーマットのミラーを行う
-    else {
-        const int nb = std::min(inBuffers->numbuffers, outBuffers->numbuffers);
-        for (int i = 0 ; i < nb ; ++i) {
-            const int chs = std::min(inBuffers->buffernumchannels[i], outBuffers->buffernumchannels[i]);
-            const float *in = inBuffers->buffers[i];
-            float *out = outBuffers->buffers[i];
-            if (!in || !out || chs <= 0) continue;
-            std::memcpy(out, in, sizeof(float) * length * static_cast<unsigned int>(chs));
-        }
+
+    /**
+     * @brief 入力が止まってからもIRの長さだけ残響を出し続ける
+     */
+    unsigned int tailLength() const {
+        return static_cast<unsigned int>(m_processor.irLength());
     }
 
-    return FMOD_OK;
-}
+    /**
+     * @brief floatパラメータの設定関数
+     */
+    FMOD_RESULT setParameterFloat(int index, float value) {
+        switch (index) {
+            case GENETIC_REVERB_PARAM_DRY:
+                m_dry.store(std::clamp(value, 0.0f, 1.0f), std::memory_order_relaxed);
+                break;
 
-/**
- * @brief GeneticReverb DSPプラグインのリセット関数
- * @param dsp_state DSPの内部データ
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はFMOD_ERR_INVALID_PARAMを返す
- */
-FMOD_RESULT F_CALL GeneticReverb_Reset(FMOD_DSP_STATE* dsp_state) {
-    auto* state = static_cast<GeneticReverbState*>(dsp_state->plugindata);
-    if (!state) {
-        return FMOD_ERR_INVALID_PARAM;
-    }
+            case GENETIC_REVERB_PARAM_WET:
+                m_wet.store(std::clamp(value, 0.0f, 1.0f), std::memory_order_relaxed);
+                break;
 
-    // サンプリングレートとバッファサイズを取得
-    unsigned int bufferSize = 0;
-    int samplingRate = 0;
-    dsp_state->functions->getblocksize(dsp_state, &bufferSize);
-    dsp_state->functions->getsamplerate(dsp_state, &samplingRate);
+            case GENETIC_REVERB_PARAM_VOLUME:
+                m_volume.store(std::clamp(value, 0.0f, 2.0f), std::memory_order_relaxed);
+                break;
+
+            case GENETIC_REVERB_PARAM_T60:
+                m_params.t60 = std::clamp(value, 0.05f, 10.0f);
+                m_processor.setTargetParams(m_params);
+                break;
 
-    if (bufferSize <= 0) bufferSize = 1024;
-    if (samplingRate <= 0) samplingRate = 48000;
+            case GENETIC_REVERB_PARAM_C80:
+                m_params.c80 = std::clamp(value, -40.0f, 40.0f);
+                m_processor.setTargetParams(m_params);
+                break;
 
-    // プロセッサを準備
-    state->processor->prepare(samplingRate, static_cast<unsigned int>(bufferSize));
-    state->scratchFrames = static_cast<unsigned int>(bufferSize);
-    state->channels = 2;
+            case GENETIC_REVERB_PARAM_BR:
+                m_params.br = std::clamp(value, 0.5f, 2.0f);
+                m_processor.setTargetParams(m_params);
+                break;
 
-    // スクラッチバッファを確保
-    state->scratchInL.reset(new float[state->scratchFrames]);
-    state->scratchInR.reset(new float[state->scratchFrames]);
-    state->scratchOutL.reset(new float[state->scratchFrames]);
-    state->scratchOutR.reset(new float[state->scratchFrames]);
+            case GENETIC_REVERB_PARAM_BRIGHTNESS:
+                m_params.brightness = std::clamp(value, 0.5f, 2.0f);
+                m_processor.setTargetParams(m_params);
+                break;
 
-    state->processor->setTargetParams(state->params);
+            case GENETIC_REVERB_PARAM_SPECTRAL:
+                m_spectralWeight = std::clamp(value, 0.0f, 10.0f);
+                m_processor.setSpectralWeights(SpectralWeightsFor(m_spectralWeight));
+                break;
 
-    state->lastProgress.store(0.0f);
+            case GENETIC_REVERB_PARAM_PROGRESS:
+                break;
 
-    return FMOD_OK;
-}
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
 
-/**
- * @brief GeneticReverb DSPプラグインのパラメータ設定関数
- * @param dsp_state DSPの内部データ
- * @param index パラメータのインデックス
- * @param value 設定する値
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はFMOD_ERR_INVALID_PARAMを返す
- */
-FMOD_RESULT F_CALL GeneticReverb_SetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float value) {
-    auto* state = static_cast<GeneticReverbState*>(dsp_state->plugindata);
-    if (!state) {
-        return FMOD_ERR_INVALID_PARAM;
+        return FMOD_OK;
     }
 
-    switch (index) {
-        case GENETIC_REVERB_PARAM_DRY:
-            if (value < 0.0f) value = 0.0f;
-            if (value > 1.0f) value = 1.0f;
-            state->dry = value;
-            break;
-
-        case GENETIC_REVERB_PARAM_WET:
-            if (value < 0.0f) value = 0.0f;
-            if (value > 1.0f) value = 1.0f;
-            state->wet = value;
-            break;
-
-        case GENETIC_REVERB_PARAM_VOLUME:
-            if (value < 0.0f) value = 0.0f;
-            if (value > 2.0f) value = 2.0f;
-            state->volume = value;
-            break;
-
-        case GENETIC_REVERB_PARAM_T60: {
-                if (value < 0.05f) value = 0.05f;
-                if (value > 10.0f) value = 10.0f;
-                state->params.t60 = value;
-                if (state->processor) state->processor->setTargetParams(state->params);
+    /**
+     * @brief floatパラメータの取得関数
+     */
+    FMOD_RESULT getParameterFloat(int index, float* value, char* valuestr) {
+        switch (index) {
+            case GENETIC_REVERB_PARAM_DRY: {
+                const float dry = m_dry.load(std::memory_order_relaxed);
+                if (value) *value = dry;
+                if (valuestr) snprintf(valuestr, 32, "%.2f x", dry);
                 break;
-        }
+            }
 
-        case GENETIC_REVERB_PARAM_C80: {
-                if (value < -40.0f) value = -40.0f;
-                if (value > 40.0f)  value = 40.0f;
-                state->params.c80 = value;
-                if (state->processor) state->processor->setTargetParams(state->params);
+            case GENETIC_REVERB_PARAM_WET: {
+                const float wet = m_wet.load(std::memory_order_relaxed);
+                if (value) *value = wet;
+                if (valuestr) snprintf(valuestr, 32, "%.2f x", wet);
                 break;
-        }
+            }
 
-        case GENETIC_REVERB_PARAM_PROGRESS:
-            break;
+            case GENETIC_REVERB_PARAM_VOLUME: {
+                const float volume = m_volume.load(std::memory_order_relaxed);
+                if (value) *value = volume;
+                if (valuestr) snprintf(valuestr, 32, "%.2f x", volume);
+                break;
+            }
 
-        default:
-            return FMOD_ERR_INVALID_PARAM;
-    }
+            case GENETIC_REVERB_PARAM_T60:
+                if (value) *value = m_params.t60;
+                if (valuestr) snprintf(valuestr, 32, "%.3f s", m_params.t60);
+                break;
 
-    return FMOD_OK;
-}
+            case GENETIC_REVERB_PARAM_C80:
+                if (value) *value = m_params.c80;
+                if (valuestr) snprintf(valuestr, 32, "%.2f dB", m_params.c80);
+                break;
 
-/**
- * @brief GeneticReverb DSPプラグインのパラメータ取得関数
- * @param dsp_state DSPの内部データ
- * @param index パラメータのインデックス
- * @param value 取得する値を格納するポインタ
- * @return 処理が成功した場合はFMOD_OKを返す、それ以外はFMOD_ERR_INVALID_PARAMを返す
- */
-FMOD_RESULT F_CALL GeneticReverb_GetParameterFloat(FMOD_DSP_STATE* dsp_state, int index, float* value, char* valuestr) {
-    auto* state = static_cast<GeneticReverbState*>(dsp_state->plugindata);
-    if (!state) return FMOD_ERR_INVALID_PARAM;
-
-    switch (index) {
-        case GENETIC_REVERB_PARAM_DRY:
-            if (value) *value = state->dry;
-            if (valuestr) snprintf(valuestr, 32, "%.2f x", state->dry);
-            break;
-
-        case GENETIC_REVERB_PARAM_WET:
-            if (value) *value = state->wet;
-            if (valuestr) snprintf(valuestr, 32, "%.2f x", state->wet);
-            break;
-
-        case GENETIC_REVERB_PARAM_VOLUME:
-            if (value) *value = state->volume;
-            if (valuestr) snprintf(valuestr, 32, "%.2f x", state->volume);
-            break;
-
-        case GENETIC_REVERB_PARAM_T60:
-            if (value) *value = state->params.t60;
-            if (valuestr) snprintf(valuestr, 32, "%.3f s", state->params.t60);
-            break;
-
-        case GENETIC_REVERB_PARAM_C80:
-            if (value) *value = state->params.c80;
-            if (valuestr) snprintf(valuestr, 32, "%.2f dB", state->params.c80);
-            break;
-
-        case GENETIC_REVERB_PARAM_PROGRESS: {
-                const float progress = state->lastProgress.load();
+            case GENETIC_REVERB_PARAM_BR:
+                if (value) *value = m_params.br;
+                if (valuestr) snprintf(valuestr, 32, "%.2f x", m_params.br);
+                break;
+
+            case GENETIC_REVERB_PARAM_BRIGHTNESS:
+                if (value) *value = m_params.brightness;
+                if (valuestr) snprintf(valuestr, 32, "%.2f x", m_params.brightness);
+                break;
+
+            case GENETIC_REVERB_PARAM_SPECTRAL:
+                if (value) *value = m_spectralWeight;
+                if (valuestr) snprintf(valuestr, 32, "%.2f x", m_spectralWeight);
+                break;
+
+            case GENETIC_REVERB_PARAM_PROGRESS: {
+                const float progress = m_lastProgress.load();
                 if (value) *value = progress;
                 if (valuestr) snprintf(valuestr, 32, "%.0f %%", progress * 100.0f);
                 break;
+            }
+
+            default:
+                return FMOD_ERR_INVALID_PARAM;
         }
 
-        default:
-            return FMOD_ERR_INVALID_PARAM;
+        return FMOD_OK;
     }
 
-    return FMOD_OK;
-}
-
-FMOD_RESULT GeneticReverb_SetParameterBool(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL value) {
-    auto* state = static_cast<GeneticReverbState*>(dsp_state->plugindata);
-    if (!state || !state->processor)
-        return FMOD_ERR_INVALID_PARAM;
+    /**
+     * @brief boolパラメータの設定関数
+     */
+    FMOD_RESULT setParameterBool(int index, FMOD_BOOL value) {
+        switch (index) {
+            case GENETIC_REVERB_PARAM_GENERATE:
+                if (value) m_processor.startGenerate();
+                break;
 
-    switch (index) {
-        case GENETIC_REVERB_PARAM_GENERATE:
-            if (value) state->processor->startGenerate();
-            break;
+            case GENETIC_REVERB_PARAM_CANCEL:
+                if (value) m_processor.cancelIR();
+                break;
 
-        case GENETIC_REVERB_PARAM_CANCEL:
-            if (value) state->processor->cancelIR();
-            break;
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
 
-        default:
-            return FMOD_ERR_INVALID_PARAM;
+        return FMOD_OK;
     }
 
-    return FMOD_OK;
-}
+    /**
+     * @brief boolパラメータの取得関数
+     */
+    FMOD_RESULT getParameterBool(int index, FMOD_BOOL* value, char* /*valuestr*/) {
+        if (!value) {
+            return FMOD_ERR_INVALID_PARAM;
+        }
 
-FMOD_RESULT GeneticReverb_GetParameterBool(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL* value, char* valuestr) {
-    auto* state = static_cast<GeneticReverbState*>(dsp_state->plugindata);
-    if (!state || !value)
-        return FMOD_ERR_INVALID_PARAM;
+        switch (index) {
+            case GENETIC_REVERB_PARAM_GENERATE:
+                *value = m_processor.isGenerating() ? 1 : 0;
+                break;
 
-    switch (index) {
-        case GENETIC_REVERB_PARAM_GENERATE:
-            *value = (state->processor && state->processor->isGenerating()) ? 1 : 0;
-            break;
+            case GENETIC_REVERB_PARAM_CANCEL:
+                // ボタン扱いのため常に false
+                *value = 0;
+                break;
 
-        case GENETIC_REVERB_PARAM_CANCEL:
-            // ボタン扱いのため常に false
-            *value = 0;
-            break;
+            default:
+                return FMOD_ERR_INVALID_PARAM;
+        }
 
-        default:
-            return FMOD_ERR_INVALID_PARAM;
+        return FMOD_OK;
     }
 
-    return FMOD_OK;
-}
-
+    ConvolutionProcessor m_processor;              // 畳み込みとIR生成
+    float* m_scratchInL = nullptr;                 // デインタリーブしたLの入力
+    float* m_scratchInR = nullptr;                 // デインタリーブしたRの入力
+    float* m_scratchOutL = nullptr;                // Lの畳み込み結果
+    float* m_scratchOutR = nullptr;                // Rの畳み込み結果
+    float* m_scratchWet = nullptr;                 // 入力と同じ並びにインタリーブしたWet信号
+    int m_wetChannels = 0;                         // m_scratchWet が収められるチャンネル数
+
+    std::atomic<IRHandle*> m_irToSwap { nullptr };
+    std::atomic<float> m_dry { 0.5f };
+    std::atomic<float> m_wet { 0.5f };
+    std::atomic<float> m_volume { 1.0f };
+
+    ReverbTargetParams m_params { 0.4f, 0.06f, 12.0f, 1.0f, 1.0f };
+    float m_spectralWeight = 0.0f;                 // Spectral パラメータ（SpectralWeightsFor で各項の重みにする）
+    std::atomic<float> m_lastProgress { 0.0f };
+};
 
 /**
  * @brief ビルドしたDLLからFMODがDSPプラグインの説明を取得するためのエクスポート関数
- * @return GeneticReverb DSPプラグインの説明構造体へのポインタ
  */
-#if defined(_WIN32)
-    #define FMOD_EXPORT __declspec(dllexport)
-#elif defined(__GNUC__) || defined(__clang__)
-    #define FMOD_EXPORT __attribute__((visibility("default")))
-#else
-    #define FMOD_EXPORT
-#endif
-
-extern "C" {
-    FMOD_EXPORT FMOD_DSP_DESCRIPTION* FMODGetDSPDescription() {
-        InitParameterDescs();
-        return &geneticReverbDesc;
-    }
-}
\ No newline at end of file
+FMOD_PLUGIN_EXPORT(GeneticReverb)
@@ -0,0 +1,124 @@
+﻿/**
+ * @file IROptimizer.cpp
+ * @author Goto Kenta
+ * @brief IRの最適化の共通部分の実装
+ */
+
+# include "IROptimizer.h"
+# include "CmaEsOptimizer.h"
+# include "DifferentialEvolutionOptimizer.h"
+# include "GeneticAlgorithm.h"
+
+# include <cstdlib>
+# include <cstring>
+
+IROptimizer::IROptimizer(float sampleRate)
+    : m_sampleRate(sampleRate),
+      m_evaluator(sampleRate),
+      m_rng(std::random_device{}())
+{
+}
+
+IROptimizer::~IROptimizer() = default;
+
+std::unique_ptr<IROptimizer> IROptimizer::Create(OptimizerBackend backend, float sampleRate) {
+    switch (backend) {
+        case OptimizerBackend::CMAES: return std::make_unique<CmaEsOptimizer>(sampleRate);
+        case OptimizerBackend::DifferentialEvolution: return std::make_unique<DifferentialEvolutionOptimizer>(sampleRate);
+        case OptimizerBackend::GeneticAlgorithm: break;
+    }
+    return std::make_unique<GeneticAlgorithm>(50, 0.001f, sampleRate);
+}
+
+OptimizerBackend IROptimizer::DefaultBackend() {
+    static const OptimizerBackend backend = [] {
+        if (const char* requested = std::getenv("FMOD_PLUGINS_OPTIMIZER")) {
+            for (OptimizerBackend candidate : { OptimizerBackend::GeneticAlgorithm, OptimizerBackend::CMAES, OptimizerBackend::DifferentialEvolution }) {
+                if (std::strcmp(requested, BackendName(candidate)) == 0) {
+                    return candidate;
+                }
+            }
+        }
+        return OptimizerBackend::GeneticAlgorithm;
+    }();
+    return backend;
+}
+
+const char* IROptimizer::BackendName(OptimizerBackend backend) {
+    switch (backend) {
+        case OptimizerBackend::CMAES: return "cmaes";
+        case OptimizerBackend::DifferentialEvolution: return "de";
+        case OptimizerBackend::GeneticAlgorithm: break;
+    }
+    return "ga";
+}
+
+/**
+ * @brief 周波数領域の評価を設定する関数
+ * @param blockSize コンボリューターの分割の長さ（0なら周波数領域の解析をしない）
+ * @param weights BR・明るさ・色付きの重み（全て0なら適応度に含めず、選ばれたIRのスペクトルだけを計算する）
+ * @note blockSize を指定すると、選ばれたIRの分割スペクトルを bestSpectrum() で受け取れる
+ */
+void IROptimizer::setSpectralAnalysis(size_t blockSize, const SpectralWeights& weights) {
+    m_evaluator.setSpectralAnalysis(blockSize, weights);
+}
+
+/**
+ * @brief 最後の compute で選ばれたIRの分割スペクトル
+ * @return 分割スペクトル（周波数領域の解析をしていなければ nullptr）
+ */
+PartitionedIR::Ptr IROptimizer::bestSpectrum() const {
+    return m_bestSpectrum;
+}
+
+/**
+ * @brief 乱数の種を固定する関数
+ * @param seed 乱数の種（同じ種・同じ設定の compute は同じ結果になる）
+ */
+void IROptimizer::setSeed(uint32_t seed) {
+    m_rng.seed(seed);
+}
+
+/**
+ * @brief 進捗コールバック関数の設定
+ * @param callback コールバック関数
+ */
+void IROptimizer::setProgressCallback(ProgressCallback callback) {
+    m_onProgress = std::move(callback);
+}
+
+/**
+ * @brief 処理のキャンセルを要求する関数
+ */
+void IROptimizer::cancel()
+{
+    m_cancel.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief キャンセルフラグをリセットする関数
+ */
+void IROptimizer::resetCancel()
+{
+    m_cancel.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief キャンセルが要求されたかどうか
+ */
+bool IROptimizer::isCancelled() const
+{
+    return m_cancel.load(std::memory_order_relaxed);
+}
+
+void IROptimizer::reportProgress(int curGen, int totalGen, double bestFitness) {
+    if (m_onProgress)
+        m_onProgress(curGen, totalGen, bestFitness);
+}
+
+void IROptimizer::storeBestSpectrum(const std::vector<float>& ir, PartitionedIR::Ptr spectrum) {
+    const size_t blockSize = m_evaluator.spectralBlockSize();
+    if (blockSize > 0 && !spectrum && !ir.empty())
+        spectrum = PartitionedIR::Create(blockSize, ir.data(), ir.size());
+    m_bestSpectrum = (blockSize > 0) ? std::move(spectrum) : nullptr;
+}
@@ -0,0 +1,99 @@
+﻿/**
+ * @file IROptimizer.h
+ * @author Goto Kenta
+ * @brief 目標の残響特性に合うIRを探す最適化の共通インターフェース
+ */
+
+# pragma once
+
+# include "FitnessEvaluator.h"
+# include "../Common/PartitionedIR.h"
+
+# include <atomic>
+# include <cstdint>
+# include <functional>
+# include <memory>
+# include <random>
+# include <vector>
+
+/**
+ * @brief 最適化の方法
+ */
+enum class OptimizerBackend {
+    GeneticAlgorithm,      // IRのサンプルをそのまま遺伝子にする（GeneticAlgorithm）
+    CMAES,                 // 減衰のパラメータをCMA-ESで探す（CmaEsOptimizer）
+    DifferentialEvolution, // 減衰のパラメータを差分進化で探す（DifferentialEvolutionOptimizer）
+};
+
+/**
+ * @brief IRの最適化の基底クラス
+ * @note 評価関数（FitnessEvaluator）・進捗の通知・キャンセル・選ばれたIRの分割スペクトルは共通で、
+ *       派生クラスは compute で探索だけを行う。compute はワーカースレッドから呼び、
+ *       cancel は別のスレッドから呼んでよい
+ */
+class IROptimizer {
+public:
+    using ProgressCallback = std::function<void(int curGen, int totalGen, double bestFitness)>;
+
+    explicit IROptimizer(float sampleRate);
+    virtual ~IROptimizer();
+
+    IROptimizer(const IROptimizer&) = delete;
+    IROptimizer& operator=(const IROptimizer&) = delete;
+
+    /**
+     * @brief 最適化を作る
+     * @param backend 最適化の方法
+     * @param sampleRate サンプリングレート
+     * @return 作った最適化（GAは集団50、突然変異率0.001）
+     */
+    static std::unique_ptr<IROptimizer> Create(OptimizerBackend backend, float sampleRate);
+
+    /**
+     * @brief 既定の方法（環境変数 FMOD_PLUGINS_OPTIMIZER=ga|cmaes|de、未指定ならGA）
+     */
+    static OptimizerBackend DefaultBackend();
+
+    static const char* BackendName(OptimizerBackend backend);
+
+    virtual OptimizerBackend backend() const = 0;
+
+    /**
+     * @brief 目標に合うIRを探す
+     * @param targetParams 目標とする残響特性のパラメータ
+     * @param numGenerations 世代数（1世代で評価する個体の数は方法ごとに異なる）
+     * @return 見つかった最良のIR（失敗したら空）
+     */
+    virtual std::vector<float> compute(const ReverbTargetParams& targetParams, int numGenerations) = 0;
+
+    // 周波数領域の評価の設定（blockSize はコンボリューターと同じ分割の長さ、0なら行わない）
+    void setSpectralAnalysis(size_t blockSize, const SpectralWeights& weights);
+    // 最後の compute で選ばれたIRの分割スペクトル（そのままコンボリューターに渡せる）
+    PartitionedIR::Ptr bestSpectrum() const;
+
+    // 乱数の種を固定する（既定は std::random_device。チェックで結果を再現するときに使う）
+    void setSeed(uint32_t seed);
+    // これまでに FitnessEvaluator で詳しく評価したIRの数
+    size_t evaluationCount() const { return m_evaluator.evaluationCount(); }
+
+    // 進捗コールバック関数の設定
+    void setProgressCallback(ProgressCallback callback);
+    void cancel();
+    void resetCancel();
+    bool isCancelled() const;
+
+protected:
+    float m_sampleRate;             // サンプリングレート
+    FitnessEvaluator m_evaluator;   // 派生クラスで共有する評価関数
+    std::mt19937 m_rng;             // 派生クラスで共有する乱数生成器
+    PartitionedIR::Ptr m_bestSpectrum;
+
+    // 進捗を通知する（コールバックがなければ何もしない）
+    void reportProgress(int curGen, int totalGen, double bestFitness);
+    // 選ばれたIRの分割スペクトルを保存する（評価で計算済みでなければ、必要なときだけ計算する）
+    void storeBestSpectrum(const std::vector<float>& ir, PartitionedIR::Ptr spectrum);
+
+private:
+    ProgressCallback m_onProgress;
+    std::atomic<bool> m_cancel { false };
+};
@@ -0,0 +1,165 @@
+﻿/**
+ * @file ParametricIR.cpp
+ * @author Goto Kenta
+ * @brief パラメータから作るIRの実装
+ */
+
+# include "ParametricIR.h"
+# include "../Common/SimdDispatch.h"
+
+# include <algorithm>
+# include <cmath>
+# include <random>
+
+namespace {
+    constexpr double kMinEarlyGainDB = -30.0;
+    constexpr double kMaxEarlyGainDB = 30.0;
+    constexpr double kMinEarlyLength = 0.005; // 秒
+    constexpr double kMaxEarlyLength = 0.2;
+
+    double Clamp01(double x) {
+        return std::min(std::max(x, 0.0), 1.0);
+    }
+
+    // [0, 1] を [lo, hi] に対数で対応させる
+    double LogScale(double normalized, double lo, double hi) {
+        return lo * std::pow(hi / lo, Clamp01(normalized));
+    }
+
+    double InverseLogScale(double value, double lo, double hi) {
+        return Clamp01(std::log(value / lo) / std::log(hi / lo));
+    }
+}
+
+void ParametricIRModel::prepare(float sampleRate, const ReverbTargetParams& targetParams, uint32_t seed) {
+    m_sampleRate = sampleRate;
+
+    // IRの長さはGAと同じ（目標のT60の1.5倍、最低1024サンプル）
+    const double targetT60 = std::max(static_cast<double>(targetParams.t60), 0.001);
+    auto irLength = static_cast<size_t>(targetT60 * 1.5 * static_cast<double>(sampleRate));
+    if (irLength < 1024)
+        irLength = 1024;
+
+    m_minT60 = targetT60 / 8.0;
+    m_maxT60 = targetT60 * 4.0;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    m_noise.resize(irLength);
+    for (float& x : m_noise) {
+        x = dist(rng);
+    }
+}
+
+void ParametricIRModel::initialGuess(double* normalized) const {
+    const double target = m_maxT60 / 4.0;
+    normalized[0] = InverseLogScale(target, m_minT60, m_maxT60);
+    normalized[1] = InverseLogScale(target, m_minT60, m_maxT60);
+    normalized[2] = (0.0 - kMinEarlyGainDB) / (kMaxEarlyGainDB - kMinEarlyGainDB);
+    normalized[3] = (0.08 - kMinEarlyLength) / (kMaxEarlyLength - kMinEarlyLength);
+}
+
+ParametricIRModel::Decoded ParametricIRModel::decode(const double* normalized) const {
+    const double lateT60 = LogScale(normalized[0], m_minT60, m_maxT60);
+    const double earlyT60 = LogScale(normalized[1], m_minT60, m_maxT60);
+    const double earlyGainDB = kMinEarlyGainDB + Clamp01(normalized[2]) * (kMaxEarlyGainDB - kMinEarlyGainDB);
+    const double earlyLength = kMinEarlyLength + Clamp01(normalized[3]) * (kMaxEarlyLength - kMinEarlyLength);
+    const auto sampleRate = static_cast<double>(m_sampleRate);
+
+    // T60で振幅が 1/1000 になる
+    Decoded decoded;
+    decoded.earlyGain = std::pow(10.0, earlyGainDB / 20.0);
+    decoded.earlyDecay = std::pow(10.0, -3.0 / (earlyT60 * sampleRate));
+    decoded.lateDecay = std::pow(10.0, -3.0 / (lateT60 * sampleRate));
+    decoded.earlyEnd = std::min(static_cast<size_t>(earlyLength * sampleRate), m_noise.size());
+    return decoded;
+}
+
+void ParametricIRModel::render(const double* normalized, std::vector<float>& ir) {
+    const Decoded decoded = decode(normalized);
+    const size_t length = m_noise.size();
+    const size_t earlyEnd = decoded.earlyEnd;
+
+    // 後部は時刻0から減衰していた場合の振幅から続ける
+    const double lateStart = std::pow(decoded.lateDecay, static_cast<double>(earlyEnd));
+
+    // 包絡の最大値を1にそろえる（GAの初期集団と同じ音量にする）
+    const double peak = (earlyEnd > 0) ? std::max(decoded.earlyGain, lateStart) : lateStart;
+
+    // 1サンプルずつの掛け算で作る（doubleで累積する）
+    m_envelope.resize(length);
+    double amplitude = decoded.earlyGain / peak;
+    for (size_t i = 0 ; i < earlyEnd ; ++i) {
+        m_envelope[i] = static_cast<float>(amplitude);
+        amplitude *= decoded.earlyDecay;
+    }
+
+    amplitude = lateStart / peak;
+    for (size_t i = earlyEnd ; i < length ; ++i) {
+        m_envelope[i] = static_cast<float>(amplitude);
+        amplitude *= decoded.lateDecay;
+    }
+
+    ir.resize(length);
+    SimdKernels().multiply(m_noise.data(), m_envelope.data(), ir.data(), length);
+}
+
+EnergyMetrics ParametricIRModel::predict(const double* normalized) const {
+    const Decoded decoded = decode(normalized);
+    const size_t length = m_noise.size();
+    const size_t earlyEnd = decoded.earlyEnd;
+
+    // エネルギーの比 q = (振幅の減衰)^2 の対数
+    const double logEarly = 2.0 * std::log(decoded.earlyDecay);
+    const double logLate = 2.0 * std::log(decoded.lateDecay);
+    const double earlyEnergy = decoded.earlyGain * decoded.earlyGain;
+
+    // sum_{k=a}^{b-1} q^k = q^a (1 - q^(b-a)) / (1 - q)（q が1に近くても桁落ちしないよう expm1 を使う）
+    auto geometricSum = [](double logQ, size_t a, size_t b) -> double {
+        if (b <= a)
+            return 0.0;
+        return std::exp(static_cast<double>(a) * logQ) * std::expm1(static_cast<double>(b - a) * logQ) / std::expm1(logQ);
+    };
+
+    // サンプル n から最後までのエネルギーの期待値（雑音の分散は共通なので省く）
+    auto decay = [&](size_t n) -> double {
+        double remaining = geometricSum(logLate, std::max(n, earlyEnd), length);
+        if (n < earlyEnd)
+            remaining += earlyEnergy * geometricSum(logEarly, n, earlyEnd);
+        return remaining;
+    };
+
+    EnergyMetrics metrics;
+    const double total = decay(0);
+    if (!(total > 1e-300))
+        return metrics;
+
+    // BatchedEnergyAnalysis と同じく、db 以下になる最初のサンプル（なければ最後のサンプル）
+    auto findTimeForDB = [&](double db) -> double {
+        const double threshold = total * std::pow(10.0, db / 10.0);
+        size_t lo = 0;
+        size_t hi = length;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (decay(mid) <= threshold) {
+                hi = mid;
+            }
+            else {
+                lo = mid + 1;
+            }
+        }
+        return static_cast<double>(std::min(lo, length - 1));
+    };
+
+    const auto sampleRate = static_cast<double>(m_sampleRate);
+    const double t30 = findTimeForDB(-35.0) - findTimeForDB(-5.0);
+    metrics.t60 = (t30 <= 0.0) ? 0.0f : static_cast<float>(2.0 * t30 / sampleRate);
+    const double t10 = findTimeForDB(-10.0) - findTimeForDB(0.0);
+    metrics.edt = (t10 <= 0.0) ? 0.0f : static_cast<float>(6.0 * t10 / sampleRate);
+
+    const auto samples_80ms = static_cast<size_t>(std::max(static_cast<int>(0.08f * m_sampleRate), 0));
+    const double late = (samples_80ms < length) ? decay(samples_80ms) : 0.0;
+    const double minEnergy = 1e-20 * total;
+    metrics.c80 = static_cast<float>(10.0 * std::log10(std::max(total - late, minEnergy) / std::max(late, minEnergy)));
+    return metrics;
+}
@@ -0,0 +1,73 @@
+﻿/**
+ * @file ParametricIR.h
+ * @author Goto Kenta
+ * @brief 少数の減衰パラメータから作るIR（CMA-ES・差分進化の遺伝子）
+ */
+
+# pragma once
+
+# include "BatchedEnergyAnalysis.h"
+# include "FitnessEvaluator.h"
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+/**
+ * @brief 固定の雑音に、初期部分と後部で傾きの違う指数減衰をかけたIR
+ * @note パラメータは各成分を [0, 1] に正規化して扱い、範囲外の値は端に寄せる。
+ *       0: 後部のT60、1: 初期部分のT60（どちらも対数で対応させる）、2: 初期部分のゲイン（dB）、3: 初期部分の長さ。
+ *       雑音は prepare で1度だけ作るので、同じパラメータからは同じIRができる（評価関数が滑らかになる）
+ */
+class ParametricIRModel {
+public:
+    static constexpr size_t kParameterCount = 4;
+
+    /**
+     * @brief 目標に合わせてIRの長さとパラメータの範囲を決め、雑音を作る
+     * @param sampleRate サンプリングレート
+     * @param targetParams 目標とする残響特性のパラメータ
+     * @param seed 雑音の乱数の種
+     */
+    void prepare(float sampleRate, const ReverbTargetParams& targetParams, uint32_t seed);
+
+    size_t length() const { return m_noise.size(); }
+
+    /**
+     * @brief 探索の初期値（目標のT60で単純に減衰するIR）
+     * @param normalized 結果（kParameterCount 個）
+     */
+    void initialGuess(double* normalized) const;
+
+    /**
+     * @brief パラメータからIRを作る
+     * @param normalized 正規化したパラメータ（kParameterCount 個）
+     * @param ir 結果（length() サンプルにする）
+     */
+    void render(const double* normalized, std::vector<float>& ir);
+
+    /**
+     * @brief IRを作らずに、雑音のエネルギーの期待値からT60・EDT・C80を閉じた式で見積もる
+     * @param normalized 正規化したパラメータ（kParameterCount 個）
+     * @return 見積もった指標（render したIRを BatchedEnergyAnalysis で測った値に近い）
+     * @note 包絡は区間ごとに等比数列なので、EDCは等比級数の和になり、各サンプルの値をO(1)で求められる。
+     *       -5dBなどを下回るサンプルは二分探索で求める（1回あたり数十回のexp・log）
+     */
+    EnergyMetrics predict(const double* normalized) const;
+
+private:
+    // 正規化したパラメータを実際の値に戻したもの
+    struct Decoded {
+        double earlyGain;  // 初期部分の振幅の倍率
+        double earlyDecay; // 初期部分の1サンプルあたりの振幅の減衰
+        double lateDecay;  // 後部の1サンプルあたりの振幅の減衰
+        size_t earlyEnd;   // 初期部分の終わり（サンプル）
+    };
+    Decoded decode(const double* normalized) const;
+
+    float m_sampleRate = 48000.0f;
+    double m_minT60 = 0.01;
+    double m_maxT60 = 1.0;
+    std::vector<float> m_noise;
+    std::vector<float> m_envelope;
+};
@@ -0,0 +1,359 @@
+/**
+ *  @file PluginHost.cpp
+ *  @author Goto Kenta
+ *  @brief FMODの代わりにプラグインを読み込んで処理させるホスト（Linuxでのプロファイル用）
+ *  @note 使い方: PluginHost <プラグインの.so> [エフェクト名] [秒数] [チャンネル数] [ブロックサイズ] [パラメータ名=値 ...]
+ *        ホワイトノイズを入力して処理時間を計測する。perf record -g ./PluginHost libBitCrasher.so のように使う
+ *        - 「名前=値」の引数はどこに書いてもよく、計測の前にパラメータを設定する（int は値の名前でも、bool は true/false/on/off/1/0 で指定できる）
+ *        - Generate=true のように、読み出すと処理中かを返すboolパラメータ（GeneticReverbの Generate）を立てたら、
+ *          false に戻るまで待ってから計測する（Progress があれば表示する）
+ *        - FMODと同じく、QUERYが FMOD_ERR_DSP_DONTPROCESS を返したブロックは PERFORM を呼ばない
+ */
+
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <functional>
+# include <random>
+# include <string>
+# include <thread>
+# include <vector>
+
+# include <strings.h>
+
+# include <dlfcn.h>
+
+# include <fmod_common.h>
+# include <fmod_dsp.h>
+
+namespace {
+    int g_sampleRate = 48000;
+    unsigned int g_blockSize = 1024;
+    FMOD_SPEAKERMODE g_speakerMode = FMOD_SPEAKERMODE_STEREO;
+
+    void* F_CALL HostAlloc(unsigned int size, FMOD_MEMORY_TYPE, const char*) { return std::malloc(size); }
+    void* F_CALL HostRealloc(void* ptr, unsigned int size, FMOD_MEMORY_TYPE, const char*) { return std::realloc(ptr, size); }
+    void F_CALL HostFree(void* ptr, FMOD_MEMORY_TYPE, const char*) { std::free(ptr); }
+
+    FMOD_RESULT F_CALL HostGetSampleRate(FMOD_DSP_STATE*, int* rate) {
+        *rate = g_sampleRate;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL HostGetBlockSize(FMOD_DSP_STATE*, unsigned int* blocksize) {
+        *blocksize = g_blockSize;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL HostGetSpeakerMode(FMOD_DSP_STATE*, FMOD_SPEAKERMODE* mixer, FMOD_SPEAKERMODE* output) {
+        if (mixer) *mixer = g_speakerMode;
+        if (output) *output = g_speakerMode;
+        return FMOD_OK;
+    }
+
+    /**
+     * @brief チャンネル数に対応するスピーカーモード
+     */
+    FMOD_SPEAKERMODE SpeakerModeFromChannels(int channels) {
+        switch (channels) {
+            case 1: return FMOD_SPEAKERMODE_MONO;
+            case 2: return FMOD_SPEAKERMODE_STEREO;
+            case 4: return FMOD_SPEAKERMODE_QUAD;
+            case 5: return FMOD_SPEAKERMODE_SURROUND;
+            case 6: return FMOD_SPEAKERMODE_5POINT1;
+            case 8: return FMOD_SPEAKERMODE_7POINT1;
+            case 12: return FMOD_SPEAKERMODE_7POINT1POINT4;
+            default: return FMOD_SPEAKERMODE_RAW;
+        }
+    }
+
+    /**
+     * @brief ライブラリからエフェクトを探す（一覧を公開していればその中から名前で、なければ単体のエフェクト）
+     */
+    FMOD_DSP_DESCRIPTION* FindDescription(void* library, const char* name) {
+        using ListFunc = FMOD_PLUGINLIST* (F_CALL *)();
+        using DescFunc = FMOD_DSP_DESCRIPTION* (F_CALL *)();
+
+        if (auto list = reinterpret_cast<ListFunc>(dlsym(library, "FMODGetPluginDescriptionList"))) {
+            for (FMOD_PLUGINLIST* entry = list() ; entry->type != FMOD_PLUGINTYPE_MAX ; ++entry) {
+                auto* desc = static_cast<FMOD_DSP_DESCRIPTION*>(entry->description);
+                if (entry->type == FMOD_PLUGINTYPE_DSP && (!name || std::strcmp(desc->name, name) == 0)) {
+                    return desc;
+                }
+            }
+            return nullptr;
+        }
+
+        if (auto single = reinterpret_cast<DescFunc>(dlsym(library, "FMODGetDSPDescription"))) {
+            return single();
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 名前でパラメータの番号を探す（大文字小文字は区別しない）
+     * @return 見つからなければ -1
+     */
+    int FindParameter(const FMOD_DSP_DESCRIPTION* desc, const char* name) {
+        for (int i = 0 ; i < desc->numparameters ; ++i) {
+            if (strcasecmp(desc->paramdesc[i]->name, name) == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief bool の値の文字列を解釈する
+     * @return 解釈できたら true
+     */
+    bool ParseBool(const char* text, FMOD_BOOL* value) {
+        for (const char* on : { "1", "true", "on", "yes" }) {
+            if (strcasecmp(text, on) == 0) {
+                *value = 1;
+                return true;
+            }
+        }
+        for (const char* off : { "0", "false", "off", "no" }) {
+            if (strcasecmp(text, off) == 0) {
+                *value = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 「名前=値」の引数でパラメータを設定する
+     * @param generating 処理中かを読み出せるboolパラメータを立てたら、その番号を入れる
+     * @return 設定できたら true（できなければ理由を表示する）
+     */
+    bool SetParameter(FMOD_DSP_DESCRIPTION* desc, FMOD_DSP_STATE* state, const char* assignment, std::vector<int>& generating) {
+        const char* equals = std::strchr(assignment, '=');
+        const std::string name(assignment, equals);
+        const char* text = equals + 1;
+
+        const int index = FindParameter(desc, name.c_str());
+        if (index < 0) {
+            std::fprintf(stderr, "%s: no parameter named %s\n", desc->name, name.c_str());
+            return false;
+        }
+
+        const FMOD_DSP_PARAMETER_DESC& param = *desc->paramdesc[index];
+        FMOD_RESULT result = FMOD_ERR_INVALID_PARAM;
+        switch (param.type) {
+            case FMOD_DSP_PARAMETER_TYPE_FLOAT: {
+                char* end = nullptr;
+                const float value = std::strtof(text, &end);
+                if (end != text && *end == '\0' && desc->setparameterfloat) {
+                    result = desc->setparameterfloat(state, index, value);
+                }
+                break;
+            }
+
+            case FMOD_DSP_PARAMETER_TYPE_INT: {
+                // 値の名前があれば名前でも指定できる
+                int value = 0;
+                char* end = nullptr;
+                bool parsed = false;
+                if (param.intdesc.valuenames) {
+                    for (int v = param.intdesc.min ; v <= param.intdesc.max && !parsed ; ++v) {
+                        if (strcasecmp(param.intdesc.valuenames[v - param.intdesc.min], text) == 0) {
+                            value = v;
+                            parsed = true;
+                        }
+                    }
+                }
+                if (!parsed) {
+                    value = static_cast<int>(std::strtol(text, &end, 10));
+                    parsed = (end != text && *end == '\0');
+                }
+                if (parsed && desc->setparameterint) {
+                    result = desc->setparameterint(state, index, value);
+                }
+                break;
+            }
+
+            case FMOD_DSP_PARAMETER_TYPE_BOOL: {
+                FMOD_BOOL value = 0;
+                if (ParseBool(text, &value) && desc->setparameterbool) {
+                    result = desc->setparameterbool(state, index, value);
+
+                    // 立てたあとも true を返すなら、バックグラウンドの処理が始まったとみなして終わるまで待つ
+                    FMOD_BOOL running = 0;
+                    if (result == FMOD_OK && value && desc->getparameterbool &&
+                        desc->getparameterbool(state, index, &running, nullptr) == FMOD_OK && running) {
+                        generating.push_back(index);
+                    }
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (result != FMOD_OK) {
+            std::fprintf(stderr, "%s: cannot set %s to %s (error %d)\n", desc->name, param.name, text, static_cast<int>(result));
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 立てたboolパラメータが false に戻るまで待つ（Progress パラメータがあれば1秒ごとに表示する）
+     * @param processBlock 待つ間にブロックの時間ごとに呼ぶ処理（FMODのミキサーと同じく、進捗の更新やIRの差し替えはバッファ先頭で行われる）
+     */
+    void WaitForGeneration(FMOD_DSP_DESCRIPTION* desc, FMOD_DSP_STATE* state, const std::vector<int>& generating, const std::function<bool()>& processBlock) {
+        const int progress = FindParameter(desc, "Progress");
+        const auto start = std::chrono::steady_clock::now();
+        auto lastReport = start;
+
+        for (int index : generating) {
+            for ( ;; ) {
+                FMOD_BOOL running = 0;
+                if (desc->getparameterbool(state, index, &running, nullptr) != FMOD_OK || !running) {
+                    break;
+                }
+                processBlock();
+                std::this_thread::sleep_for(std::chrono::microseconds(1000000LL * g_blockSize / g_sampleRate));
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now - lastReport >= std::chrono::seconds(1)) {
+                    lastReport = now;
+                    float value = 0.0f;
+                    if (progress >= 0 && desc->paramdesc[progress]->type == FMOD_DSP_PARAMETER_TYPE_FLOAT && desc->getparameterfloat &&
+                        desc->getparameterfloat(state, progress, &value, nullptr) == FMOD_OK) {
+                        std::fprintf(stderr, "%s: waiting for %s (%.0f%%)\n", desc->name, desc->paramdesc[index]->name, value * 100.0f);
+                    }
+                    else {
+                        std::fprintf(stderr, "%s: waiting for %s\n", desc->name, desc->paramdesc[index]->name);
+                    }
+                }
+            }
+        }
+
+        if (!generating.empty()) {
+            std::printf("%s: generation finished in %.3f s\n", desc->name,
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <plugin.so> [effect] [seconds] [channels] [blocksize] [param=value ...]\n", argv[0]);
+        return 1;
+    }
+
+    // 「名前=値」はパラメータ、それ以外は順番どおりの引数
+    std::vector<const char*> positional;
+    std::vector<const char*> assignments;
+    for (int i = 2 ; i < argc ; ++i) {
+        (std::strchr(argv[i], '=') ? assignments : positional).push_back(argv[i]);
+    }
+
+    const char* effect = (positional.size() > 0 && std::strcmp(positional[0], "-") != 0) ? positional[0] : nullptr;
+    const double seconds = (positional.size() > 1) ? std::atof(positional[1]) : 10.0;
+    const int channels = (positional.size() > 2) ? std::atoi(positional[2]) : 2;
+    g_blockSize = (positional.size() > 3) ? static_cast<unsigned int>(std::atoi(positional[3])) : g_blockSize;
+    g_speakerMode = SpeakerModeFromChannels(channels);
+
+    if (seconds <= 0.0 || channels < 1 || channels > FMOD_MAX_CHANNEL_WIDTH || g_blockSize == 0) {
+        std::fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    void* library = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!library) {
+        std::fprintf(stderr, "%s\n", dlerror());
+        return 1;
+    }
+
+    FMOD_DSP_DESCRIPTION* desc = FindDescription(library, effect);
+    if (!desc) {
+        std::fprintf(stderr, "no DSP description found in %s\n", argv[1]);
+        return 1;
+    }
+
+    FMOD_DSP_STATE_FUNCTIONS functions {};
+    functions.alloc = HostAlloc;
+    functions.realloc = HostRealloc;
+    functions.free = HostFree;
+    functions.getsamplerate = HostGetSampleRate;
+    functions.getblocksize = HostGetBlockSize;
+    functions.getspeakermode = HostGetSpeakerMode;
+
+    FMOD_DSP_STATE state {};
+    state.functions = &functions;
+
+    if (desc->create(&state) != FMOD_OK) {
+        std::fprintf(stderr, "%s: create failed\n", desc->name);
+        return 1;
+    }
+    if (desc->reset) {
+        desc->reset(&state);
+    }
+
+    // 入力はホワイトノイズ（毎ブロック同じものを使い回す）
+    std::vector<float> input(static_cast<size_t>(g_blockSize) * channels);
+    std::vector<float> output(input.size());
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (float& x : input) {
+        x = noise(rng);
+    }
+
+    int inChannels = channels;
+    int outChannels = channels;
+    FMOD_CHANNELMASK inMask = 0;
+    FMOD_CHANNELMASK outMask = 0;
+    float* inBuffer = input.data();
+    float* outBuffer = output.data();
+    FMOD_DSP_BUFFER_ARRAY inArray { 1, &inChannels, &inMask, &inBuffer, g_speakerMode };
+    FMOD_DSP_BUFFER_ARRAY outArray { 1, &outChannels, &outMask, &outBuffer, g_speakerMode };
+
+    // FMODと同じく、QUERYが DONTPROCESS なら PERFORM を呼ばない
+    const auto processBlock = [&]() {
+        if (desc->process(&state, g_blockSize, &inArray, &outArray, false, FMOD_DSP_PROCESS_QUERY) == FMOD_ERR_DSP_DONTPROCESS) {
+            return false;
+        }
+        desc->process(&state, g_blockSize, &inArray, &outArray, false, FMOD_DSP_PROCESS_PERFORM);
+        return true;
+    };
+
+    // パラメータを設定し、IR生成などが始まったら終わってから計測する（待つ間もミキサーのように処理を呼び、進捗とIRの差し替えを進める）
+    std::vector<int> generating;
+    for (const char* assignment : assignments) {
+        if (!SetParameter(desc, &state, assignment, generating)) {
+            desc->release(&state);
+            return 1;
+        }
+    }
+    WaitForGeneration(desc, &state, generating, processBlock);
+
+    const auto numBlocks = static_cast<long long>(seconds * g_sampleRate / g_blockSize) + 1;
+    long long skipped = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (long long i = 0 ; i < numBlocks ; ++i) {
+        if (!processBlock()) {
+            ++skipped;
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double audioSeconds = static_cast<double>(numBlocks) * g_blockSize / g_sampleRate;
+
+    std::printf("%s: %lld blocks x %u frames x %d ch, %.3f s audio in %.3f s (%.1fx realtime, %.2f us/block)\n",
+                desc->name, numBlocks, g_blockSize, channels, audioSeconds, elapsed,
+                audioSeconds / elapsed, elapsed * 1e6 / static_cast<double>(numBlocks));
+    if (skipped > 0) {
+        std::printf("%s: %lld blocks skipped (QUERY returned DONTPROCESS)\n", desc->name, skipped);
+    }
+
+    desc->release(&state);
+    dlclose(library);
+    return 0;
+}
@@ -0,0 +1,12 @@
+/**
+ *  @file fmod.h
+ *  @brief FMOD Core APIのホスト代替用スタブ
+ */
+
+# ifndef FMOD_H
+# define FMOD_H
+
+# include "fmod_common.h"
+# include "fmod_dsp.h"
+
+# endif // FMOD_H
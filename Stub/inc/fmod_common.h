@@ -0,0 +1,165 @@
+/**
+ *  @file fmod_common.h
+ *  @brief FMOD Core APIのホスト代替用スタブ（プラグインのビルドに必要な型のみ）
+ */
+
+# ifndef FMOD_COMMON_H
+# define FMOD_COMMON_H
+
+# if defined(_WIN32) || defined(__CYGWIN__)
+    # define F_CALL __stdcall
+# else
+    # define F_CALL
+# endif
+
+# define F_CALLBACK F_CALL
+
+typedef int                        FMOD_BOOL;
+typedef unsigned int               FMOD_MEMORY_TYPE;
+typedef unsigned int               FMOD_CHANNELMASK;
+
+# define FMOD_MEMORY_NORMAL        0x00000000
+# define FMOD_MEMORY_STREAM_FILE   0x00000001
+# define FMOD_MEMORY_STREAM_DECODE 0x00000002
+# define FMOD_MEMORY_SAMPLEDATA    0x00000004
+# define FMOD_MEMORY_DSP_BUFFER    0x00000008
+# define FMOD_MEMORY_PLUGIN        0x00000010
+# define FMOD_MEMORY_PERSISTENT    0x00200000
+# define FMOD_MEMORY_ALL           0xFFFFFFFF
+
+# define FMOD_MAX_CHANNEL_WIDTH    32
+
+typedef enum FMOD_RESULT {
+    FMOD_OK,
+    FMOD_ERR_BADCOMMAND,
+    FMOD_ERR_CHANNEL_ALLOC,
+    FMOD_ERR_CHANNEL_STOLEN,
+    FMOD_ERR_DMA,
+    FMOD_ERR_DSP_CONNECTION,
+    FMOD_ERR_DSP_DONTPROCESS,
+    FMOD_ERR_DSP_FORMAT,
+    FMOD_ERR_DSP_INUSE,
+    FMOD_ERR_DSP_NOTFOUND,
+    FMOD_ERR_DSP_RESERVED,
+    FMOD_ERR_DSP_SILENCE,
+    FMOD_ERR_DSP_TYPE,
+    FMOD_ERR_FILE_BAD,
+    FMOD_ERR_FILE_COULDNOTSEEK,
+    FMOD_ERR_FILE_DISKEJECTED,
+    FMOD_ERR_FILE_EOF,
+    FMOD_ERR_FILE_ENDOFDATA,
+    FMOD_ERR_FILE_NOTFOUND,
+    FMOD_ERR_FORMAT,
+    FMOD_ERR_HEADER_MISMATCH,
+    FMOD_ERR_HTTP,
+    FMOD_ERR_HTTP_ACCESS,
+    FMOD_ERR_HTTP_PROXY_AUTH,
+    FMOD_ERR_HTTP_SERVER_ERROR,
+    FMOD_ERR_HTTP_TIMEOUT,
+    FMOD_ERR_INITIALIZATION,
+    FMOD_ERR_INITIALIZED,
+    FMOD_ERR_INTERNAL,
+    FMOD_ERR_INVALID_FLOAT,
+    FMOD_ERR_INVALID_HANDLE,
+    FMOD_ERR_INVALID_PARAM,
+    FMOD_ERR_INVALID_POSITION,
+    FMOD_ERR_INVALID_SPEAKER,
+    FMOD_ERR_INVALID_SYNCPOINT,
+    FMOD_ERR_INVALID_THREAD,
+    FMOD_ERR_INVALID_VECTOR,
+    FMOD_ERR_MAXAUDIBLE,
+    FMOD_ERR_MEMORY,
+    FMOD_ERR_MEMORY_CANTPOINT,
+    FMOD_ERR_NEEDS3D,
+    FMOD_ERR_NEEDSHARDWARE,
+    FMOD_ERR_NET_CONNECT,
+    FMOD_ERR_NET_SOCKET_ERROR,
+    FMOD_ERR_NET_URL,
+    FMOD_ERR_NET_WOULD_BLOCK,
+    FMOD_ERR_NOTREADY,
+    FMOD_ERR_OUTPUT_ALLOCATED,
+    FMOD_ERR_OUTPUT_CREATEBUFFER,
+    FMOD_ERR_OUTPUT_DRIVERCALL,
+    FMOD_ERR_OUTPUT_FORMAT,
+    FMOD_ERR_OUTPUT_INIT,
+    FMOD_ERR_OUTPUT_NODRIVERS,
+    FMOD_ERR_PLUGIN,
+    FMOD_ERR_PLUGIN_MISSING,
+    FMOD_ERR_PLUGIN_RESOURCE,
+    FMOD_ERR_PLUGIN_VERSION,
+    FMOD_ERR_RECORD,
+    FMOD_ERR_REVERB_CHANNELGROUP,
+    FMOD_ERR_REVERB_INSTANCE,
+    FMOD_ERR_SUBSOUNDS,
+    FMOD_ERR_SUBSOUND_ALLOCATED,
+    FMOD_ERR_SUBSOUND_CANTMOVE,
+    FMOD_ERR_TAGNOTFOUND,
+    FMOD_ERR_TOOMANYCHANNELS,
+    FMOD_ERR_TRUNCATED,
+    FMOD_ERR_UNIMPLEMENTED,
+    FMOD_ERR_UNINITIALIZED,
+    FMOD_ERR_UNSUPPORTED,
+    FMOD_ERR_VERSION,
+    FMOD_ERR_EVENT_ALREADY_LOADED,
+    FMOD_ERR_EVENT_LIVEUPDATE_BUSY,
+    FMOD_ERR_EVENT_LIVEUPDATE_MISMATCH,
+    FMOD_ERR_EVENT_LIVEUPDATE_TIMEOUT,
+    FMOD_ERR_EVENT_NOTFOUND,
+    FMOD_ERR_STUDIO_UNINITIALIZED,
+    FMOD_ERR_STUDIO_NOT_LOADED,
+    FMOD_ERR_INVALID_STRING,
+    FMOD_ERR_ALREADY_LOCKED,
+    FMOD_ERR_NOT_LOCKED,
+    FMOD_ERR_RECORD_DISCONNECTED,
+    FMOD_ERR_TOOMANYSAMPLES,
+
+    FMOD_RESULT_FORCEINT = 65536
+} FMOD_RESULT;
+
+typedef enum FMOD_SPEAKERMODE {
+    FMOD_SPEAKERMODE_DEFAULT,
+    FMOD_SPEAKERMODE_RAW,
+    FMOD_SPEAKERMODE_MONO,
+    FMOD_SPEAKERMODE_STEREO,
+    FMOD_SPEAKERMODE_QUAD,
+    FMOD_SPEAKERMODE_SURROUND,
+    FMOD_SPEAKERMODE_5POINT1,
+    FMOD_SPEAKERMODE_7POINT1,
+    FMOD_SPEAKERMODE_7POINT1POINT4,
+
+    FMOD_SPEAKERMODE_MAX,
+    FMOD_SPEAKERMODE_FORCEINT = 65536
+} FMOD_SPEAKERMODE;
+
+typedef enum FMOD_PLUGINTYPE {
+    FMOD_PLUGINTYPE_OUTPUT,
+    FMOD_PLUGINTYPE_CODEC,
+    FMOD_PLUGINTYPE_DSP,
+
+    FMOD_PLUGINTYPE_MAX,
+    FMOD_PLUGINTYPE_FORCEINT = 65536
+} FMOD_PLUGINTYPE;
+
+typedef struct FMOD_PLUGINLIST {
+    FMOD_PLUGINTYPE type;
+    void*           description;
+} FMOD_PLUGINLIST;
+
+typedef struct FMOD_VECTOR {
+    float x;
+    float y;
+    float z;
+} FMOD_VECTOR;
+
+typedef struct FMOD_3D_ATTRIBUTES {
+    FMOD_VECTOR position;
+    FMOD_VECTOR velocity;
+    FMOD_VECTOR forward;
+    FMOD_VECTOR up;
+} FMOD_3D_ATTRIBUTES;
+
+typedef void* (F_CALL *FMOD_MEMORY_ALLOC_CALLBACK)(unsigned int size, FMOD_MEMORY_TYPE type, const char* sourcestr);
+typedef void* (F_CALL *FMOD_MEMORY_REALLOC_CALLBACK)(void* ptr, unsigned int size, FMOD_MEMORY_TYPE type, const char* sourcestr);
+typedef void  (F_CALL *FMOD_MEMORY_FREE_CALLBACK)(void* ptr, FMOD_MEMORY_TYPE type, const char* sourcestr);
+
+# endif // FMOD_COMMON_H
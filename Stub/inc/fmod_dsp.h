@@ -0,0 +1,218 @@
+/**
+ *  @file fmod_dsp.h
+ *  @brief FMOD DSPプラグインAPIのホスト代替用スタブ
+ */
+
+# ifndef FMOD_DSP_H
+# define FMOD_DSP_H
+
+# include "fmod_common.h"
+
+# include <string.h>
+
+# define FMOD_PLUGIN_SDK_VERSION 110
+
+typedef struct FMOD_DSP_STATE FMOD_DSP_STATE;
+typedef struct FMOD_DSP_BUFFER_ARRAY FMOD_DSP_BUFFER_ARRAY;
+typedef struct FMOD_COMPLEX FMOD_COMPLEX;
+
+typedef enum {
+    FMOD_DSP_PROCESS_PERFORM,
+    FMOD_DSP_PROCESS_QUERY
+} FMOD_DSP_PROCESS_OPERATION;
+
+typedef enum {
+    FMOD_DSP_PARAMETER_TYPE_FLOAT,
+    FMOD_DSP_PARAMETER_TYPE_INT,
+    FMOD_DSP_PARAMETER_TYPE_BOOL,
+    FMOD_DSP_PARAMETER_TYPE_DATA,
+
+    FMOD_DSP_PARAMETER_TYPE_MAX,
+    FMOD_DSP_PARAMETER_TYPE_FORCEINT = 65536
+} FMOD_DSP_PARAMETER_TYPE;
+
+typedef enum {
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE_LINEAR,
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE_AUTO,
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE_PIECEWISE_LINEAR,
+
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE_FORCEINT = 65536
+} FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE;
+
+/* DSPコールバック */
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_CREATE_CALLBACK)(FMOD_DSP_STATE* dsp_state);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_RELEASE_CALLBACK)(FMOD_DSP_STATE* dsp_state);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_RESET_CALLBACK)(FMOD_DSP_STATE* dsp_state);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_READ_CALLBACK)(FMOD_DSP_STATE* dsp_state, float* inbuffer, float* outbuffer, unsigned int length, int inchannels, int* outchannels);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_PROCESS_CALLBACK)(FMOD_DSP_STATE* dsp_state, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inbufferarray, FMOD_DSP_BUFFER_ARRAY* outbufferarray, FMOD_BOOL inputsidle, FMOD_DSP_PROCESS_OPERATION op);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SETPOSITION_CALLBACK)(FMOD_DSP_STATE* dsp_state, unsigned int pos);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SHOULDIPROCESS_CALLBACK)(FMOD_DSP_STATE* dsp_state, FMOD_BOOL inputsidle, unsigned int length, FMOD_CHANNELMASK inmask, int inchannels, FMOD_SPEAKERMODE speakermode);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SETPARAM_FLOAT_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, float value);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SETPARAM_INT_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, int value);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SETPARAM_BOOL_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL value);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SETPARAM_DATA_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, void* data, unsigned int length);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETPARAM_FLOAT_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, float* value, char* valuestr);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETPARAM_INT_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, int* value, char* valuestr);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETPARAM_BOOL_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, FMOD_BOOL* value, char* valuestr);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETPARAM_DATA_CALLBACK)(FMOD_DSP_STATE* dsp_state, int index, void** data, unsigned int* length, char* valuestr);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SYSTEM_REGISTER_CALLBACK)(FMOD_DSP_STATE* dsp_state);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SYSTEM_DEREGISTER_CALLBACK)(FMOD_DSP_STATE* dsp_state);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_SYSTEM_MIX_CALLBACK)(FMOD_DSP_STATE* dsp_state, int stage);
+
+/* ホストが提供する関数 */
+typedef void*       (F_CALL *FMOD_DSP_ALLOC_FUNC)(unsigned int size, FMOD_MEMORY_TYPE type, const char* sourcestr);
+typedef void*       (F_CALL *FMOD_DSP_REALLOC_FUNC)(void* ptr, unsigned int size, FMOD_MEMORY_TYPE type, const char* sourcestr);
+typedef void        (F_CALL *FMOD_DSP_FREE_FUNC)(void* ptr, FMOD_MEMORY_TYPE type, const char* sourcestr);
+typedef void        (F_CALL *FMOD_DSP_LOG_FUNC)(int level, const char* file, int line, const char* function, const char* str, ...);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETSAMPLERATE_FUNC)(FMOD_DSP_STATE* dsp_state, int* rate);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETBLOCKSIZE_FUNC)(FMOD_DSP_STATE* dsp_state, unsigned int* blocksize);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETSPEAKERMODE_FUNC)(FMOD_DSP_STATE* dsp_state, FMOD_SPEAKERMODE* speakermode_mixer, FMOD_SPEAKERMODE* speakermode_output);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETCLOCK_FUNC)(FMOD_DSP_STATE* dsp_state, unsigned long long* clock, unsigned int* offset, unsigned int* length);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETLISTENERATTRIBUTES_FUNC)(FMOD_DSP_STATE* dsp_state, int* numlisteners, FMOD_3D_ATTRIBUTES* attributes);
+typedef FMOD_RESULT (F_CALL *FMOD_DSP_GETUSERDATA_FUNC)(FMOD_DSP_STATE* dsp_state, void** userdata);
+
+typedef struct FMOD_DSP_PARAMETER_FLOAT_MAPPING_PIECEWISE_LINEAR {
+    int    numpoints;
+    float* pointparamvalues;
+    float* pointpositions;
+} FMOD_DSP_PARAMETER_FLOAT_MAPPING_PIECEWISE_LINEAR;
+
+typedef struct FMOD_DSP_PARAMETER_FLOAT_MAPPING {
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE             type;
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING_PIECEWISE_LINEAR piecewiselinearmapping;
+} FMOD_DSP_PARAMETER_FLOAT_MAPPING;
+
+typedef struct FMOD_DSP_PARAMETER_DESC_FLOAT {
+    float                            min;
+    float                            max;
+    float                            defaultval;
+    FMOD_DSP_PARAMETER_FLOAT_MAPPING mapping;
+} FMOD_DSP_PARAMETER_DESC_FLOAT;
+
+typedef struct FMOD_DSP_PARAMETER_DESC_INT {
+    int                min;
+    int                max;
+    int                defaultval;
+    FMOD_BOOL          goestoinf;
+    const char* const* valuenames;
+} FMOD_DSP_PARAMETER_DESC_INT;
+
+typedef struct FMOD_DSP_PARAMETER_DESC_BOOL {
+    FMOD_BOOL          defaultval;
+    const char* const* valuenames;
+} FMOD_DSP_PARAMETER_DESC_BOOL;
+
+typedef struct FMOD_DSP_PARAMETER_DESC_DATA {
+    int datatype;
+} FMOD_DSP_PARAMETER_DESC_DATA;
+
+typedef struct FMOD_DSP_PARAMETER_DESC {
+    FMOD_DSP_PARAMETER_TYPE type;
+    char                    name[16];
+    char                    label[16];
+    const char*             description;
+
+    union {
+        FMOD_DSP_PARAMETER_DESC_FLOAT floatdesc;
+        FMOD_DSP_PARAMETER_DESC_INT   intdesc;
+        FMOD_DSP_PARAMETER_DESC_BOOL  booldesc;
+        FMOD_DSP_PARAMETER_DESC_DATA  datadesc;
+    };
+} FMOD_DSP_PARAMETER_DESC;
+
+typedef struct FMOD_DSP_DESCRIPTION {
+    unsigned int                        pluginsdkversion;
+    char                                name[32];
+    unsigned int                        version;
+    int                                 numinputbuffers;
+    int                                 numoutputbuffers;
+    FMOD_DSP_CREATE_CALLBACK            create;
+    FMOD_DSP_RELEASE_CALLBACK           release;
+    FMOD_DSP_RESET_CALLBACK             reset;
+    FMOD_DSP_READ_CALLBACK              read;
+    FMOD_DSP_PROCESS_CALLBACK           process;
+    FMOD_DSP_SETPOSITION_CALLBACK       setposition;
+    int                                 numparameters;
+    FMOD_DSP_PARAMETER_DESC**           paramdesc;
+    FMOD_DSP_SETPARAM_FLOAT_CALLBACK    setparameterfloat;
+    FMOD_DSP_SETPARAM_INT_CALLBACK      setparameterint;
+    FMOD_DSP_SETPARAM_BOOL_CALLBACK     setparameterbool;
+    FMOD_DSP_SETPARAM_DATA_CALLBACK     setparameterdata;
+    FMOD_DSP_GETPARAM_FLOAT_CALLBACK    getparameterfloat;
+    FMOD_DSP_GETPARAM_INT_CALLBACK      getparameterint;
+    FMOD_DSP_GETPARAM_BOOL_CALLBACK     getparameterbool;
+    FMOD_DSP_GETPARAM_DATA_CALLBACK     getparameterdata;
+    FMOD_DSP_SHOULDIPROCESS_CALLBACK    shouldiprocess;
+    void*                               userdata;
+    FMOD_DSP_SYSTEM_REGISTER_CALLBACK   sys_register;
+    FMOD_DSP_SYSTEM_DEREGISTER_CALLBACK sys_deregister;
+    FMOD_DSP_SYSTEM_MIX_CALLBACK        sys_mix;
+} FMOD_DSP_DESCRIPTION;
+
+struct FMOD_DSP_BUFFER_ARRAY {
+    int               numbuffers;
+    int*              buffernumchannels;
+    FMOD_CHANNELMASK* bufferchannelmask;
+    float**           buffers;
+    FMOD_SPEAKERMODE  speakermode;
+};
+
+typedef struct FMOD_DSP_STATE_FUNCTIONS {
+    FMOD_DSP_ALLOC_FUNC                 alloc;
+    FMOD_DSP_REALLOC_FUNC               realloc;
+    FMOD_DSP_FREE_FUNC                  free;
+    FMOD_DSP_GETSAMPLERATE_FUNC         getsamplerate;
+    FMOD_DSP_GETBLOCKSIZE_FUNC          getblocksize;
+    void*                               dft;
+    void*                               pan;
+    FMOD_DSP_GETSPEAKERMODE_FUNC        getspeakermode;
+    FMOD_DSP_GETCLOCK_FUNC              getclock;
+    FMOD_DSP_GETLISTENERATTRIBUTES_FUNC getlistenerattributes;
+    FMOD_DSP_LOG_FUNC                   log;
+    FMOD_DSP_GETUSERDATA_FUNC           getuserdata;
+} FMOD_DSP_STATE_FUNCTIONS;
+
+struct FMOD_DSP_STATE {
+    void*                     instance;
+    void*                     plugindata;
+    FMOD_CHANNELMASK          channelmask;
+    FMOD_SPEAKERMODE          source_speakermode;
+    float*                    sidechaindata;
+    int                       sidechainchannels;
+    FMOD_DSP_STATE_FUNCTIONS* functions;
+    int                       systemobject;
+};
+
+# define FMOD_DSP_INIT_PARAMDESC_FLOAT(_paramstruct, _name, _label, _description, _min, _max, _defaultval) \
+    memset(&(_paramstruct), 0, sizeof(_paramstruct)); \
+    (_paramstruct).type = FMOD_DSP_PARAMETER_TYPE_FLOAT; \
+    strncpy((_paramstruct).name, _name, 15); \
+    strncpy((_paramstruct).label, _label, 15); \
+    (_paramstruct).description = _description; \
+    (_paramstruct).floatdesc.min = _min; \
+    (_paramstruct).floatdesc.max = _max; \
+    (_paramstruct).floatdesc.defaultval = _defaultval; \
+    (_paramstruct).floatdesc.mapping.type = FMOD_DSP_PARAMETER_FLOAT_MAPPING_TYPE_AUTO;
+
+# define FMOD_DSP_INIT_PARAMDESC_INT(_paramstruct, _name, _label, _description, _min, _max, _defaultval, _goestoinf, _valuenames) \
+    memset(&(_paramstruct), 0, sizeof(_paramstruct)); \
+    (_paramstruct).type = FMOD_DSP_PARAMETER_TYPE_INT; \
+    strncpy((_paramstruct).name, _name, 15); \
+    strncpy((_paramstruct).label, _label, 15); \
+    (_paramstruct).description = _description; \
+    (_paramstruct).intdesc.min = _min; \
+    (_paramstruct).intdesc.max = _max; \
+    (_paramstruct).intdesc.defaultval = _defaultval; \
+    (_paramstruct).intdesc.goestoinf = _goestoinf; \
+    (_paramstruct).intdesc.valuenames = _valuenames;
+
+# define FMOD_DSP_INIT_PARAMDESC_BOOL(_paramstruct, _name, _label, _description, _defaultval, _valuenames) \
+    memset(&(_paramstruct), 0, sizeof(_paramstruct)); \
+    (_paramstruct).type = FMOD_DSP_PARAMETER_TYPE_BOOL; \
+    strncpy((_paramstruct).name, _name, 15); \
+    strncpy((_paramstruct).label, _label, 15); \
+    (_paramstruct).description = _description; \
+    (_paramstruct).booldesc.defaultval = _defaultval; \
+    (_paramstruct).booldesc.valuenames = _valuenames;
+
+# endif // FMOD_DSP_H